@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+
+option="$1"
+lines="${2:-100000}"
+# nothing generated is left in the tree
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+corpus=$dir/corpus.pine
+
+# roughly 10 lines per function
+corpus() {
+    {
+        echo "Vec2 :: struct {"
+        echo "    x: i32;"
+        echo "    y: i32;"
+        echo "}"
+        echo ""
+        for ((i = 0; i < lines / 10; i++)); do
+            echo "step_$i :: fn(a: i32, b: i32) i32 {"
+            echo "    v := Vec2{ .x = a, .y = b };"
+            echo "    n: i32 = v.x * 3 + v.y - $i;"
+            echo "    for (i: i32 = 0; i < 4; i += 1) {"
+            echo "        if (n > 100) { n = n - b; } else { n = n + a * 2; }"
+            echo "    }"
+            echo "    xs: [4]i32 = { a, b, n, $i };"
+            echo "    return xs[2] + v.x;"
+            echo "}"
+            echo ""
+        done
+        echo "main :: fn() void {"
+        echo "    x := step_0(1, 2);"
+        echo "}"
+    } > $corpus
+}
+
+# every declaration is a compound type sema has to compare, roughly 12 lines per function
+types_corpus() {
+    {
+        echo "Vec2 :: struct {"
+        echo "    x: i32;"
+        echo "    y: i32;"
+        echo "}"
+        echo ""
+        for ((i = 0; i < lines / 12; i++)); do
+            echo "shape_$i :: fn(p: *[4]Vec2, s: [][]i32, o: ?*Vec2) i64 {"
+            echo "    q: *[4]Vec2 = p;"
+            echo "    t: [][]i32 = s;"
+            echo "    w: ?*Vec2 = o;"
+            echo "    ps: [3]*[4]Vec2 = { p, q, p };"
+            echo "    ss: [2][][]i32 = { s, t };"
+            echo "    ws: [2]?*Vec2 = { w, o };"
+            echo "    first: *[4]Vec2 = ps[1];"
+            echo "    return cast(i64) first[2].x + cast(i64) ss[0].len + $i;"
+            echo "}"
+            echo ""
+        done
+        echo "main :: fn() void {"
+        echo "}"
+    } > $corpus
+}
+
+# the report ends with the peak rss of the whole build, the timing starts with sema
+build() {
+    echo "corpus: $(wc -l < $corpus) lines"
+    TIMEFORMAT="time: %R s"
+    time ./pine build $corpus -memory-report -pass-timing
+}
+
+if [[ $option == "memory" ]]; then
+    corpus
+    build
+elif [[ $option == "types" ]]; then
+    types_corpus
+    build
+else
+    echo "usage: ./bench.sh memory|types [lines]"
+fi
@@ -0,0 +1,644 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "include/alias.h"
+#include "include/exprs.h"
+#include "include/sema.h"
+#include "include/stb_ds.h"
+#include "include/stmnts.h"
+#include "include/strb.h"
+#include "include/types.h"
+#include "include/utils.h"
+
+// not a function with a body, or not a call
+#define ALIAS_NONE SIZE_MAX
+
+// a bit per argument, the rest are never candidates
+#define ALIAS_MAX_ARGS 64
+
+typedef struct AliasFn {
+    Stmnt *decl; // NULL if it isn't a function with a body
+    bool internal; // every call to it is in the program
+
+    uint64_t candidates; // pointer and slice arguments that can't be reassigned
+    uint64_t annotated; // #noalias
+    uint64_t written; // written through, or handed to something that does
+    uint64_t escaped; // used as a value, or handed to something that does
+    uint64_t noalias;
+    FnEffect effect;
+
+    // a local is pinned once its address can end up anywhere but an argument that doesn't escape
+    struct { const char *key; bool value; } *locals;
+    Arr(size_t) callees;
+} AliasFn;
+
+// fn hands its argument arg straight to callee_arg of callee
+typedef struct AliasEdge {
+    size_t fn;
+    size_t arg;
+    size_t callee;
+    size_t callee_arg;
+} AliasEdge;
+
+// the address of a local or a slice of a local array, callee is ALIAS_NONE unless it's passed straight to a function
+typedef struct AliasAddr {
+    size_t fn;
+    const char *local;
+    size_t callee;
+    size_t arg;
+} AliasAddr;
+
+typedef struct AliasCall {
+    size_t fn;
+    size_t callee;
+    Arr(Expr) args;
+} AliasCall;
+
+typedef struct Alias {
+    Sema *sema;
+    struct { const char *key; size_t value; } *fns; // name to index in the ast
+    struct { const char *key; bool value; } *globals; // true for variables, false for constants
+    AliasFn *info; // one per statement in the ast
+    Arr(AliasEdge) edges;
+    Arr(AliasAddr) addrs;
+    Arr(AliasCall) calls;
+    size_t cur; // function being walked
+} Alias;
+
+// where the pointer an argument carries points, a local or an argument of the caller
+typedef struct AliasRoot {
+    const char *local; // NULL if it's an argument
+    size_t arg;
+} AliasRoot;
+
+static void alias_expr(Alias *a, Expr *expr, bool accessed);
+static void alias_stmnt(Alias *a, Stmnt *stmnt);
+
+static bool alias_candidate_type(Type type) {
+    return type.kind == TkPtr || type.kind == TkSlice;
+}
+
+static AliasFn *alias_cur(Alias *a) {
+    return &a->info[a->cur];
+}
+
+static void alias_effect(Alias *a, FnEffect effect) {
+    AliasFn *fn = alias_cur(a);
+    if (effect < fn->effect) fn->effect = effect;
+}
+
+static bool alias_is_local(Alias *a, const char *name) {
+    return shgeti(alias_cur(a)->locals, name) >= 0;
+}
+
+static void alias_declare(Alias *a, Stmnt *stmnt) {
+    if (stmnt == NULL || (stmnt->kind != SkVarDecl && stmnt->kind != SkConstDecl)) return;
+    if (stmnt->vardecl.name.kind != EkIdent) return;
+
+    AliasFn *fn = alias_cur(a);
+    if (shgeti(fn->locals, stmnt->vardecl.name.ident) < 0) shput(fn->locals, stmnt->vardecl.name.ident, false);
+}
+
+// the argument of the current function an expression names, ALIAS_NONE if it isn't a candidate
+static size_t alias_arg_index(Alias *a, Expr *expr) {
+    while (expr->kind == EkGrouping) expr = expr->group;
+    if (expr->kind != EkIdent) return ALIAS_NONE;
+
+    AliasFn *fn = alias_cur(a);
+    Arr(Stmnt) args = fn->decl->fndecl.args;
+    for (size_t i = 0; i < arrlenu(args) && i < ALIAS_MAX_ARGS; i++) {
+        if ((fn->candidates >> i & 1) && streq(args[i].constdecl.name.ident, expr->ident)) return i;
+    }
+    return ALIAS_NONE;
+}
+
+static void alias_escape(Alias *a, size_t arg) {
+    if (arg == ALIAS_NONE) return;
+    alias_cur(a)->escaped |= (uint64_t)1 << arg;
+    alias_cur(a)->written |= (uint64_t)1 << arg;
+}
+
+// the variable an lvalue is part of, NULL if it could be anywhere else in memory
+static Expr *alias_root(Expr *expr) {
+    while (true) {
+        switch (expr->kind) {
+            case EkIdent:
+                return expr;
+            case EkGrouping:
+                expr = expr->group;
+                break;
+            case EkFieldAccess:
+                if (expr->fieldacc.deref || expr->fieldacc.accessing->type.kind != TkTypeDef) return NULL;
+                expr = expr->fieldacc.accessing;
+                break;
+            case EkArrayIndex:
+                if (expr->arrayidx.accessing->type.kind != TkArray) return NULL;
+                expr = expr->arrayidx.accessing;
+                break;
+            default:
+                return NULL;
+        }
+    }
+}
+
+// what an lvalue is reached from, through pointers too
+static Expr *alias_base(Expr *expr) {
+    while (true) {
+        switch (expr->kind) {
+            case EkGrouping:
+                expr = expr->group;
+                break;
+            case EkFieldAccess:
+                expr = expr->fieldacc.accessing;
+                break;
+            case EkArrayIndex:
+                expr = expr->arrayidx.accessing;
+                break;
+            default:
+                return expr;
+        }
+    }
+}
+
+static void alias_address(Alias *a, Expr *lvalue, size_t callee, size_t arg) {
+    Expr *root = alias_root(lvalue);
+    if (root != NULL && alias_is_local(a, root->ident)) {
+        arrpush(a->addrs, ((AliasAddr){
+            .fn = a->cur,
+            .local = root->ident,
+            .callee = callee,
+            .arg = arg,
+        }));
+    }
+
+    // a pointer into what an argument points at
+    alias_escape(a, alias_arg_index(a, alias_base(lvalue)));
+    alias_expr(a, lvalue, true);
+}
+
+// an argument passed straight to a function, callee is ALIAS_NONE if what it does with it isn't known
+static void alias_call_arg(Alias *a, Expr *expr, size_t callee, size_t i) {
+    while (expr->kind == EkGrouping) expr = expr->group;
+
+    size_t arg = alias_arg_index(a, expr);
+    if (arg != ALIAS_NONE) {
+        if (callee == ALIAS_NONE || i >= ALIAS_MAX_ARGS) {
+            alias_escape(a, arg);
+        } else {
+            arrpush(a->edges, ((AliasEdge){.fn = a->cur, .arg = arg, .callee = callee, .callee_arg = i}));
+        }
+        return;
+    }
+
+    if (expr->kind == EkUnop && expr->unop.kind == UkAddress) {
+        alias_address(a, expr->unop.val, callee, i);
+        return;
+    }
+
+    if (expr->kind == EkArraySlice) {
+        Expr *accessing = expr->arrayslice.accessing;
+        size_t sliced = alias_arg_index(a, accessing);
+
+        if (sliced != ALIAS_NONE && callee != ALIAS_NONE && i < ALIAS_MAX_ARGS) {
+            arrpush(a->edges, ((AliasEdge){.fn = a->cur, .arg = sliced, .callee = callee, .callee_arg = i}));
+            alias_expr(a, expr->arrayslice.slice, false);
+            return;
+        }
+        if (accessing->type.kind == TkArray) {
+            alias_address(a, accessing, callee, i);
+            alias_expr(a, expr->arrayslice.slice, false);
+            return;
+        }
+    }
+
+    alias_expr(a, expr, false);
+}
+
+static void alias_call(Alias *a, FnCall *call) {
+    // <soa>.push(v) and friends write to the container
+    if (call->name->kind != EkIdent) {
+        alias_effect(a, FeAny);
+        alias_expr(a, call->name->fieldacc.accessing, false);
+        for (size_t i = 0; i < arrlenu(call->args.exprs); i++) {
+            alias_call_arg(a, &call->args.exprs[i], ALIAS_NONE, i);
+        }
+        return;
+    }
+
+    ptrdiff_t at = shgeti(a->fns, call->name->ident);
+    size_t callee = at < 0 ? ALIAS_NONE : a->fns[at].value;
+    if (callee == ALIAS_NONE) {
+        // externs and anything else that isn't checked here
+        alias_effect(a, FeAny);
+    } else {
+        arrpush(alias_cur(a)->callees, callee);
+        arrpush(a->calls, ((AliasCall){.fn = a->cur, .callee = callee, .args = call->args.exprs}));
+    }
+
+    // sema moves every argument into exprs
+    for (size_t i = 0; i < arrlenu(call->args.exprs); i++) {
+        alias_call_arg(a, &call->args.exprs[i], callee, i);
+    }
+}
+
+// accessed is set for what's indexed or has a field read, anything else of array type decays to a pointer
+static void alias_expr(Alias *a, Expr *expr, bool accessed) {
+    if (!accessed && expr->type.kind == TkArray) {
+        Expr *root = alias_root(expr);
+        if (root != NULL && alias_is_local(a, root->ident)) {
+            alias_address(a, expr, ALIAS_NONE, 0);
+            return;
+        }
+    }
+
+    switch (expr->kind) {
+        case EkIdent: {
+            size_t arg = alias_arg_index(a, expr);
+            if (!accessed) alias_escape(a, arg);
+
+            ptrdiff_t global = shgeti(a->globals, expr->ident);
+            if (global >= 0 && a->globals[global].value && !alias_is_local(a, expr->ident)) alias_effect(a, FePure);
+        } break;
+        case EkFieldAccess: {
+            Expr *accessing = expr->fieldacc.accessing;
+            TypeKind kind = accessing->type.kind;
+            if (expr->fieldacc.deref || kind == TkPtr || kind == TkSoa) alias_effect(a, FePure);
+
+            // only the length of a slice is a plain value
+            bool len = expr->fieldacc.field->kind == EkIdent && streq(expr->fieldacc.field->ident, "len");
+            if ((kind == TkSlice || kind == TkString) && !len) {
+                alias_expr(a, accessing, false);
+            } else {
+                alias_expr(a, accessing, true);
+            }
+        } break;
+        case EkArrayIndex: {
+            Expr *accessing = expr->arrayidx.accessing;
+            Expr *root = alias_root(accessing);
+            if (accessing->type.kind != TkArray || root == NULL || !alias_is_local(a, root->ident)) alias_effect(a, FePure);
+
+            alias_expr(a, accessing, true);
+            alias_expr(a, expr->arrayidx.index, false);
+        } break;
+        case EkArraySlice:
+            alias_expr(a, expr->arrayslice.accessing, false);
+            alias_expr(a, expr->arrayslice.slice, false);
+            break;
+        case EkUnop:
+            if (expr->unop.kind == UkAddress) {
+                alias_address(a, expr->unop.val, ALIAS_NONE, 0);
+            } else if (expr->unop.kind != UkSizeof) {
+                alias_expr(a, expr->unop.val, false);
+            }
+            break;
+        case EkBinop:
+            alias_expr(a, expr->binop.left, false);
+            alias_expr(a, expr->binop.right, false);
+            break;
+        case EkGrouping:
+            alias_expr(a, expr->group, accessed);
+            break;
+        case EkRangeLit:
+            alias_expr(a, expr->rangelit.start, false);
+            alias_expr(a, expr->rangelit.end, false);
+            break;
+        case EkLiteral:
+            if (expr->literal.kind == LitkExprs) {
+                for (size_t i = 0; i < arrlenu(expr->literal.exprs); i++) {
+                    alias_expr(a, &expr->literal.exprs[i], false);
+                }
+            } else if (expr->literal.kind == LitkVars) {
+                for (size_t i = 0; i < arrlenu(expr->literal.vars); i++) {
+                    alias_expr(a, &expr->literal.vars[i].varreassign.value, false);
+                }
+            }
+            break;
+        case EkFnCall:
+            alias_call(a, &expr->fncall);
+            break;
+        default: break;
+    }
+}
+
+// <lvalue> = <value>, anything but a local of the function is memory the caller can see
+static void alias_target(Alias *a, Expr *expr) {
+    bool through = false;
+    Expr *cur = expr;
+    while (true) {
+        if (cur->kind == EkGrouping) {
+            cur = cur->group;
+        } else if (cur->kind == EkFieldAccess) {
+            if (cur->fieldacc.deref || cur->fieldacc.accessing->type.kind != TkTypeDef) through = true;
+            cur = cur->fieldacc.accessing;
+        } else if (cur->kind == EkArrayIndex) {
+            if (cur->arrayidx.accessing->type.kind != TkArray) through = true;
+            alias_expr(a, cur->arrayidx.index, false);
+            cur = cur->arrayidx.accessing;
+        } else {
+            break;
+        }
+    }
+
+    size_t arg = alias_arg_index(a, cur);
+    if (arg != ALIAS_NONE) alias_cur(a)->written |= (uint64_t)1 << arg;
+
+    bool local = cur->kind == EkIdent && alias_is_local(a, cur->ident);
+    if (through || !local) alias_effect(a, FeAny);
+    if (through) alias_expr(a, cur, true);
+}
+
+static void alias_block(Alias *a, Arr(Stmnt) block) {
+    for (size_t i = 0; i < arrlenu(block); i++) {
+        alias_stmnt(a, &block[i]);
+    }
+}
+
+static void alias_stmnt(Alias *a, Stmnt *stmnt) {
+    switch (stmnt->kind) {
+        case SkVarDecl:
+        case SkConstDecl:
+            alias_declare(a, stmnt);
+            alias_expr(a, &stmnt->vardecl.value, false);
+            break;
+        case SkVarReassign:
+            alias_target(a, &stmnt->varreassign.name);
+            alias_expr(a, &stmnt->varreassign.value, false);
+            break;
+        case SkReturn:
+            alias_expr(a, &stmnt->returnf.value, false);
+            break;
+        case SkDefer:
+            alias_stmnt(a, stmnt->defer);
+            break;
+        case SkFnCall:
+            alias_call(a, &stmnt->fncall);
+            break;
+        case SkIf:
+            alias_expr(a, &stmnt->iff.condition, false);
+            if (stmnt->iff.capturekind == CkConstDecl) alias_declare(a, stmnt->iff.capture.constdecl);
+            alias_block(a, stmnt->iff.body);
+            alias_block(a, stmnt->iff.els);
+            break;
+        case SkFor:
+            alias_stmnt(a, stmnt->forf.decl);
+            // a loop that might never end can't be dropped along with an unused result
+            if (stmnt->forf.condition.kind == EkNone || stmnt->forf.condition.kind == EkTrue) alias_effect(a, FeAny);
+            alias_expr(a, &stmnt->forf.condition, false);
+            alias_stmnt(a, stmnt->forf.reassign);
+            alias_block(a, stmnt->forf.body);
+            break;
+        case SkSwitch:
+            alias_expr(a, &stmnt->switchf.value, false);
+            for (size_t i = 0; i < arrlenu(stmnt->switchf.cases); i++) {
+                Case *c = &stmnt->switchf.cases[i];
+                alias_declare(a, c->capture_decl);
+                alias_block(a, c->body);
+            }
+            break;
+        case SkBlock:
+            alias_block(a, stmnt->block);
+            break;
+        default: break;
+    }
+}
+
+static bool alias_root_of(Alias *a, size_t fn, Expr *expr, AliasRoot *root) {
+    while (expr->kind == EkGrouping) expr = expr->group;
+
+    size_t saved = a->cur;
+    a->cur = fn;
+
+    bool known = false;
+    Expr *local = NULL;
+    if (expr->kind == EkUnop && expr->unop.kind == UkAddress) {
+        local = alias_root(expr->unop.val);
+    } else if (expr->kind == EkArraySlice && expr->arrayslice.accessing->type.kind == TkArray) {
+        local = alias_root(expr->arrayslice.accessing);
+    } else {
+        Expr *sliced = expr->kind == EkArraySlice ? expr->arrayslice.accessing : expr;
+        size_t arg = alias_arg_index(a, sliced);
+        if (arg != ALIAS_NONE) {
+            *root = (AliasRoot){.local = NULL, .arg = arg};
+            known = true;
+        }
+    }
+
+    if (local != NULL && alias_is_local(a, local->ident)) {
+        *root = (AliasRoot){.local = local->ident, .arg = 0};
+        known = true;
+    }
+
+    a->cur = saved;
+    return known;
+}
+
+static bool alias_root_eq(AliasRoot x, AliasRoot y) {
+    if (x.local != NULL || y.local != NULL) return x.local != NULL && y.local != NULL && streq(x.local, y.local);
+    return x.arg == y.arg;
+}
+
+// nothing else the callee can reach points at what argument j of the call does
+static bool alias_disjoint(Alias *a, AliasCall call, size_t j) {
+    if (j >= arrlenu(call.args)) return false;
+
+    AliasFn *caller = &a->info[call.fn];
+    AliasFn *callee = &a->info[call.callee];
+
+    AliasRoot root;
+    if (!alias_root_of(a, call.fn, &call.args[j], &root)) return false;
+
+    // a local nothing else points at, or an argument that's restrict in the caller and isn't handed on
+    if (root.local != NULL) {
+        if (shget(caller->locals, root.local)) return false;
+    } else if (!(caller->noalias >> root.arg & 1) || (caller->escaped >> root.arg & 1)) {
+        return false;
+    }
+
+    uint64_t readonly = callee->candidates & ~callee->written & ~callee->escaped;
+    for (size_t k = 0; k < arrlenu(call.args); k++) {
+        if (k == j || !alias_candidate_type(call.args[k].type)) continue;
+
+        // pointers that aren't from a local or an argument can't point at either, see above
+        AliasRoot other;
+        if (!alias_root_of(a, call.fn, &call.args[k], &other) || !alias_root_eq(root, other)) continue;
+
+        bool both_read = k < ALIAS_MAX_ARGS && (readonly >> j & 1) && (readonly >> k & 1);
+        if (!both_read) return false;
+    }
+
+    return true;
+}
+
+static void alias_report_names(strb *line, const char *what, Arr(Stmnt) args, uint64_t bits) {
+    if (bits == 0) return;
+
+    strbprintf(line, "%s%s", *line == NULL ? "" : "; ", what);
+    bool first = true;
+    for (size_t i = 0; i < arrlenu(args) && i < ALIAS_MAX_ARGS; i++) {
+        if (!(bits >> i & 1)) continue;
+        strbprintf(line, first ? " %s" : ", %s", args[i].constdecl.name.ident);
+        first = false;
+    }
+}
+
+void alias_analyse(Sema *sema, bool library, bool report) {
+    Arr(Stmnt) ast = sema->ast;
+    size_t len = arrlenu(ast);
+
+    Alias a = {
+        .sema = sema,
+        .fns = NULL,
+        .globals = NULL,
+        .info = ealloc(sizeof(AliasFn) * (len + 1)),
+        .edges = NULL,
+        .addrs = NULL,
+        .calls = NULL,
+        .cur = 0,
+    };
+    memset(a.info, 0, sizeof(AliasFn) * (len + 1));
+
+    for (size_t i = 0; i < len; i++) {
+        Stmnt *stmnt = &ast[i];
+
+        // #noalias is trusted on externs, nothing else is known about them
+        if (stmnt->kind == SkExtern && stmnt->externf->kind == SkFnDecl) {
+            FnDecl *fndecl = &stmnt->externf->fndecl;
+            for (size_t j = 0; j < arrlenu(fndecl->args) && j < ALIAS_MAX_ARGS; j++) {
+                if (fndecl->args[j].constdecl.noalias) fndecl->alias.noalias |= (uint64_t)1 << j;
+            }
+            continue;
+        }
+
+        if (stmnt->kind == SkVarDecl || stmnt->kind == SkConstDecl) {
+            if (stmnt->vardecl.name.kind == EkIdent) shput(a.globals, stmnt->vardecl.name.ident, stmnt->kind == SkVarDecl);
+            continue;
+        }
+
+        if (stmnt->kind != SkFnDecl || !stmnt->fndecl.has_body || stmnt->fndecl.name.kind != EkIdent) continue;
+        FnDecl *fndecl = &stmnt->fndecl;
+        shput(a.fns, fndecl->name.ident, i);
+
+        AliasFn *info = &a.info[i];
+        info->decl = stmnt;
+        info->internal = !library && !streq(fndecl->name.ident, "main");
+        info->effect = FeConst;
+
+        for (size_t j = 0; j < arrlenu(fndecl->args) && j < ALIAS_MAX_ARGS; j++) {
+            Stmnt arg = fndecl->args[j];
+            if (arg.constdecl.noalias) info->annotated |= (uint64_t)1 << j;
+            if (arg.kind == SkConstDecl && alias_candidate_type(arg.constdecl.type)) info->candidates |= (uint64_t)1 << j;
+        }
+    }
+
+    // every function is walked once, what it does to its arguments is all it needs from the others
+    for (size_t i = 0; i < len; i++) {
+        if (a.info[i].decl == NULL) continue;
+        a.cur = i;
+
+        // arrays are passed as a pointer to the caller's, so they aren't the function's own memory
+        FnDecl *fndecl = &a.info[i].decl->fndecl;
+        for (size_t j = 0; j < arrlenu(fndecl->args); j++) {
+            if (fndecl->args[j].constdecl.type.kind != TkArray) alias_declare(&a, &fndecl->args[j]);
+        }
+        alias_block(&a, fndecl->body);
+    }
+
+    // an argument handed on is written and escapes if the one it's handed to does
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 0; i < arrlenu(a.edges); i++) {
+            AliasEdge e = a.edges[i];
+            AliasFn *fn = &a.info[e.fn];
+            AliasFn *callee = &a.info[e.callee];
+
+            uint64_t bit = (uint64_t)1 << e.arg;
+            bool candidate = e.callee_arg < ALIAS_MAX_ARGS && (callee->candidates >> e.callee_arg & 1);
+            bool written = !candidate || (callee->written >> e.callee_arg & 1);
+            bool escaped = !candidate || (callee->escaped >> e.callee_arg & 1);
+
+            if (written && !(fn->written & bit)) { fn->written |= bit; changed = true; }
+            if (escaped && !(fn->escaped & bit)) { fn->escaped |= bit; changed = true; }
+        }
+    }
+
+    for (size_t i = 0; i < arrlenu(a.addrs); i++) {
+        AliasAddr addr = a.addrs[i];
+        AliasFn *callee = addr.callee == ALIAS_NONE ? NULL : &a.info[addr.callee];
+
+        bool kept = callee != NULL && addr.arg < ALIAS_MAX_ARGS
+            && (callee->candidates >> addr.arg & 1) && !(callee->escaped >> addr.arg & 1);
+        if (!kept) shput(a.info[addr.fn].locals, addr.local, true);
+    }
+
+    // assume every argument that could be restrict is, then drop the ones a call proves wrong until nothing changes
+    for (size_t i = 0; i < len; i++) {
+        AliasFn *info = &a.info[i];
+        info->noalias = info->annotated | (info->internal ? info->candidates : 0);
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 0; i < arrlenu(a.calls); i++) {
+            AliasCall call = a.calls[i];
+            AliasFn *callee = &a.info[call.callee];
+
+            uint64_t proven = callee->noalias & ~callee->annotated;
+            for (size_t j = 0; j < ALIAS_MAX_ARGS && proven >> j != 0; j++) {
+                if (!(proven >> j & 1) || alias_disjoint(&a, call, j)) continue;
+                callee->noalias &= ~((uint64_t)1 << j);
+                changed = true;
+            }
+        }
+    }
+
+    // a function does at most what the functions it calls do
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 0; i < len; i++) {
+            AliasFn *info = &a.info[i];
+            for (size_t j = 0; j < arrlenu(info->callees); j++) {
+                FnEffect callee = a.info[info->callees[j]].effect;
+                if (callee < info->effect) {
+                    info->effect = callee;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        AliasFn *info = &a.info[i];
+        if (info->decl == NULL) continue;
+
+        FnDecl *fndecl = &info->decl->fndecl;
+        fndecl->alias = (FnAlias){
+            .noalias = info->noalias,
+            .readonly = info->candidates & ~info->written & ~info->escaped,
+            .effect = info->effect,
+        };
+
+        if (!report) continue;
+
+        // gen only puts pure and const on functions that return something
+        strb line = NULL;
+        alias_report_names(&line, "restrict", fndecl->args, fndecl->alias.noalias);
+        alias_report_names(&line, "readonly", fndecl->args, fndecl->alias.readonly);
+        if (fndecl->alias.effect != FeAny && fndecl->type.kind != TkVoid) {
+            strbprintf(&line, "%s%s", line == NULL ? "" : "; ", fndecl->alias.effect == FeConst ? "const" : "pure");
+        }
+        if (line != NULL) printfln("%s: %s", fndecl->name.ident, line);
+        strbfree(line);
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        shfree(a.info[i].locals);
+        arrfree(a.info[i].callees);
+    }
+    free(a.info);
+    arrfree(a.edges);
+    arrfree(a.addrs);
+    arrfree(a.calls);
+    shfree(a.fns);
+    shfree(a.globals);
+}
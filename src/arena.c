@@ -0,0 +1,65 @@
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/arena.h"
+#include "include/utils.h"
+
+_Thread_local Arena ast_arena = {0};
+
+static Arena retired = {0};
+static pthread_mutex_t retired_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+
+    ArenaBlock *block = arena->head;
+    if (block == NULL || block->used + size > block->cap) {
+        size_t cap = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = ealloc(sizeof(ArenaBlock) + cap);
+        block->next = arena->head;
+        block->used = 0;
+        block->cap = cap;
+        arena->head = block;
+        arena->reserved += cap;
+    }
+
+    void *mem = block->data + block->used;
+    block->used += size;
+    arena->used += size;
+    arena->allocs += 1;
+
+    memset(mem, 0, size);
+    return mem;
+}
+
+void arena_free(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    *arena = (Arena){0};
+}
+
+void arena_retire(Arena *arena) {
+    pthread_mutex_lock(&retired_lock);
+    retired.allocs += arena->allocs;
+    retired.used += arena->used;
+    retired.reserved += arena->reserved;
+    pthread_mutex_unlock(&retired_lock);
+
+    *arena = (Arena){0};
+}
+
+Arena arena_usage(void) {
+    pthread_mutex_lock(&retired_lock);
+    Arena usage = {
+        .allocs = retired.allocs + ast_arena.allocs,
+        .used = retired.used + ast_arena.used,
+        .reserved = retired.reserved + ast_arena.reserved,
+    };
+    pthread_mutex_unlock(&retired_lock);
+    return usage;
+}
@@ -9,156 +9,223 @@ unsigned char builtin_defs[] = {
   0x6c, 0x75, 0x64, 0x65, 0x20, 0x3c, 0x73, 0x74, 0x72, 0x69, 0x6e, 0x67,
   0x2e, 0x68, 0x3e, 0x0a, 0x23, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65,
   0x20, 0x3c, 0x73, 0x74, 0x64, 0x62, 0x6f, 0x6f, 0x6c, 0x2e, 0x68, 0x3e,
-  0x0a, 0x23, 0x69, 0x66, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64,
-  0x28, 0x5f, 0x5f, 0x6c, 0x69, 0x6e, 0x75, 0x78, 0x5f, 0x5f, 0x29, 0x20,
-  0x7c, 0x7c, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f,
-  0x5f, 0x41, 0x50, 0x50, 0x4c, 0x45, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c,
-  0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x46,
-  0x72, 0x65, 0x65, 0x42, 0x53, 0x44, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c,
-  0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x4f,
-  0x70, 0x65, 0x6e, 0x42, 0x53, 0x44, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c,
-  0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x4e,
-  0x65, 0x74, 0x42, 0x53, 0x44, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c, 0x20,
-  0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x73, 0x75,
-  0x6e, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
-  0x64, 0x28, 0x5f, 0x5f, 0x43, 0x59, 0x47, 0x57, 0x49, 0x4e, 0x5f, 0x5f,
-  0x29, 0x0a, 0x23, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x20, 0x3c,
-  0x73, 0x79, 0x73, 0x2f, 0x74, 0x79, 0x70, 0x65, 0x73, 0x2e, 0x68, 0x3e,
-  0x0a, 0x23, 0x65, 0x6c, 0x69, 0x66, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e,
-  0x65, 0x64, 0x28, 0x5f, 0x57, 0x49, 0x4e, 0x33, 0x32, 0x29, 0x20, 0x7c,
+  0x0a, 0x23, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x20, 0x3c, 0x73,
+  0x74, 0x64, 0x6c, 0x69, 0x62, 0x2e, 0x68, 0x3e, 0x0a, 0x23, 0x69, 0x66,
+  0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x6c,
+  0x69, 0x6e, 0x75, 0x78, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x64,
+  0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x41, 0x50, 0x50,
+  0x4c, 0x45, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x64, 0x65, 0x66,
+  0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x46, 0x72, 0x65, 0x65, 0x42,
+  0x53, 0x44, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x64, 0x65, 0x66,
+  0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x4f, 0x70, 0x65, 0x6e, 0x42,
+  0x53, 0x44, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x64, 0x65, 0x66,
+  0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x4e, 0x65, 0x74, 0x42, 0x53,
+  0x44, 0x5f, 0x5f, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x64, 0x65, 0x66, 0x69,
+  0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x73, 0x75, 0x6e, 0x29, 0x20, 0x7c,
   0x7c, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f,
-  0x4d, 0x49, 0x4e, 0x47, 0x57, 0x33, 0x32, 0x5f, 0x5f, 0x29, 0x0a, 0x23,
-  0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x20, 0x3c, 0x42, 0x61, 0x73,
-  0x65, 0x54, 0x73, 0x64, 0x2e, 0x68, 0x3e, 0x0a, 0x74, 0x79, 0x70, 0x65,
-  0x64, 0x65, 0x66, 0x20, 0x53, 0x53, 0x49, 0x5a, 0x45, 0x5f, 0x54, 0x20,
-  0x73, 0x73, 0x69, 0x7a, 0x65, 0x5f, 0x74, 0x3b, 0x0a, 0x23, 0x65, 0x6e,
-  0x64, 0x69, 0x66, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20,
-  0x69, 0x6e, 0x74, 0x38, 0x5f, 0x74, 0x20, 0x69, 0x38, 0x3b, 0x0a, 0x74,
-  0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x69, 0x6e, 0x74, 0x31, 0x36,
-  0x5f, 0x74, 0x20, 0x69, 0x31, 0x36, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65,
-  0x64, 0x65, 0x66, 0x20, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20,
-  0x69, 0x33, 0x32, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66,
-  0x20, 0x69, 0x6e, 0x74, 0x36, 0x34, 0x5f, 0x74, 0x20, 0x69, 0x36, 0x34,
-  0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x73,
-  0x69, 0x7a, 0x65, 0x5f, 0x74, 0x20, 0x69, 0x73, 0x69, 0x7a, 0x65, 0x3b,
+  0x43, 0x59, 0x47, 0x57, 0x49, 0x4e, 0x5f, 0x5f, 0x29, 0x0a, 0x23, 0x69,
+  0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x20, 0x3c, 0x73, 0x79, 0x73, 0x2f,
+  0x74, 0x79, 0x70, 0x65, 0x73, 0x2e, 0x68, 0x3e, 0x0a, 0x23, 0x65, 0x6c,
+  0x69, 0x66, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f,
+  0x57, 0x49, 0x4e, 0x33, 0x32, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x64, 0x65,
+  0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f, 0x5f, 0x4d, 0x49, 0x4e, 0x47,
+  0x57, 0x33, 0x32, 0x5f, 0x5f, 0x29, 0x0a, 0x23, 0x69, 0x6e, 0x63, 0x6c,
+  0x75, 0x64, 0x65, 0x20, 0x3c, 0x42, 0x61, 0x73, 0x65, 0x54, 0x73, 0x64,
+  0x2e, 0x68, 0x3e, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20,
+  0x53, 0x53, 0x49, 0x5a, 0x45, 0x5f, 0x54, 0x20, 0x73, 0x73, 0x69, 0x7a,
+  0x65, 0x5f, 0x74, 0x3b, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0a,
+  0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x69, 0x6e, 0x74, 0x38,
+  0x5f, 0x74, 0x20, 0x69, 0x38, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64,
+  0x65, 0x66, 0x20, 0x69, 0x6e, 0x74, 0x31, 0x36, 0x5f, 0x74, 0x20, 0x69,
+  0x31, 0x36, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20,
+  0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x69, 0x33, 0x32, 0x3b,
+  0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x69, 0x6e, 0x74,
+  0x36, 0x34, 0x5f, 0x74, 0x20, 0x69, 0x36, 0x34, 0x3b, 0x0a, 0x74, 0x79,
+  0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x73, 0x69, 0x7a, 0x65, 0x5f,
+  0x74, 0x20, 0x69, 0x73, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x74, 0x79, 0x70,
+  0x65, 0x64, 0x65, 0x66, 0x20, 0x75, 0x69, 0x6e, 0x74, 0x38, 0x5f, 0x74,
+  0x20, 0x75, 0x38, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66,
+  0x20, 0x75, 0x69, 0x6e, 0x74, 0x31, 0x36, 0x5f, 0x74, 0x20, 0x75, 0x31,
+  0x36, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x75,
+  0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20, 0x75, 0x33, 0x32, 0x3b,
   0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x75, 0x69, 0x6e,
-  0x74, 0x38, 0x5f, 0x74, 0x20, 0x75, 0x38, 0x3b, 0x0a, 0x74, 0x79, 0x70,
-  0x65, 0x64, 0x65, 0x66, 0x20, 0x75, 0x69, 0x6e, 0x74, 0x31, 0x36, 0x5f,
-  0x74, 0x20, 0x75, 0x31, 0x36, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64,
-  0x65, 0x66, 0x20, 0x75, 0x69, 0x6e, 0x74, 0x33, 0x32, 0x5f, 0x74, 0x20,
-  0x75, 0x33, 0x32, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66,
-  0x20, 0x75, 0x69, 0x6e, 0x74, 0x36, 0x34, 0x5f, 0x74, 0x20, 0x75, 0x36,
-  0x34, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73,
-  0x69, 0x7a, 0x65, 0x5f, 0x74, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x3b,
-  0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x66, 0x6c, 0x6f,
-  0x61, 0x74, 0x20, 0x66, 0x33, 0x32, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65,
-  0x64, 0x65, 0x66, 0x20, 0x64, 0x6f, 0x75, 0x62, 0x6c, 0x65, 0x20, 0x66,
-  0x36, 0x34, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20,
+  0x74, 0x36, 0x34, 0x5f, 0x74, 0x20, 0x75, 0x36, 0x34, 0x3b, 0x0a, 0x74,
+  0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x69, 0x7a, 0x65, 0x5f,
+  0x74, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x3b, 0x0a, 0x74, 0x79, 0x70,
+  0x65, 0x64, 0x65, 0x66, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x66,
+  0x33, 0x32, 0x3b, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20,
+  0x64, 0x6f, 0x75, 0x62, 0x6c, 0x65, 0x20, 0x66, 0x36, 0x34, 0x3b, 0x0a,
+  0x23, 0x69, 0x66, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x50, 0x49, 0x4e, 0x45,
+  0x5f, 0x52, 0x45, 0x41, 0x4c, 0x4c, 0x4f, 0x43, 0x0a, 0x23, 0x64, 0x65,
+  0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x49, 0x4e, 0x45, 0x5f, 0x52, 0x45,
+  0x41, 0x4c, 0x4c, 0x4f, 0x43, 0x28, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x73,
+  0x69, 0x7a, 0x65, 0x29, 0x20, 0x72, 0x65, 0x61, 0x6c, 0x6c, 0x6f, 0x63,
+  0x28, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x73, 0x69, 0x7a, 0x65, 0x29, 0x0a,
+  0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0a, 0x23, 0x69, 0x66, 0x6e, 0x64,
+  0x65, 0x66, 0x20, 0x50, 0x49, 0x4e, 0x45, 0x5f, 0x46, 0x52, 0x45, 0x45,
+  0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x49, 0x4e,
+  0x45, 0x5f, 0x46, 0x52, 0x45, 0x45, 0x28, 0x70, 0x74, 0x72, 0x29, 0x20,
+  0x66, 0x72, 0x65, 0x65, 0x28, 0x70, 0x74, 0x72, 0x29, 0x0a, 0x23, 0x65,
+  0x6e, 0x64, 0x69, 0x66, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66,
+  0x20, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x20, 0x50, 0x69, 0x6e, 0x65,
+  0x53, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20,
+  0x2a, 0x70, 0x74, 0x72, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x73,
+  0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x3b, 0x0a, 0x7d, 0x20, 0x50,
+  0x69, 0x6e, 0x65, 0x53, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x3b, 0x0a, 0x0a,
+  0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x69, 0x6e, 0x65,
+  0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x44, 0x65, 0x66, 0x28, 0x54,
+  0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x5c, 0x0a, 0x74, 0x79,
+  0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74,
+  0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x7b, 0x5c, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x54, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x3b, 0x5c,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c,
+  0x65, 0x6e, 0x3b, 0x5c, 0x0a, 0x7d, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53,
+  0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61,
+  0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20,
+  0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f,
+  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65,
+  0x73, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e,
+  0x61, 0x6d, 0x65, 0x28, 0x54, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x2c, 0x20,
+  0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x3b, 0x5c,
+  0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65,
+  0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e,
+  0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69, 0x63,
+  0x65, 0x31, 0x64, 0x5f, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x5f, 0x23, 0x23,
+  0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x54, 0x20, 0x2a, 0x70, 0x74, 0x72,
+  0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x73, 0x74, 0x61, 0x72,
+  0x74, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x65, 0x6e, 0x64,
+  0x29, 0x3b, 0x5c, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20,
   0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53,
-  0x74, 0x72, 0x69, 0x6e, 0x67, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20,
-  0x63, 0x6f, 0x6e, 0x73, 0x74, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x2a,
-  0x70, 0x74, 0x72, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x73, 0x69,
-  0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x3b, 0x0a, 0x7d, 0x20, 0x50, 0x69,
-  0x6e, 0x65, 0x53, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x3b, 0x0a, 0x0a, 0x23,
-  0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53,
-  0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x44, 0x65, 0x66, 0x28, 0x54, 0x2c,
-  0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x5c, 0x0a, 0x74, 0x79, 0x70,
-  0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x20,
+  0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61,
+  0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x7b, 0x5c,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x54, 0x20, 0x2a, 0x72, 0x65, 0x73, 0x74,
+  0x72, 0x69, 0x63, 0x74, 0x20, 0x70, 0x74, 0x72, 0x3b, 0x5c, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e,
+  0x3b, 0x5c, 0x0a, 0x7d, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69,
+  0x63, 0x65, 0x31, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61, 0x73, 0x5f,
+  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x73, 0x74,
+  0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69,
+  0x63, 0x65, 0x31, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61, 0x73, 0x5f,
+  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65,
+  0x73, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x6e, 0x6f, 0x61, 0x6c,
+  0x69, 0x61, 0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28,
   0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f,
-  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x7b, 0x5c, 0x0a, 0x20,
-  0x20, 0x20, 0x20, 0x54, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x3b, 0x5c, 0x0a,
-  0x20, 0x20, 0x20, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65,
-  0x6e, 0x3b, 0x5c, 0x0a, 0x7d, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c,
+  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x73, 0x6c, 0x69, 0x63,
+  0x65, 0x29, 0x3b, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+  0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x49,
+  0x6d, 0x70, 0x28, 0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29,
+  0x5c, 0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e,
+  0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54,
+  0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69,
+  0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
+  0x28, 0x54, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x69,
+  0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65,
+  0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x72,
+  0x65, 0x74, 0x20, 0x3d, 0x20, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c,
   0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
-  0x65, 0x3b, 0x5c, 0x0a, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63,
+  0x65, 0x29, 0x7b, 0x2e, 0x6c, 0x65, 0x6e, 0x20, 0x3d, 0x20, 0x6c, 0x65,
+  0x6e, 0x7d, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74,
+  0x2e, 0x70, 0x74, 0x72, 0x20, 0x3d, 0x20, 0x70, 0x74, 0x72, 0x3b, 0x5c,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20,
+  0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x5c, 0x0a, 0x73, 0x74, 0x61,
+  0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63,
   0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20,
   0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f,
-  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x54, 0x20, 0x2a, 0x70,
-  0x74, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65,
-  0x6e, 0x29, 0x3b, 0x5c, 0x0a, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69,
-  0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
-  0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64,
-  0x5f, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61,
-  0x6d, 0x65, 0x28, 0x54, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x75,
-  0x73, 0x69, 0x7a, 0x65, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74, 0x2c, 0x20,
-  0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x65, 0x6e, 0x64, 0x29, 0x3b, 0x0a,
-  0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x69, 0x6e, 0x65,
-  0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x49, 0x6d, 0x70, 0x28, 0x54,
-  0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x5c, 0x0a, 0x50, 0x69,
-  0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23,
-  0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c,
-  0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
+  0x72, 0x61, 0x6e, 0x67, 0x65, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
   0x65, 0x28, 0x54, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x75, 0x73,
-  0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x20, 0x7b, 0x5c, 0x0a,
-  0x20, 0x20, 0x20, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63,
-  0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20,
-  0x72, 0x65, 0x74, 0x20, 0x3d, 0x20, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53,
-  0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61,
-  0x6d, 0x65, 0x29, 0x7b, 0x2e, 0x6c, 0x65, 0x6e, 0x20, 0x3d, 0x20, 0x6c,
-  0x65, 0x6e, 0x7d, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65,
-  0x74, 0x2e, 0x70, 0x74, 0x72, 0x20, 0x3d, 0x20, 0x70, 0x74, 0x72, 0x3b,
-  0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e,
-  0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x5c, 0x0a, 0x50, 0x69,
-  0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23,
-  0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c,
-  0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x5f,
-  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x54, 0x20, 0x2a, 0x70,
-  0x74, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x73, 0x74,
-  0x61, 0x72, 0x74, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x65,
-  0x6e, 0x64, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50,
+  0x69, 0x7a, 0x65, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74, 0x2c, 0x20, 0x75,
+  0x73, 0x69, 0x7a, 0x65, 0x20, 0x65, 0x6e, 0x64, 0x29, 0x20, 0x7b, 0x5c,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69,
+  0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
+  0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72,
+  0x65, 0x74, 0x2e, 0x70, 0x74, 0x72, 0x20, 0x3d, 0x20, 0x26, 0x70, 0x74,
+  0x72, 0x5b, 0x73, 0x74, 0x61, 0x72, 0x74, 0x5d, 0x3b, 0x5c, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x6c, 0x65, 0x6e, 0x20, 0x3d,
+  0x20, 0x65, 0x6e, 0x64, 0x20, 0x2d, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74,
+  0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72,
+  0x6e, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x5c, 0x0a, 0x73,
+  0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c,
+  0x69, 0x63, 0x65, 0x31, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61, 0x73,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e,
+  0x65, 0x73, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x6e, 0x6f, 0x61,
+  0x6c, 0x69, 0x61, 0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
+  0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x73, 0x6c, 0x69,
+  0x63, 0x65, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72,
+  0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53,
+  0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61,
+  0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x7b, 0x73,
+  0x6c, 0x69, 0x63, 0x65, 0x2e, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x73, 0x6c,
+  0x69, 0x63, 0x65, 0x2e, 0x6c, 0x65, 0x6e, 0x7d, 0x3b, 0x5c, 0x0a, 0x7d,
+  0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x69, 0x6e,
+  0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x44, 0x65, 0x66, 0x28,
+  0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x5c, 0x0a, 0x74,
+  0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x74, 0x72, 0x75, 0x63,
+  0x74, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32,
+  0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x7b, 0x5c,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69,
+  0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
+  0x20, 0x2a, 0x70, 0x74, 0x72, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x3b, 0x5c, 0x0a,
+  0x7d, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32,
+  0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x3b, 0x5c, 0x0a,
+  0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53,
+  0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61,
+  0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69, 0x63, 0x65,
+  0x32, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x50,
   0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23,
-  0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c,
-  0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x70, 0x74, 0x72,
-  0x20, 0x3d, 0x20, 0x26, 0x70, 0x74, 0x72, 0x5b, 0x73, 0x74, 0x61, 0x72,
-  0x74, 0x5d, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74,
-  0x2e, 0x6c, 0x65, 0x6e, 0x20, 0x3d, 0x20, 0x65, 0x6e, 0x64, 0x20, 0x2d,
-  0x20, 0x31, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74,
-  0x75, 0x72, 0x6e, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x0a,
-  0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x69, 0x6e, 0x65,
-  0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x44, 0x65, 0x66, 0x28, 0x54,
-  0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x5c, 0x0a, 0x74, 0x79,
-  0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74,
-  0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64,
-  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x7b, 0x5c, 0x0a,
-  0x20, 0x20, 0x20, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63,
-  0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20,
-  0x2a, 0x70, 0x74, 0x72, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75,
-  0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x3b, 0x5c, 0x0a, 0x7d,
+  0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x2c,
+  0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x3b,
+  0x5c, 0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e,
+  0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23, 0x54,
+  0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69,
+  0x63, 0x65, 0x32, 0x64, 0x5f, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x5f, 0x23,
+  0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53,
+  0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61,
+  0x6d, 0x65, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x69,
+  0x7a, 0x65, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74, 0x2c, 0x20, 0x75, 0x73,
+  0x69, 0x7a, 0x65, 0x20, 0x65, 0x6e, 0x64, 0x29, 0x3b, 0x5c, 0x0a, 0x74,
+  0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x74, 0x72, 0x75, 0x63,
+  0x74, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32,
+  0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61, 0x73, 0x5f, 0x23, 0x23, 0x54,
+  0x6e, 0x61, 0x6d, 0x65, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f,
+  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x2a, 0x72, 0x65, 0x73,
+  0x74, 0x72, 0x69, 0x63, 0x74, 0x20, 0x70, 0x74, 0x72, 0x3b, 0x5c, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65,
+  0x6e, 0x3b, 0x5c, 0x0a, 0x7d, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c,
+  0x69, 0x63, 0x65, 0x32, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61, 0x73,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x73,
+  0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c,
+  0x69, 0x63, 0x65, 0x32, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61, 0x73,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e,
+  0x65, 0x73, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x6e, 0x6f, 0x61,
+  0x6c, 0x69, 0x61, 0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
+  0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x73, 0x6c, 0x69,
+  0x63, 0x65, 0x29, 0x3b, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
   0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64,
-  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x50,
-  0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23,
-  0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73,
-  0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61,
-  0x6d, 0x65, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65,
-  0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x2a,
-  0x70, 0x74, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c,
-  0x65, 0x6e, 0x29, 0x3b, 0x5c, 0x0a, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c,
+  0x49, 0x6d, 0x70, 0x28, 0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65,
+  0x29, 0x5c, 0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69,
+  0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23,
+  0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c,
   0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
-  0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69, 0x63, 0x65, 0x32,
-  0x64, 0x5f, 0x72, 0x61, 0x6e, 0x67, 0x65, 0x5f, 0x23, 0x23, 0x54, 0x6e,
-  0x61, 0x6d, 0x65, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63,
-  0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20,
-  0x2a, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20,
-  0x73, 0x74, 0x61, 0x72, 0x74, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65,
-  0x20, 0x65, 0x6e, 0x64, 0x29, 0x3b, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69,
-  0x6e, 0x65, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65,
-  0x32, 0x64, 0x49, 0x6d, 0x70, 0x28, 0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61,
-  0x6d, 0x65, 0x29, 0x5c, 0x0a, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69,
-  0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
-  0x20, 0x70, 0x69, 0x6e, 0x65, 0x73, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64,
-  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x50, 0x69, 0x6e,
-  0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31, 0x64, 0x5f, 0x23, 0x23, 0x54,
-  0x6e, 0x61, 0x6d, 0x65, 0x20, 0x2a, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x75,
-  0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x20, 0x7b, 0x5c,
-  0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69,
-  0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
-  0x20, 0x72, 0x65, 0x74, 0x20, 0x3d, 0x20, 0x28, 0x50, 0x69, 0x6e, 0x65,
-  0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e,
-  0x61, 0x6d, 0x65, 0x29, 0x7b, 0x2e, 0x6c, 0x65, 0x6e, 0x20, 0x3d, 0x20,
-  0x6c, 0x65, 0x6e, 0x7d, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72,
-  0x65, 0x74, 0x2e, 0x70, 0x74, 0x72, 0x20, 0x3d, 0x20, 0x70, 0x74, 0x72,
-  0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72,
-  0x6e, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x5c, 0x0a, 0x50,
+  0x65, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x31,
+  0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x2a, 0x70,
+  0x74, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6c, 0x65,
+  0x6e, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x69,
+  0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23, 0x23,
+  0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x72, 0x65, 0x74, 0x20, 0x3d, 0x20,
+  0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x7b, 0x2e, 0x6c,
+  0x65, 0x6e, 0x20, 0x3d, 0x20, 0x6c, 0x65, 0x6e, 0x7d, 0x3b, 0x5c, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x70, 0x74, 0x72, 0x20,
+  0x3d, 0x20, 0x70, 0x74, 0x72, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c,
+  0x0a, 0x7d, 0x5c, 0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50,
   0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x23,
   0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x73,
   0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x72, 0x61, 0x6e, 0x67, 0x65,
@@ -173,50 +240,66 @@ unsigned char builtin_defs[] = {
   0x72, 0x65, 0x74, 0x2e, 0x70, 0x74, 0x72, 0x20, 0x3d, 0x20, 0x26, 0x70,
   0x74, 0x72, 0x5b, 0x73, 0x74, 0x61, 0x72, 0x74, 0x5d, 0x3b, 0x5c, 0x0a,
   0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x6c, 0x65, 0x6e, 0x20,
-  0x3d, 0x20, 0x65, 0x6e, 0x64, 0x20, 0x2d, 0x20, 0x31, 0x3b, 0x5c, 0x0a,
-  0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72,
-  0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69,
-  0x6e, 0x65, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f,
-  0x6e, 0x44, 0x65, 0x66, 0x28, 0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d,
-  0x65, 0x29, 0x5c, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20,
-  0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f,
-  0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
-  0x65, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x54, 0x20, 0x73,
-  0x6f, 0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6f,
-  0x6f, 0x6c, 0x20, 0x6f, 0x6b, 0x3b, 0x5c, 0x0a, 0x7d, 0x20, 0x50, 0x69,
-  0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54,
-  0x6e, 0x61, 0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x50, 0x69, 0x6e, 0x65, 0x4f,
+  0x3d, 0x20, 0x65, 0x6e, 0x64, 0x20, 0x2d, 0x20, 0x73, 0x74, 0x61, 0x72,
+  0x74, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75,
+  0x72, 0x6e, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x5c, 0x0a,
+  0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x53,
+  0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69, 0x61,
+  0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69,
+  0x6e, 0x65, 0x73, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x5f, 0x6e, 0x6f,
+  0x61, 0x6c, 0x69, 0x61, 0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
+  0x65, 0x28, 0x50, 0x69, 0x6e, 0x65, 0x53, 0x6c, 0x69, 0x63, 0x65, 0x32,
+  0x64, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x73, 0x6c,
+  0x69, 0x63, 0x65, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x28, 0x50, 0x69, 0x6e, 0x65,
+  0x53, 0x6c, 0x69, 0x63, 0x65, 0x32, 0x64, 0x4e, 0x6f, 0x61, 0x6c, 0x69,
+  0x61, 0x73, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x7b,
+  0x73, 0x6c, 0x69, 0x63, 0x65, 0x2e, 0x70, 0x74, 0x72, 0x2c, 0x20, 0x73,
+  0x6c, 0x69, 0x63, 0x65, 0x2e, 0x6c, 0x65, 0x6e, 0x7d, 0x3b, 0x5c, 0x0a,
+  0x7d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50, 0x69,
+  0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x44, 0x65, 0x66, 0x28,
+  0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x5c, 0x0a, 0x74,
+  0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x73, 0x74, 0x72, 0x75, 0x63,
+  0x74, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x7b, 0x5c, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x54, 0x20, 0x73, 0x6f, 0x6d, 0x65, 0x3b, 0x5c,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6f, 0x6f, 0x6c, 0x20, 0x6f, 0x6b,
+  0x3b, 0x5c, 0x0a, 0x7d, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74,
+  0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x3b,
+  0x5c, 0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e,
+  0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e,
+  0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x6f, 0x70, 0x74, 0x69,
+  0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x54,
+  0x20, 0x73, 0x6f, 0x6d, 0x65, 0x29, 0x3b, 0x5c, 0x0a, 0x73, 0x74, 0x61,
+  0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69,
+  0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70,
+  0x69, 0x6e, 0x65, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x6e, 0x75, 0x6c,
+  0x6c, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x29, 0x3b,
+  0x5c, 0x0a, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x50,
+  0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x49, 0x6d, 0x70,
+  0x28, 0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x29, 0x5c, 0x0a,
+  0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f,
   0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
   0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e,
   0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x28, 0x54, 0x20, 0x73,
-  0x6f, 0x6d, 0x65, 0x29, 0x3b, 0x5c, 0x0a, 0x50, 0x69, 0x6e, 0x65, 0x4f,
-  0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d,
-  0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e,
-  0x6e, 0x75, 0x6c, 0x6c, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65,
-  0x28, 0x29, 0x3b, 0x5c, 0x0a, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e,
-  0x65, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e,
-  0x49, 0x6d, 0x70, 0x28, 0x54, 0x2c, 0x20, 0x54, 0x6e, 0x61, 0x6d, 0x65,
-  0x29, 0x5c, 0x0a, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f,
-  0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69,
-  0x6e, 0x65, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54,
-  0x6e, 0x61, 0x6d, 0x65, 0x28, 0x54, 0x20, 0x73, 0x6f, 0x6d, 0x65, 0x29,
-  0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x50, 0x69, 0x6e, 0x65,
-  0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61,
-  0x6d, 0x65, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20,
-  0x20, 0x72, 0x65, 0x74, 0x2e, 0x73, 0x6f, 0x6d, 0x65, 0x20, 0x3d, 0x20,
-  0x73, 0x6f, 0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72,
-  0x65, 0x74, 0x2e, 0x6f, 0x6b, 0x20, 0x3d, 0x20, 0x74, 0x72, 0x75, 0x65,
-  0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72,
-  0x6e, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x5c, 0x0a, 0x50,
-  0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23,
-  0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x6f, 0x70,
-  0x74, 0x69, 0x6f, 0x6e, 0x6e, 0x75, 0x6c, 0x6c, 0x5f, 0x23, 0x23, 0x54,
-  0x6e, 0x61, 0x6d, 0x65, 0x28, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20,
-  0x20, 0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e,
-  0x5f, 0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x72, 0x65, 0x74,
-  0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x6f,
-  0x6b, 0x20, 0x3d, 0x20, 0x66, 0x61, 0x6c, 0x73, 0x65, 0x3b, 0x5c, 0x0a,
-  0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72,
-  0x65, 0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x0a, 0x0a
+  0x6f, 0x6d, 0x65, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23,
+  0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x73, 0x6f, 0x6d,
+  0x65, 0x20, 0x3d, 0x20, 0x73, 0x6f, 0x6d, 0x65, 0x3b, 0x5c, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x6f, 0x6b, 0x20, 0x3d, 0x20,
+  0x74, 0x72, 0x75, 0x65, 0x3b, 0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72,
+  0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x5c, 0x0a,
+  0x7d, 0x5c, 0x0a, 0x73, 0x74, 0x61, 0x74, 0x69, 0x63, 0x20, 0x50, 0x69,
+  0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x23, 0x23, 0x54,
+  0x6e, 0x61, 0x6d, 0x65, 0x20, 0x70, 0x69, 0x6e, 0x65, 0x6f, 0x70, 0x74,
+  0x69, 0x6f, 0x6e, 0x6e, 0x75, 0x6c, 0x6c, 0x5f, 0x23, 0x23, 0x54, 0x6e,
+  0x61, 0x6d, 0x65, 0x28, 0x29, 0x20, 0x7b, 0x5c, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x50, 0x69, 0x6e, 0x65, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f,
+  0x23, 0x23, 0x54, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x72, 0x65, 0x74, 0x3b,
+  0x5c, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x2e, 0x6f, 0x6b,
+  0x20, 0x3d, 0x20, 0x66, 0x61, 0x6c, 0x73, 0x65, 0x3b, 0x5c, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72, 0x65,
+  0x74, 0x3b, 0x5c, 0x0a, 0x7d, 0x0a, 0x0a
 };
-unsigned int builtin_defs_len = 2624;
+unsigned int builtin_defs_len = 3619;
@@ -10,6 +10,18 @@ static Cli cli_init(char ***argv, int *argc) {
         .help = false,
         .command = CommandNone,
         .keepc = false,
+        .layout_report = false,
+        .switch_report = false,
+        .instantiation_report = false,
+        .memory_report = false,
+        .tree_shake_report = false,
+        .alias_report = false,
+        .threads = 0,
+        .byref_size = 16,
+        .pmi = false,
+        .ir = false,
+        .pass_timing = false,
+        .native = false,
         .filename = "",
         .pass_to_prog = false,
         .argv = *argv,
@@ -95,6 +107,18 @@ void cli_usage(Cli cli, bool force) {
             printfln("USAGE:");
             printfln("    build [filename]");
             printfln("    generate executable with entry point file");
+            printfln("    -layout-report | print size, alignment, padding and cache line usage of every struct");
+            printfln("    -switch-report | print how every switch statement is lowered");
+            printfln("    -instantiation-report | print every generic struct instance and how often it's used");
+            printfln("    -memory-report | print how much memory the tokens and ast take up, and the peak of the whole build");
+            printfln("    -tree-shake-report | print every function, type and instantiation dropped because nothing reaches it");
+            printfln("    -alias-report | print the arguments passed as restrict or const and the functions marked pure or const");
+            printfln("    -j [n] | parse imported files, check function bodies and generate C on n threads, defaults to one per core");
+            printfln("    -byref-size [n] | pass const struct, union and option arguments bigger than n bytes by pointer, defaults to 16, 0 copies every argument");
+            printfln("    -pmi | build an object file and a module interface other programs can #import instead of an executable");
+            printfln("    -ir | print the three address code of every function after the ir passes");
+            printfln("    -pass-timing | print how long sema, lowering to the ir and each ir pass took");
+            printfln("    -native | generate x86-64 assembly instead of C for #O0 and #Odebug, falls back to C for anything it can't generate");
             exit(0);
         } break;
         case CommandRun:
@@ -130,11 +154,52 @@ Cli cli_parse(char **argv, int argc) {
             cli_parse_help(&cli);
         } else if (streq(arg, "-keepc")) {
             cli.keepc = true;
+        } else if (streq(arg, "-layout-report")) {
+            cli.layout_report = true;
+        } else if (streq(arg, "-switch-report")) {
+            cli.switch_report = true;
+        } else if (streq(arg, "-instantiation-report")) {
+            cli.instantiation_report = true;
+        } else if (streq(arg, "-memory-report")) {
+            cli.memory_report = true;
+        } else if (streq(arg, "-tree-shake-report")) {
+            cli.tree_shake_report = true;
+        } else if (streq(arg, "-alias-report")) {
+            cli.alias_report = true;
+        } else if (streq(arg, "-j")) {
+            char *n = cli_args_next(&cli);
+            uint64_t threads = 0;
+            if (!parse_u64(n, &threads) || threads == 0) {
+                comp_elog("unexpected %s, expected number of threads after -j", n);
+            }
+            cli.threads = (size_t)threads;
+        } else if (streq(arg, "-byref-size")) {
+            char *n = cli_args_next(&cli);
+            uint64_t size = 0;
+            if (!parse_u64(n, &size)) {
+                comp_elog("unexpected %s, expected size in bytes after -byref-size", n);
+            }
+            cli.byref_size = (size_t)size;
+        } else if (streq(arg, "-pmi")) {
+            cli.pmi = true;
+        } else if (streq(arg, "-ir")) {
+            cli.ir = true;
+        } else if (streq(arg, "-pass-timing")) {
+            cli.pass_timing = true;
+        } else if (streq(arg, "-native")) {
+            cli.native = true;
         } else if (streq(arg, "--")) {
             cli.pass_to_prog = true;
             break;
         }
     }
 
+    if (cli.pmi && cli.command == CommandRun) {
+        comp_elog("unexpected -pmi, a library can't be run");
+    }
+    if (cli.pmi && cli.native) {
+        comp_elog("unexpected -native, a library is always compiled through C");
+    }
+
     return cli;
 }
@@ -3,96 +3,621 @@
 #include <stdint.h>
 #include "include/eval.h"
 #include "include/exprs.h"
+#include "include/layout.h"
+#include "include/stb_ds.h"
+#include "include/stmnts.h"
 #include "include/sema.h"
 #include "include/types.h"
 #include "include/utils.h"
 
-uint64_t eval_binop(Sema *sema, Expr *expr) {
-    assert(expr->kind == EkBinop);
+// guards against constants that refer to each other
+#define EVAL_MAX_DEPTH 64
+
+static bool eval_value_at(Sema *sema, Expr *expr, size_t depth, ConstValue *out);
+
+static bool is_float(Type type) {
+    return type.kind == TkF32 || type.kind == TkF64 || type.kind == TkUntypedFloat;
+}
+
+// typedefs that get this far are enums, which are ints in C
+static bool is_signed(Type type) {
+    switch (type.kind) {
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkUntypedInt:
+        case TkTypeDef:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_scalar(Type type) {
+    switch (type.kind) {
+        case TkBool:
+        case TkChar:
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkU8:
+        case TkU16:
+        case TkU32:
+        case TkU64:
+        case TkUsize:
+        case TkF32:
+        case TkF64:
+        case TkUntypedInt:
+        case TkUntypedFloat:
+        case TkTypeDef:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static size_t bit_width(Type type) {
+    switch (type.kind) {
+        case TkBool:
+            return 1;
+        case TkChar:
+        case TkI8:
+        case TkU8:
+            return 8;
+        case TkI16:
+        case TkU16:
+            return 16;
+        case TkI32:
+        case TkU32:
+        case TkTypeDef:
+            return 32;
+        default:
+            return 64;
+    }
+}
+
+static ConstValue wrap(ConstValue value) {
+    if (is_float(value.type)) {
+        if (value.type.kind == TkF32) value.f = (float)value.f;
+        return value;
+    }
+
+    size_t bits = bit_width(value.type);
+    if (bits == 1) {
+        value.u = value.u != 0;
+        return value;
+    }
+    if (bits == 64) return value;
+
+    uint64_t mask = (UINT64_C(1) << bits) - 1;
+    value.u &= mask;
+    if (is_signed(value.type) && (value.u >> (bits - 1)) & 1) {
+        value.u |= ~mask;
+    }
+    return value;
+}
+
+static ConstValue value_bool(bool b) {
+    return (ConstValue){
+        .type = type_bool(TYPEVAR, 0),
+        .u = b,
+    };
+}
+
+// integer promotion, same as the generated C does
+static Type promote(Type type) {
+    switch (type.kind) {
+        case TkBool:
+        case TkChar:
+        case TkI8:
+        case TkI16:
+        case TkU8:
+        case TkU16:
+        case TkTypeDef:
+            return type_integer(TkI32, TYPEVAR, 0);
+        case TkIsize:
+            return type_integer(TkI64, TYPEVAR, 0);
+        case TkUsize:
+            return type_integer(TkU64, TYPEVAR, 0);
+        default:
+            // untyped ints stay untyped so they can still take the type of what they're assigned to
+            return type;
+    }
+}
+
+// usual arithmetic conversions
+static Type common_type(Type lhs, Type rhs) {
+    if (is_float(lhs) || is_float(rhs)) {
+        if (lhs.kind == TkF64 || rhs.kind == TkF64) return type_decimal(TkF64, TYPEVAR, 0);
+        if (lhs.kind == TkF32 || rhs.kind == TkF32) return type_decimal(TkF32, TYPEVAR, 0);
+        return type_decimal(TkUntypedFloat, TYPEVAR, 0);
+    }
+
+    lhs = promote(lhs);
+    rhs = promote(rhs);
+    if (lhs.kind == rhs.kind) return lhs;
+    if (lhs.kind == TkUntypedInt) return rhs.kind == TkU64 ? rhs : type_integer(TkI64, TYPEVAR, 0);
+    if (rhs.kind == TkUntypedInt) return lhs.kind == TkU64 ? lhs : type_integer(TkI64, TYPEVAR, 0);
+
+    size_t lbits = bit_width(lhs);
+    size_t rbits = bit_width(rhs);
+    if (lbits != rbits) return lbits > rbits ? lhs : rhs;
+    return is_signed(lhs) ? rhs : lhs;
+}
+
+bool eval_convert(ConstValue value, Type type, ConstValue *out) {
+    if (type.kind == TkNone) {
+        *out = value;
+        return true;
+    }
+    if (!is_scalar(type) || !is_scalar(value.type)) return false;
+
+    ConstValue converted = {.type = type};
+    if (is_float(type)) {
+        if (is_float(value.type)) converted.f = value.f;
+        else if (is_signed(value.type)) converted.f = (double)value.i;
+        else converted.f = (double)value.u;
+    } else if (type.kind == TkBool) {
+        converted.u = is_float(value.type) ? value.f != 0 : value.u != 0;
+    } else if (is_float(value.type)) {
+        // float to int is undefined behaviour in C if it doesn't fit
+        size_t bits = bit_width(type);
+        double limit = (double)(UINT64_C(1) << (bits - 1));
+
+        if (is_signed(type)) {
+            if (!(value.f >= -limit && value.f < limit)) return false;
+            converted.i = (int64_t)value.f;
+        } else {
+            if (!(value.f >= 0 && value.f < limit * 2)) return false;
+            converted.u = (uint64_t)value.f;
+        }
+    } else {
+        converted.u = value.u;
+    }
+
+    *out = wrap(converted);
+    return true;
+}
+
+static bool eval_shift(BinopKind kind, ConstValue lhs, ConstValue rhs, ConstValue *out) {
+    if (is_float(lhs.type) || is_float(rhs.type)) return false;
+
+    Type type = promote(lhs.type);
+    if (!eval_convert(lhs, type, &lhs)) return false;
+
+    // shifting by the width or more is undefined behaviour in C
+    if (is_signed(rhs.type) && rhs.i < 0) return false;
+    if (rhs.u >= bit_width(type)) return false;
+
+    ConstValue result = {.type = type};
+    if (kind == BkLeftShift) {
+        result.u = lhs.u << rhs.u;
+    } else if (is_signed(type)) {
+        result.i = lhs.i >> rhs.u;
+    } else {
+        result.u = lhs.u >> rhs.u;
+    }
+
+    *out = wrap(result);
+    return true;
+}
 
-    uint64_t lhs = eval_expr(sema, expr->binop.left);
-    uint64_t rhs = eval_expr(sema, expr->binop.right);
+static bool eval_float_binop(BinopKind kind, Type type, double lhs, double rhs, ConstValue *out) {
+    ConstValue result = {.type = type};
 
-    switch (expr->binop.kind) {
+    switch (kind) {
         case BkPlus:
-            return lhs + rhs;
+            result.f = lhs + rhs;
+            break;
         case BkMinus:
-            return lhs - rhs;
+            result.f = lhs - rhs;
+            break;
         case BkMultiply:
-            return lhs * rhs;
+            result.f = lhs * rhs;
+            break;
         case BkDivide:
-            return lhs / rhs;
-        case BkMod:
-            return lhs % rhs;
+            result.f = lhs / rhs;
+            break;
         case BkLess:
-            return lhs < rhs;
+            *out = value_bool(lhs < rhs);
+            return true;
         case BkLessEqual:
-            return lhs <= rhs;
+            *out = value_bool(lhs <= rhs);
+            return true;
         case BkGreater:
-            return lhs > rhs;
+            *out = value_bool(lhs > rhs);
+            return true;
         case BkGreaterEqual:
-            return lhs >= rhs;
+            *out = value_bool(lhs >= rhs);
+            return true;
         case BkEquals:
-            return lhs == rhs;
+            *out = value_bool(lhs == rhs);
+            return true;
         case BkInequals:
-            return lhs != rhs;
-        case BkLeftShift:
-            return lhs << rhs;
-        case BkRightShift:
-            return lhs >> rhs;
+            *out = value_bool(lhs != rhs);
+            return true;
+        default:
+            return false;
+    }
+
+    // inf and nan don't have a literal in C
+    result = wrap(result);
+    if (result.f - result.f != 0) return false;
+
+    *out = result;
+    return true;
+}
+
+static bool eval_int_binop(BinopKind kind, Type type, ConstValue lhs, ConstValue rhs, ConstValue *out) {
+    bool sign = is_signed(type);
+    ConstValue result = {.type = type};
+
+    switch (kind) {
+        case BkPlus:
+            result.u = lhs.u + rhs.u;
+            break;
+        case BkMinus:
+            result.u = lhs.u - rhs.u;
+            break;
+        case BkMultiply:
+            result.u = lhs.u * rhs.u;
+            break;
+        case BkDivide:
+        case BkMod: {
+            if (rhs.u == 0) return false;
+
+            if (sign) {
+                // min / -1 overflows
+                int64_t min = bit_width(type) == 64 ? INT64_MIN : -(INT64_C(1) << (bit_width(type) - 1));
+                if (lhs.i == min && rhs.i == -1) return false;
+                result.i = kind == BkDivide ? lhs.i / rhs.i : lhs.i % rhs.i;
+            } else {
+                result.u = kind == BkDivide ? lhs.u / rhs.u : lhs.u % rhs.u;
+            }
+        } break;
+        case BkLess:
+            *out = value_bool(sign ? lhs.i < rhs.i : lhs.u < rhs.u);
+            return true;
+        case BkLessEqual:
+            *out = value_bool(sign ? lhs.i <= rhs.i : lhs.u <= rhs.u);
+            return true;
+        case BkGreater:
+            *out = value_bool(sign ? lhs.i > rhs.i : lhs.u > rhs.u);
+            return true;
+        case BkGreaterEqual:
+            *out = value_bool(sign ? lhs.i >= rhs.i : lhs.u >= rhs.u);
+            return true;
+        case BkEquals:
+            *out = value_bool(lhs.u == rhs.u);
+            return true;
+        case BkInequals:
+            *out = value_bool(lhs.u != rhs.u);
+            return true;
         case BkBitAnd:
-            return lhs & rhs;
+            result.u = lhs.u & rhs.u;
+            break;
         case BkBitOr:
-            return lhs | rhs;
+            result.u = lhs.u | rhs.u;
+            break;
         case BkBitXor:
-            return lhs ^ rhs;
+            result.u = lhs.u ^ rhs.u;
+            break;
+        case BkLeftShift:
+        case BkRightShift:
         case BkAnd:
-            return lhs && rhs;
         case BkOr:
-            return lhs || rhs;
+            assert(false && "handled in eval_binop");
     }
 
-    assert(false);
+    *out = wrap(result);
+    return true;
 }
 
-uint64_t eval_unop(Sema *sema, Expr *expr) {
-    assert(expr->kind == EkUnop);
+Type eval_binop_type(BinopKind kind, Type lhs, Type rhs) {
+    switch (kind) {
+        case BkLess:
+        case BkLessEqual:
+        case BkGreater:
+        case BkGreaterEqual:
+        case BkEquals:
+        case BkInequals:
+        case BkAnd:
+        case BkOr:
+            return type_bool(TYPEVAR, 0);
+        case BkLeftShift:
+        case BkRightShift:
+            return promote(lhs);
+        default:
+            return common_type(lhs, rhs);
+    }
+}
 
-    uint64_t val = eval_expr(sema, expr->unop.val);
+bool eval_apply_binop(BinopKind kind, ConstValue lhs, ConstValue rhs, ConstValue *out) {
+    if (kind == BkAnd) {
+        *out = value_bool(lhs.u && rhs.u);
+        return true;
+    }
+    if (kind == BkOr) {
+        *out = value_bool(lhs.u || rhs.u);
+        return true;
+    }
+    if (kind == BkLeftShift || kind == BkRightShift) {
+        return eval_shift(kind, lhs, rhs, out);
+    }
 
-    // TODO: add cast and sizeof to eval
-    switch (expr->unop.kind) {
-        case UkBitNot:
-            return ~val;
+    Type type = common_type(lhs.type, rhs.type);
+    if (!eval_convert(lhs, type, &lhs) || !eval_convert(rhs, type, &rhs)) return false;
+
+    if (is_float(type)) {
+        return eval_float_binop(kind, type, lhs.f, rhs.f, out);
+    }
+    return eval_int_binop(kind, type, lhs, rhs, out);
+}
+
+static bool eval_binop(Sema *sema, Expr *expr, size_t depth, ConstValue *out) {
+    assert(expr->kind == EkBinop);
+
+    ConstValue lhs, rhs;
+    if (!eval_value_at(sema, expr->binop.left, depth, &lhs) || !eval_value_at(sema, expr->binop.right, depth, &rhs)) {
+        return false;
+    }
+
+    return eval_apply_binop(expr->binop.kind, lhs, rhs, out);
+}
+
+static bool eval_sizeof(Sema *sema, Expr *expr, ConstValue *out) {
+    Expr *of = expr->unop.val->kind == EkGrouping ? expr->unop.val->group : expr->unop.val;
+
+    Type type;
+    if (of->kind == EkType) {
+        type = *of->type_expr;
+    } else if (of->kind == EkIdent) {
+        Stmnt decl = symtab_find(sema, of->ident, of->cursors_idx);
+        switch (decl.kind) {
+            case SkVarDecl:
+                type = decl.vardecl.type;
+                break;
+            case SkConstDecl:
+                type = decl.constdecl.type;
+                break;
+            case SkStructDecl:
+            case SkEnumDecl:
+            case SkUnionDecl:
+                type = type_typedef(of->ident, TYPEVAR, of->cursors_idx);
+                break;
+            default:
+                return false;
+        }
+    } else {
+        return false;
+    }
+
+    // field order isn't known until the struct is analysed
+    if (type.kind == TkTypeDef) {
+        Stmnt decl = ast_find_decl(sema->ast, type.typedeff);
+        if (decl.kind == SkStructDecl && decl.structdecl.attrs != NULL && !decl.structdecl.attrs->laid_out) {
+            return false;
+        }
+    }
+
+    size_t size = layout_sizeof(sema->ast, type);
+    if (size == 0) return false;
+
+    *out = (ConstValue){
+        .type = type_integer(TkUsize, TYPEVAR, 0),
+        .u = size,
+    };
+    return true;
+}
+
+Type eval_unop_type(UnopKind kind, Type type) {
+    if (kind == UkNot) return type_bool(TYPEVAR, 0);
+    return is_float(type) ? type : promote(type);
+}
+
+bool eval_apply_unop(UnopKind kind, ConstValue val, ConstValue *out) {
+    switch (kind) {
         case UkNot:
-            return !val;
+            *out = value_bool(!val.u);
+            return true;
         case UkNegate:
-            return -val;
+            if (is_float(val.type)) {
+                val.f = -val.f;
+                *out = val;
+                return true;
+            }
+            if (!eval_convert(val, promote(val.type), &val)) return false;
+            val.u = -val.u;
+            *out = wrap(val);
+            return true;
+        case UkBitNot:
+            if (is_float(val.type)) return false;
+            if (!eval_convert(val, promote(val.type), &val)) return false;
+            val.u = ~val.u;
+            *out = wrap(val);
+            return true;
         case UkAddress:
-            comp_elog("cannot take address at compile time");
-            return 0;
+        case UkCast:
+        case UkSizeof:
+            return false;
     }
 
     assert(false);
 }
 
-uint64_t eval_expr(Sema *sema, Expr *expr) {
-    sema_expr(sema, expr);
+static bool eval_unop(Sema *sema, Expr *expr, size_t depth, ConstValue *out) {
+    assert(expr->kind == EkUnop);
+
+    if (expr->unop.kind == UkSizeof) return eval_sizeof(sema, expr, out);
+    if (expr->unop.kind == UkAddress) return false;
+
+    ConstValue val;
+    if (!eval_value_at(sema, expr->unop.val, depth, &val)) return false;
+
+    if (expr->unop.kind == UkCast) return eval_convert(val, expr->type, out);
+    return eval_apply_unop(expr->unop.kind, val, out);
+}
+
+static bool eval_field_access(Sema *sema, Expr *expr, size_t depth, ConstValue *out) {
+    assert(expr->kind == EkFieldAccess);
+
+    Expr *accessing = expr->fieldacc.accessing;
+    const char *field = expr->fieldacc.field->ident;
+
+    Type type = accessing->type;
+    if (accessing->kind == EkIdent) {
+        Stmnt decl = symtab_find(sema, accessing->ident, accessing->cursors_idx);
+
+        if (decl.kind == SkEnumDecl) {
+            // <enum>.<field>
+            ConstValue value = {.type = type_typedef(decl.enumdecl.name.ident, TYPEVAR, expr->cursors_idx)};
+            if (!eval_enum_field(sema, decl.enumdecl, field, &value.u)) return false;
+
+            *out = wrap(value);
+            return true;
+        }
+
+        if (type.kind == TkNone && decl.kind == SkVarDecl) type = decl.vardecl.type;
+        if (type.kind == TkNone && decl.kind == SkConstDecl) type = decl.constdecl.type;
+    }
+
+    // <array>.len
+    if (type.kind == TkPtr) type = *type.ptr_to;
+    if (type.kind != TkArray || !streq(field, "len") || type.array.len->kind == EkNone) return false;
+
+    ConstValue len;
+    if (!eval_value_at(sema, type.array.len, depth, &len)) return false;
+    return eval_convert(len, type_integer(TkUsize, TYPEVAR, 0), out);
+}
+
+static bool eval_value_at(Sema *sema, Expr *expr, size_t depth, ConstValue *out) {
+    if (depth > EVAL_MAX_DEPTH) return false;
+    depth++;
 
     switch (expr->kind) {
-        case EkIntLit:
-            return (uint64_t)expr->numlit;
-        case EkIdent:
-            // TODO: find out if ident is compile time known
-            return 0;
-        case EkBinop:
-            return eval_binop(sema, expr);
+        case EkIntLit: {
+            Type type = expr->type.kind == TkNone ? type_integer(TkUntypedInt, TYPEVAR, 0) : expr->type;
+            ConstValue value = {.type = type, .u = expr->intlit};
+            // an int literal only ends up as a float when it's written straight into one, so it's never negative
+            if (is_float(type)) value.f = (double)expr->intlit;
+            *out = wrap(value);
+            return true;
+        }
+        case EkFloatLit:
+            *out = wrap((ConstValue){
+                .type = is_float(expr->type) ? expr->type : type_decimal(TkUntypedFloat, TYPEVAR, 0),
+                .f = expr->numlit,
+            });
+            return true;
+        case EkCharLit:
+            *out = (ConstValue){
+                .type = type_char(TYPEVAR, 0),
+                .u = expr->charlit,
+            };
+            return true;
+        case EkTrue:
+            *out = value_bool(true);
+            return true;
+        case EkFalse:
+            *out = value_bool(false);
+            return true;
+        case EkGrouping:
+            return eval_value_at(sema, expr->group, depth, out);
+        case EkIdent: {
+            Stmnt decl = symtab_find(sema, expr->ident, expr->cursors_idx);
+            if (decl.kind != SkConstDecl || decl.constdecl.value.kind == EkNone) return false;
+
+            ConstValue value;
+            if (!eval_value_at(sema, &decl.constdecl.value, depth, &value)) return false;
+            return eval_convert(value, decl.constdecl.type, out);
+        }
+        case EkFieldAccess:
+            return eval_field_access(sema, expr, depth, out);
         case EkUnop:
-            return eval_unop(sema, expr);
+            return eval_unop(sema, expr, depth, out);
+        case EkBinop:
+            return eval_binop(sema, expr, depth, out);
         default:
-            debug("not implemented in eval_expr");
-            exit(1);
+            return false;
     }
+}
 
-    assert(false);
+bool eval_value(Sema *sema, Expr *expr, ConstValue *out) {
+    return eval_value_at(sema, expr, 0, out);
+}
+
+bool eval_const(Sema *sema, Expr *expr, uint64_t *out) {
+    ConstValue value;
+    if (!eval_value(sema, expr, &value) || is_float(value.type)) return false;
+
+    *out = value.u;
+    return true;
+}
+
+uint64_t eval_expr(Sema *sema, Expr *expr) {
+    sema_expr(sema, expr);
+
+    uint64_t value;
+    if (!eval_const(sema, expr, &value)) return 0;
+    return value;
+}
+
+bool eval_enum_field(Sema *sema, EnumDecl enumd, const char *name, uint64_t *out) {
+    // same numbering as sema_enum_decl, the enum might not have been analysed yet
+    uint64_t counter = 0;
+    for (size_t i = 0; i < arrlenu(enumd.fields); i++) {
+        Stmnt f = enumd.fields[i];
+        if (f.constdecl.value.kind != EkNone && !eval_const(sema, &f.constdecl.value, &counter)) {
+            return false;
+        }
+
+        if (streq(f.constdecl.name.ident, name)) {
+            *out = counter;
+            return true;
+        }
+        counter++;
+    }
+
+    return false;
+}
+
+bool eval_to_expr(ConstValue value, Type type, size_t index, Expr *out) {
+    if (!eval_convert(value, type, &value)) return false;
+
+    switch (value.type.kind) {
+        case TkBool:
+            *out = value.u ? expr_true(index) : expr_false(index);
+            break;
+        case TkChar:
+            *out = expr_charlit((uint8_t)value.u, index);
+            break;
+        case TkF32:
+        case TkF64:
+        case TkUntypedFloat:
+            *out = expr_floatlit(value.f, value.type, index);
+            break;
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkUntypedInt:
+        case TkU8:
+        case TkU16:
+        case TkU32:
+        case TkU64:
+        case TkUsize:
+            *out = expr_intlit(value.u, value.type, index);
+            break;
+        default:
+            // enums keep their name in the generated code
+            return false;
+    }
+
+    out->type = value.type;
+    return true;
 }
@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "include/arena.h"
 #include "include/exprs.h"
 #include "include/lexer.h"
 #include "include/types.h"
@@ -36,22 +37,24 @@ Expr expr_null(Type t, size_t index) {
 }
 
 Expr expr_type(Type v, size_t index) {
+    Type *type_expr = arena_alloc(&ast_arena, sizeof(Type)); *type_expr = v;
+
     return (Expr){
         .kind = EkType,
         .cursors_idx = index,
         .type = (Type){
             .kind = TkTypeId,
         },
-        .type_expr = v,
+        .type_expr = type_expr,
     };
 }
 
-Expr expr_intlit(double v, Type t, size_t index) {
+Expr expr_intlit(uint64_t v, Type t, size_t index) {
     return (Expr){
         .kind = EkIntLit,
         .cursors_idx = index,
         .type = t,
-        .numlit = v,
+        .intlit = v,
     };
 }
 
@@ -2,11 +2,17 @@
 #include <ctype.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include "include/eval.h"
 #include "include/gen.h"
+#include "include/ir.h"
+#include "include/layout.h"
+#include "include/pool.h"
 #include "include/exprs.h"
 #include "include/sema.h"
 #include "include/stb_ds.h"
@@ -16,6 +22,7 @@
 #include "include/utils.h"
 
 extern unsigned char builtin_defs[];
+extern unsigned int builtin_defs_len;
 
 void mastrfree(MaybeAllocStr s) {
     if (s.alloced) strbfree(s.str);
@@ -29,19 +36,39 @@ Gen gen_init(Arr(Stmnt) ast, Dgraph dgraph) {
 
         .indent = 0,
         .defers = NULL,
+        .defer_labels = 0,
+        .defer_exits = 0,
+        .loop_defers = 0,
         
         .in_defs = false,
         .dgraph = dgraph,
         .def_loc = 0,
 
         .code_loc = 0,
+        .switch_count = 0,
         .generated_typedefs = NULL,
+        .generated_ids = NULL,
 
         .compile_flags = {
             .links = NULL,
             .optimisation = OlDebug,
             .output = "",
+            .object = false,
+            .native = false,
         },
+
+        .threads = 1,
+
+        .byref_size = 16,
+        .byref = NULL,
+        .byref_args = NULL,
+        .byref_locals = NULL,
+        .ir = NULL,
+        .noalias_slices = NULL,
+
+        .worker = false,
+        .generics = NULL,
+        .directives = NULL,
     };
 }
 
@@ -49,20 +76,21 @@ void gen_push_defer(Gen *gen, Stmnt *stmnt) {
     Defer defer = {
         .stmnt = stmnt,
         .indent = gen->indent,
+        .label = gen->defer_labels++,
+        .exits = 0,
     };
     arrpush(gen->defers, defer);
 }
 
-void gen_pop_defers(Gen *gen) {
-    for (ptrdiff_t i = arrlen(gen->defers) - 1; i >= 0; i--) {
-        if (gen->defers[i].indent == gen->indent) {
-            arrdel(gen->defers, i);
-        }
-    }
-}
-
 void gen_directive(Gen *gen, Stmnt stmnt) {
     assert(stmnt.kind == SkDirective);
+
+    // the flags are shared, gen_generate applies a worker's in order
+    if (gen->worker) {
+        arrpush(gen->directives, stmnt);
+        return;
+    }
+
     switch (stmnt.directive.kind) {
         case DkLink:
             arrpush(gen->compile_flags.links, stmnt.directive.str);
@@ -144,6 +172,12 @@ bool gen_find_generated_typedef(Gen *gen, const char *needle) {
     return false;
 }
 
+// array lengths are folded into literals by sema
+size_t gen_array_len(Type type) {
+    assert(type.kind == TkArray && type.array.len->kind == EkIntLit);
+    return (size_t)type.array.len->intlit;
+}
+
 strb gen_array_type(Gen *gen, Type type, const char *name) {
     strb subtype = NULL;
     strb lens = NULL;
@@ -151,9 +185,7 @@ strb gen_array_type(Gen *gen, Type type, const char *name) {
     Type st = type;
     while (true) {
         if (st.kind == TkArray) {
-            MaybeAllocStr len = gen_expr(gen, *st.array.len);
-            strbprintf(&lens, "[%s]", len.str);
-            mastrfree(len);
+            strbprintf(&lens, "[%zu]", gen_array_len(st));
 
             st = *st.array.of;
         } else {
@@ -224,6 +256,15 @@ MaybeAllocStr gen_type(Gen *gen, Type type) {
                 .alloced = true,
             };
         }
+        case TkSoa: {
+            strb ret = NULL;
+            gen_typename(gen, &type, 1, &ret);
+
+            return (MaybeAllocStr){
+                .str = ret,
+                .alloced = true,
+            };
+        }
         case TkPtr:
             return (MaybeAllocStr){
                 .str = gen_ptr_type(gen, type),
@@ -264,9 +305,7 @@ strb gen_typename_array(Gen *gen, Type type) {
         if (st.kind == TkArray) {
             dim++;
 
-            MaybeAllocStr len = gen_expr(gen, *st.array.len);
-            strbprintf(&lengths, "%s", len.str);
-            mastrfree(len);
+            strbprintf(&lengths, "_%zu", gen_array_len(st));
 
             st = *st.array.of;
         } else {
@@ -312,6 +351,25 @@ void gen_typename(Gen *gen, Type *types, size_t types_len, strb *typename) {
     for (size_t i = 0; i < types_len; i++) {
         Type type = types[i];
 
+        // compound names are built once per interned type
+        TypeId id = 0;
+        switch (type.kind) {
+            case TkPtr:
+            case TkSlice:
+            case TkArray:
+            case TkOption:
+                id = type_cache_id(&type);
+                break;
+            default:
+                break;
+        }
+        const char *cname = id != 0 ? type_info(id)->cname : NULL;
+        if (cname != NULL) {
+            strbprintf(typename, "%s", cname);
+            continue;
+        }
+        size_t start = *typename == NULL ? 0 : strlen(*typename);
+
         switch (type.kind) {
             case TkUntypedInt:
             case TkUntypedFloat:
@@ -340,6 +398,9 @@ void gen_typename(Gen *gen, Type *types, size_t types_len, strb *typename) {
                 strbprintf(typename, "PineOption_%s", option);
                 strbfree(option);
             } break;
+            case TkSoa:
+                strbprintf(typename, "PineSoa_%s", type.soa.of->typedeff);
+                break;
             default: {
                 MaybeAllocStr ty = gen_type(gen, type);
                 if (ty.alloced) {
@@ -351,6 +412,15 @@ void gen_typename(Gen *gen, Type *types, size_t types_len, strb *typename) {
                 }
             }
         }
+
+        if (id != 0) {
+            // another worker can build the same name, the first one is kept
+            char *built = strdup(*typename + start);
+            const char *expected = NULL;
+            if (!atomic_compare_exchange_strong(&type_info(id)->cname, &expected, built)) {
+                free(built);
+            }
+        }
     }
 }
 
@@ -380,48 +450,63 @@ MaybeAllocStr gen_option_expr(Gen *gen, Expr expr) {
     };
 }
 
+// enough digits to get the same value back, always with a '.' or exponent so C doesn't read an int
+void gen_float_lit(strb *s, double value, int digits, const char *suffix) {
+    strb lit = NULL;
+    strbprintf(&lit, "%.*g", digits, value);
+
+    bool is_int = strpbrk(lit, ".e") == NULL;
+    strbprintf(s, "%s%s%s", lit, is_int ? ".0" : "", suffix);
+    strbfree(lit);
+}
+
 strb gen_numlit_expr(Expr expr) {
     assert(expr.kind == EkIntLit || expr.kind == EkFloatLit);
     strb s = NULL;
 
+    // an int literal written straight into a float, never negative
+    double number = expr.kind == EkIntLit ? (double)expr.intlit : expr.numlit;
+    uint64_t bits = expr.kind == EkIntLit ? expr.intlit : (uint64_t)(int64_t)expr.numlit;
+
     switch (expr.type.kind) {
         case TkF32:
-            strbprintf(&s, "%.7ff", (float)expr.numlit);
+            gen_float_lit(&s, (float)number, 9, "f");
             break;
         case TkF64:
         case TkUntypedFloat:
-            strbprintf(&s, "%.15f", expr.numlit);
+            gen_float_lit(&s, number, 17, "");
             break;
         case TkU8:
-            strbprintf(&s, "UINT8_C(%" PRIu8 ")", (uint8_t)expr.numlit);
+            strbprintf(&s, "UINT8_C(%" PRIu8 ")", (uint8_t)bits);
             break;
         case TkU16:
-            strbprintf(&s, "UINT16_C(%" PRIu16 ")", (uint16_t)expr.numlit);
+            strbprintf(&s, "UINT16_C(%" PRIu16 ")", (uint16_t)bits);
             break;
         case TkU32:
-            strbprintf(&s, "UINT32_C(%" PRIu32 ")", (uint32_t)expr.numlit);
+            strbprintf(&s, "UINT32_C(%" PRIu32 ")", (uint32_t)bits);
             break;
         case TkU64:
-            strbprintf(&s, "UINT64_C(%" PRIu64 ")", (uint64_t)expr.numlit);
-            break;
         case TkUsize:
-            strbprintf(&s, "UINT64_C(%zu)", (size_t)expr.numlit);
+            strbprintf(&s, "UINT64_C(%" PRIu64 ")", bits);
             break;
         case TkI8:
-            strbprintf(&s, "INT8_C(%" PRIi8 ")", (int8_t)expr.numlit);
+            strbprintf(&s, "INT8_C(%" PRIi8 ")", (int8_t)bits);
             break;
         case TkI16:
-            strbprintf(&s, "INT16_C(%" PRIi16 ")", (int16_t)expr.numlit);
+            strbprintf(&s, "INT16_C(%" PRIi16 ")", (int16_t)bits);
             break;
         case TkI32:
-            strbprintf(&s, "INT32_C(%" PRIi32 ")", (int32_t)expr.numlit);
+            strbprintf(&s, "INT32_C(%" PRIi32 ")", (int32_t)bits);
             break;
         case TkI64:
-        case TkUntypedInt:
-            strbprintf(&s, "INT64_C(%" PRIi64 ")", (int64_t)expr.numlit);
-            break;
         case TkIsize:
-            strbprintf(&s, "INT64_C(%zd)", (ssize_t)expr.numlit);
+        case TkUntypedInt:
+            // NOTE: -9223372036854775808 is the negation of a literal too big for int64_t
+            if (bits == (UINT64_C(1) << 63)) {
+                strbprintf(&s, "INT64_MIN");
+            } else {
+                strbprintf(&s, "INT64_C(%" PRIi64 ")", (int64_t)bits);
+            }
             break;
         default: break;
     }
@@ -429,6 +514,229 @@ strb gen_numlit_expr(Expr expr) {
     return s;
 }
 
+// an argument of the function being generated that's passed as `const T *restrict`
+bool gen_byref_param(Gen *gen, const char *name) {
+    for (size_t i = 0; i < arrlenu(gen->byref_args); i++) {
+        if (streq(gen->byref_args[i], name)) return true;
+    }
+    return false;
+}
+
+static int gen_mask_cmp(const void *a, const void *b) {
+    return strcmp(((const GenMask*)a)->name, ((const GenMask*)b)->name);
+}
+
+// NOTE: shgeti writes to the table it looks in, these are read by every worker at once so they're searched instead
+static uint64_t gen_mask_find(Arr(GenMask) masks, Expr name) {
+    if (name.kind != EkIdent || arrlenu(masks) == 0) return 0;
+    GenMask key = {.name = name.ident};
+    GenMask *found = bsearch(&key, masks, arrlenu(masks), sizeof(GenMask), gen_mask_cmp);
+    return found == NULL ? 0 : found->mask;
+}
+
+static void gen_mask_freeze(Arr(GenMask) masks) {
+    if (arrlenu(masks) > 1) qsort(masks, arrlenu(masks), sizeof(GenMask), gen_mask_cmp);
+}
+
+uint64_t gen_byref_mask(Gen *gen, Expr name) {
+    return gen_mask_find(gen->byref, name);
+}
+
+uint64_t gen_noalias_mask(Gen *gen, Expr name) {
+    return gen_mask_find(gen->noalias_slices, name);
+}
+
+// PineSlice<N>d_T as PineSlice<N>dNoalias_T, or pineslice<N>d_noalias_T that converts to it
+strb gen_noalias_slice(Gen *gen, Type type, bool convert) {
+    MaybeAllocStr name = gen_type(gen, type);
+    const char *dim = name.str + strlen("PineSlice");
+    const char *underscore = strchr(dim, '_');
+
+    strb s = NULL;
+    if (convert) {
+        strbprintf(&s, "pineslice%.*s_noalias%s", (int)(underscore - dim), dim, underscore);
+    } else {
+        strbprintf(&s, "PineSlice%.*sNoalias%s", (int)(underscore - dim), dim, underscore);
+    }
+    mastrfree(name);
+    return s;
+}
+
+// the local an lvalue is part of, NULL if it could be anywhere else in memory
+Expr *gen_byref_root(Expr *expr) {
+    while (true) {
+        switch (expr->kind) {
+            case EkIdent:
+                return expr;
+            case EkGrouping:
+                expr = expr->group;
+                break;
+            case EkFieldAccess:
+                if (expr->fieldacc.deref || expr->fieldacc.accessing->type.kind != TkTypeDef) return NULL;
+                expr = expr->fieldacc.accessing;
+                break;
+            case EkArrayIndex:
+                if (expr->arrayidx.accessing->type.kind != TkArray) return NULL;
+                expr = expr->arrayidx.accessing;
+                break;
+            default:
+                return NULL;
+        }
+    }
+}
+
+void gen_byref_escape(Gen *gen, Expr *expr) {
+    Expr *root = gen_byref_root(expr);
+    if (root != NULL) shput(gen->byref_locals, root->ident, true);
+}
+
+void gen_byref_declare(Gen *gen, Stmnt *stmnt) {
+    if (stmnt == NULL || (stmnt->kind != SkVarDecl && stmnt->kind != SkConstDecl)) return;
+    if (stmnt->vardecl.name.kind != EkIdent) return;
+    if (shgeti(gen->byref_locals, stmnt->vardecl.name.ident) < 0) shput(gen->byref_locals, stmnt->vardecl.name.ident, false);
+}
+
+void gen_byref_scan_stmnt(Gen *gen, Stmnt *stmnt);
+
+void gen_byref_scan_block(Gen *gen, Arr(Stmnt) block) {
+    for (size_t i = 0; i < arrlenu(block); i++) {
+        gen_byref_scan_stmnt(gen, &block[i]);
+    }
+}
+
+// accessed is set for what's indexed or has a field read, anything else of array type decays to a pointer
+void gen_byref_scan_expr(Gen *gen, Expr *expr, bool accessed) {
+    if (!accessed && expr->type.kind == TkArray) gen_byref_escape(gen, expr);
+
+    switch (expr->kind) {
+        case EkUnop:
+            if (expr->unop.kind == UkAddress) gen_byref_escape(gen, expr->unop.val);
+            gen_byref_scan_expr(gen, expr->unop.val, false);
+            break;
+        case EkBinop:
+            gen_byref_scan_expr(gen, expr->binop.left, false);
+            gen_byref_scan_expr(gen, expr->binop.right, false);
+            break;
+        case EkGrouping:
+            gen_byref_scan_expr(gen, expr->group, accessed);
+            break;
+        case EkFnCall:
+            gen_byref_scan_expr(gen, expr->fncall.name, false);
+            for (size_t i = 0; i < arrlenu(expr->fncall.args.exprs); i++) {
+                gen_byref_scan_expr(gen, &expr->fncall.args.exprs[i], false);
+            }
+            break;
+        case EkLiteral:
+            if (expr->literal.kind == LitkExprs) {
+                for (size_t i = 0; i < arrlenu(expr->literal.exprs); i++) {
+                    gen_byref_scan_expr(gen, &expr->literal.exprs[i], false);
+                }
+            } else if (expr->literal.kind == LitkVars) {
+                for (size_t i = 0; i < arrlenu(expr->literal.vars); i++) {
+                    gen_byref_scan_expr(gen, &expr->literal.vars[i].varreassign.value, false);
+                }
+            }
+            break;
+        case EkRangeLit:
+            gen_byref_scan_expr(gen, expr->rangelit.start, false);
+            gen_byref_scan_expr(gen, expr->rangelit.end, false);
+            break;
+        case EkFieldAccess:
+            gen_byref_scan_expr(gen, expr->fieldacc.accessing, true);
+            break;
+        case EkArrayIndex:
+            gen_byref_scan_expr(gen, expr->arrayidx.accessing, true);
+            gen_byref_scan_expr(gen, expr->arrayidx.index, false);
+            break;
+        case EkArraySlice:
+            gen_byref_scan_expr(gen, expr->arrayslice.accessing, false);
+            gen_byref_scan_expr(gen, expr->arrayslice.slice, false);
+            break;
+        default: break;
+    }
+}
+
+void gen_byref_scan_stmnt(Gen *gen, Stmnt *stmnt) {
+    switch (stmnt->kind) {
+        case SkVarDecl:
+        case SkConstDecl:
+            gen_byref_declare(gen, stmnt);
+            gen_byref_scan_expr(gen, &stmnt->vardecl.value, false);
+            break;
+        case SkVarReassign:
+            gen_byref_scan_expr(gen, &stmnt->varreassign.name, true);
+            gen_byref_scan_expr(gen, &stmnt->varreassign.value, false);
+            break;
+        case SkReturn:
+            gen_byref_scan_expr(gen, &stmnt->returnf.value, false);
+            break;
+        case SkDefer:
+            gen_byref_scan_stmnt(gen, stmnt->defer);
+            break;
+        case SkFnCall:
+            gen_byref_scan_expr(gen, stmnt->fncall.name, false);
+            for (size_t i = 0; i < arrlenu(stmnt->fncall.args.exprs); i++) {
+                gen_byref_scan_expr(gen, &stmnt->fncall.args.exprs[i], false);
+            }
+            break;
+        case SkIf:
+            gen_byref_scan_expr(gen, &stmnt->iff.condition, false);
+            if (stmnt->iff.capturekind != CkNone) gen_byref_declare(gen, stmnt->iff.capture.constdecl);
+            gen_byref_scan_block(gen, stmnt->iff.body);
+            gen_byref_scan_block(gen, stmnt->iff.els);
+            break;
+        case SkFor:
+            gen_byref_scan_stmnt(gen, stmnt->forf.decl);
+            gen_byref_scan_expr(gen, &stmnt->forf.condition, false);
+            gen_byref_scan_stmnt(gen, stmnt->forf.reassign);
+            gen_byref_scan_block(gen, stmnt->forf.body);
+            break;
+        case SkSwitch:
+            gen_byref_scan_expr(gen, &stmnt->switchf.value, false);
+            for (size_t i = 0; i < arrlenu(stmnt->switchf.cases); i++) {
+                Case *c = &stmnt->switchf.cases[i];
+                gen_byref_declare(gen, c->capture_decl);
+                gen_byref_scan_block(gen, c->body);
+            }
+            break;
+        case SkBlock:
+            gen_byref_scan_block(gen, stmnt->block);
+            break;
+        default: break;
+    }
+}
+
+// which locals of a function can be passed by pointer, nothing can write to one while a call reads it through that pointer
+// arguments are locals too, so a big argument is forwarded without another copy
+void gen_byref_scan(Gen *gen, FnDecl fndecl) {
+    arrfree(gen->byref_args);
+    shfree(gen->byref_locals);
+    if (arrlenu(gen->byref) == 0) return;
+
+    for (size_t i = 0; i < arrlenu(fndecl.args); i++) {
+        gen_byref_declare(gen, &fndecl.args[i]);
+    }
+    gen_byref_scan_block(gen, fndecl.body);
+}
+
+// the callee reads it through a pointer instead of getting a copy
+// a local nothing else can point at is passed as is, anything else is copied into a compound literal at the call
+strb gen_byref_arg(Gen *gen, Expr *arg, const char *value) {
+    strb ret = NULL;
+
+    Expr *root = gen_byref_root(arg);
+    bool coerced = arg->type.kind == TkOption && arg->type.option.gen_option;
+    if (!coerced && root != NULL && shgeti(gen->byref_locals, root->ident) >= 0 && !shget(gen->byref_locals, root->ident)) {
+        strbprintf(&ret, "&%s", value);
+    } else {
+        MaybeAllocStr type = gen_type(gen, arg->type);
+        strbprintf(&ret, "(const %s[]){%s}", type.str, value);
+        mastrfree(type);
+    }
+
+    return ret;
+}
+
 MaybeAllocStr gen_unop_expr(Gen *gen, Expr expr) {
     assert(expr.kind == EkUnop);
 
@@ -437,6 +745,13 @@ MaybeAllocStr gen_unop_expr(Gen *gen, Expr expr) {
 
     switch (expr.unop.kind) {
         case UkAddress:
+            // sema won't let anything write through it, the cast only keeps the pointer type the same as for a copy
+            if (expr.unop.val->kind == EkIdent && gen_byref_param(gen, expr.unop.val->ident)) {
+                MaybeAllocStr type = gen_type(gen, expr.type);
+                strbprintf(&ret, "(%s)%s", type.str, expr.unop.val->ident);
+                mastrfree(type);
+                break;
+            }
             strbprintf(&ret, "&%s", value.str);
             break;
         case UkNegate:
@@ -466,14 +781,70 @@ MaybeAllocStr gen_unop_expr(Gen *gen, Expr expr) {
     };
 }
 
+// <soa>.<field> as a C lvalue for the column
+strb gen_soa_column(Gen *gen, Expr soa, const char *field) {
+    MaybeAllocStr access = gen_expr(gen, soa);
+    strb ret = NULL;
+
+    if (soa.type.kind == TkPtr) {
+        strbprintf(&ret, "%s->%s", access.str, field);
+    } else {
+        strbprintf(&ret, "(%s).%s", access.str, field);
+    }
+
+    mastrfree(access);
+    return ret;
+}
+
+// <soa>.push(v) -> pinesoa_push_T(&soa, v)
+MaybeAllocStr gen_soa_method_call(Gen *gen, Expr expr) {
+    assert(expr.kind == EkFnCall && expr.fncall.name->kind == EkFieldAccess);
+    Expr soa = *expr.fncall.name->fieldacc.accessing;
+    Type soatype = soa.type.kind == TkPtr ? *soa.type.ptr_to : soa.type;
+    gen_decl_generic(gen, soatype);
+
+    MaybeAllocStr access = gen_expr(gen, soa);
+    strb call = NULL;
+    strbprintf(&call, "pinesoa_%s_%s(%s%s", expr.fncall.name->fieldacc.field->ident, soatype.soa.of->typedeff, soa.type.kind == TkPtr ? "" : "&", access.str);
+    mastrfree(access);
+
+    for (size_t i = 0; i < arrlenu(expr.fncall.args.exprs); i++) {
+        MaybeAllocStr arg = gen_expr(gen, expr.fncall.args.exprs[i]);
+        strbprintf(&call, ", %s", arg.str);
+        mastrfree(arg);
+    }
+    strbpush(&call, ')');
+
+    return (MaybeAllocStr){
+        .str = call,
+        .alloced = true,
+    };
+}
+
 MaybeAllocStr gen_fn_call(Gen *gen, Expr expr) {
     assert(expr.kind == EkFnCall);
 
+    if (expr.fncall.name->kind == EkFieldAccess) {
+        return gen_soa_method_call(gen, expr);
+    }
+
     strb call = NULL;
     strbprintf(&call, "%s(", expr.fncall.name->ident);
+    uint64_t byref = gen_byref_mask(gen, *expr.fncall.name);
+    uint64_t noalias = gen_noalias_mask(gen, *expr.fncall.name);
 
     for (size_t i = 0; i < arrlenu(expr.fncall.args.exprs); i++) {
         MaybeAllocStr arg = gen_expr(gen, expr.fncall.args.exprs[i]);
+        if (i < 64 && (byref >> i & 1)) {
+            strb ptr = gen_byref_arg(gen, &expr.fncall.args.exprs[i], arg.str);
+            mastrfree(arg);
+            arg = (MaybeAllocStr){.str = ptr, .alloced = true};
+        } else if (i < 64 && (noalias >> i & 1)) {
+            strb convert = gen_noalias_slice(gen, expr.fncall.args.exprs[i].type, true);
+            strbprintf(&convert, "(%s)", arg.str);
+            mastrfree(arg);
+            arg = (MaybeAllocStr){.str = convert, .alloced = true};
+        }
 
         if (i == 0) {
             strbprintf(&call, "%s", arg.str);
@@ -499,7 +870,10 @@ MaybeAllocStr gen_slice_literal_expr(Gen *gen, Expr expr) {
     strb typename = NULL;
     gen_typename(gen, &slice, 1, &typename);
 
-    char *type = strtok(typename, "_");
+    // PineSlice<N>d, strtok isn't safe with functions generated in parallel
+    char *type = typename;
+    char *underscore = strchr(typename, '_');
+    if (underscore != NULL) *underscore = '\0';
     for (size_t i = 0; i < strlen(type); i++) {
         type[i] = tolower(type[i]);
     }
@@ -549,30 +923,49 @@ MaybeAllocStr gen_literal_expr(Gen *gen, Expr expr) {
         mastrfree(exprtype);
     }
 
+    // positional literals no longer line up with the fields of a reordered struct
+    Stmnt structd = stmnt_none();
+    if (expr.literal.kind == LitkExprs && expr.type.kind == TkTypeDef) {
+        structd = ast_find_decl(gen->ast, expr.type.typedeff);
+        if (structd.kind != SkStructDecl || structd.structdecl.attrs == NULL || structd.structdecl.attrs->order == NULL) {
+            structd = stmnt_none();
+        }
+    }
+
     if (expr.literal.kind == LitkExprs) {
         for (size_t i = 0; i < arrlenu(expr.literal.exprs); i++) {
             MaybeAllocStr val = gen_expr(gen, expr.literal.exprs[i]);
 
-            if (i == 0) {
-                strbprintf(&lit, "%s", val.str);
+            if (i != 0) {
+                strbprintf(&lit, ", ");
+            }
+
+            if (structd.kind == SkStructDecl) {
+                strbprintf(&lit, ".%s = %s", structd.structdecl.fields[i].vardecl.name.ident, val.str);
             } else {
-                strbprintf(&lit, ", %s", val.str);
+                strbprintf(&lit, "%s", val.str);
             }
 
             mastrfree(val);
         }
+    } else if (expr.type.kind == TkTypeDef && ast_find_decl(gen->ast, expr.type.typedeff).kind == SkUnionDecl) {
+        // sema made sure there's exactly one variant
+        const char *variant = expr.literal.vars[0].varreassign.name.ident;
+        MaybeAllocStr value = gen_expr(gen, expr.literal.vars[0].varreassign.value);
+
+        strbprintf(&lit, ".as.%s = %s, .tag = %s_%s", variant, value.str, expr.type.typedeff, variant);
+        mastrfree(value);
     } else {
         for (size_t i = 0; i < arrlenu(expr.literal.vars); i++) {
-            MaybeAllocStr reassigned = gen_expr(gen, expr.literal.vars[i].varreassign.name);
+            const char *field = expr.literal.vars[i].varreassign.name.ident;
             MaybeAllocStr value = gen_expr(gen, expr.literal.vars[i].varreassign.value);
 
             if (i == 0) {
-                strbprintf(&lit, ".%s = %s", reassigned.str, value.str);
+                strbprintf(&lit, ".%s = %s", field, value.str);
             } else {
-                strbprintf(&lit, ", .%s = %s", reassigned.str, value.str);
+                strbprintf(&lit, ", .%s = %s", field, value.str);
             }
 
-            mastrfree(reassigned);
             mastrfree(value);
         }
     }
@@ -659,7 +1052,7 @@ MaybeAllocStr gen_binop_expr(Gen *gen, Expr expr) {
 
 MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
     if (expr.kind == EkType) {
-        return gen_type(gen, expr.type_expr);
+        return gen_type(gen, *expr.type_expr);
     }
 
     if (expr.kind != EkNull) {
@@ -669,6 +1062,14 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
 
     switch (expr.kind) {
         case EkIdent:
+            if (gen_byref_param(gen, expr.ident)) {
+                strb deref = NULL; strbprintf(&deref, "(*%s)", expr.ident);
+                return (MaybeAllocStr){
+                    .str = deref,
+                    .alloced = true,
+                };
+            }
+
             return (MaybeAllocStr){
                 .str = expr.ident, // nothing much i can do to silence this warning, but rest assured .str is not edited anywhere
                 .alloced = false,
@@ -728,6 +1129,48 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
             };
         } break;
         case EkFieldAccess: {
+            Expr *accessing = expr.fieldacc.accessing;
+
+            // <soa>[i].<field> -> soa.field[i], only reads the column it needs
+            if (!expr.fieldacc.deref && accessing->kind == EkArrayIndex) {
+                Expr soa = *accessing->arrayidx.accessing;
+                Type soatype = soa.type.kind == TkPtr ? *soa.type.ptr_to : soa.type;
+
+                if (soatype.kind == TkSoa) {
+                    strb column = gen_soa_column(gen, soa, expr.fieldacc.field->ident);
+                    MaybeAllocStr index = gen_expr(gen, *accessing->arrayidx.index);
+                    strb ret = NULL; strbprintf(&ret, "%s[%s]", column, index.str);
+
+                    strbfree(column);
+                    mastrfree(index);
+                    return (MaybeAllocStr){
+                        .str = ret,
+                        .alloced = true,
+                    };
+                }
+            }
+
+            // <soa>.<field> -> the whole column as a slice
+            Type soatype = accessing->type.kind == TkPtr ? *accessing->type.ptr_to : accessing->type;
+            if (!expr.fieldacc.deref && soatype.kind == TkSoa && expr.type.kind == TkSlice) {
+                strb typename = NULL;
+                gen_typename(gen, expr.type.slice.of, 1, &typename);
+                MaybeAllocStr slicetype = gen_type(gen, expr.type);
+                mastrfree(slicetype);
+
+                strb column = gen_soa_column(gen, *accessing, expr.fieldacc.field->ident);
+                strb len = gen_soa_column(gen, *accessing, "len");
+                strb ret = NULL; strbprintf(&ret, "pineslice1d_%s(%s, %s)", typename, column, len);
+
+                strbfree(typename);
+                strbfree(column);
+                strbfree(len);
+                return (MaybeAllocStr){
+                    .str = ret,
+                    .alloced = true,
+                };
+            }
+
             MaybeAllocStr subexpr = gen_expr(gen, *expr.fieldacc.accessing);
             if (expr.fieldacc.deref) {
                 strb ret = NULL; strbprintf(&ret, "*%s", subexpr.str);
@@ -738,28 +1181,13 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
                 };
             }
 
-            MaybeAllocStr field = gen_expr(gen, *expr.fieldacc.field);
+            // a field named like an argument passed by pointer is still just the field
+            MaybeAllocStr field = expr.fieldacc.field->kind == EkIdent
+                ? (MaybeAllocStr){.str = (char*)expr.fieldacc.field->ident, .alloced = false}
+                : gen_expr(gen, *expr.fieldacc.field);
             strb ret = NULL;
 
-            // NOTE: temporary fix for constant folding `array.len`
-            // TODO: maybe have an optimisation step, do constant folding, etc
-            if (
-                ((expr.fieldacc.accessing->type.kind == TkPtr &&
-                expr.fieldacc.accessing->type.ptr_to->kind == TkArray) ||
-                expr.fieldacc.accessing->type.kind == TkArray) &&
-                streq(field.str, "len")
-            ) {
-                MaybeAllocStr len;
-                if (expr.fieldacc.accessing->type.kind == TkPtr) {
-                    len = gen_expr(gen, *expr.fieldacc.accessing->type.ptr_to->array.len);
-                } else {
-                    len = gen_expr(gen, *expr.fieldacc.accessing->type.array.len);
-                }
-                strbprintf(&ret, "%s", len.str);
-                mastrfree(len);
-            }
-
-            else if (expr.fieldacc.accessing->type.kind == TkPtr) {
+            if (expr.fieldacc.accessing->type.kind == TkPtr) {
                 strbprintf(&ret, "%s->%s", subexpr.str, field.str);
             } else if (expr.fieldacc.accessing->type.kind == TkTypeDef) {
                 Stmnt stmnt = ast_find_decl(gen->ast, expr.fieldacc.accessing->type.typedeff);
@@ -768,6 +1196,9 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
                     strbprintf(&ret, "%s.%s", subexpr.str, field.str);
                 } else if (stmnt.kind == SkEnumDecl) {
                     strbprintf(&ret, "%s_%s", subexpr.str, field.str);
+                } else if (stmnt.kind == SkUnionDecl) {
+                    // only variants without a payload can be accessed
+                    strbprintf(&ret, "(%s){.tag = %s_%s}", subexpr.str, subexpr.str, field.str);
                 }
             } else {
                 strbprintf(&ret, "%s.%s", subexpr.str, field.str);
@@ -786,8 +1217,15 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
             MaybeAllocStr index = gen_expr(gen, *expr.arrayidx.index);
             strb ret = NULL;
 
-            if (expr.fieldacc.accessing->type.kind == TkPtr) {
-                strbprintf(&ret, "(*%s)[%s]", access.str, index.str);
+            Type accessing = expr.arrayidx.accessing->type;
+            if (accessing.kind == TkPtr && accessing.ptr_to->kind == TkSoa) {
+                strbprintf(&ret, "pinesoa_get_%s(*%s, %s)", accessing.ptr_to->soa.of->typedeff, access.str, index.str);
+            } else if (accessing.kind == TkSoa) {
+                strbprintf(&ret, "pinesoa_get_%s(%s, %s)", accessing.soa.of->typedeff, access.str, index.str);
+            } else if (accessing.kind == TkPtr) {
+                strbprintf(&ret, "(*%s)%s[%s]", access.str, accessing.ptr_to->kind == TkSlice ? ".ptr" : "", index.str);
+            } else if (accessing.kind == TkSlice) {
+                strbprintf(&ret, "(%s).ptr[%s]", access.str, index.str);
             } else {
                 strbprintf(&ret, "(%s)[%s]", access.str, index.str);
             }
@@ -819,15 +1257,13 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
             MaybeAllocStr end;
             if (expr.arrayslice.slice->rangelit.end->kind == EkNone) {
                 if (expr.arrayslice.accessing->type.kind == TkArray) {
-                    MaybeAllocStr len = gen_expr(gen, *expr.arrayslice.accessing->type.array.len);
-                    strb end_s = NULL; strbprintf(&end_s, "%s - 1", len.str);
-                    mastrfree(len);
+                    strb end_s = NULL; strbprintf(&end_s, "%zu", gen_array_len(expr.arrayslice.accessing->type));
                     end = (MaybeAllocStr){
                         .str = end_s,
                         .alloced = true,
                     };
                 } else {
-                    strb end_s = NULL; strbprintf(&end_s, "%s.len - 1", access.str);
+                    strb end_s = NULL; strbprintf(&end_s, "%s.len", access.str);
                     end = (MaybeAllocStr){
                         .str = end_s,
                         .alloced = true,
@@ -836,14 +1272,16 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
             } else {
                 end = gen_expr(gen, *expr.arrayslice.slice->rangelit.end);
             }
+            // an array decays to a pointer to its first element, a slice has one in .ptr
             strb ret = NULL;
             strbprintf(&ret,
-                "pineslice1d_range_%s(%s.ptr, %s, %s%s)",
+                "pineslice1d_range_%s(%s%s, %s, %s%s)",
                 typename,
                 access.str,
+                expr.arrayslice.accessing->type.kind == TkArray ? "" : ".ptr",
                 start.str,
                 end.str,
-                expr.arrayslice.slice->rangelit.inclusive ? " + 1" : ""
+                expr.arrayslice.slice->rangelit.inclusive && expr.arrayslice.slice->rangelit.end->kind != EkNone ? " + 1" : ""
             );
 
             mastrfree(end);
@@ -884,6 +1322,26 @@ MaybeAllocStr gen_expr(Gen *gen, Expr expr) {
     }
 }
 
+// right before the function or global being generated
+// a worker keeps a copy instead, gen_generate inserts it once it knows nothing earlier emitted it
+void gen_insert_generic(Gen *gen, GenGeneric generic) {
+    if (gen->worker) {
+        GenGeneric copy = {.id = generic.id};
+        strbappend(&copy.key, generic.key);
+        strbappend(&copy.def, generic.def);
+        if (generic.imp != NULL) strbappend(&copy.imp, generic.imp);
+        arrpush(gen->generics, copy);
+        return;
+    }
+
+    gen->defs = strbinsert(gen->defs, generic.def, gen->def_loc);
+    gen->def_loc += strlen(generic.def);
+    if (generic.imp != NULL) {
+        gen->code = strbinsert(gen->code, generic.imp, gen->code_loc);
+        gen->code_loc += strlen(generic.imp);
+    }
+}
+
 // returns true if decl needs to be inserted
 bool gen_decl_generic_array(Gen *gen, Type type, strb *decl) {
     strb typename = NULL;
@@ -895,9 +1353,7 @@ bool gen_decl_generic_array(Gen *gen, Type type, strb *decl) {
         if (st.kind == TkArray) {
             gen_decl_generic(gen, *st.array.of);
 
-            MaybeAllocStr len = gen_expr(gen, *st.array.len);
-            strbprintf(&lengths, "[%s]", len.str);
-            mastrfree(len);
+            strbprintf(&lengths, "[%zu]", gen_array_len(st));
 
             st = *st.array.of;
         } else {
@@ -918,7 +1374,9 @@ bool gen_decl_generic_array(Gen *gen, Type type, strb *decl) {
 bool gen_decl_generic_slice(Gen *gen, Type type, strb *decl) {
     strb typename = NULL;
     gen_typename(gen, &type, 1, &typename);
-    char *t = strtok(typename, "_");
+    char *t = typename;
+    char *underscore = strchr(typename, '_');
+    if (underscore != NULL) *underscore = '\0';
 
     // PineSlice<N>dDef(
     strbprintf(decl, "%sDef(", t);
@@ -943,12 +1401,131 @@ bool gen_decl_generic_slice(Gen *gen, Type type, strb *decl) {
     return !gen_find_generated_typedef(gen, *decl);
 }
 
+// struct of arrays container for a #soa struct
+// definition and prototypes go in defs, implementations go in code
+void gen_decl_generic_soa(Gen *gen, Type type) {
+    assert(type.kind == TkSoa);
+
+    strb typename = NULL;
+    gen_typename(gen, &type, 1, &typename);
+
+    strb soa_def = NULL;
+    strbprintf(&soa_def, "struct %s", typename);
+    if (gen_find_generated_typedef(gen, soa_def)) {
+        strbfree(soa_def);
+        strbfree(typename);
+        return;
+    }
+    arrpush(gen->generated_typedefs, soa_def);
+
+    const char *of = type.soa.of->typedeff;
+    gen_decl_generic(gen, *type.soa.of);
+
+    Stmnt stmnt = ast_find_decl(gen->ast, of);
+    assert(stmnt.kind == SkStructDecl);
+    Arr(Stmnt) fields = stmnt.structdecl.fields;
+
+    // field types first, they might insert their own defs
+    Arr(MaybeAllocStr) fieldtypes = NULL;
+    for (size_t i = 0; i < arrlenu(fields); i++) {
+        arrpush(fieldtypes, gen_type(gen, fields[i].vardecl.type));
+    }
+
+    strb def = NULL;
+    strbprintfln(&def, "typedef struct %s {", typename);
+    for (size_t i = 0; i < arrlenu(fields); i++) {
+        strbprintfln(&def, "    %s *%s;", fieldtypes[i].str, fields[i].vardecl.name.ident);
+    }
+    strbprintfln(&def, "    usize len;");
+    strbprintfln(&def, "    usize cap;");
+    strbprintfln(&def, "} %s;", typename);
+    // static like the builtin slice and option helpers, a library's object has its own copy
+    strbprintfln(&def, "static void pinesoa_reserve_%s(%s *soa, usize cap);", of, typename);
+    strbprintfln(&def, "static void pinesoa_push_%s(%s *soa, %s v);", of, typename, of);
+    strbprintfln(&def, "static %s pinesoa_get_%s(%s soa, usize i);", of, of, typename);
+    strbprintfln(&def, "static void pinesoa_set_%s(%s *soa, usize i, %s v);", of, typename, of);
+    strbprintfln(&def, "static void pinesoa_free_%s(%s *soa);", of, typename);
+
+    strb imp = NULL;
+    strbprintfln(&imp, "static void pinesoa_reserve_%s(%s *soa, usize cap) {", of, typename);
+    strbprintfln(&imp, "    if (cap <= soa->cap) return;");
+    for (size_t i = 0; i < arrlenu(fields); i++) {
+        const char *f = fields[i].vardecl.name.ident;
+        strbprintfln(&imp, "    soa->%s = PINE_REALLOC(soa->%s, cap * sizeof(*soa->%s));", f, f, f);
+    }
+    strbprintfln(&imp, "    soa->cap = cap;");
+    strbprintfln(&imp, "}");
+
+    strbprintfln(&imp, "static void pinesoa_push_%s(%s *soa, %s v) {", of, typename, of);
+    strbprintfln(&imp, "    if (soa->len == soa->cap) pinesoa_reserve_%s(soa, soa->cap == 0 ? 8 : soa->cap * 2);", of);
+    strbprintfln(&imp, "    pinesoa_set_%s(soa, soa->len, v);", of);
+    strbprintfln(&imp, "    soa->len += 1;");
+    strbprintfln(&imp, "}");
+
+    strbprintfln(&imp, "static %s pinesoa_get_%s(%s soa, usize i) {", of, of, typename);
+    strbprintfln(&imp, "    %s v;", of);
+    for (size_t i = 0; i < arrlenu(fields); i++) {
+        const char *f = fields[i].vardecl.name.ident;
+        if (fields[i].vardecl.type.kind == TkArray) {
+            strbprintfln(&imp, "    memcpy(&v.%s, &soa.%s[i], sizeof(v.%s));", f, f, f);
+        } else {
+            strbprintfln(&imp, "    v.%s = soa.%s[i];", f, f);
+        }
+    }
+    strbprintfln(&imp, "    return v;");
+    strbprintfln(&imp, "}");
+
+    strbprintfln(&imp, "static void pinesoa_set_%s(%s *soa, usize i, %s v) {", of, typename, of);
+    for (size_t i = 0; i < arrlenu(fields); i++) {
+        const char *f = fields[i].vardecl.name.ident;
+        if (fields[i].vardecl.type.kind == TkArray) {
+            strbprintfln(&imp, "    memcpy(&soa->%s[i], &v.%s, sizeof(v.%s));", f, f, f);
+        } else {
+            strbprintfln(&imp, "    soa->%s[i] = v.%s;", f, f);
+        }
+    }
+    strbprintfln(&imp, "}");
+
+    strbprintfln(&imp, "static void pinesoa_free_%s(%s *soa) {", of, typename);
+    for (size_t i = 0; i < arrlenu(fields); i++) {
+        const char *f = fields[i].vardecl.name.ident;
+        strbprintfln(&imp, "    PINE_FREE(soa->%s);", f);
+        strbprintfln(&imp, "    soa->%s = NULL;", f);
+    }
+    strbprintfln(&imp, "    soa->len = 0;");
+    strbprintfln(&imp, "    soa->cap = 0;");
+    strbprintfln(&imp, "}");
+
+    gen_insert_generic(gen, (GenGeneric){
+        .id = 0,
+        .key = soa_def,
+        .def = def,
+        .imp = imp,
+    });
+
+    for (size_t i = 0; i < arrlenu(fieldtypes); i++) {
+        mastrfree(fieldtypes[i]);
+    }
+    arrfree(fieldtypes);
+    strbfree(def);
+    strbfree(imp);
+    strbfree(typename);
+}
+
 void gen_decl_generic(Gen *gen, Type type) {
     strb def = NULL;
 
+    // skips building the def just to find it was already emitted
+    TypeId id = type_cache_id(&type);
+    if (id != 0 && hmget(gen->generated_ids, id)) return;
+
     switch (type.kind) {
+        case TkSoa:
+            gen_decl_generic_soa(gen, type);
+            return;
         case TkSlice: {
             bool add = gen_decl_generic_slice(gen, type, &def);
+            if (id != 0) hmput(gen->generated_ids, id, true);
             if (!add) {
                 strbfree(def);
                 return;
@@ -956,13 +1533,18 @@ void gen_decl_generic(Gen *gen, Type type) {
         } break;
         case TkArray: {
             bool add = gen_decl_generic_array(gen, type, &def);
+            if (id != 0) hmput(gen->generated_ids, id, true);
             if (!add) {
                 strbfree(def);
                 return;
             }
 
-            gen->defs = strbinsert(gen->defs, def, gen->def_loc);
-            gen->def_loc += strlen(def);
+            gen_insert_generic(gen, (GenGeneric){
+                .id = id,
+                .key = def,
+                .def = def,
+                .imp = NULL,
+            });
             arrpush(gen->generated_typedefs, def);
             return;
         } break;
@@ -977,6 +1559,7 @@ void gen_decl_generic(Gen *gen, Type type) {
             strbfree(typename);
             mastrfree(typestr);
 
+            if (id != 0) hmput(gen->generated_ids, id, true);
             if (gen_find_generated_typedef(gen, def)) {
                 strbfree(def);
                 return;
@@ -989,38 +1572,45 @@ void gen_decl_generic(Gen *gen, Type type) {
             strb typedeff = NULL;
 
             Stmnt stmnt = ast_find_decl(gen->ast, type.typedeff);
-            if (stmnt.kind == SkStructDecl) {
+            if (stmnt.kind == SkStructDecl || stmnt.kind == SkUnionDecl) {
                 strbprintfln(&typedeff, "typedef struct %s %s;", type.typedeff, type.typedeff);
             } else if (stmnt.kind == SkEnumDecl) {
                 strbprintfln(&typedeff, "typedef enum %s %s;", type.typedeff, type.typedeff);
             }
 
+            if (id != 0) hmput(gen->generated_ids, id, true);
             if (gen_find_generated_typedef(gen, typedeff)) {
                 strbfree(typedeff);
                 return;
             }
 
             arrpush(gen->generated_typedefs, typedeff);
-
-            gen->defs = strbinsert(gen->defs, typedeff, gen->def_loc);
-            gen->def_loc += strlen(typedeff);
+            gen_insert_generic(gen, (GenGeneric){
+                .id = id,
+                .key = typedeff,
+                .def = typedeff,
+                .imp = NULL,
+            });
             return;
         } break;
         default:
             return;
     }
 
-    gen->defs = strbinsert(gen->defs, def, gen->def_loc);
-    gen->def_loc += strlen(def);
     arrpush(gen->generated_typedefs, def);
 
-    bool replaced = strreplace(def, "Def", "Imp");
+    strb imp = NULL;
+    strbappend(&imp, def);
+    bool replaced = strreplace(imp, "Def", "Imp");
     assert(replaced);
-    gen->code = strbinsert(gen->code, def, gen->code_loc);
-    gen->code_loc += strlen(def);
 
-    replaced = strreplace(def, "Imp", "Def");
-    assert(replaced);
+    gen_insert_generic(gen, (GenGeneric){
+        .id = id,
+        .key = def,
+        .def = def,
+        .imp = imp,
+    });
+    strbfree(imp);
 }
 
 strb gen_decl_proto(Gen *gen, Stmnt stmnt) {
@@ -1081,6 +1671,9 @@ void gen_var_decl(Gen *gen, Stmnt stmnt) {
 
             mastrfree(value);
             return;
+        } else if (vardecl.type.kind == TkSoa) {
+            gen_writeln(gen, " = {0};");
+            return;
         }
 
         gen_writeln(gen, ";");
@@ -1094,12 +1687,49 @@ void gen_var_decl(Gen *gen, Stmnt stmnt) {
     }
 }
 
+// true if expr only holds literals, sema folds constant names in these before gen
+bool gen_is_baked(Gen *gen, Expr expr) {
+    switch (expr.kind) {
+        case EkIntLit:
+        case EkFloatLit:
+        case EkCharLit:
+        case EkStrLit:
+        case EkCstrLit:
+        case EkTrue:
+        case EkFalse:
+        case EkNull:
+            return true;
+        case EkLiteral:
+            if (expr.type.kind == TkSlice) return false;
+
+            if (expr.literal.kind == LitkExprs) {
+                for (size_t i = 0; i < arrlenu(expr.literal.exprs); i++) {
+                    if (!gen_is_baked(gen, expr.literal.exprs[i])) return false;
+                }
+            } else if (expr.literal.kind == LitkVars) {
+                for (size_t i = 0; i < arrlenu(expr.literal.vars); i++) {
+                    if (!gen_is_baked(gen, expr.literal.vars[i].varreassign.value)) return false;
+                }
+            }
+            return true;
+        case EkFieldAccess:
+            // <enum>.<field>
+            return expr.fieldacc.accessing->kind == EkIdent && ast_find_decl(gen->ast, expr.fieldacc.accessing->ident).kind == SkEnumDecl;
+        default:
+            return false;
+    }
+}
+
 void gen_const_decl(Gen *gen, Stmnt stmnt) {
     assert(stmnt.kind == SkConstDecl);
     ConstDecl constdecl = stmnt.constdecl;
 
+    // constant data lives in .rodata instead of being rebuilt every time the scope is entered
+    // NOTE: const on a pointer would apply to what it points to
+    bool baked = constdecl.type.kind != TkPtr && constdecl.type.kind != TkCstring && gen_is_baked(gen, constdecl.value);
+
     strb proto = gen_decl_proto(gen, stmnt);
-    gen_write(gen, "%s = ", proto);
+    gen_write(gen, "%s%s = ", baked ? "static const " : "", proto);
     strbfree(proto);
 
     MaybeAllocStr value = gen_expr(gen, constdecl.value);
@@ -1114,6 +1744,24 @@ void gen_var_reassign(Gen *gen, Stmnt stmnt) {
 
     gen_indent(gen);
 
+    // <soa>[i] = v; writes every column
+    if (varre.name.kind == EkArrayIndex) {
+        Expr soa = *varre.name.arrayidx.accessing;
+        Type soatype = soa.type.kind == TkPtr ? *soa.type.ptr_to : soa.type;
+
+        if (soatype.kind == TkSoa) {
+            MaybeAllocStr access = gen_expr(gen, soa);
+            MaybeAllocStr index = gen_expr(gen, *varre.name.arrayidx.index);
+            MaybeAllocStr value = gen_expr(gen, varre.value);
+            gen_writeln(gen, "pinesoa_set_%s(%s%s, %s, %s);", soatype.soa.of->typedeff, soa.type.kind == TkPtr ? "" : "&", access.str, index.str, value.str);
+
+            mastrfree(access);
+            mastrfree(index);
+            mastrfree(value);
+            return;
+        }
+    }
+
     MaybeAllocStr reassign = gen_expr(gen, varre.name);
     MaybeAllocStr value = gen_expr(gen, varre.value);
     gen_writeln(gen, "%s = %s;", reassign.str, value.str);
@@ -1122,25 +1770,105 @@ void gen_var_reassign(Gen *gen, Stmnt stmnt) {
     mastrfree(reassign);
 }
 
-void gen_all_defers(Gen *gen) {
-    for (ptrdiff_t i = arrlen(gen->defers) - 1; i >= 0; i--) {
-        gen_stmnt(gen, gen->defers[i].stmnt);
+// the last thing deferred inside the innermost loop, -1 if nothing was
+ptrdiff_t gen_loop_defer(Gen *gen) {
+    ptrdiff_t last = arrlen(gen->defers) - 1;
+    if (last >= (ptrdiff_t)gen->loop_defers) return last;
+    return -1;
+}
+
+void gen_defer_jump(Gen *gen, size_t i, DeferExit exit) {
+    gen->defers[i].exits |= 1 << exit;
+    gen->defer_exits |= 1 << exit;
+
+    gen_indent(gen);
+    gen_writeln(gen, "pine_defer_exit = %d; goto pine_defer_%zu;", exit, gen->defers[i].label);
+}
+
+// each deferred statement is emitted once, at the end of its scope
+// an exit jumps to the label of the last thing deferred and falls through the rest, then leaves the way it came in
+void gen_defers(Gen *gen, bool reachable) {
+    ptrdiff_t first = arrlen(gen->defers);
+    while (first > 0 && gen->defers[first - 1].indent == gen->indent) first--;
+
+    // popped first so a return inside a deferred statement only runs the scopes around this one
+    Arr(Defer) scope = NULL;
+    uint8_t exits = 0;
+    for (ptrdiff_t i = first; i < arrlen(gen->defers); i++) {
+        arrpush(scope, gen->defers[i]);
+        exits |= gen->defers[i].exits;
+    }
+    arrsetlen(gen->defers, first);
+
+    if (exits != 0 && reachable) {
+        gen_indent(gen);
+        gen_writeln(gen, "pine_defer_exit = %d;", DeFall);
+    }
+
+    for (ptrdiff_t i = arrlen(scope) - 1; i >= 0; i--) {
+        if (scope[i].exits != 0) {
+            gen_indent(gen);
+            gen_writeln(gen, "pine_defer_%zu:;", scope[i].label);
+        }
+        gen_stmnt(gen, scope[i].stmnt);
+    }
+    arrfree(scope);
+
+    // with nothing falling in and one way in, there's only one way out
+    bool only = !reachable && (exits & (exits - 1)) == 0;
+    for (DeferExit exit = DeReturn; exit <= DeContinue; exit++) {
+        if (!(exits & (1 << exit))) continue;
+
+        gen_indent(gen);
+        if (!only) gen_write(gen, "if (pine_defer_exit == %d) ", exit);
+
+        // break and continue carry on through the scopes around this one until they leave the loop
+        ptrdiff_t outer = exit == DeReturn ? arrlen(gen->defers) - 1 : gen_loop_defer(gen);
+        if (outer >= 0) {
+            gen->defers[outer].exits |= 1 << exit;
+            gen_writeln(gen, "goto pine_defer_%zu;", gen->defers[outer].label);
+        } else if (exit == DeBreak) {
+            gen_writeln(gen, "break;");
+        } else if (exit == DeContinue) {
+            gen_writeln(gen, "continue;");
+        } else {
+            gen_writeln(gen, "return;");
+        }
     }
 }
-void gen_defers(Gen *gen) {
-    for (ptrdiff_t i = arrlen(gen->defers) - 1; i >= 0; i--) {
-        if (gen->defers[i].indent == gen->indent) {
-            gen_stmnt(gen, gen->defers[i].stmnt);
+
+// a returned value is worked out after the defers, and the locals of inner scopes are gone by the end of a chain
+// so a return with a value runs everything deferred in place
+void gen_inline_defers(Gen *gen) {
+    Arr(Defer) defers = NULL;
+    for (size_t i = 0; i < arrlenu(gen->defers); i++) {
+        arrpush(defers, gen->defers[i]);
+    }
+
+    // as in a chain, a return inside a deferred statement only runs what was deferred before it
+    for (ptrdiff_t i = arrlen(defers) - 1; i >= 0; i--) {
+        arrsetlen(gen->defers, i);
+        gen_stmnt(gen, defers[i].stmnt);
+        for (ptrdiff_t j = 0; j < i; j++) {
+            defers[j].exits = gen->defers[j].exits;
         }
     }
+
+    arrfree(gen->defers);
+    gen->defers = defers;
 }
 
 void gen_return(Gen *gen, Stmnt stmnt) {
     assert(stmnt.kind == SkReturn);
-    gen_all_defers(gen);
-
     Return ret = stmnt.returnf;
 
+    ptrdiff_t last = arrlen(gen->defers) - 1;
+    if (last >= 0 && ret.value.kind == EkNone) {
+        gen_defer_jump(gen, last, DeReturn);
+        return;
+    }
+    gen_inline_defers(gen);
+
     gen_indent(gen);
     if (ret.value.kind == EkNone) {
         gen_writeln(gen, "return;");
@@ -1155,14 +1883,22 @@ void gen_return(Gen *gen, Stmnt stmnt) {
 
 void gen_continue(Gen *gen, Stmnt stmnt) {
     assert(stmnt.kind == SkContinue);
-    gen_defers(gen);
+    ptrdiff_t last = gen_loop_defer(gen);
+    if (last >= 0) {
+        gen_defer_jump(gen, last, DeContinue);
+        return;
+    }
     gen_indent(gen);
     gen_writeln(gen, "continue;");
 }
 
 void gen_break(Gen *gen, Stmnt stmnt) {
     assert(stmnt.kind == SkBreak);
-    gen_defers(gen);
+    ptrdiff_t last = gen_loop_defer(gen);
+    if (last >= 0) {
+        gen_defer_jump(gen, last, DeBreak);
+        return;
+    }
     gen_indent(gen);
     gen_writeln(gen, "break;");
 }
@@ -1230,7 +1966,10 @@ void gen_for(Gen *gen, Stmnt stmnt) {
 
     gen_indent(gen);
     gen_write(gen, "for (; %s; %s = %s) ", cond.str, reassign.str, value.str);
+    size_t loop_defers = gen->loop_defers;
+    gen->loop_defers = arrlenu(gen->defers);
     gen_block(gen, forf.body);
+    gen->loop_defers = loop_defers;
 
     gen_indent(gen);
     gen_writeln(gen, "}");
@@ -1240,6 +1979,305 @@ void gen_for(Gen *gen, Stmnt stmnt) {
     mastrfree(cond);
 }
 
+// case bodies live outside of any C switch so break and continue still apply to the enclosing loop
+void gen_switch_cases(Gen *gen, Switch sw, size_t id) {
+    for (size_t i = 0; i < arrlenu(sw.cases); i++) {
+        Case c = sw.cases[i];
+
+        gen_indent(gen);
+        gen_write(gen, "pine_switch_%zu_case_%zu: ", id, i);
+
+        if (c.capture_decl != NULL) {
+            const char *variant = c.values[0].fieldacc.field->ident;
+
+            gen_writeln(gen, "{");
+            gen->indent++;
+            strb proto = gen_decl_proto(gen, *c.capture_decl);
+            gen_writeln(gen, "%s = pine_switch_%zu.as.%s;", proto, id, variant);
+            strbfree(proto);
+
+            gen_indent(gen);
+            gen_block(gen, c.body);
+
+            gen->indent--;
+            gen_indent(gen);
+            gen_writeln(gen, "}");
+        } else {
+            gen_block(gen, c.body);
+        }
+
+        gen_indent(gen);
+        gen_writeln(gen, "goto pine_switch_%zu_end;", id);
+    }
+}
+
+// where values without a case go
+strb gen_switch_default_label(Switch sw, size_t id) {
+    strb label = NULL;
+    for (size_t i = 0; i < arrlenu(sw.cases); i++) {
+        if (sw.cases[i].values == NULL) {
+            strbprintf(&label, "pine_switch_%zu_case_%zu", id, i);
+            return label;
+        }
+    }
+
+    strbprintf(&label, "pine_switch_%zu_end", id);
+    return label;
+}
+
+MaybeAllocStr gen_switch_const(Switch sw, uint64_t value) {
+    strb ret = NULL;
+    if (sw.is_signed) {
+        strbprintf(&ret, "INT64_C(%" PRId64 ")", (int64_t)value);
+    } else {
+        strbprintf(&ret, "UINT64_C(%" PRIu64 ")", value);
+    }
+
+    return (MaybeAllocStr){
+        .str = ret,
+        .alloced = true,
+    };
+}
+
+// jumps straight to the case for the tag, no compare chain
+// the table is indexed by tag so it's always dense
+void gen_switch_tag_table(Gen *gen, Switch sw, size_t id, UnionDecl uniond) {
+    size_t variants = arrlenu(uniond.fields);
+    strb default_label = gen_switch_default_label(sw, id);
+
+    // case index for every tag, -1 if it goes to default
+    Arr(ptrdiff_t) targets = NULL;
+    for (size_t i = 0; i < variants; i++) {
+        arrpush(targets, -1);
+    }
+
+    for (size_t i = 0; i < arrlenu(sw.cases); i++) {
+        Case c = sw.cases[i];
+        for (size_t j = 0; j < arrlenu(c.values); j++) {
+            const char *name = c.values[j].fieldacc.field->ident;
+            for (size_t k = 0; k < variants; k++) {
+                if (streq(uniond.fields[k].vardecl.name.ident, name)) targets[k] = (ptrdiff_t)i;
+            }
+        }
+    }
+
+    gen_writeln(gen, "#if defined(__GNUC__)");
+    gen_indent(gen);
+    gen_write(gen, "static void *pine_switch_%zu_table[] = {", id);
+    for (size_t i = 0; i < variants; i++) {
+        if (i != 0) gen_write(gen, ", ");
+
+        if (targets[i] >= 0) gen_write(gen, "&&pine_switch_%zu_case_%td", id, targets[i]);
+        else gen_write(gen, "&&%s", default_label);
+    }
+    gen_writeln(gen, "};");
+    gen_indent(gen);
+    gen_writeln(gen, "goto *pine_switch_%zu_table[pine_switch_%zu.tag];", id, id);
+
+    gen_writeln(gen, "#else");
+    gen_indent(gen);
+    gen_writeln(gen, "switch (pine_switch_%zu.tag) {", id);
+    gen->indent++;
+    for (size_t i = 0; i < variants; i++) {
+        if (targets[i] < 0) continue;
+        gen_indent(gen);
+        gen_writeln(gen, "case %s_%s: goto pine_switch_%zu_case_%td;", uniond.name.ident, uniond.fields[i].vardecl.name.ident, id, targets[i]);
+    }
+    gen_indent(gen);
+    gen_writeln(gen, "default: goto %s;", default_label);
+    gen->indent--;
+    gen_indent(gen);
+    gen_writeln(gen, "}");
+    gen_writeln(gen, "#endif");
+
+    arrfree(targets);
+    strbfree(default_label);
+}
+
+// dense cases, the C compiler turns this into a jump table
+void gen_switch_jump_table(Gen *gen, Switch sw, size_t id) {
+    strb default_label = gen_switch_default_label(sw, id);
+
+    gen_indent(gen);
+    gen_writeln(gen, "switch (pine_switch_%zu) {", id);
+    gen->indent++;
+    for (size_t i = 0; i < arrlenu(sw.ranges); i++) {
+        CaseRange r = sw.ranges[i];
+        MaybeAllocStr lo = gen_switch_const(sw, r.lo);
+
+        gen_indent(gen);
+        if (r.lo == r.hi) {
+            gen_writeln(gen, "case %s: goto pine_switch_%zu_case_%zu;", lo.str, id, r.case_idx);
+        } else {
+            // NOTE: case ranges are a gcc/clang extension, pine only uses those two
+            MaybeAllocStr hi = gen_switch_const(sw, r.hi);
+            gen_writeln(gen, "case %s ... %s: goto pine_switch_%zu_case_%zu;", lo.str, hi.str, id, r.case_idx);
+            mastrfree(hi);
+        }
+
+        mastrfree(lo);
+    }
+    gen_indent(gen);
+    gen_writeln(gen, "default: goto %s;", default_label);
+    gen->indent--;
+    gen_indent(gen);
+    gen_writeln(gen, "}");
+
+    strbfree(default_label);
+}
+
+// binary search over the sorted ranges, sparse cases would make a huge table
+void gen_switch_tree(Gen *gen, Switch sw, size_t id, ptrdiff_t lo, ptrdiff_t hi, const char *default_label) {
+    gen_indent(gen);
+    if (lo > hi) {
+        gen_writeln(gen, "goto %s;", default_label);
+        return;
+    }
+
+    ptrdiff_t mid = lo + (hi - lo) / 2;
+    CaseRange r = sw.ranges[mid];
+    MaybeAllocStr rlo = gen_switch_const(sw, r.lo);
+    MaybeAllocStr rhi = gen_switch_const(sw, r.hi);
+
+    gen_writeln(gen, "if (pine_switch_%zu < %s) {", id, rlo.str);
+    gen->indent++;
+    gen_switch_tree(gen, sw, id, lo, mid - 1, default_label);
+    gen->indent--;
+
+    gen_indent(gen);
+    gen_writeln(gen, "} else if (pine_switch_%zu > %s) {", id, rhi.str);
+    gen->indent++;
+    gen_switch_tree(gen, sw, id, mid + 1, hi, default_label);
+    gen->indent--;
+
+    gen_indent(gen);
+    gen_writeln(gen, "} else {");
+    gen->indent++;
+    gen_indent(gen);
+    gen_writeln(gen, "goto pine_switch_%zu_case_%zu;", id, r.case_idx);
+    gen->indent--;
+
+    gen_indent(gen);
+    gen_writeln(gen, "}");
+
+    mastrfree(rlo);
+    mastrfree(rhi);
+}
+
+// every arm assigns a constant to the same variable, sema checked this
+void gen_switch_lookup_table(Gen *gen, Switch sw, size_t id) {
+    Stmnt first = sw.cases[0].body[0];
+    Expr target = first.varreassign.name;
+
+    ptrdiff_t default_case = -1;
+    for (size_t i = 0; i < arrlenu(sw.cases); i++) {
+        if (sw.cases[i].values == NULL) default_case = (ptrdiff_t)i;
+    }
+
+    Arr(MaybeAllocStr) values = NULL;
+    for (size_t i = 0; i < arrlenu(sw.cases); i++) {
+        arrpush(values, gen_expr(gen, sw.cases[i].body[0].varreassign.value));
+    }
+
+    MaybeAllocStr elemtype = gen_type(gen, target.type);
+    MaybeAllocStr lo = gen_switch_const(sw, sw.ranges[0].lo);
+
+    gen_indent(gen);
+    gen_write(gen, "static const %s pine_switch_%zu_table[%" PRIu64 "] = {", elemtype.str, id, sw.span);
+    // offsets from the smallest value keep their order for signed values too
+    uint64_t base = sw.ranges[0].lo;
+    size_t r = 0;
+    for (uint64_t i = 0; i < sw.span; i++) {
+        while (r < arrlenu(sw.ranges) && sw.ranges[r].hi - base < i) r++;
+
+        bool in_range = r < arrlenu(sw.ranges) && sw.ranges[r].lo - base <= i;
+        size_t arm = in_range ? sw.ranges[r].case_idx : (size_t)default_case;
+
+        if (i != 0) gen_write(gen, ", ");
+        gen_write(gen, "%s", values[arm].str);
+    }
+    gen_writeln(gen, "};");
+
+    MaybeAllocStr name = gen_expr(gen, target);
+    gen_indent(gen);
+    gen_writeln(gen, "if ((u64)pine_switch_%zu - (u64)%s < UINT64_C(%" PRIu64 ")) {", id, lo.str, sw.span);
+    gen->indent++;
+    gen_indent(gen);
+    gen_writeln(gen, "%s = pine_switch_%zu_table[(u64)pine_switch_%zu - (u64)%s];", name.str, id, id, lo.str);
+    gen->indent--;
+    gen_indent(gen);
+
+    if (default_case >= 0) {
+        gen_writeln(gen, "} else {");
+        gen->indent++;
+        gen_indent(gen);
+        gen_writeln(gen, "%s = %s;", name.str, values[default_case].str);
+        gen->indent--;
+        gen_indent(gen);
+    }
+    gen_writeln(gen, "}");
+
+    for (size_t i = 0; i < arrlenu(values); i++) {
+        mastrfree(values[i]);
+    }
+    arrfree(values);
+    mastrfree(name);
+    mastrfree(lo);
+    mastrfree(elemtype);
+}
+
+void gen_switch(Gen *gen, Stmnt stmnt) {
+    assert(stmnt.kind == SkSwitch);
+    Switch sw = stmnt.switchf;
+    size_t id = gen->switch_count++;
+
+    MaybeAllocStr value = gen_expr(gen, sw.value);
+    MaybeAllocStr valtype = gen_type(gen, sw.value.type);
+
+    gen_indent(gen);
+    gen_writeln(gen, "{");
+    gen->indent++;
+
+    gen_indent(gen);
+    gen_writeln(gen, "%s pine_switch_%zu = %s;", valtype.str, id, value.str);
+
+    switch (sw.lowering) {
+        case SlTagTable: {
+            Stmnt decl = ast_find_decl(gen->ast, sw.value.type.typedeff);
+            assert(decl.kind == SkUnionDecl);
+            gen_switch_tag_table(gen, sw, id, decl.uniondecl);
+        } break;
+        case SlJumpTable:
+            gen_switch_jump_table(gen, sw, id);
+            break;
+        case SlDecisionTree: {
+            strb default_label = gen_switch_default_label(sw, id);
+            gen_switch_tree(gen, sw, id, 0, (ptrdiff_t)arrlenu(sw.ranges) - 1, default_label);
+            strbfree(default_label);
+        } break;
+        case SlLookupTable:
+            gen_switch_lookup_table(gen, sw, id);
+            break;
+        case SlNone:
+            assert(false && "switch lowering not picked in sema");
+            break;
+    }
+
+    if (sw.lowering != SlLookupTable) {
+        gen_switch_cases(gen, sw, id);
+
+        gen_indent(gen);
+        gen_writeln(gen, "pine_switch_%zu_end:;", id);
+    }
+
+    gen->indent--;
+    gen_indent(gen);
+    gen_writeln(gen, "}");
+
+    mastrfree(valtype);
+    mastrfree(value);
+}
+
 void gen_stmnt(Gen *gen, Stmnt *stmnt) {
     switch (stmnt->kind) {
         case SkNone:
@@ -1267,6 +2305,9 @@ void gen_stmnt(Gen *gen, Stmnt *stmnt) {
         case SkEnumDecl:
             // do nothing, defs will be resolved later
             break;
+        case SkUnionDecl:
+            // do nothing, defs will be resolved later
+            break;
         case SkVarDecl:
             gen_var_decl(gen, *stmnt);
             break;
@@ -1294,6 +2335,9 @@ void gen_stmnt(Gen *gen, Stmnt *stmnt) {
         case SkFor:
             gen_for(gen, *stmnt);
             break;
+        case SkSwitch:
+            gen_switch(gen, *stmnt);
+            break;
     }
 }
 
@@ -1305,18 +2349,37 @@ void gen_block(Gen *gen, Arr(Stmnt) block) {
         gen_stmnt(gen, &block[i]);
     }
 
-    gen_defers(gen);
-    gen_pop_defers(gen);
+    // nothing after a return, break or continue falls into the cleanup
+    Stmnt *last = arrlenu(block) > 0 ? &block[arrlenu(block) - 1] : NULL;
+    bool reachable = last == NULL || (last->kind != SkReturn && last->kind != SkBreak && last->kind != SkContinue);
+    gen_defers(gen, reachable);
     gen->indent--;
     gen_indent(gen);
     gen_writeln(gen, "}");
 }
 
+// where the body of the function being generated starts, generics inserted before the function move it along
+size_t gen_body_loc(Gen *gen, size_t header) {
+    return (gen->code == NULL ? 0 : strlen(gen->code)) + header - gen->code_loc;
+}
+
+// what the cleanup chains of a function need, only known once its whole body is generated
+void gen_defer_locals(Gen *gen, size_t body) {
+    if (gen->defer_exits == 0) return;
+
+    strb locals = NULL;
+    strbprintf(&locals, "    int pine_defer_exit = %d;\n", DeFall);
+
+    gen->code = strbinsert(gen->code, locals, gen->code_loc + body);
+    strbfree(locals);
+}
+
 void gen_fn_main_decl(Gen *gen, Stmnt stmnt) {
     assert(stmnt.kind == SkFnDecl);
     FnDecl fndecl = stmnt.fndecl;
 
     gen_writeln(gen, "int main(int argc, const char **argv) {");
+    size_t body = gen_body_loc(gen, 0);
     gen->indent++;
 
     if (arrlenu(fndecl.args) == 1) {
@@ -1342,14 +2405,177 @@ void gen_fn_main_decl(Gen *gen, Stmnt stmnt) {
     gen->indent--;
     gen_indent(gen);
     gen_writeln(gen, "}");
+
+    gen_defer_locals(gen, body);
+}
+
+static void gen_ir_local(IrFn *fn, size_t args, size_t local, strb *out) {
+    if (local < args) {
+        strbprintf(out, "%s", fn->locals[local].name);
+    } else {
+        strbprintf(out, "pine_%s_%zu", fn->locals[local].name, local);
+    }
+}
+
+// every temporary is used once, so it's written out where it's used the same way gen_expr would have
+static void gen_ir_value(Gen *gen, IrFn *fn, IrInst **defs, size_t args, size_t temp, strb *out) {
+    IrInst *inst = defs[temp];
+
+    switch (inst->op) {
+        case IrConst: {
+            Expr literal;
+            eval_to_expr(inst->value, inst->type, 0, &literal);
+            MaybeAllocStr value = gen_expr(gen, literal);
+            strbprintf(out, "%s", value.str);
+            mastrfree(value);
+        } break;
+        case IrCopy:
+            strbprintf(out, "(");
+            gen_ir_value(gen, fn, defs, args, inst->a, out);
+            strbprintf(out, ")");
+            break;
+        case IrLoad:
+            gen_ir_local(fn, args, inst->local, out);
+            break;
+        case IrBinop: {
+            static const char *ops[] = {
+                [BkPlus] = "+", [BkMinus] = "-", [BkMultiply] = "*", [BkDivide] = "/", [BkMod] = "%",
+                [BkLess] = "<", [BkLessEqual] = "<=", [BkGreater] = ">", [BkGreaterEqual] = ">=", [BkEquals] = "==", [BkInequals] = "!=",
+                [BkLeftShift] = "<<", [BkRightShift] = ">>", [BkBitAnd] = "&", [BkBitOr] = "|", [BkBitXor] = "^",
+                [BkAnd] = "&&", [BkOr] = "||",
+            };
+            strbprintf(out, "(");
+            gen_ir_value(gen, fn, defs, args, inst->a, out);
+            strbprintf(out, " %s ", ops[inst->sub]);
+            gen_ir_value(gen, fn, defs, args, inst->b, out);
+            strbprintf(out, ")");
+        } break;
+        case IrUnop:
+            strbprintf(out, "%s(", inst->sub == UkNegate ? "-" : inst->sub == UkNot ? "!" : "~");
+            gen_ir_value(gen, fn, defs, args, inst->a, out);
+            strbprintf(out, ")");
+            break;
+        case IrConvert: {
+            MaybeAllocStr type = gen_type(gen, inst->type);
+            strbprintf(out, "((%s)", type.str);
+            gen_ir_value(gen, fn, defs, args, inst->a, out);
+            strbprintf(out, ")");
+            mastrfree(type);
+        } break;
+        case IrCall:
+            strbprintf(out, "%s(", inst->call->name->ident);
+            for (size_t i = 0; i < arrlenu(inst->args); i++) {
+                if (i > 0) strbprintf(out, ", ");
+                gen_ir_value(gen, fn, defs, args, inst->args[i], out);
+            }
+            strbprintf(out, ")");
+            break;
+        case IrStore:
+        case IrEval:
+        case IrEffect:
+            assert(false && "ir_optimise only keeps bodies without these");
+    }
+}
+
+// a body ir_optimise kept, locals are declared up front and blocks are labels, defers were already copied to every exit
+static void gen_ir_body(Gen *gen, IrFn *fn, size_t args) {
+    size_t blocks = arrlenu(fn->blocks);
+    IrInst **defs = ealloc(sizeof(IrInst*) * (fn->temps + 1));
+    bool *targeted = ealloc(sizeof(bool) * blocks);
+    memset(targeted, 0, sizeof(bool) * blocks);
+
+    // the next block emitted is fallen into instead of jumped to
+    size_t *next = ealloc(sizeof(size_t) * blocks);
+    size_t after = IR_NONE;
+    for (size_t b = blocks; b-- > 0;) {
+        next[b] = after;
+        if (fn->blocks[b].dead) continue;
+        after = b;
+
+        IrBlock *block = &fn->blocks[b];
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            if (block->insts[i].dst != IR_NONE) defs[block->insts[i].dst] = &block->insts[i];
+        }
+    }
+    for (size_t b = 0; b < blocks; b++) {
+        IrTerm term = fn->blocks[b].term;
+        if (fn->blocks[b].dead) continue;
+        if (term.kind == IrBranch || (term.kind == IrJump && term.then != next[b])) targeted[term.then] = true;
+        if (term.kind == IrBranch && term.els != next[b]) targeted[term.els] = true;
+    }
+
+    gen_writeln(gen, "{");
+    for (size_t i = args; i < arrlenu(fn->locals); i++) {
+        strb name = NULL;
+        gen_ir_local(fn, args, i, &name);
+        MaybeAllocStr type = gen_type(gen, fn->locals[i].type);
+        gen_writeln(gen, "    %s %s = 0;", type.str, name);
+        mastrfree(type);
+        strbfree(name);
+    }
+
+    for (size_t b = 0; b < blocks; b++) {
+        IrBlock *block = &fn->blocks[b];
+        if (block->dead) continue;
+        if (targeted[b]) gen_writeln(gen, "pine_b%zu:;", b);
+
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            IrInst inst = block->insts[i];
+            strb line = NULL;
+            if (inst.op == IrStore && inst.a != IR_NONE) {
+                gen_ir_local(fn, args, inst.local, &line);
+                strbprintf(&line, " = ");
+                gen_ir_value(gen, fn, defs, args, inst.a, &line);
+            } else if (inst.op == IrCall && inst.expr == NULL) {
+                gen_ir_value(gen, fn, defs, args, inst.dst, &line);
+            }
+            if (line != NULL) gen_writeln(gen, "    %s;", line);
+            strbfree(line);
+        }
+
+        IrTerm term = block->term;
+        strb cond = NULL;
+        if (term.cond != IR_NONE) gen_ir_value(gen, fn, defs, args, term.cond, &cond);
+        switch (term.kind) {
+            case IrJump:
+                if (term.then != next[b]) gen_writeln(gen, "    goto pine_b%zu;", term.then);
+                break;
+            case IrBranch:
+                gen_writeln(gen, "    if (%s) goto pine_b%zu;", cond, term.then);
+                if (term.els != next[b]) gen_writeln(gen, "    goto pine_b%zu;", term.els);
+                break;
+            case IrRet:
+                if (cond == NULL) {
+                    gen_writeln(gen, "    return;");
+                } else {
+                    gen_writeln(gen, "    return %s;", cond);
+                }
+                break;
+            default:
+                assert(false && "ir_optimise only keeps bodies ending in these");
+        }
+        strbfree(cond);
+    }
+    gen_writeln(gen, "}");
+
+    free(next);
+    free(targeted);
+    free(defs);
 }
 
 void gen_fn_decl(Gen *gen, Stmnt stmnt, bool is_extern) {
     assert(stmnt.kind == SkFnDecl);
     FnDecl fndecl = stmnt.fndecl;
 
-    gen->code_loc = strlen(gen->code);
-    gen->def_loc = strlen(gen->defs);
+    // C can't return arrays, every call to these was evaluated at compile time
+    if (fndecl.type.kind == TkArray) return;
+
+    // a worker starts with empty buffers
+    gen->code_loc = gen->code == NULL ? 0 : strlen(gen->code);
+    gen->def_loc = gen->defs == NULL ? 0 : strlen(gen->defs);
+    gen->defer_labels = 0;
+    gen->defer_exits = 0;
+    gen_byref_scan(gen, fndecl);
     gen_indent(gen);
 
     if (fndecl.name.kind == EkIdent && streq("main", fndecl.name.ident)) {
@@ -1362,31 +2588,93 @@ void gen_fn_decl(Gen *gen, Stmnt stmnt, bool is_extern) {
     strbprintf(&code, "%s(", proto);
     strbfree(proto);
 
+    uint64_t byref = is_extern ? 0 : gen_byref_mask(gen, fndecl.name);
+    uint64_t noalias_slices = is_extern ? 0 : gen_noalias_mask(gen, fndecl.name);
+    bool internal = fndecl.has_body && !is_extern && !gen->compile_flags.object;
+    strb prologue = NULL;
+
     for (size_t i = 0; i < arrlenu(fndecl.args); i++) {
         Stmnt arg = fndecl.args[i];
         assert(arg.kind == SkConstDecl || arg.kind == SkVarDecl);
 
-        strb arg_proto = gen_decl_proto(gen, arg);
+        // arguments can't be mutated, so constant arrays in .rodata can be passed without a copy
+        const char *qual = !is_extern && arg.kind == SkConstDecl && arg.constdecl.type.kind == TkArray ? "const " : "";
+
+        strb arg_proto = NULL;
+        if (i < 64 && (byref >> i & 1)) {
+            MaybeAllocStr type = gen_type(gen, arg.constdecl.type);
+            strbprintf(&arg_proto, "const %s *restrict %s", type.str, arg.constdecl.name.ident);
+            arrpush(gen->byref_args, arg.constdecl.name.ident);
+            mastrfree(type);
+        } else if (i < 64 && (noalias_slices >> i & 1)) {
+            // the body keeps using a plain slice, copied from the restrict one so gcc still knows where it points
+            const char *name = arg.constdecl.name.ident;
+            MaybeAllocStr type = gen_type(gen, arg.constdecl.type);
+            strb restricted = gen_noalias_slice(gen, arg.constdecl.type, false);
+            strbprintf(&arg_proto, "%s pine_noalias_%s", restricted, name);
+            strbprintf(&prologue, "    %s %s = {pine_noalias_%s.ptr, pine_noalias_%s.len};\n", type.str, name, name, name);
+            strbfree(restricted);
+            mastrfree(type);
+        } else if (i < 64 && arg.constdecl.type.kind == TkPtr && (fndecl.alias.noalias | fndecl.alias.readonly) >> i & 1) {
+            // const only goes on the first level, a pointer to a cstring is already const
+            Type *to = arg.constdecl.type.ptr_to;
+            bool readonly = internal && (fndecl.alias.readonly >> i & 1) && to->kind != TkPtr && to->kind != TkCstring;
+            MaybeAllocStr type = gen_type(gen, arg.constdecl.type);
+            strbprintf(&arg_proto, "%s%s%s %s", readonly ? "const " : "", type.str, fndecl.alias.noalias >> i & 1 ? " restrict" : "", arg.constdecl.name.ident);
+            mastrfree(type);
+        } else {
+            arg_proto = gen_decl_proto(gen, arg);
+        }
+
         if (i == 0) {
-            strbprintf(&code, "%s", arg_proto);
+            strbprintf(&code, "%s%s", qual, arg_proto);
         } else {
-            strbprintf(&code, ", %s", arg_proto);
+            strbprintf(&code, ", %s%s", qual, arg_proto);
         }
 
         strbfree(arg_proto);
     }
     strbprintf(&code, ")");
 
+    // output.c is the whole program, only main and extern functions are called from outside of it
+    // a library built for -pmi is linked into other programs, so everything in it keeps external linkage
+    const char *linkage = internal ? "static " : "";
+
+    // const lets gcc reuse a result for the same arguments, a by-ref argument is read through a pointer so it's only pure
+    const char *effect = "";
+    if (fndecl.has_body && fndecl.type.kind != TkVoid) {
+        if (fndecl.alias.effect == FeConst && byref == 0) {
+            effect = "__attribute__((const)) ";
+        } else if (fndecl.alias.effect != FeAny) {
+            effect = "__attribute__((pure)) ";
+        }
+    }
+
     gen->in_defs = true;
-    gen_writeln(gen, "%s;", code);
+    gen_writeln(gen, "%s%s%s;", linkage, effect, code);
     gen->in_defs = false;
 
     if (fndecl.has_body) {
+        // the prototype isn't inline, so an external #inline function still gets a definition
+        const char *inlining = "";
+        if (fndecl.attrs.inline_always) inlining = "inline __attribute__((always_inline)) ";
+        if (fndecl.attrs.noinline) inlining = "__attribute__((noinline)) ";
+        gen_write(gen, "%s%s%s%s", linkage, inlining, effect, fndecl.attrs.flatten ? "__attribute__((flatten)) " : "");
+
         gen_write(gen, "%s ", code);
-        gen_block(gen, fndecl.body);
+        size_t body = gen_body_loc(gen, strlen("{\n"));
+        IrFn *ir = ir_fn_find(gen->ir, fndecl.body);
+        if (ir != NULL) {
+            gen_ir_body(gen, ir, arrlenu(fndecl.args));
+        } else {
+            gen_block(gen, fndecl.body);
+            gen_defer_locals(gen, body);
+        }
+        if (prologue != NULL) gen->code = strbinsert(gen->code, prologue, gen->code_loc + body);
     } else if (!is_extern) {
         gen_writeln(gen, "%v;", code);
     }
+    strbfree(prologue);
 }
 
 void gen_extern(Gen *gen, Stmnt stmnt) {
@@ -1428,8 +2716,29 @@ void gen_struct_decl(Gen *gen, Stmnt stmnt) {
     gen_indent(gen);
 
     gen->in_defs = true;
-    gen_write(gen, "%s", struct_def);
-    gen_block(gen, structd.fields);
+
+    StructAttrs *attrs = structd.attrs;
+    if (attrs != NULL && (attrs->packed || attrs->align != 0)) {
+        gen_write(gen, "struct __attribute__((");
+        if (attrs->packed) gen_write(gen, "packed");
+        if (attrs->packed && attrs->align != 0) gen_write(gen, ", ");
+        if (attrs->align != 0) gen_write(gen, "aligned(%lu)", attrs->align);
+        gen_write(gen, ")) %s", structd.name.ident);
+    } else {
+        gen_write(gen, "%s", struct_def);
+    }
+
+    if (attrs != NULL && attrs->order != NULL) {
+        Arr(Stmnt) fields = NULL;
+        for (size_t i = 0; i < arrlenu(attrs->order); i++) {
+            arrpush(fields, structd.fields[attrs->order[i]]);
+        }
+
+        gen_block(gen, fields);
+        arrfree(fields);
+    } else {
+        gen_block(gen, structd.fields);
+    }
     gen_writeln(gen, ";");
     gen->in_defs = false;
 }
@@ -1470,6 +2779,67 @@ void gen_enum_decl(Gen *gen, Stmnt stmnt) {
     gen->in_defs = false;
 }
 
+// struct <name> { union { <payloads> } as; <u8 or u16> tag; };
+void gen_union_decl(Gen *gen, Stmnt stmnt) {
+    assert(stmnt.kind == SkUnionDecl);
+    UnionDecl uniond = stmnt.uniondecl;
+
+    strb union_def = NULL;
+    strbprintf(&union_def, "struct %s", uniond.name.ident);
+
+    if (gen_find_generated_typedef(gen, union_def)) {
+        strbfree(union_def);
+        return;
+    }
+
+    arrpush(gen->generated_typedefs, union_def);
+    gen->def_loc = strlen(gen->defs);
+    gen_indent(gen);
+
+    gen->in_defs = true;
+
+    gen_writeln(gen, "enum {");
+    gen->indent++;
+    for (size_t i = 0; i < arrlenu(uniond.fields); i++) {
+        gen_indent(gen);
+        gen_writeln(gen, "%s_%s = %zu,", uniond.name.ident, uniond.fields[i].vardecl.name.ident, i);
+    }
+    gen->indent--;
+    gen_writeln(gen, "};");
+
+    gen_writeln(gen, "%s {", union_def);
+    gen->indent++;
+
+    bool has_payload = false;
+    for (size_t i = 0; i < arrlenu(uniond.fields); i++) {
+        if (uniond.fields[i].vardecl.type.kind != TkVoid) has_payload = true;
+    }
+
+    if (has_payload) {
+        gen_indent(gen);
+        gen_writeln(gen, "union {");
+        gen->indent++;
+        for (size_t i = 0; i < arrlenu(uniond.fields); i++) {
+            if (uniond.fields[i].vardecl.type.kind == TkVoid) continue;
+
+            strb proto = gen_decl_proto(gen, uniond.fields[i]);
+            gen_writeln(gen, "%s;", proto);
+            strbfree(proto);
+        }
+        gen->indent--;
+        gen_indent(gen);
+        gen_writeln(gen, "} as;");
+    }
+
+    gen_indent(gen);
+    gen_writeln(gen, "%s tag;", layout_union_tag_size(arrlenu(uniond.fields)) == 1 ? "u8" : "u16");
+
+    gen->indent--;
+    gen_writeln(gen, "};");
+
+    gen->in_defs = false;
+}
+
 void gen_resolve_def(Gen *gen, Dnode node) {
     for (size_t i = 0; i < arrlenu(node.children); i++) {
         size_t index = 0;
@@ -1487,6 +2857,8 @@ void gen_resolve_def(Gen *gen, Dnode node) {
         gen_struct_decl(gen, stmnt);
     } else if (stmnt.kind == SkEnumDecl) {
         gen_enum_decl(gen, stmnt);
+    } else if (stmnt.kind == SkUnionDecl) {
+        gen_union_decl(gen, stmnt);
     }
 }
 
@@ -1496,6 +2868,129 @@ void gen_resolve_defs(Gen *gen) {
     }
 }
 
+// a fresh Gen sharing everything but the output buffers and what has been generated
+static Gen gen_worker(Gen *gen) {
+    Gen worker = gen_init(gen->ast, gen->dgraph);
+    worker.threads = 1;
+    worker.worker = true;
+    worker.compile_flags.object = gen->compile_flags.object;
+    worker.byref_size = gen->byref_size;
+    worker.byref = gen->byref;
+    worker.noalias_slices = gen->noalias_slices;
+    worker.ir = gen->ir;
+    return worker;
+}
+
+static void gen_unit(void *ctx, size_t i) {
+    Gen *worker = &((Gen*)ctx)[i];
+    Stmnt stmnt = worker->ast[i];
+    switch (stmnt.kind) {
+        case SkExtern:
+            gen_extern(worker, stmnt);
+            break;
+        case SkFnDecl:
+            gen_fn_decl(worker, stmnt, false);
+            break;
+        case SkVarDecl:
+            gen_var_decl(worker, stmnt);
+            break;
+        case SkConstDecl:
+            gen_const_decl(worker, stmnt);
+            break;
+        case SkVarReassign:
+            gen_var_reassign(worker, stmnt);
+            break;
+        default:
+            break;
+    }
+}
+
+// returns true if nothing before the worker's unit emitted it
+static bool gen_claim_generic(Gen *gen, GenGeneric generic) {
+    if (generic.id != 0) {
+        if (hmget(gen->generated_ids, generic.id)) return false;
+        hmput(gen->generated_ids, generic.id, true);
+    }
+    if (gen_find_generated_typedef(gen, generic.key)) return false;
+
+    arrpush(gen->generated_typedefs, generic.key);
+    return true;
+}
+
+// one allocation for the whole file instead of growing it once per function
+static strb gen_join(strb head, Arr(char*) parts) {
+    size_t len = strlen(head);
+    for (size_t i = 0; i < arrlenu(parts); i++) {
+        len += strlen(parts[i]);
+    }
+
+    char *joined = ealloc(len + 1);
+    size_t at = strlen(head);
+    memcpy(joined, head, at);
+    for (size_t i = 0; i < arrlenu(parts); i++) {
+        size_t part = strlen(parts[i]);
+        memcpy(joined + at, parts[i], part);
+        at += part;
+    }
+    joined[at] = '\0';
+
+    strb out = NULL;
+    strbappend(&out, joined);
+    free(joined);
+    strbfree(head);
+    return out;
+}
+
+// copying a big argument costs more than reading it through a pointer, arguments are never written so a pointer behaves the same
+// only for functions with internal linkage, externs and everything in a -pmi library keep the C ABI
+static bool gen_byref_type(Gen *gen, Type type) {
+    if (type.kind == TkTypeDef) {
+        Stmnt decl = ast_find_decl(gen->ast, type.typedeff);
+        if (decl.kind != SkStructDecl && decl.kind != SkUnionDecl) return false;
+    } else if (type.kind != TkOption) {
+        return false;
+    }
+
+    return layout_sizeof(gen->ast, type) > gen->byref_size;
+}
+
+static void gen_byref_plan(Gen *gen) {
+    if (gen->byref_size == 0 || gen->compile_flags.object) return;
+
+    for (size_t i = 0; i < arrlenu(gen->ast); i++) {
+        Stmnt stmnt = gen->ast[i];
+        if (stmnt.kind != SkFnDecl || !stmnt.fndecl.has_body || stmnt.fndecl.name.kind != EkIdent) continue;
+        if (streq(stmnt.fndecl.name.ident, "main")) continue;
+
+        uint64_t mask = 0;
+        for (size_t j = 0; j < arrlenu(stmnt.fndecl.args) && j < 64; j++) {
+            Stmnt arg = stmnt.fndecl.args[j];
+            if (arg.kind == SkConstDecl && gen_byref_type(gen, arg.constdecl.type)) mask |= (uint64_t)1 << j;
+        }
+        if (mask != 0) arrpush(gen->byref, ((GenMask){stmnt.fndecl.name.ident, mask}));
+    }
+    gen_mask_freeze(gen->byref);
+}
+
+// gcc only trusts restrict on arguments, a slice gets it through a by value struct with a restrict ptr
+// that changes how it's passed, so it's only done where every call is generated here too
+static void gen_noalias_plan(Gen *gen) {
+    if (gen->compile_flags.object) return;
+
+    for (size_t i = 0; i < arrlenu(gen->ast); i++) {
+        Stmnt stmnt = gen->ast[i];
+        if (stmnt.kind != SkFnDecl || !stmnt.fndecl.has_body || stmnt.fndecl.name.kind != EkIdent) continue;
+        if (streq(stmnt.fndecl.name.ident, "main")) continue;
+
+        uint64_t mask = 0;
+        for (size_t j = 0; j < arrlenu(stmnt.fndecl.args) && j < 64; j++) {
+            if (stmnt.fndecl.args[j].constdecl.type.kind == TkSlice && (stmnt.fndecl.alias.noalias >> j & 1)) mask |= (uint64_t)1 << j;
+        }
+        if (mask != 0) arrpush(gen->noalias_slices, ((GenMask){stmnt.fndecl.name.ident, mask}));
+    }
+    gen_mask_freeze(gen->noalias_slices);
+}
+
 void gen_generate(Gen *gen) {
     char *defs;
     bool defs_ok = read_entire_file("./newsrc/pine_builtin_defs.txt", &defs);
@@ -1503,40 +2998,68 @@ void gen_generate(Gen *gen) {
         defs = (char*)builtin_defs;
     }
 
-    strbprintf(&gen->defs, "%s", defs);
+    strbprintf(&gen->defs, "%.*s", defs_ok ? (int)strlen(defs) : (int)builtin_defs_len, defs);
     strbprintf(&gen->code, "#include \"output.h\"\n");
 
-    for (size_t i = 0; i < arrlenu(gen->ast); i++) {
+    // types first, array typedefs need their element type to be complete
+    gen_resolve_defs(gen);
+    gen_byref_plan(gen);
+    gen_noalias_plan(gen);
+
+    // every function and global gets its own buffers and is generated in parallel
+    // they're put back together in ast order, so the output is the same for any number of threads
+    size_t len = arrlenu(gen->ast);
+    Gen *workers = ealloc(sizeof(Gen) * (len > 0 ? len : 1));
+    for (size_t i = 0; i < len; i++) {
+        workers[i] = gen_worker(gen);
+    }
+    pool_for(gen->threads, len, gen_unit, workers);
+
+    Arr(char*) def_parts = NULL;
+    Arr(char*) code_parts = NULL;
+    for (size_t i = 0; i < len; i++) {
         Stmnt stmnt = gen->ast[i];
-        switch (stmnt.kind) {
-            case SkDirective:
-                gen_directive(gen, stmnt);
-                break;
-            case SkExtern:
-                gen_extern(gen, stmnt);
-                break;
-            case SkFnDecl:
-                gen_fn_decl(gen, stmnt, false);
-                break;
-            case SkStructDecl:
-            case SkEnumDecl:
-                // do nothing, defs will be resolved later
-                break;
-            case SkVarDecl:
-                gen_var_decl(gen, stmnt);
-                break;
-            case SkConstDecl:
-                gen_const_decl(gen, stmnt);
-                break;
-            case SkVarReassign:
-                gen_var_reassign(gen, stmnt);
-                break;
-            default:
-                break;
+        if (stmnt.kind == SkDirective) {
+            gen_directive(gen, stmnt);
+            continue;
+        }
+
+        Gen *worker = &workers[i];
+        for (size_t j = 0; j < arrlenu(worker->generics); j++) {
+            GenGeneric generic = worker->generics[j];
+            if (!gen_claim_generic(gen, generic)) continue;
+
+            arrpush(def_parts, generic.def);
+            if (generic.imp != NULL) arrpush(code_parts, generic.imp);
+        }
+        for (size_t j = 0; j < arrlenu(worker->directives); j++) {
+            gen_directive(gen, worker->directives[j]);
         }
+
+        if (worker->defs != NULL) arrpush(def_parts, worker->defs);
+        if (worker->code != NULL) arrpush(code_parts, worker->code);
     }
 
-    gen_resolve_defs(gen);
+    gen->defs = gen_join(gen->defs, def_parts);
+    gen->code = gen_join(gen->code, code_parts);
+    arrfree(def_parts);
+    arrfree(code_parts);
+
+    for (size_t i = 0; i < len; i++) {
+        Gen *worker = &workers[i];
+        for (size_t j = 0; j < arrlenu(worker->generics); j++) {
+            strbfree(worker->generics[j].def);
+            strbfree(worker->generics[j].imp);
+        }
+        arrfree(worker->generics);
+        arrfree(worker->directives);
+        arrfree(worker->byref_args);
+        shfree(worker->byref_locals);
+        hmfree(worker->generated_ids);
+        strbfree(worker->defs);
+        strbfree(worker->code);
+    }
+    free(workers);
 
     strbprintf(&gen->defs, "#endif // PINE_DEFS_H");
 }
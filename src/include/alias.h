@@ -0,0 +1,13 @@
+#ifndef ALIAS_H
+#define ALIAS_H
+
+#include <stdbool.h>
+#include "sema.h"
+
+// works out which pointer and slice arguments nothing else points at, which are only read through
+// and which functions don't write memory, the findings go in FnDecl.alias for gen to emit
+// an argument is only proven to not alias when every call passes it a different local than the other arguments
+// NOTE: a library built for -pmi is called from code that isn't checked, so only #noalias is trusted there
+void alias_analyse(Sema *sema, bool library, bool report);
+
+#endif // ALIAS_H
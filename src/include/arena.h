@@ -0,0 +1,38 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    size_t cap;
+    _Alignas(16) unsigned char data[];
+} ArenaBlock;
+
+// bump allocator, everything is freed at once
+typedef struct Arena {
+    ArenaBlock *head;
+    size_t allocs;
+    size_t used; // bytes handed out
+    size_t reserved; // bytes held in blocks
+} Arena;
+
+// NOTE: ast nodes (exprs, stmnts and types behind pointers) live here
+// they're never freed on their own, so they're packed next to each other instead of scattered over the heap
+// one per thread so modules can be parsed in parallel without locking
+extern _Thread_local Arena ast_arena;
+
+// memory is zeroed and aligned to 16
+void *arena_alloc(Arena *arena, size_t size);
+void arena_free(Arena *arena);
+
+// a worker is done with its arena, the blocks are kept since the ast still points into them
+// only the counts are added to arena_usage
+void arena_retire(Arena *arena);
+// counts of every retired arena plus the calling thread's ast_arena
+Arena arena_usage(void);
+
+#endif // ARENA_H
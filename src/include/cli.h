@@ -2,6 +2,7 @@
 #define CLI_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef enum Command {
     CommandNone = -1,
@@ -14,6 +15,18 @@ typedef struct Cli {
     Command command;
     bool help;
     bool keepc;
+    bool layout_report;
+    bool switch_report;
+    bool instantiation_report;
+    bool memory_report;
+    bool tree_shake_report;
+    bool alias_report;
+    size_t threads; // -j, 0 is one per core
+    size_t byref_size; // -byref-size, 0 copies every argument
+    bool pmi; // build a library, an object and a module interface instead of an executable
+    bool ir; // print the ir of every function once every pass is done
+    bool pass_timing;
+    bool native; // #O0 and #Odebug skip the c compiler if the native backend can generate the whole program
     char *filename;
     bool pass_to_prog;
     char **argv;
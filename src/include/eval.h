@@ -3,8 +3,42 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "sema.h"
 
+// a value known at compile time
+// integers are kept as two's complement bits wrapped to the width of type
+typedef struct ConstValue {
+    Type type;
+
+    union {
+        uint64_t u;
+        int64_t i;
+        double f;
+    };
+} ConstValue;
+
+// returns 0 if expr is not known at compile time
 uint64_t eval_expr(Sema *sema, Expr *expr);
 
+// returns false if expr is not known at compile time
+bool eval_value(Sema *sema, Expr *expr, ConstValue *out);
+// returns false if expr is not known at compile time
+bool eval_const(Sema *sema, Expr *expr, uint64_t *out);
+// returns false if enumd does not have field name
+bool eval_enum_field(Sema *sema, EnumDecl enumd, const char *name, uint64_t *out);
+
+// returns false if value can't be converted to type
+bool eval_convert(ConstValue value, Type type, ConstValue *out);
+// type of the result of kind, same as the generated C
+Type eval_binop_type(BinopKind kind, Type lhs, Type rhs);
+Type eval_unop_type(UnopKind kind, Type type);
+// returns false if the result is undefined, like division by zero
+bool eval_apply_binop(BinopKind kind, ConstValue lhs, ConstValue rhs, ConstValue *out);
+// only for not, negate and bit not
+bool eval_apply_unop(UnopKind kind, ConstValue val, ConstValue *out);
+
+// returns false if value can't be written as a literal of type
+bool eval_to_expr(ConstValue value, Type type, size_t index, Expr *out);
+
 #endif // EVAL_H
@@ -133,12 +133,13 @@ typedef struct Unop { // Unary Operation
 
 typedef struct Expr {
     ExprKind kind;
-    size_t cursors_idx;
+    uint32_t cursors_idx;
     Type type;
 
     union {
-        Type type_expr;
+        Type *type_expr; // behind a pointer, it would otherwise be the largest member
 
+        uint64_t intlit; // the bits, signed types read them as int64_t
         double numlit;
         uint8_t charlit;
         const char *strlit;
@@ -164,7 +165,7 @@ Expr expr_true(size_t index);
 Expr expr_false(size_t index);
 Expr expr_null(Type t, size_t index);
 Expr expr_type(Type v, size_t index);
-Expr expr_intlit(double v, Type t, size_t index);
+Expr expr_intlit(uint64_t v, Type t, size_t index);
 Expr expr_floatlit(double v, Type t, size_t index);
 Expr expr_charlit(uint8_t v, size_t index);
 Expr expr_strlit(const char *v, size_t index);
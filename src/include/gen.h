@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "exprs.h"
+#include "ir.h"
 #include "sema.h"
 #include "stmnts.h"
 #include "stb_ds.h"
@@ -25,13 +26,39 @@ typedef struct CompileFlags {
     OptLevel optimisation;
     Arr(const char*) links;
     const char *output;
+    bool object; // -pmi, not linked, the links go in the interface instead and functions keep external linkage
+    bool native; // output.s from the native backend, only assembled and linked
 } CompileFlags;
 
+// how a jump into a cleanup chain leaves once the chain is done, stored in pine_defer_exit
+typedef enum DeferExit {
+    DeFall, // the end of the scope, nothing jumps in
+    DeReturn,
+    DeBreak,
+    DeContinue,
+} DeferExit;
+
 typedef struct Defer {
     Stmnt *stmnt;
     uint8_t indent;
+    size_t label; // pine_defer_<label> runs this and everything deferred before it in the same scope
+    uint8_t exits; // a bit per DeferExit jumping to the label, it's only emitted if something does
 } Defer;
 
+// a typedef or PineXDef needed by a function or global, it's emitted right before it unless something earlier already was
+typedef struct GenGeneric {
+    TypeId id; // 0 if the type can't be interned
+    strb key; // what's looked for in generated_typedefs
+    strb def;
+    strb imp; // NULL if nothing goes in code
+} GenGeneric;
+
+// a bit per argument of a function, sorted by name once it's built so workers can look it up without writing to it
+typedef struct GenMask {
+    const char *name;
+    uint64_t mask;
+} GenMask;
+
 typedef struct Gen {
     Arr(Stmnt) ast;
 
@@ -40,6 +67,9 @@ typedef struct Gen {
 
     uint8_t indent;
     Arr(Defer) defers;
+    size_t defer_labels; // for unique cleanup labels, counted per function
+    uint8_t defer_exits; // every exit that went through a cleanup chain in the current function
+    size_t loop_defers; // how many were deferred outside the innermost loop, break and continue only run the rest
 
     bool in_defs;
     Dgraph dgraph;
@@ -47,9 +77,32 @@ typedef struct Gen {
 
     size_t code_loc;
 
+    size_t switch_count; // for unique switch labels
 
     Arr(const char*) generated_typedefs;
+    struct { TypeId key; bool value; } *generated_ids; // checked before building a def just to find it was already emitted
     CompileFlags compile_flags;
+
+    size_t threads;
+
+    // const struct, union and option arguments bigger than byref_size bytes are passed as `const T *restrict`, 0 copies every argument
+    // byref is a bit per argument passed that way for every function with internal linkage, built once and shared with the workers
+    size_t byref_size;
+    Arr(GenMask) byref;
+    Arr(const char*) byref_args; // of the function being generated
+    struct { const char *key; bool value; } *byref_locals; // locals of the function being generated, true if anything could point at one
+
+    // bodies ir_optimise found C can be written straight from, looked up with ir_fn_find
+    Arr(IrFn) ir;
+
+    // slice arguments alias_analyse marked noalias in functions with internal linkage, calls convert them to PineSlice<N>dNoalias
+    Arr(GenMask) noalias_slices;
+
+    // only used by the copies gen_generate hands to its workers
+    // generics are collected instead of inserted, gen_generate inserts them in order once every worker is done
+    bool worker;
+    Arr(GenGeneric) generics;
+    Arr(Stmnt) directives;
 } Gen;
 
 typedef struct MaybeAllocStr {
@@ -57,6 +110,7 @@ typedef struct MaybeAllocStr {
     bool alloced;
 } MaybeAllocStr;
 
+void gen_directive(Gen *gen, Stmnt stmnt);
 void gen_extern(Gen *gen, Stmnt stmnt);
 void gen_fn_decl(Gen *gen, Stmnt stmnt, bool is_extern);
 void gen_decl_generic(Gen *gen, Type type);
@@ -0,0 +1,136 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "eval.h"
+#include "sema.h"
+#include "stmnts.h"
+#include "strb.h"
+
+// three address code with basic blocks, lowered from every function body once sema is done
+// passes work on the ir, what they find is written back into the ast before gen or native see it
+// gen emits a body from the ir when every local and instruction in it is one C can take as it is, the rest still come from the ast
+// NOTE: native doesn't read the ir, it still walks the ast
+// NOTE: only numbers, bools and chars are tracked through locals, everything else is an opaque value
+// expressions can't assign, so a temporary is only ever used in the block that defines it
+
+typedef enum IrOp {
+    IrConst, // dst = value
+    IrCopy, // dst = a
+    IrLoad, // dst = local
+    IrStore, // local = a, a is IR_NONE if the value isn't known
+    IrBinop, // dst = a <sub> b
+    IrUnop, // dst = <sub> a
+    IrConvert, // dst = cast(type) a
+    IrCall, // dst = call with args
+    IrEval, // dst = anything not lowered any further, args are the temporaries it reads
+    IrEffect, // a statement that writes to memory, args are the temporaries it reads
+} IrOp;
+
+typedef enum IrTermKind {
+    IrFall, // not terminated yet
+    IrJump,
+    IrBranch, // cond ? then : els
+    IrSwitch, // any of targets
+    IrRet,
+    IrLeave, // runs the cleanups in targets innermost first then carries on at then, the defers pass replaces it
+    IrResume, // the end of a cleanup, goes back to wherever it was run from
+} IrTermKind;
+
+// no operand
+#define IR_NONE SIZE_MAX
+
+typedef struct IrInst {
+    IrOp op;
+    uint8_t sub; // BinopKind or UnopKind
+    Type type;
+    size_t dst; // temporary, IR_NONE for stores and effects
+    size_t local; // load and store
+    size_t a;
+    size_t b;
+    Arr(size_t) args; // call, eval and effect
+    FnCall *call;
+    ConstValue value; // const
+    Expr *expr; // what computes dst, NULL if nothing in the ast does
+} IrInst;
+
+typedef struct IrTerm {
+    IrTermKind kind;
+    size_t cond; // branch, switch and the value of ret
+    size_t then; // jump and branch
+    size_t els;
+    Arr(size_t) targets; // switch, the cleanups of a leave
+} IrTerm;
+
+typedef struct IrBlock {
+    Arr(IrInst) insts;
+    IrTerm term;
+    bool dead; // removed by a pass, kept so block ids don't change
+} IrBlock;
+
+typedef struct IrLocal {
+    const char *name;
+    Type type;
+    bool tracked; // a scalar that never has its address taken
+} IrLocal;
+
+// a statement from a block in the ast and where its lowering started
+// a statement is lowered once per copy, the defers pass copies deferred ones to every exit
+typedef struct IrStmnt {
+    Stmnt *stmnt;
+    size_t block;
+} IrStmnt;
+
+// a value worked out by a pass for an expression in the ast
+typedef struct IrFold {
+    Expr *expr;
+    ConstValue value;
+    bool known;
+} IrFold;
+
+// the blocks a defer was lowered into, first is where it starts and only an IrResume leaves
+typedef struct IrCleanup {
+    size_t first;
+    size_t last;
+} IrCleanup;
+
+typedef struct IrFn {
+    Stmnt *decl;
+    Arr(IrBlock) blocks; // the entry is first
+    Arr(IrLocal) locals;
+    size_t temps;
+    Arr(IrStmnt) stmnts;
+    Arr(IrFold) fixed; // known from types alone, like `array.len` through a pointer
+    Arr(IrFold) folds; // filled in by fold
+    Arr(IrCleanup) cleanups;
+    bool skipped; // had a statement the ir doesn't lower, like a nested declaration
+    bool emit; // gen emits the body from the ir
+} IrFn;
+
+typedef void (*IrPassFn)(IrFn *fn);
+
+typedef struct IrPass {
+    const char *name;
+    IrPassFn run;
+} IrPass;
+
+// lowers every function gen would emit, runs every pass over them and writes what they found back into sema->ast
+// each pass runs over every function across up to threads threads
+// dump prints the ir once every pass is done, timing prints how long lowering, each pass and writing back took
+// returns the functions gen emits from the ir sorted by body for ir_fn_find, the rest are freed
+Arr(IrFn) ir_optimise(Sema *sema, size_t threads, bool dump, bool timing);
+void ir_dump(IrFn *fn, strb *out);
+// the function with that body, NULL if gen emits it from the ast
+IrFn *ir_fn_find(Arr(IrFn) fns, Arr(Stmnt) body);
+void ir_free(Arr(IrFn) fns);
+
+// copies every cleanup to each leave that runs it, so nothing after it sees a defer
+void ir_defers(IrFn *fn);
+// sparse conditional constant propagation over locals, branches on a constant only take one side
+void ir_fold(IrFn *fn);
+// removes blocks that can't be reached and instructions whose result is never used
+void ir_dce(IrFn *fn);
+
+#endif // IR_H
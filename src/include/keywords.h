@@ -21,6 +21,10 @@ typedef enum Keyword {
     KwDefer,
     KwCast,
     KwSizeof,
+    KwUnion,
+    KwSwitch,
+    KwCase,
+    KwDefault,
 } Keyword;
 
 Keyword keyword_map(const char *str);
@@ -0,0 +1,48 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "sema.h"
+#include "stmnts.h"
+#include "types.h"
+
+// NOTE: sizes and alignments assume an LP64 target, same as the generated C
+#define CACHE_LINE_SIZE 64
+
+typedef struct FieldLayout {
+    const char *name;
+    size_t offset;
+    size_t size;
+    size_t align;
+    bool hot;
+} FieldLayout;
+
+typedef struct StructLayout {
+    size_t size;
+    size_t align;
+    size_t padding;
+    Arr(FieldLayout) fields; // in emitted order
+} StructLayout;
+
+size_t layout_sizeof(Arr(Stmnt) ast, Type type);
+size_t layout_alignof(Arr(Stmnt) ast, Type type);
+
+// remember to call layout_struct_free
+StructLayout layout_struct(Arr(Stmnt) ast, StructDecl *structd);
+void layout_struct_free(StructLayout layout);
+
+// 1 or 2 bytes, enough to tell every variant apart
+size_t layout_union_tag_size(size_t variants);
+// every variant is at offset 0, followed by the tag
+// remember to call layout_struct_free
+StructLayout layout_union(Arr(Stmnt) ast, UnionDecl *uniond);
+
+// a layout worked out somewhere else, like a struct loaded from a .pmi
+void layout_seed(Type type, size_t size, size_t align);
+
+// fills in structd->attrs->order if the struct should be reordered
+void layout_order(Arr(Stmnt) ast, StructDecl *structd, bool reorder_all);
+void layout_report(Arr(Stmnt) ast, Dgraph dgraph);
+
+#endif // LAYOUT_H
@@ -54,53 +54,47 @@ typedef enum TokenKind {
 } TokenKind;
 const char *tokenkind_stringify(TokenKind kind);
 
+// NOTE: the text of a token is a range of the source, values are read from it when they're needed
 typedef struct Token {
     TokenKind kind;
-    union {
-        const char *ident;
-        double numlit;
-        char charlit;
-        const char *strlit;
-        const char *directive;
-    };
+    uint32_t offset;
+    uint32_t len; // quotes included for strings and chars
 } Token;
 
-Token token_none(void);
-Token token_ident(const char *s);
-Token token_intlit(uint64_t n);
-Token token_floatlit(double n);
-Token token_charlit(char s);
-Token token_strlit(const char *s);
-Token token_directive(const char *s);
-void print_tokens(Token *tokens);
-
-// returns strb, needs to be freed
-strb token_stringify(Token tok);
-
 typedef struct Cursor {
     uint32_t row;
     uint32_t col;
 } Cursor;
 
-#define BUF_CAP 255
-
 typedef struct Lexer {
+    const char *source;
     Arr(Token) tokens;
-    Arr(Cursor) cursors;
-
-    char ch;
-    char buf[BUF_CAP];
-    size_t buf_len;
-    Cursor cursor;
-
-    int ignore_index;
-    bool in_single_line_comment;
-    bool in_block_comment;
-    bool escaped;
-    bool in_quotes;
-    bool in_double_quotes;
-    bool is_directive;
+    Arr(uint32_t) lines; // offset every line starts at
+
+    struct { uint32_t key; const char *value; } *texts; // token offset -> interned text, filled in as it's asked for
+
+    // lexing stops at the first error, the last token is the one it's about
+    const char *error;
 } Lexer;
 
+Token token_none(void);
+Token token_new(TokenKind kind, size_t offset, size_t len);
+
+// the same text always gives back the same pointer, no matter which module it's from
+const char *lexer_intern(const char *start, size_t len);
+
+// ident, directive or string without the quotes, interned
+const char *token_text(Lexer *lex, Token tok);
+uint64_t token_int(Lexer *lex, Token tok);
+double token_number(Lexer *lex, Token tok);
+char token_char(Lexer *lex, Token tok);
+
+// binary search over the line starts, only used when reporting
+Cursor lexer_cursor(Lexer *lex, size_t token_idx);
+
+// returns strb, needs to be freed
+strb token_stringify(Lexer *lex, Token tok);
+void print_tokens(Lexer *lex);
+
 Lexer lexer(const char *source);
 #endif // LEXER_H
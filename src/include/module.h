@@ -0,0 +1,43 @@
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "lexer.h"
+#include "parser.h"
+#include "stmnts.h"
+
+// one source file, the entry file or one brought in with #import
+typedef struct Module {
+    const char *path; // as given, relative to the importer's directory for imports
+    const char *realpath; // used to only load a file once
+    char *source;
+    Lexer lex;
+    size_t first_token; // cursors_idx of the first token, every module gets its own range
+    Parser parser;
+    Arr(Stmnt) ast;
+
+    bool interface; // a .pmi, the ast comes from pmi_load instead of the parser
+    const char *error; // why it couldn't be loaded
+
+    Arr(struct Module*) imports;
+    size_t import_cursor; // of the #import that first loaded it
+    bool read_ok;
+    bool visited;
+} Module;
+
+// every loaded module, the entry file is first
+extern Arr(Module*) modules;
+
+// loads the entry file and everything it imports, each wave of imports is lexed and parsed across threads
+// returns the ast of every module, imports come before the modules that import them
+// templates, instances and parse errors of every module are merged into parser
+Arr(Stmnt) module_load(const char *path, size_t threads, Parser *parser);
+
+// imports are relative to the directory of the file importing them
+const char *module_resolve(const char *importer, const char *path);
+
+// returns the filename cursors_idx is in, also used for errors from parsing, sema and typecheck
+const char *module_cursor(size_t cursors_idx, Cursor *cursor);
+
+#endif // MODULE_H
@@ -0,0 +1,22 @@
+#ifndef NATIVE_H
+#define NATIVE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "sema.h"
+#include "stmnts.h"
+#include "strb.h"
+
+// x86-64 assembly straight from the analysed ast, for #O0 and #Odebug builds that don't need the c compiler's front end
+// NOTE: only covers part of the language, numbers, bools, chars, enums, pointers, cstrings, arrays and structs of them
+// a program using anything else is compiled through C instead, so the output never depends on which backend was picked
+// System V calling convention, so it only targets x86-64 linux
+
+// directives anywhere in ast, in the order gen would apply them
+Arr(Stmnt) native_directives(Arr(Stmnt) ast);
+
+// appends the assembly for the whole program to out, debug adds line info for every statement
+// returns false and sets why and cursor_idx at the first thing it can't generate
+bool native_generate(Sema *sema, bool debug, strb *out, strb *why, size_t *cursor_idx);
+
+#endif // NATIVE_H
@@ -10,13 +10,44 @@
 #include "exprs.h"
 #include "stmnts.h"
 
+// generic struct or receiver method, its tokens are parsed again for every instance
+typedef struct Template {
+    const char *name; // the struct, also set for methods
+    const char *method; // NULL for the struct itself
+    Arr(const char*) params;
+
+    Arr(Token) tokens; // from the struct body or fn to the closing curl
+    Lexer *lex; // of the module it's declared in, the tokens' text is there
+    long cursors_idx; // cursor of the token before tokens[0]
+} Template;
+
+// <struct>(<types>), one per distinct list of type arguments
+typedef struct Instance {
+    const char *name; // mangled, vec2(i32) -> vec2_i32
+    const char *generic;
+    Arr(Type) args;
+
+    size_t uses;
+    size_t methods;
+    uint32_t cursors_idx; // first use
+} Instance;
+
 typedef struct Parser {
     Arr(Token) tokens;
+    size_t tokens_idx; // next token, tokens are never removed
     bool in_func_decl_args;
     bool in_enum_decl;
+    bool in_case_values; // <ident>{ starts the case body, not a literal
+
+    Arr(Template) templates;
+    Arr(Instance) instances;
+    struct { char *key; size_t value; } *instance_map; // mangled name -> index into instances
+
+    // template params and the types they're replaced with while parsing an instance
+    Arr(const char*) subst_names;
+    Arr(Type) subst_types;
 
-    const char *filename;
-    Arr(Cursor) cursors;
+    Lexer *lex; // token text is looked up through it
     long cursors_idx;
     int error_count;
 } Parser;
@@ -24,7 +55,10 @@ typedef struct Parser {
 Expr parse_expr(Parser *parser);
 Expr parse_array_index(Parser *parser, Expr expr);
 Expr parse_field_access(Parser *parser, Expr expr);
-Parser parser_init(Lexer lex, const char *filename);
+Parser parser_init(Lexer *lex, size_t first_token);
 Stmnt parser_parse(Parser *parser);
+void parser_merge(Parser *into, Parser *from);
+void parser_instantiate(Parser *parser, Arr(Stmnt) *ast);
+void parser_instantiation_report(Parser *parser);
 
 #endif // PARSER_H
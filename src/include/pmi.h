@@ -0,0 +1,99 @@
+#ifndef PMI_H
+#define PMI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sema.h"
+#include "stmnts.h"
+
+// pine module interface, what a program needs to call into a library without its source
+// `pine build <lib>.pine -pmi` writes <lib>.pmi next to <lib>.o, programs bring it in with #import "<lib>.pmi";
+// NOTE: every section is an array of fixed size records read in place from a mmap
+// indices point back into earlier records, loading is one pass over them with no lexing or parsing
+
+#define PMI_MAGIC "PMI"
+#define PMI_VERSION 1
+#define PMI_NONE UINT32_MAX
+
+typedef struct PmiSection {
+    uint32_t off; // from the start of the file
+    uint32_t len; // records, bytes for strings
+} PmiSection;
+
+typedef struct PmiHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t object; // string, relative to the .pmi
+    PmiSection strings; // nul terminated, every name is only stored once
+    PmiSection links; // uint32_t strings passed to the c compiler, the library's #link and #syslink
+    PmiSection types;
+    PmiSection fields;
+    PmiSection orders; // uint32_t field indices of reordered structs
+    PmiSection decls;
+} PmiHeader;
+
+// children come before the types that point at them
+typedef struct PmiType {
+    uint8_t kind; // TypeKind
+    uint8_t constant;
+    uint8_t is_null; // options
+    uint8_t gen_option;
+    uint32_t of; // ptr_to, array.of, slice.of, option.subtype, soa.of, range.subtype
+    uint32_t name; // typedefs
+    uint64_t len; // arrays, 0 if inferred
+} PmiType;
+
+// a value known at compile time, see ConstValue
+typedef struct PmiValue {
+    uint32_t type; // PMI_NONE if there is no value
+    uint64_t bits;
+} PmiValue;
+
+// struct fields, enum fields, union variants and function arguments
+typedef struct PmiField {
+    uint32_t name;
+    uint32_t type; // PMI_NONE for enum fields
+    bool var; // argument with a default value
+    bool hot;
+    PmiValue value; // enum value, default argument
+} PmiField;
+
+typedef enum PmiDeclKind {
+    PdkStruct,
+    PdkEnum,
+    PdkUnion,
+    PdkConst,
+    PdkFn,
+} PmiDeclKind;
+
+typedef struct PmiDecl {
+    uint8_t kind; // PmiDeclKind
+    bool method;
+    bool packed;
+    bool reorder;
+    bool soa;
+    uint32_t name;
+    uint32_t type; // return type, constant's type
+    uint32_t fields;
+    uint32_t fields_len;
+    uint32_t order; // PMI_NONE if fields are in declaration order
+    uint64_t align; // #align, 0 if not set
+
+    // precomputed layout of structs and unions
+    uint64_t size;
+    uint64_t layout_align;
+
+    PmiValue value; // constants
+} PmiDecl;
+
+// writes every struct, enum, union, constant and function with a body in sema's ast
+// constants that aren't scalars known at compile time and functions returning arrays stay private
+// links are the flags the library was compiled with
+bool pmi_write(Sema *sema, const char *path, const char *object, Arr(const char*) links);
+
+// declarations in path as externs, plus #link for the object, every node is at cursors_idx
+// returns NULL on success, otherwise why it failed
+const char *pmi_load(const char *path, size_t cursors_idx, Arr(Stmnt) *ast);
+
+#endif // PMI_H
@@ -0,0 +1,15 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+typedef void (*PoolJob)(void *ctx, size_t i);
+
+// number of cores, what -j defaults to
+size_t pool_default_threads(void);
+
+// runs job(ctx, 0..jobs) across up to threads threads, the calling thread is one of them
+// returns once every job is done, jobs are handed out in order but finish in any order
+void pool_for(size_t threads, size_t jobs, PoolJob job, void *ctx);
+
+#endif // POOL_H
@@ -1,18 +1,25 @@
 #ifndef SEMA_H
 #define SEMA_H
 
+#include <setjmp.h>
+#include <stdarg.h>
 #include <stddef.h>
 #include <stdbool.h>
 #include "lexer.h"
 #include "stb_ds.h"
 #include "exprs.h"
 #include "stmnts.h"
+#include "strb.h"
 
 typedef struct Sema Sema;
+typedef struct Vm Vm;
 
+// NOTE: a scope only holds what's declared in it, lookups walk down to the scopes around it
+// a scope sees what its parent had when it was opened, so globals declared after a function aren't in its scope
 typedef struct SymTab {
     Arr(Arr(Stmnt)) stmnts;
     Arr(Arr(const char*)) keys;
+    Arr(size_t) visible; // per scope, how much of the scope below it can be seen
     size_t cur_scope;
 } SymTab;
 
@@ -36,6 +43,23 @@ typedef struct Dgraph {
 Dgraph dgraph_init(void);
 void dgraph_push(Dgraph *graph, Dnode node);
 
+// an error found while checking a function body on a worker, printed once every body is done
+typedef struct Diagnostic {
+    size_t cursors_idx;
+    size_t order; // keeps errors at the same cursor in the order they were found
+    strb msg;
+    bool fatal; // type errors stop the build
+} Diagnostic;
+
+// a function body waiting to be checked, its signature already has been
+typedef struct FnBody {
+    Stmnt *fn;
+    // the scope the body starts in, its arguments
+    Arr(const char*) keys;
+    Arr(Stmnt) stmnts;
+    size_t globals; // declared before the function, the ones it can see
+} FnBody;
+
 typedef struct Sema {
     Stmnt *ast;
     SymTab symtab;
@@ -43,29 +67,46 @@ typedef struct Sema {
     struct {
         Stmnt fn; // can be SkNone
         bool forl;
+        bool const_call; // the next call is the value of a constant
     } envinfo;
 
     struct {
         bool output;
         bool optimise;
+        bool reorder;
     } compile_flags;
 
     Dgraph dgraph;
+    Arr(Stmnt*) switches; // for -switch-report
+    Arr(Stmnt*) comptime; // constants set by a call, evaluated after analysis
+    Vm *vm; // NULL until something is evaluated at compile time
+
+    Arr(FnBody) bodies; // checked in parallel by sema_bodies once every global is known
+    size_t threads;
+
+    // only used by the copies sema_bodies hands to its workers
+    bool worker;
+    Arr(Diagnostic) diagnostics;
+    Arr(Stmnt*) directives; // #output and optimisations, checked in order after the workers are done
+    jmp_buf bail; // out of the body on a type error
 
-    const char *filename;
-    Arr(Cursor) cursors;
     int error_count;
 } Sema;
 
-Sema sema_init(Arr(Stmnt) ast, const char *filename, Arr(Cursor) cursors, int error_count);
+Sema sema_init(Arr(Stmnt) ast, int error_count);
+// keeps the error for later if sema is a worker, returns false if it has to be printed now
+bool sema_buffer_error(Sema *sema, size_t cursor_idx, bool fatal, const char *msg, va_list args);
 Type *resolve_expr_type(Sema *sema, Expr *expr);
 void sema_analyse(Sema *sema);
 void sema_extern(Sema *sema, Stmnt *stmnt);
 void sema_defer(Sema *sema, Stmnt *stmnt);
 void sema_fn_decl(Sema *sema, Stmnt *stmnt);
+void sema_bodies(Sema *sema);
 void sema_block(Sema *sema, Arr(Stmnt) body);
 void sema_directive(Sema *sema, Stmnt *stmnt);
 void sema_expr(Sema *sema, Expr *expr);
+void sema_switch_report(Sema *sema);
+void sema_comptime(Sema *sema);
 
 // returns SkNone if not found
 Stmnt ast_find_decl(Arr(Stmnt) ast, const char *key);
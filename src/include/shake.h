@@ -0,0 +1,12 @@
+#ifndef SHAKE_H
+#define SHAKE_H
+
+#include <stdbool.h>
+#include "sema.h"
+
+// drops every function, struct, enum and union main, externs and globals can't reach before gen sees them
+// slice and option instantiations are generated when gen finds a use, so ones only used by dropped functions go with them
+// NOTE: a library built for -pmi is linked into programs that call anything in it, so nothing is dropped
+void tree_shake(Sema *sema, bool library, bool report);
+
+#endif // SHAKE_H
@@ -2,6 +2,7 @@
 #define STMNTS_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include "exprs.h"
 #include "lexer.h"
 
@@ -25,27 +26,71 @@ typedef enum StmntKind {
     SkExtern,
     SkDirective,
     SkDefer,
+    SkUnionDecl,
+    SkSwitch,
 } StmntKind;
 
+typedef struct FnAttrs {
+    bool inline_always; // #inline
+    bool noinline; // #noinline
+    bool flatten; // #flatten, every call inside it is inlined
+} FnAttrs;
+
+typedef enum FnEffect {
+    FeAny, // might write memory, or never return
+    FePure, // only reads memory, __attribute__((pure))
+    FeConst, // only reads its arguments, __attribute__((const))
+} FnEffect;
+
+// set by alias analysis, a bit per pointer or slice argument
+typedef struct FnAlias {
+    uint64_t noalias; // nothing else the function can reach points at what it does, emitted as restrict
+    uint64_t readonly; // only read through and never handed on, emitted as a pointer to const
+    FnEffect effect;
+} FnAlias;
+
 typedef struct FnDecl {
     Expr name;
     Type type;
     Arr(Stmnt) args;
     Arr(Stmnt) body;
     bool has_body;
+    bool method; // <struct>.<name>, the first argument is self
+    FnAttrs attrs;
+    FnAlias alias;
 } FnDecl;
 
+typedef struct StructAttrs {
+    bool reorder;
+    bool packed;
+    bool soa; // generate a struct of arrays container, #soa <struct>
+    uint64_t align; // 0 if not set
+
+    Arr(const char*) hot; // fields marked with #hot
+    Arr(size_t) order; // field indices in emitted order, NULL if declaration order
+    bool laid_out;
+} StructAttrs;
+
 typedef struct StructDecl {
     Expr name;
     Arr(Stmnt) fields;
+
+    // NOTE: pointer so every copy of the decl (symtab, dgraph) shares the computed layout
+    // always NULL for enums
+    StructAttrs *attrs;
 } StructDecl;
 
 typedef StructDecl EnumDecl;
 
+// variants are VarDecls, void if they carry no payload
+// attrs is always NULL
+typedef StructDecl UnionDecl;
+
 typedef struct VarDecl {
     Expr name;
     Type type;
     Expr value;
+    bool noalias; // #noalias on an argument, the caller promises nothing else points at what it does
 } VarDecl;
 
 typedef VarDecl VarReassign;
@@ -67,7 +112,7 @@ typedef struct If {
 
     CaptureKind capturekind;
     union {
-        Expr ident;
+        Expr *ident;
         Stmnt *constdecl;
     } capture;
 
@@ -82,6 +127,46 @@ typedef struct For {
     Arr(Stmnt) body;
 } For;
 
+typedef struct Case {
+    // .<name> is a field access with an EkNone accessing
+    // NULL for default
+    Arr(Expr) values;
+
+    Expr capture; // EkNone if not captured
+    Stmnt *capture_decl; // set in sema
+
+    Arr(Stmnt) body;
+    uint32_t cursors_idx;
+} Case;
+
+typedef struct CaseRange {
+    // inclusive, signed values are stored as their two's complement bits
+    uint64_t lo;
+    uint64_t hi;
+    size_t case_idx;
+    uint32_t cursors_idx;
+} CaseRange;
+
+typedef enum SwitchLowering {
+    SlNone,
+    SlTagTable, // union, computed goto on the tag
+    SlJumpTable, // dense cases, C switch
+    SlDecisionTree, // sparse cases, binary search over the ranges
+    SlLookupTable, // every arm assigns a constant to the same variable
+} SwitchLowering;
+
+typedef struct Switch {
+    Expr value;
+    Arr(Case) cases;
+
+    // set in sema
+    SwitchLowering lowering;
+    Arr(CaseRange) ranges; // sorted, not used for unions
+    bool is_signed;
+    uint64_t covered; // values with a case, saturates
+    uint64_t span; // max - min + 1, saturates
+} Switch;
+
 typedef enum DirectiveKind {
     DkNone,
     DkLink,
@@ -94,23 +179,30 @@ typedef enum DirectiveKind {
     DkOdebug,
     DkOfast,
     DkOsmall,
+    DkReorder,
+    DkIf,
+    DkImport,
 } DirectiveKind;
 
 typedef struct Directive {
     DirectiveKind kind;
 
-    const char *str; // link, syslink, output
+    union {
+        const char *str; // link, syslink, output, import
+        If *iff; // if, replaced by the branch taken before analysis
+    };
 } Directive;
 
 typedef struct Stmnt {
     StmntKind kind;
-    size_t cursors_idx;
+    uint32_t cursors_idx;
 
     union {
         FnDecl fndecl;
         FnCall fncall;
         StructDecl structdecl;
         EnumDecl enumdecl;
+        UnionDecl uniondecl;
         VarDecl vardecl;
         VarReassign varreassign;
         ConstDecl constdecl;
@@ -120,6 +212,7 @@ typedef struct Stmnt {
 
         If iff;
         For forf;
+        Switch switchf;
         Stmnt *externf;
 
         Arr(Stmnt) block;
@@ -132,6 +225,7 @@ Stmnt stmnt_extern(Stmnt *v, size_t index);
 Stmnt stmnt_fndecl(FnDecl v, size_t index);
 Stmnt stmnt_structdecl(StructDecl v, size_t index);
 Stmnt stmnt_enumdecl(EnumDecl v, size_t index);
+Stmnt stmnt_uniondecl(UnionDecl v, size_t index);
 Stmnt stmnt_vardecl(VarDecl v, size_t index);
 Stmnt stmnt_varreassign(VarReassign v, size_t index);
 Stmnt stmnt_constdecl(ConstDecl v, size_t index);
@@ -143,6 +237,7 @@ Stmnt stmnt_defer(Stmnt *v, size_t index);
 
 Stmnt stmnt_if(If v, size_t index);
 Stmnt stmnt_for(For v, size_t index);
+Stmnt stmnt_switch(Switch v, size_t index);
 Stmnt stmnt_block(Arr(Stmnt) v, size_t index);
 
 Stmnt stmnt_directive(Directive v, size_t index);
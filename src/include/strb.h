@@ -13,6 +13,8 @@ void strbpush(strb *s, char c);
 void vstrbprintf(strb *s, const char *fmt, va_list args);
 void strbprintf(strb *s, const char *fmt, ...);
 void strbprintfln(strb *s, const char *fmt, ...);
+// copies str in one go instead of a char at a time, for big buffers
+void strbappend(strb *s, const char *str);
 
 // warning: this frees sb and returns a new strb
 strb strbinsert(strb sb, const char *str, size_t index);
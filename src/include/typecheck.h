@@ -5,15 +5,16 @@
 
 void tc_make_constant(Type *type);
 void tc_const_decl(Sema *sema, Stmnt *stmnt);
-bool tc_can_arithmetic(Type lhs, Type rhs, bool ints_only);
-bool tc_can_compare_equality(Type lhs, Type rhs);
-bool tc_can_compare_order(Type lhs, Type rhs);
-bool tc_can_bitwise(Type lhs, Type rhs);
-bool tc_is_unsigned(Sema *sema, Expr expr);
+bool tc_can_arithmetic(TypeId lhs, TypeId rhs, bool ints_only);
+bool tc_can_compare_equality(TypeId lhs, TypeId rhs);
+bool tc_can_compare_order(TypeId lhs, TypeId rhs);
+bool tc_can_bitwise(TypeId lhs, TypeId rhs);
+bool tc_is_unsigned(Sema *sema, Expr *expr);
 void tc_var_decl(Sema *sema, Stmnt *stmnt);
-bool tc_equals(Sema *sema, Type lhs, Type *rhs);
-void tc_number_within_bounds(Sema *sema, Type type, Expr expr);
+// lhs is only read, rhs is filled in when it's untyped or null
+bool tc_equals(Sema *sema, TypeId lhs, Type *rhs);
+void tc_number_within_bounds(Sema *sema, TypeId type, Expr *expr);
 void tc_return(Sema *sema, Stmnt *stmnt);
-bool tc_can_cast(Sema *sema, Type *from, Type to);
+bool tc_can_cast(Sema *sema, Type *from, TypeId to);
 
 #endif // TYPECHECK_H
@@ -9,6 +9,10 @@
 typedef struct Type Type;
 typedef struct Expr Expr;
 
+// index into the type table, every distinct type has one
+// a scalar's id is its kind, so 0 is TkNone and comparing an id against a scalar kind is fine
+typedef uint32_t TypeId;
+
 typedef enum TypeKind {
     TkNone, // null
 
@@ -42,6 +46,7 @@ typedef enum TypeKind {
     TkArray,
     TkPtr,
     TkOption,
+    TkSoa,
 
     TkTypeDef,
     TkTypeId,
@@ -68,10 +73,18 @@ typedef struct Range {
     Type *subtype;
 } Range;
 
+// #soa <struct>, a column per field of the struct
+typedef struct Soa {
+    Type *of;
+} Soa;
+
 typedef struct Type {
     TypeKind kind;
-    size_t cursors_idx;
+    uint32_t cursors_idx;
     bool constant;
+    // compound types and typedefs are interned when they're built, comparing them is comparing ids
+    // 0 for scalars and anything that can still change (see TypeInfo.settled), type_intern works it out then
+    TypeId id;
 
     union {
         Range range;
@@ -79,10 +92,47 @@ typedef struct Type {
         Array array;
         Type *ptr_to;
         Option option;
+        Soa soa;
         const char *typedeff;
     };
 } Type;
 
+// NOTE: a Type value only lives in the ast, where sema fills it in and changes it in place
+// sema passes TypeId around to read a type and Type* to the ast where it fills one in
+typedef struct TypeInfo {
+    Type type; // canonical, children point at other entries, cursors_idx is the first place it was written
+    uint64_t hash;
+    TypeId of; // ptr_to, array.of, slice.of, option.subtype, soa.of, range.subtype
+    TypeId leaf; // innermost non compound type
+    uint64_t len; // arrays
+    Expr *len_expr; // arrays whose length isn't a literal yet are keyed by the expression
+    // false for untyped, poison, null and anything holding them or a length that isn't a literal yet,
+    // sema can still change those in place so nothing is cached for them and ids only say it's the same ast node
+    bool settled;
+
+    // filled in by the passes that need them
+    _Atomic bool resolved; // typedef name was found by sema
+    _Atomic(const char*) cname; // gen_typename, set once by whichever thread builds it first
+    size_t size;
+    size_t align;
+    uint64_t layout_epoch; // size and align are stale if this isn't type_layout_epoch
+} TypeInfo;
+
+extern _Atomic uint64_t type_layout_epoch;
+
+// NOTE: function bodies are checked on several threads, only interning a compound type without an id takes a lock
+// entries never move once they're added, so type_info doesn't need one
+// what's cached in TypeInfo is written by whichever pass owns it, see the comments above
+TypeId type_intern(const Type *type);
+// 0 if the type isn't settled, for passes that cache something per type
+TypeId type_cache_id(const Type *type);
+// for a type changed in place after it was built
+void type_reintern(Type *type);
+TypeInfo *type_info(TypeId id);
+// canonical type for reading, it's shared so it's never changed
+const Type *type_canon(TypeId id);
+size_t type_table_len(void);
+
 #define CONSTNESS bool
 #define TYPECONST true
 #define TYPEVAR   false
@@ -102,6 +152,7 @@ Type type_slice(Slice v, CONSTNESS constant, size_t index);
 Type type_array(Array v, CONSTNESS constant, size_t index);
 Type type_ptr(Type *v, CONSTNESS constant, size_t index);
 Type type_option(Option v, CONSTNESS constant, size_t index);
+Type type_soa(Soa v, CONSTNESS constant, size_t index);
 Type type_typedef(const char *v, CONSTNESS constant, size_t index);
 Type type_poison(void);
 
@@ -67,6 +67,7 @@ bool streq(const char *s1, const char *s2);
 
 int strhas(const char *hay, const char *needle);
 bool strstartswith(const char *hay, const char *needle);
+bool strendswith(const char *hay, const char *needle);
 
 // from and to must be of the same size
 bool strreplace(char *s, const char *from, const char *to);
@@ -0,0 +1,18 @@
+#ifndef VM_H
+#define VM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "exprs.h"
+#include "sema.h"
+#include "strb.h"
+
+// function bodies are compiled to bytecode the first time they're called at compile time
+// every call is memoised, a function can't see anything but its arguments and constants
+typedef struct Vm Vm;
+
+// runs call at compile time and sets out to a literal of the result
+// returns false and sets why and cursor_idx if it can't be evaluated
+bool vm_eval_call(Sema *sema, Expr *call, Expr *out, strb *why, size_t *cursor_idx);
+
+#endif // VM_H
@@ -0,0 +1,1449 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "include/eval.h"
+#include "include/exprs.h"
+#include "include/ir.h"
+#include "include/pool.h"
+#include "include/sema.h"
+#include "include/stb_ds.h"
+#include "include/stmnts.h"
+#include "include/strb.h"
+#include "include/types.h"
+#include "include/utils.h"
+
+static const IrPass ir_passes[] = {
+    {"defers", ir_defers},
+    {"fold", ir_fold},
+    {"dce", ir_dce},
+};
+
+typedef struct IrName {
+    const char *name;
+    size_t local;
+} IrName;
+
+typedef struct IrLower {
+    Sema *sema;
+    IrFn *fn;
+    size_t cur; // block being appended to
+    Arr(IrName) names; // innermost last
+    Arr(size_t) defers; // cleanups in scope, innermost last
+    Arr(size_t) breaks;
+    Arr(size_t) continues;
+    size_t loop_defers; // how many were deferred outside the innermost loop, same as gen's
+} IrLower;
+
+static void ir_stmnt(IrLower *l, Stmnt *stmnt, bool record);
+static size_t ir_expr(IrLower *l, Expr *expr);
+
+static bool ir_tracked(Type type) {
+    switch (type.kind) {
+        case TkBool:
+        case TkChar:
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkU8:
+        case TkU16:
+        case TkU32:
+        case TkU64:
+        case TkUsize:
+        case TkUntypedInt:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// zeroed
+static void *ir_alloc(size_t count, size_t size) {
+    void *mem = ealloc(count * size);
+    memset(mem, 0, count * size);
+    return mem;
+}
+
+static size_t ir_block_new(IrLower *l) {
+    IrBlock block = {
+        .insts = NULL,
+        .term = {.kind = IrFall, .cond = IR_NONE, .then = IR_NONE, .els = IR_NONE, .targets = NULL},
+        .dead = false,
+    };
+    arrpush(l->fn->blocks, block);
+    return arrlenu(l->fn->blocks) - 1;
+}
+
+// only the first terminator of a block counts, anything after a return is in a block of its own
+static void ir_terminate(IrLower *l, IrTerm term) {
+    IrBlock *block = &l->fn->blocks[l->cur];
+    if (block->term.kind == IrFall) {
+        block->term = term;
+    } else {
+        arrfree(term.targets);
+    }
+}
+
+static void ir_jump(IrLower *l, size_t to) {
+    ir_terminate(l, (IrTerm){.kind = IrJump, .cond = IR_NONE, .then = to, .els = IR_NONE});
+}
+
+static size_t ir_emit(IrLower *l, IrInst inst) {
+    if (inst.op != IrStore && inst.op != IrEffect) {
+        inst.dst = l->fn->temps++;
+    }
+    arrpush(l->fn->blocks[l->cur].insts, inst);
+    return inst.dst;
+}
+
+static IrInst ir_inst(IrOp op, Type type, Expr *expr) {
+    return (IrInst){
+        .op = op,
+        .sub = 0,
+        .type = type,
+        .dst = IR_NONE,
+        .local = IR_NONE,
+        .a = IR_NONE,
+        .b = IR_NONE,
+        .args = NULL,
+        .call = NULL,
+        .expr = expr,
+    };
+}
+
+static size_t ir_declare(IrLower *l, const char *name, Type type) {
+    IrLocal local = {
+        .name = name,
+        .type = type,
+        .tracked = ir_tracked(type),
+    };
+    arrpush(l->fn->locals, local);
+
+    size_t id = arrlenu(l->fn->locals) - 1;
+    arrpush(l->names, ((IrName){.name = name, .local = id}));
+    return id;
+}
+
+static size_t ir_find(IrLower *l, const char *name) {
+    for (ptrdiff_t i = arrlen(l->names) - 1; i >= 0; i--) {
+        if (streq(l->names[i].name, name)) return l->names[i].local;
+    }
+    return IR_NONE;
+}
+
+// C converts what's stored to the type of the local, that's the value written back for expr
+static size_t ir_store_value(IrLower *l, size_t local, Expr *expr, size_t value) {
+    if (!l->fn->locals[local].tracked) return value;
+
+    IrBlock *block = &l->fn->blocks[l->cur];
+    block->insts[arrlenu(block->insts) - 1].expr = NULL;
+
+    IrInst inst = ir_inst(IrConvert, l->fn->locals[local].type, expr);
+    inst.a = value;
+    return ir_emit(l, inst);
+}
+
+static void ir_store(IrLower *l, size_t local, size_t value) {
+    IrInst inst = ir_inst(IrStore, l->fn->locals[local].type, NULL);
+    inst.local = local;
+    inst.a = value;
+    ir_emit(l, inst);
+}
+
+// arguments and captures, their value comes from somewhere the ir can't see
+static void ir_declare_unknown(IrLower *l, Stmnt *decl) {
+    if (decl == NULL) return;
+
+    if (decl->kind == SkConstDecl) {
+        ir_store(l, ir_declare(l, decl->constdecl.name.ident, decl->constdecl.type), IR_NONE);
+    } else if (decl->kind == SkVarDecl) {
+        ir_store(l, ir_declare(l, decl->vardecl.name.ident, decl->vardecl.type), IR_NONE);
+    }
+}
+
+static size_t ir_opaque(IrLower *l, Expr *expr, Arr(size_t) args) {
+    IrInst inst = ir_inst(IrEval, expr->type, expr);
+    inst.args = args;
+    return ir_emit(l, inst);
+}
+
+// the temporaries an lvalue reads, the place itself is never loaded
+// a local having its address taken or being written through a field or index stops it being tracked
+static void ir_lvalue(IrLower *l, Expr *expr, Arr(size_t) *args) {
+    switch (expr->kind) {
+        case EkIdent: {
+            size_t local = ir_find(l, expr->ident);
+            if (local != IR_NONE) l->fn->locals[local].tracked = false;
+        } break;
+        case EkGrouping:
+            ir_lvalue(l, expr->group, args);
+            break;
+        case EkFieldAccess:
+            if (expr->fieldacc.deref) {
+                arrpush(*args, ir_expr(l, expr->fieldacc.accessing));
+            } else {
+                ir_lvalue(l, expr->fieldacc.accessing, args);
+            }
+            break;
+        case EkArrayIndex:
+            ir_lvalue(l, expr->arrayidx.accessing, args);
+            arrpush(*args, ir_expr(l, expr->arrayidx.index));
+            break;
+        default:
+            arrpush(*args, ir_expr(l, expr));
+            break;
+    }
+}
+
+static Arr(size_t) ir_call_args(IrLower *l, FnCall *call) {
+    Arr(size_t) args = NULL;
+    if (call->name->kind != EkIdent) {
+        arrpush(args, ir_expr(l, call->name));
+    }
+
+    // sema puts named arguments in order
+    for (size_t i = 0; i < arrlenu(call->args.exprs); i++) {
+        arrpush(args, ir_expr(l, &call->args.exprs[i]));
+    }
+    return args;
+}
+
+// NOTE: sema has left every scope by now, so eval can only be asked about names that aren't locals
+static bool ir_global(IrLower *l, Expr *expr) {
+    if (expr->kind == EkGrouping) return ir_global(l, expr->group);
+    return expr->kind == EkNone || expr->kind == EkType || (expr->kind == EkIdent && ir_find(l, expr->ident) == IR_NONE);
+}
+
+// `array.len` through a pointer, sema folds it for arrays
+static bool ir_array_len(Expr *expr, ConstValue *out) {
+    if (expr->fieldacc.deref || expr->fieldacc.field->kind != EkIdent || !streq(expr->fieldacc.field->ident, "len")) return false;
+
+    Type arrtype = expr->fieldacc.accessing->type;
+    if (arrtype.kind == TkPtr) arrtype = *arrtype.ptr_to;
+    if (arrtype.kind != TkArray || arrtype.array.len == NULL || arrtype.array.len->kind != EkIntLit) return false;
+
+    *out = (ConstValue){
+        .type = type_integer(TkUsize, TYPEVAR, 0),
+        .u = arrtype.array.len->intlit,
+    };
+    return true;
+}
+
+static size_t ir_expr(IrLower *l, Expr *expr) {
+    switch (expr->kind) {
+        case EkIntLit:
+        case EkCharLit:
+        case EkTrue:
+        case EkFalse:
+        case EkIdent: {
+            if (expr->kind == EkIdent) {
+                size_t local = ir_find(l, expr->ident);
+                if (local != IR_NONE) {
+                    IrInst inst = ir_inst(IrLoad, expr->type, expr);
+                    inst.local = local;
+                    return ir_emit(l, inst);
+                }
+            }
+
+            // globals and constants
+            IrInst inst = ir_inst(IrConst, expr->type, expr);
+            if (!ir_tracked(expr->type) || !eval_value(l->sema, expr, &inst.value)) {
+                return ir_opaque(l, expr, NULL);
+            }
+            return ir_emit(l, inst);
+        }
+        case EkGrouping: {
+            IrInst inst = ir_inst(IrCopy, expr->type, expr);
+            inst.a = ir_expr(l, expr->group);
+            return ir_emit(l, inst);
+        }
+        case EkBinop: {
+            IrInst inst = ir_inst(IrBinop, expr->type, expr);
+            inst.sub = (uint8_t)expr->binop.kind;
+            inst.a = ir_expr(l, expr->binop.left);
+            inst.b = ir_expr(l, expr->binop.right);
+            return ir_emit(l, inst);
+        }
+        case EkUnop: {
+            switch (expr->unop.kind) {
+                case UkAddress: {
+                    Arr(size_t) args = NULL;
+                    ir_lvalue(l, expr->unop.val, &args);
+                    return ir_opaque(l, expr, args);
+                }
+                case UkSizeof: {
+                    IrInst inst = ir_inst(IrConst, expr->type, expr);
+                    if (!ir_tracked(expr->type) || !ir_global(l, expr->unop.val) || !eval_value(l->sema, expr, &inst.value)) {
+                        return ir_opaque(l, expr, NULL);
+                    }
+                    return ir_emit(l, inst);
+                }
+                case UkCast: {
+                    IrInst inst = ir_inst(IrConvert, expr->type, expr);
+                    inst.a = ir_expr(l, expr->unop.val);
+                    return ir_emit(l, inst);
+                }
+                case UkNot:
+                case UkNegate:
+                case UkBitNot: {
+                    IrInst inst = ir_inst(IrUnop, expr->type, expr);
+                    inst.sub = (uint8_t)expr->unop.kind;
+                    inst.a = ir_expr(l, expr->unop.val);
+                    return ir_emit(l, inst);
+                }
+            }
+        } break;
+        case EkFieldAccess: {
+            IrInst inst = ir_inst(IrConst, expr->type, expr);
+            if (ir_array_len(expr, &inst.value)) {
+                arrpush(l->fn->fixed, ((IrFold){.expr = expr, .value = inst.value, .known = true}));
+                return ir_emit(l, inst);
+            }
+
+            // <enum>.<field>
+            if (ir_tracked(expr->type) && ir_global(l, expr->fieldacc.accessing) && eval_value(l->sema, expr, &inst.value)) {
+                return ir_emit(l, inst);
+            }
+
+            Arr(size_t) args = NULL;
+            if (expr->fieldacc.accessing->kind != EkNone) {
+                arrpush(args, ir_expr(l, expr->fieldacc.accessing));
+            }
+            return ir_opaque(l, expr, args);
+        }
+        case EkArrayIndex: {
+            Arr(size_t) args = NULL;
+            arrpush(args, ir_expr(l, expr->arrayidx.accessing));
+            arrpush(args, ir_expr(l, expr->arrayidx.index));
+            return ir_opaque(l, expr, args);
+        }
+        case EkArraySlice: {
+            Arr(size_t) args = NULL;
+            arrpush(args, ir_expr(l, expr->arrayslice.accessing));
+
+            RangeLit range = expr->arrayslice.slice->rangelit;
+            if (range.start->kind != EkNone) arrpush(args, ir_expr(l, range.start));
+            if (range.end->kind != EkNone) arrpush(args, ir_expr(l, range.end));
+            return ir_opaque(l, expr, args);
+        }
+        case EkFnCall: {
+            IrInst inst = ir_inst(IrCall, expr->type, expr);
+            inst.call = &expr->fncall;
+            inst.args = ir_call_args(l, &expr->fncall);
+            return ir_emit(l, inst);
+        }
+        case EkLiteral: {
+            Arr(size_t) args = NULL;
+            if (expr->literal.kind == LitkExprs) {
+                for (size_t i = 0; i < arrlenu(expr->literal.exprs); i++) {
+                    arrpush(args, ir_expr(l, &expr->literal.exprs[i]));
+                }
+            } else if (expr->literal.kind == LitkVars) {
+                for (size_t i = 0; i < arrlenu(expr->literal.vars); i++) {
+                    arrpush(args, ir_expr(l, &expr->literal.vars[i].varreassign.value));
+                }
+            }
+            return ir_opaque(l, expr, args);
+        }
+        default:
+            break;
+    }
+
+    return ir_opaque(l, expr, NULL);
+}
+
+// runs everything deferred since the first, innermost first, same order gen runs them in, then carries on at to
+static void ir_leave(IrLower *l, size_t first, size_t to) {
+    if (arrlenu(l->defers) <= first) {
+        ir_jump(l, to);
+        return;
+    }
+
+    Arr(size_t) cleanups = NULL;
+    for (size_t i = arrlenu(l->defers); i-- > first;) {
+        arrpush(cleanups, l->defers[i]);
+    }
+    ir_terminate(l, (IrTerm){.kind = IrLeave, .cond = IR_NONE, .then = to, .els = IR_NONE, .targets = cleanups});
+}
+
+static void ir_body(IrLower *l, Arr(Stmnt) body) {
+    size_t names = arrlenu(l->names);
+    size_t defers = arrlenu(l->defers);
+
+    for (size_t i = 0; i < arrlenu(body); i++) {
+        ir_stmnt(l, &body[i], true);
+    }
+
+    if (arrlenu(l->defers) > defers) {
+        size_t after = ir_block_new(l);
+        ir_leave(l, defers, after);
+        l->cur = after;
+    }
+    arrsetlen(l->defers, defers);
+    arrsetlen(l->names, names);
+}
+
+// everything after a return, break or continue until the next label can't be reached
+static void ir_unreachable(IrLower *l) {
+    l->cur = ir_block_new(l);
+}
+
+static void ir_if(IrLower *l, Stmnt *stmnt) {
+    If *iff = &stmnt->iff;
+    size_t cond = ir_expr(l, &iff->condition);
+
+    size_t then = ir_block_new(l);
+    size_t els = ir_block_new(l);
+    size_t join = ir_block_new(l);
+    ir_terminate(l, (IrTerm){.kind = IrBranch, .cond = cond, .then = then, .els = els});
+
+    l->cur = then;
+    size_t names = arrlenu(l->names);
+    if (iff->capturekind == CkConstDecl) {
+        ir_declare_unknown(l, iff->capture.constdecl);
+    }
+    ir_body(l, iff->body);
+    arrsetlen(l->names, names);
+    ir_jump(l, join);
+
+    l->cur = els;
+    ir_body(l, iff->els);
+    ir_jump(l, join);
+
+    l->cur = join;
+}
+
+static void ir_for(IrLower *l, Stmnt *stmnt) {
+    For *forf = &stmnt->forf;
+    size_t names = arrlenu(l->names);
+    ir_stmnt(l, forf->decl, false);
+
+    size_t header = ir_block_new(l);
+    size_t body = ir_block_new(l);
+    size_t latch = ir_block_new(l);
+    size_t exit = ir_block_new(l);
+    ir_jump(l, header);
+
+    l->cur = header;
+    if (forf->condition.kind == EkNone) {
+        ir_jump(l, body);
+    } else {
+        size_t cond = ir_expr(l, &forf->condition);
+        ir_terminate(l, (IrTerm){.kind = IrBranch, .cond = cond, .then = body, .els = exit});
+    }
+
+    arrpush(l->breaks, exit);
+    arrpush(l->continues, latch);
+
+    l->cur = body;
+    size_t loop_defers = l->loop_defers;
+    l->loop_defers = arrlenu(l->defers);
+    ir_body(l, forf->body);
+    l->loop_defers = loop_defers;
+    ir_jump(l, latch);
+
+    arrsetlen(l->breaks, arrlenu(l->breaks) - 1);
+    arrsetlen(l->continues, arrlenu(l->continues) - 1);
+
+    l->cur = latch;
+    ir_stmnt(l, forf->reassign, false);
+    ir_jump(l, header);
+
+    l->cur = exit;
+    arrsetlen(l->names, names);
+}
+
+// NOTE: every case is taken to be reachable, lookup tables need every arm to stay as it is
+static void ir_switch(IrLower *l, Stmnt *stmnt) {
+    Switch *sw = &stmnt->switchf;
+    size_t value = ir_expr(l, &sw->value);
+
+    size_t from = l->cur;
+    size_t join = ir_block_new(l);
+    Arr(size_t) targets = NULL;
+    bool has_default = false;
+
+    for (size_t i = 0; i < arrlenu(sw->cases); i++) {
+        Case *c = &sw->cases[i];
+        if (c->values == NULL) has_default = true;
+
+        l->cur = ir_block_new(l);
+        arrpush(targets, l->cur);
+
+        size_t names = arrlenu(l->names);
+        ir_declare_unknown(l, c->capture_decl);
+        ir_body(l, c->body);
+        arrsetlen(l->names, names);
+        ir_jump(l, join);
+    }
+    if (!has_default) arrpush(targets, join);
+
+    l->cur = from;
+    ir_terminate(l, (IrTerm){.kind = IrSwitch, .cond = value, .then = IR_NONE, .els = IR_NONE, .targets = targets});
+    l->cur = join;
+}
+
+static void ir_stmnt(IrLower *l, Stmnt *stmnt, bool record) {
+    if (record) {
+        arrpush(l->fn->stmnts, ((IrStmnt){.stmnt = stmnt, .block = l->cur}));
+    }
+
+    switch (stmnt->kind) {
+        case SkVarDecl:
+        case SkConstDecl: {
+            VarDecl *decl = stmnt->kind == SkVarDecl ? &stmnt->vardecl : &stmnt->constdecl;
+            size_t value = decl->value.kind == EkNone ? IR_NONE : ir_expr(l, &decl->value);
+            size_t local = ir_declare(l, decl->name.ident, decl->type);
+            if (value != IR_NONE) value = ir_store_value(l, local, &decl->value, value);
+            ir_store(l, local, value);
+        } break;
+        case SkVarReassign: {
+            VarReassign *varre = &stmnt->varreassign;
+            size_t local = varre->name.kind == EkIdent ? ir_find(l, varre->name.ident) : IR_NONE;
+            if (local != IR_NONE) {
+                size_t value = ir_expr(l, &varre->value);
+                ir_store(l, local, ir_store_value(l, local, &varre->value, value));
+                break;
+            }
+
+            IrInst inst = ir_inst(IrEffect, type_none(), NULL);
+            ir_lvalue(l, &varre->name, &inst.args);
+            arrpush(inst.args, ir_expr(l, &varre->value));
+            ir_emit(l, inst);
+        } break;
+        case SkFnCall: {
+            IrInst inst = ir_inst(IrCall, type_none(), NULL);
+            inst.call = &stmnt->fncall;
+            inst.args = ir_call_args(l, &stmnt->fncall);
+            ir_emit(l, inst);
+        } break;
+        case SkReturn: {
+            // gen runs the defers before evaluating the value
+            if (arrlenu(l->defers) > 0) {
+                size_t after = ir_block_new(l);
+                ir_leave(l, 0, after);
+                l->cur = after;
+            }
+            size_t value = stmnt->returnf.value.kind == EkNone ? IR_NONE : ir_expr(l, &stmnt->returnf.value);
+            ir_terminate(l, (IrTerm){.kind = IrRet, .cond = value, .then = IR_NONE, .els = IR_NONE});
+            ir_unreachable(l);
+        } break;
+        case SkBreak:
+        case SkContinue: {
+            // every scope inside the loop is left, not just the innermost
+            Arr(size_t) to = stmnt->kind == SkBreak ? l->breaks : l->continues;
+            if (arrlenu(to) > 0) ir_leave(l, l->loop_defers, to[arrlenu(to) - 1]);
+            ir_unreachable(l);
+        } break;
+        case SkIf:
+            ir_if(l, stmnt);
+            break;
+        case SkFor:
+            ir_for(l, stmnt);
+            break;
+        case SkSwitch:
+            ir_switch(l, stmnt);
+            break;
+        case SkBlock:
+            ir_body(l, stmnt->block);
+            break;
+        case SkDefer: {
+            // lowered once out of line, the defers pass copies it to every exit that runs it
+            size_t from = l->cur;
+            IrCleanup cleanup = {.first = ir_block_new(l), .last = 0};
+            l->cur = cleanup.first;
+            ir_stmnt(l, stmnt->defer, false);
+            ir_terminate(l, (IrTerm){.kind = IrResume, .cond = IR_NONE, .then = IR_NONE, .els = IR_NONE});
+            cleanup.last = arrlenu(l->fn->blocks) - 1;
+            l->cur = from;
+
+            arrpush(l->fn->cleanups, cleanup);
+            arrpush(l->defers, arrlenu(l->fn->cleanups) - 1);
+        } break;
+        case SkNone:
+            break;
+        default:
+            l->fn->skipped = true;
+            break;
+    }
+}
+
+static IrFn ir_lower_fn(Sema *sema, Stmnt *decl) {
+    IrFn fn = {
+        .decl = decl,
+        .blocks = NULL,
+        .locals = NULL,
+        .temps = 0,
+        .stmnts = NULL,
+        .fixed = NULL,
+        .folds = NULL,
+        .cleanups = NULL,
+        .skipped = false,
+        .emit = false,
+    };
+
+    IrLower l = {
+        .sema = sema,
+        .fn = &fn,
+        .cur = 0,
+        .names = NULL,
+        .defers = NULL,
+        .breaks = NULL,
+        .continues = NULL,
+        .loop_defers = 0,
+    };
+    l.cur = ir_block_new(&l);
+
+    for (size_t i = 0; i < arrlenu(decl->fndecl.args); i++) {
+        ir_declare_unknown(&l, &decl->fndecl.args[i]);
+    }
+    ir_body(&l, decl->fndecl.body);
+    ir_terminate(&l, (IrTerm){.kind = IrRet, .cond = IR_NONE, .then = IR_NONE, .els = IR_NONE});
+
+    arrfree(l.names);
+    arrfree(l.defers);
+    arrfree(l.breaks);
+    arrfree(l.continues);
+    return fn;
+}
+
+static Arr(IrFn) ir_lower(Sema *sema) {
+    Arr(IrFn) fns = NULL;
+    for (size_t i = 0; i < arrlenu(sema->ast); i++) {
+        Stmnt *decl = &sema->ast[i];
+        if (decl->kind == SkExtern) decl = decl->externf;
+        if (decl->kind != SkFnDecl || !decl->fndecl.has_body) continue;
+
+        // C can't return arrays, gen skips these
+        if (decl->fndecl.type.kind == TkArray) continue;
+
+        arrpush(fns, ir_lower_fn(sema, decl));
+    }
+    return fns;
+}
+
+// copies the blocks of a cleanup, its end carries on at resume, returns where the copy starts
+// temps maps the temporaries of the original to the ones of the copy
+static size_t ir_copy_cleanup(IrFn *fn, IrCleanup cleanup, size_t resume, size_t *temps) {
+    size_t base = arrlenu(fn->blocks);
+    for (size_t b = cleanup.first; b <= cleanup.last; b++) {
+        IrBlock copy = {.insts = NULL, .term = fn->blocks[b].term, .dead = false};
+
+        for (size_t i = 0; i < arrlenu(fn->blocks[b].insts); i++) {
+            IrInst inst = fn->blocks[b].insts[i];
+            if (inst.a != IR_NONE) inst.a = temps[inst.a];
+            if (inst.b != IR_NONE) inst.b = temps[inst.b];
+
+            Arr(size_t) args = NULL;
+            for (size_t j = 0; j < arrlenu(inst.args); j++) {
+                arrpush(args, temps[inst.args[j]]);
+            }
+            inst.args = args;
+
+            if (inst.dst != IR_NONE) {
+                temps[inst.dst] = fn->temps;
+                inst.dst = fn->temps++;
+            }
+            arrpush(copy.insts, inst);
+        }
+
+        IrTerm *term = &copy.term;
+        if (term->cond != IR_NONE) term->cond = temps[term->cond];
+        if (term->kind == IrResume) {
+            term->kind = IrJump;
+            term->then = resume;
+        }
+        if (term->then >= cleanup.first && term->then <= cleanup.last) term->then += base - cleanup.first;
+        if (term->els >= cleanup.first && term->els <= cleanup.last) term->els += base - cleanup.first;
+
+        // a leave's targets are cleanups, not blocks
+        Arr(size_t) targets = NULL;
+        for (size_t i = 0; i < arrlenu(term->targets); i++) {
+            size_t target = term->targets[i];
+            if (term->kind == IrSwitch && target >= cleanup.first && target <= cleanup.last) target += base - cleanup.first;
+            arrpush(targets, target);
+        }
+        term->targets = targets;
+
+        arrpush(fn->blocks, copy);
+    }
+
+    for (size_t i = 0, len = arrlenu(fn->stmnts); i < len; i++) {
+        IrStmnt s = fn->stmnts[i];
+        if (s.block < cleanup.first || s.block > cleanup.last) continue;
+        arrpush(fn->stmnts, ((IrStmnt){.stmnt = s.stmnt, .block = s.block + base - cleanup.first}));
+    }
+    return base;
+}
+
+void ir_defers(IrFn *fn) {
+    size_t blocks = arrlenu(fn->blocks);
+    if (arrlenu(fn->cleanups) == 0) return;
+
+    bool *original = ir_alloc(blocks, sizeof(bool));
+    for (size_t i = 0; i < arrlenu(fn->cleanups); i++) {
+        for (size_t b = fn->cleanups[i].first; b <= fn->cleanups[i].last; b++) {
+            original[b] = true;
+        }
+    }
+
+    // only the original cleanups have temporaries that need mapping, copies are never copied
+    size_t *temps = ir_alloc(fn->temps + 1, sizeof(size_t));
+
+    // copies can leave too, so this keeps going over the blocks it adds
+    for (size_t b = 0; b < arrlenu(fn->blocks); b++) {
+        if ((b < blocks && original[b]) || fn->blocks[b].term.kind != IrLeave) continue;
+
+        // built from the outermost in, each one carries on into the one after it
+        IrTerm leave = fn->blocks[b].term;
+        size_t next = leave.then;
+        for (size_t i = arrlenu(leave.targets); i-- > 0;) {
+            next = ir_copy_cleanup(fn, fn->cleanups[leave.targets[i]], next, temps);
+        }
+        arrfree(leave.targets);
+        fn->blocks[b].term = (IrTerm){.kind = IrJump, .cond = IR_NONE, .then = next, .els = IR_NONE, .targets = NULL};
+    }
+
+    for (size_t b = 0; b < blocks; b++) {
+        if (!original[b]) continue;
+
+        IrBlock *block = &fn->blocks[b];
+        block->dead = true;
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            arrfree(block->insts[i].args);
+        }
+        arrfree(block->insts);
+        arrfree(block->term.targets);
+        block->term = (IrTerm){.kind = IrRet, .cond = IR_NONE, .then = IR_NONE, .els = IR_NONE, .targets = NULL};
+    }
+
+    free(temps);
+    free(original);
+}
+
+// a lattice value, unknown until something reaches it, then a constant, then varying
+typedef enum IrLevel {
+    IrUnknown,
+    IrKnown,
+    IrVarying,
+} IrLevel;
+
+typedef struct IrValue {
+    IrLevel level;
+    ConstValue value;
+} IrValue;
+
+static IrValue ir_known(ConstValue value) {
+    return (IrValue){.level = IrKnown, .value = value};
+}
+
+static IrValue ir_varying(void) {
+    return (IrValue){.level = IrVarying};
+}
+
+// returns true if into changed
+static bool ir_meet(IrValue *into, IrValue from) {
+    if (from.level == IrUnknown || into->level == IrVarying) return false;
+    if (into->level == IrUnknown) {
+        *into = from;
+        return true;
+    }
+    if (from.level == IrVarying || from.value.u != into->value.u) {
+        *into = ir_varying();
+        return true;
+    }
+    return false;
+}
+
+static IrValue ir_fold_inst(IrFn *fn, IrInst *inst, IrValue *temps, IrValue *state) {
+    IrValue a = inst->a == IR_NONE ? ir_varying() : temps[inst->a];
+    IrValue b = inst->b == IR_NONE ? ir_varying() : temps[inst->b];
+    ConstValue out;
+
+    switch (inst->op) {
+        case IrConst:
+            return ir_known(inst->value);
+        case IrCopy:
+            return a;
+        case IrLoad:
+            return fn->locals[inst->local].tracked ? state[inst->local] : ir_varying();
+        case IrStore: {
+            IrLocal local = fn->locals[inst->local];
+            if (!local.tracked) return ir_varying();
+            if (a.level == IrKnown && !eval_convert(a.value, local.type, &a.value)) a = ir_varying();
+            state[inst->local] = a;
+            return a;
+        }
+        case IrBinop: {
+            // the rhs isn't evaluated if the lhs decides it
+            if (a.level == IrKnown && ((inst->sub == BkAnd && !a.value.u) || (inst->sub == BkOr && a.value.u))) {
+                eval_apply_binop(inst->sub, a.value, a.value, &out);
+                return ir_known(out);
+            }
+            if (a.level == IrVarying || b.level == IrVarying) return ir_varying();
+            if (a.level == IrUnknown || b.level == IrUnknown) return (IrValue){.level = IrUnknown};
+            if (!eval_apply_binop(inst->sub, a.value, b.value, &out)) return ir_varying();
+            return ir_known(out);
+        }
+        case IrUnop:
+            if (a.level != IrKnown) return a;
+            if (!eval_apply_unop(inst->sub, a.value, &out)) return ir_varying();
+            return ir_known(out);
+        case IrConvert:
+            if (a.level != IrKnown) return a;
+            if (!ir_tracked(inst->type) || !eval_convert(a.value, inst->type, &out)) return ir_varying();
+            return ir_known(out);
+        case IrCall:
+        case IrEval:
+        case IrEffect:
+            return ir_varying();
+    }
+
+    assert(false);
+}
+
+void ir_fold(IrFn *fn) {
+    size_t blocks = arrlenu(fn->blocks);
+    size_t locals = arrlenu(fn->locals);
+
+    IrValue *ins = ir_alloc(blocks * locals + 1, sizeof(IrValue));
+    IrValue *state = ir_alloc(locals + 1, sizeof(IrValue));
+    IrValue *temps = ir_alloc(fn->temps + 1, sizeof(IrValue));
+    bool *executable = ir_alloc(blocks, sizeof(bool));
+
+    Arr(size_t) work = NULL;
+    executable[0] = true;
+    arrpush(work, 0);
+
+    while (arrlenu(work) > 0) {
+        size_t b = arrpop(work);
+        IrBlock *block = &fn->blocks[b];
+        memcpy(state, &ins[b * locals], locals * sizeof(IrValue));
+
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            IrInst *inst = &block->insts[i];
+            IrValue value = ir_fold_inst(fn, inst, temps, state);
+            if (inst->dst != IR_NONE) temps[inst->dst] = value;
+        }
+
+        Arr(size_t) succs = NULL;
+        switch (block->term.kind) {
+            case IrJump:
+                arrpush(succs, block->term.then);
+                break;
+            case IrBranch: {
+                IrValue cond = temps[block->term.cond];
+                if (cond.level == IrVarying || (cond.level == IrKnown && cond.value.u)) arrpush(succs, block->term.then);
+                if (cond.level == IrVarying || (cond.level == IrKnown && !cond.value.u)) arrpush(succs, block->term.els);
+            } break;
+            case IrSwitch:
+                for (size_t i = 0; i < arrlenu(block->term.targets); i++) {
+                    arrpush(succs, block->term.targets[i]);
+                }
+                break;
+            case IrFall:
+            case IrRet:
+            // NOTE: defers has replaced every one of these by now
+            case IrLeave:
+            case IrResume:
+                break;
+        }
+
+        for (size_t i = 0; i < arrlenu(succs); i++) {
+            size_t s = succs[i];
+            bool changed = false;
+            for (size_t j = 0; j < locals; j++) {
+                changed |= ir_meet(&ins[s * locals + j], state[j]);
+            }
+            if (changed || !executable[s]) {
+                executable[s] = true;
+                arrpush(work, s);
+            }
+        }
+        arrfree(succs);
+    }
+
+    // every block has been run with its final state, so the temporaries it defines are final too
+    // only the outermost constant in an expression is written back, gen would otherwise warn about folding the rest
+    bool *inner = ir_alloc(fn->temps + 1, sizeof(bool));
+    for (size_t b = 0; b < blocks; b++) {
+        if (!executable[b]) continue;
+        IrBlock *block = &fn->blocks[b];
+
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            IrInst inst = block->insts[i];
+            if (inst.dst == IR_NONE || temps[inst.dst].level != IrKnown) continue;
+
+            if (inst.a != IR_NONE) inner[inst.a] = true;
+            if (inst.b != IR_NONE) inner[inst.b] = true;
+        }
+
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            IrInst *inst = &block->insts[i];
+            if (inst->dst == IR_NONE) continue;
+
+            IrValue value = temps[inst->dst];
+            if (inst->expr != NULL) {
+                arrpush(fn->folds, ((IrFold){.expr = inst->expr, .value = value.value, .known = value.level == IrKnown && !inner[inst->dst]}));
+            }
+            if (value.level == IrKnown && inst->op != IrCall) {
+                arrfree(inst->args);
+                inst->op = IrConst;
+                inst->value = value.value;
+                inst->a = IR_NONE;
+                inst->b = IR_NONE;
+            }
+        }
+
+        if (block->term.kind == IrBranch && temps[block->term.cond].level == IrKnown) {
+            block->term.then = temps[block->term.cond].value.u ? block->term.then : block->term.els;
+            block->term.kind = IrJump;
+            block->term.cond = IR_NONE;
+            block->term.els = IR_NONE;
+        }
+    }
+
+    arrfree(work);
+    free(inner);
+    free(executable);
+    free(temps);
+    free(state);
+    free(ins);
+}
+
+static void ir_reach(IrFn *fn, size_t b, bool *reached) {
+    Arr(size_t) work = NULL;
+    arrpush(work, b);
+
+    while (arrlenu(work) > 0) {
+        size_t at = arrpop(work);
+        if (reached[at]) continue;
+        reached[at] = true;
+
+        IrTerm term = fn->blocks[at].term;
+        if (term.kind == IrJump || term.kind == IrBranch) arrpush(work, term.then);
+        if (term.kind == IrBranch) arrpush(work, term.els);
+        for (size_t i = 0; term.kind == IrSwitch && i < arrlenu(term.targets); i++) {
+            arrpush(work, term.targets[i]);
+        }
+    }
+    arrfree(work);
+}
+
+static bool ir_removable(IrInst inst) {
+    switch (inst.op) {
+        case IrConst:
+        case IrCopy:
+        case IrLoad:
+        case IrBinop:
+        case IrUnop:
+        case IrConvert:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ir_dce(IrFn *fn) {
+    size_t blocks = arrlenu(fn->blocks);
+    bool *reached = ir_alloc(blocks, sizeof(bool));
+    ir_reach(fn, 0, reached);
+
+    for (size_t b = 0; b < blocks; b++) {
+        if (reached[b]) continue;
+
+        IrBlock *block = &fn->blocks[b];
+        block->dead = true;
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            arrfree(block->insts[i].args);
+        }
+        arrfree(block->insts);
+    }
+    free(reached);
+
+    size_t *uses = ir_alloc(fn->temps + 1, sizeof(size_t));
+    for (size_t b = 0; b < blocks; b++) {
+        IrBlock *block = &fn->blocks[b];
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            IrInst inst = block->insts[i];
+            if (inst.a != IR_NONE) uses[inst.a]++;
+            if (inst.b != IR_NONE) uses[inst.b]++;
+            for (size_t j = 0; j < arrlenu(inst.args); j++) {
+                uses[inst.args[j]]++;
+            }
+        }
+        if (block->term.cond != IR_NONE) uses[block->term.cond]++;
+    }
+
+    // temporaries only live in the block defining them, so going backwards removes chains in one go
+    // what's kept is moved to the end of the block as it goes, then moved back down once
+    for (size_t b = 0; b < blocks; b++) {
+        IrBlock *block = &fn->blocks[b];
+        size_t len = arrlenu(block->insts);
+        if (len == 0) continue;
+        size_t kept = len;
+        for (ptrdiff_t i = (ptrdiff_t)len - 1; i >= 0; i--) {
+            IrInst inst = block->insts[i];
+            if (!ir_removable(inst) || uses[inst.dst] > 0) {
+                block->insts[--kept] = inst;
+                continue;
+            }
+
+            if (inst.a != IR_NONE) uses[inst.a]--;
+            if (inst.b != IR_NONE) uses[inst.b]--;
+        }
+        memmove(block->insts, block->insts + kept, sizeof(IrInst) * (len - kept));
+        arrsetlen(block->insts, len - kept);
+    }
+    free(uses);
+}
+
+typedef struct IrRewrite {
+    Expr *key;
+    IrFold value;
+} IrRewrite;
+
+static void ir_record(IrRewrite **rewrites, IrFold fold) {
+    ptrdiff_t at = hmgeti(*rewrites, fold.expr);
+    if (at < 0) {
+        hmput(*rewrites, fold.expr, fold);
+        return;
+    }
+
+    // lowered more than once, deferred statements are lowered at every exit
+    IrFold *seen = &(*rewrites)[at].value;
+    if (!fold.known || !seen->known || seen->value.u != fold.value.u) seen->known = false;
+}
+
+static bool ir_is_literal(Expr *expr) {
+    return expr->kind == EkIntLit || expr->kind == EkCharLit || expr->kind == EkTrue || expr->kind == EkFalse;
+}
+
+// the literal has the type of the expression it replaces, so it's only used if that's the type the C had too
+// NOTE: C does arithmetic on smaller integers as int, the sum of two u8 is only written back where it's converted
+static void ir_rewrite(IrFold fold) {
+    Expr *expr = fold.expr;
+    if (!fold.known || ir_is_literal(expr) || !ir_tracked(expr->type) || fold.value.type.kind != expr->type.kind) return;
+
+    Expr folded;
+    if (!eval_to_expr(fold.value, expr->type, expr->cursors_idx, &folded)) return;
+    *expr = folded;
+}
+
+typedef struct IrCallee {
+    const char *key;
+    Stmnt *value;
+} IrCallee;
+
+static bool ir_c_type(Type type) {
+    return ir_tracked(type) && type.kind != TkUntypedInt;
+}
+
+// C works out sums of smaller integers as int, so fold's value for one is only the same if nothing was worked out
+static bool ir_c_const(IrInst inst) {
+    Expr literal;
+    if (!eval_to_expr(inst.value, inst.type, 0, &literal)) return false;
+
+    switch (inst.type.kind) {
+        case TkChar:
+        case TkI8:
+        case TkI16:
+        case TkU8:
+        case TkU16:
+            return inst.expr == NULL || ir_is_literal(inst.expr) || inst.expr->kind == EkIdent;
+        default:
+            return true;
+    }
+}
+
+// a function taking and returning scalars, called by name
+static bool ir_c_call(IrCallee *callees, IrInst inst) {
+    if (inst.call->name->kind != EkIdent) return false;
+
+    Stmnt *callee = shget(callees, inst.call->name->ident);
+    if (callee == NULL || arrlenu(callee->fndecl.args) != arrlenu(inst.args)) return false;
+    if (callee->fndecl.type.kind != TkVoid && !ir_c_type(callee->fndecl.type)) return false;
+
+    for (size_t i = 0; i < arrlenu(callee->fndecl.args); i++) {
+        Stmnt arg = callee->fndecl.args[i];
+        if (!ir_c_type(arg.kind == SkVarDecl ? arg.vardecl.type : arg.constdecl.type)) return false;
+    }
+    return true;
+}
+
+// every local is a tracked scalar and every temporary is used once, so gen can write each one out where it's used
+static bool ir_emittable(IrFn *fn, IrCallee *callees) {
+    FnDecl *fndecl = &fn->decl->fndecl;
+    bool returns = fndecl->type.kind != TkVoid;
+    if (fn->skipped || streq(fndecl->name.ident, "main") || (returns && !ir_c_type(fndecl->type))) return false;
+
+    for (size_t i = 0; i < arrlenu(fn->locals); i++) {
+        if (!fn->locals[i].tracked || !ir_c_type(fn->locals[i].type)) return false;
+    }
+
+    bool ok = true;
+    size_t *uses = ir_alloc(fn->temps + 1, sizeof(size_t));
+    for (size_t b = 0; b < arrlenu(fn->blocks); b++) {
+        IrBlock *block = &fn->blocks[b];
+        if (block->dead) continue;
+
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            IrInst inst = block->insts[i];
+            if (inst.a != IR_NONE) uses[inst.a]++;
+            if (inst.b != IR_NONE) uses[inst.b]++;
+            for (size_t j = 0; j < arrlenu(inst.args); j++) {
+                uses[inst.args[j]]++;
+            }
+
+            switch (inst.op) {
+                case IrConst:
+                    ok &= ir_c_const(inst);
+                    break;
+                case IrConvert:
+                    ok &= ir_c_type(inst.type);
+                    break;
+                case IrCall:
+                    ok &= ir_c_call(callees, inst);
+                    break;
+                case IrEval:
+                case IrEffect:
+                    ok = false;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        IrTerm term = block->term;
+        if (term.cond != IR_NONE) uses[term.cond]++;
+        if (term.kind == IrRet) {
+            ok &= (term.cond != IR_NONE) == returns;
+        } else if (term.kind != IrJump && term.kind != IrBranch) {
+            ok = false;
+        }
+    }
+
+    // a call in an expression that nothing uses was only kept for its effects, like the rhs of an `and` fold decided
+    for (size_t b = 0; ok && b < arrlenu(fn->blocks); b++) {
+        for (size_t i = 0; i < arrlenu(fn->blocks[b].insts); i++) {
+            IrInst inst = fn->blocks[b].insts[i];
+            if (inst.dst == IR_NONE) continue;
+            if (uses[inst.dst] > 1 || (inst.op == IrCall && inst.expr != NULL && uses[inst.dst] == 0)) ok = false;
+        }
+    }
+    free(uses);
+    return ok;
+}
+
+static void ir_apply(Arr(IrFn) fns) {
+    IrRewrite *rewrites = NULL;
+    for (size_t i = 0; i < arrlenu(fns); i++) {
+        for (size_t j = 0; j < arrlenu(fns[i].folds); j++) {
+            ir_record(&rewrites, fns[i].folds[j]);
+        }
+    }
+    for (ptrdiff_t i = 0; i < hmlen(rewrites); i++) {
+        ir_rewrite(rewrites[i].value);
+    }
+    hmfree(rewrites);
+
+    // NOTE: gen relies on these, they're written back whatever the passes found
+    for (size_t i = 0; i < arrlenu(fns); i++) {
+        for (size_t j = 0; j < arrlenu(fns[i].fixed); j++) {
+            IrFold fixed = fns[i].fixed[j];
+            eval_to_expr(fixed.value, fixed.expr->type, fixed.expr->cursors_idx, fixed.expr);
+        }
+    }
+
+    struct { Stmnt *key; bool value; } *live = NULL;
+    for (size_t i = 0; i < arrlenu(fns); i++) {
+        IrFn fn = fns[i];
+        for (size_t j = 0; j < arrlenu(fn.stmnts); j++) {
+            IrStmnt s = fn.stmnts[j];
+            bool reached = !fn.blocks[s.block].dead;
+            bool seen = hmget(live, s.stmnt);
+            hmput(live, s.stmnt, seen || reached);
+        }
+    }
+
+    for (ptrdiff_t i = 0; i < hmlen(live); i++) {
+        Stmnt *stmnt = live[i].key;
+        if (!live[i].value) {
+            *stmnt = stmnt_none();
+            continue;
+        }
+
+        // if (<constant>), only the branch taken is left
+        if (stmnt->kind == SkIf && stmnt->iff.capturekind == CkNone && (stmnt->iff.condition.kind == EkTrue || stmnt->iff.condition.kind == EkFalse)) {
+            Arr(Stmnt) taken = stmnt->iff.condition.kind == EkTrue ? stmnt->iff.body : stmnt->iff.els;
+            *stmnt = arrlenu(taken) == 0 ? stmnt_none() : stmnt_block(taken, stmnt->cursors_idx);
+        }
+    }
+    hmfree(live);
+}
+
+static void ir_free_fn(IrFn *fn) {
+    for (size_t b = 0; b < arrlenu(fn->blocks); b++) {
+        IrBlock *block = &fn->blocks[b];
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            arrfree(block->insts[i].args);
+        }
+        arrfree(block->insts);
+        arrfree(block->term.targets);
+    }
+    arrfree(fn->blocks);
+    arrfree(fn->locals);
+    arrfree(fn->stmnts);
+    arrfree(fn->fixed);
+    arrfree(fn->folds);
+    arrfree(fn->cleanups);
+}
+
+void ir_free(Arr(IrFn) fns) {
+    for (size_t i = 0; i < arrlenu(fns); i++) {
+        ir_free_fn(&fns[i]);
+    }
+    arrfree(fns);
+}
+
+static int ir_body_cmp(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t)((const IrFn*)a)->decl->fndecl.body;
+    uintptr_t y = (uintptr_t)((const IrFn*)b)->decl->fndecl.body;
+    return (x > y) - (x < y);
+}
+
+IrFn *ir_fn_find(Arr(IrFn) fns, Arr(Stmnt) body) {
+    if (body == NULL || arrlenu(fns) == 0) return NULL;
+    Stmnt decl = {.kind = SkFnDecl, .fndecl = {.body = body}};
+    IrFn key = {.decl = &decl};
+    return bsearch(&key, fns, arrlenu(fns), sizeof(IrFn), ir_body_cmp);
+}
+
+static const char *ir_binops[] = {
+    [BkPlus] = "+",
+    [BkMinus] = "-",
+    [BkDivide] = "/",
+    [BkMultiply] = "*",
+    [BkMod] = "%",
+    [BkLess] = "<",
+    [BkLessEqual] = "<=",
+    [BkGreater] = ">",
+    [BkGreaterEqual] = ">=",
+    [BkEquals] = "==",
+    [BkInequals] = "!=",
+    [BkBitOr] = "|",
+    [BkBitAnd] = "&",
+    [BkBitXor] = "~",
+    [BkLeftShift] = "<<",
+    [BkRightShift] = ">>",
+    [BkAnd] = "and",
+    [BkOr] = "or",
+};
+
+static const char *ir_unops[] = {
+    [UkBitNot] = "~",
+    [UkNot] = "!",
+    [UkNegate] = "-",
+    [UkAddress] = "&",
+    [UkCast] = "cast",
+    [UkSizeof] = "sizeof",
+};
+
+static void ir_dump_const(ConstValue value, strb *out) {
+    if (value.type.kind == TkBool) {
+        strbprintf(out, "%s", value.u ? "true" : "false");
+    } else if (value.type.kind >= TkI8 && value.type.kind <= TkIsize) {
+        strbprintf(out, "%" PRId64, value.i);
+    } else if (value.type.kind == TkUntypedInt) {
+        strbprintf(out, "%" PRId64, value.i);
+    } else {
+        strbprintf(out, "%" PRIu64, value.u);
+    }
+}
+
+static void ir_dump_args(Arr(size_t) args, strb *out) {
+    strbprintf(out, "(");
+    for (size_t i = 0; i < arrlenu(args); i++) {
+        strbprintf(out, "%st%zu", i == 0 ? "" : ", ", args[i]);
+    }
+    strbprintf(out, ")");
+}
+
+static const char *ir_expr_kind(Expr *expr) {
+    if (expr == NULL) return "store";
+
+    switch (expr->kind) {
+        case EkFieldAccess: return "field";
+        case EkArrayIndex: return "index";
+        case EkArraySlice: return "slice";
+        case EkLiteral: return "literal";
+        case EkIdent: return expr->ident;
+        case EkUnop: return "address";
+        default: return "value";
+    }
+}
+
+void ir_dump(IrFn *fn, strb *out) {
+    strbprintf(out, "fn %s%s\n", fn->decl->fndecl.name.ident, fn->emit ? ", emitted from the ir" : "");
+
+    for (size_t b = 0; b < arrlenu(fn->blocks); b++) {
+        IrBlock *block = &fn->blocks[b];
+        if (block->dead) continue;
+
+        strbprintf(out, "b%zu:\n", b);
+        for (size_t i = 0; i < arrlenu(block->insts); i++) {
+            IrInst inst = block->insts[i];
+            strbprintf(out, "    ");
+            if (inst.dst != IR_NONE) strbprintf(out, "t%zu = ", inst.dst);
+
+            switch (inst.op) {
+                case IrConst:
+                    ir_dump_const(inst.value, out);
+                    break;
+                case IrCopy:
+                    strbprintf(out, "t%zu", inst.a);
+                    break;
+                case IrLoad:
+                    strbprintf(out, "%s", fn->locals[inst.local].name);
+                    break;
+                case IrStore:
+                    if (inst.a == IR_NONE) {
+                        strbprintf(out, "%s = ?", fn->locals[inst.local].name);
+                    } else {
+                        strbprintf(out, "%s = t%zu", fn->locals[inst.local].name, inst.a);
+                    }
+                    break;
+                case IrBinop:
+                    strbprintf(out, "t%zu %s t%zu", inst.a, ir_binops[inst.sub], inst.b);
+                    break;
+                case IrUnop:
+                    strbprintf(out, "%s t%zu", ir_unops[inst.sub], inst.a);
+                    break;
+                case IrConvert: {
+                    strb type = string_from_type(inst.type);
+                    strbprintf(out, "cast(%s) t%zu", type, inst.a);
+                    strbfree(type);
+                } break;
+                case IrCall: {
+                    Expr *name = inst.call->name;
+                    strbprintf(out, "call %s", name->kind == EkIdent ? name->ident : "");
+                    ir_dump_args(inst.args, out);
+                } break;
+                case IrEval:
+                case IrEffect:
+                    strbprintf(out, "%s %s", inst.op == IrEval ? "eval" : "effect", ir_expr_kind(inst.expr));
+                    ir_dump_args(inst.args, out);
+                    break;
+            }
+            strbprintf(out, "\n");
+        }
+
+        IrTerm term = block->term;
+        switch (term.kind) {
+            case IrJump:
+                strbprintf(out, "    jump b%zu\n", term.then);
+                break;
+            case IrBranch:
+                strbprintf(out, "    branch t%zu b%zu b%zu\n", term.cond, term.then, term.els);
+                break;
+            case IrSwitch:
+                strbprintf(out, "    switch t%zu", term.cond);
+                for (size_t i = 0; i < arrlenu(term.targets); i++) {
+                    strbprintf(out, " b%zu", term.targets[i]);
+                }
+                strbprintf(out, "\n");
+                break;
+            case IrRet:
+                if (term.cond == IR_NONE) {
+                    strbprintf(out, "    ret\n");
+                } else {
+                    strbprintf(out, "    ret t%zu\n", term.cond);
+                }
+                break;
+            case IrLeave:
+                strbprintf(out, "    leave");
+                for (size_t i = 0; i < arrlenu(term.targets); i++) {
+                    strbprintf(out, " c%zu", term.targets[i]);
+                }
+                strbprintf(out, " b%zu\n", term.then);
+                break;
+            case IrResume:
+                strbprintf(out, "    resume\n");
+                break;
+            case IrFall:
+                break;
+        }
+    }
+}
+
+typedef struct IrJob {
+    Arr(IrFn) fns;
+    IrPassFn run;
+} IrJob;
+
+static void ir_pass_one(void *ctx, size_t i) {
+    IrJob *job = ctx;
+    job->run(&job->fns[i]);
+}
+
+static double ir_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+Arr(IrFn) ir_optimise(Sema *sema, size_t threads, bool dump, bool timing) {
+    double start = ir_now();
+    Arr(IrFn) fns = ir_lower(sema);
+    if (timing) printfln("%-6s %9.3f ms", "lower", ir_now() - start);
+
+    for (size_t i = 0; i < sizeof(ir_passes) / sizeof(ir_passes[0]); i++) {
+        start = ir_now();
+        IrJob job = {.fns = fns, .run = ir_passes[i].run};
+        pool_for(threads, arrlenu(fns), ir_pass_one, &job);
+        if (timing) printfln("%-6s %9.3f ms", ir_passes[i].name, ir_now() - start);
+    }
+
+    IrCallee *callees = NULL;
+    for (size_t i = 0; i < arrlenu(sema->ast); i++) {
+        Stmnt *decl = &sema->ast[i];
+        if (decl->kind == SkExtern) decl = decl->externf;
+        if (decl->kind == SkFnDecl && decl->fndecl.name.kind == EkIdent) shput(callees, decl->fndecl.name.ident, decl);
+    }
+    for (size_t i = 0; i < arrlenu(fns); i++) {
+        fns[i].emit = ir_emittable(&fns[i], callees);
+    }
+    shfree(callees);
+
+    if (dump) {
+        strb out = NULL;
+        for (size_t i = 0; i < arrlenu(fns); i++) {
+            ir_dump(&fns[i], &out);
+        }
+        printf("%s", out == NULL ? "" : out);
+        strbfree(out);
+    }
+
+    start = ir_now();
+    ir_apply(fns);
+    if (timing) printfln("%-6s %9.3f ms", "apply", ir_now() - start);
+
+    // gen only reads the bodies it emits
+    Arr(IrFn) emit = NULL;
+    for (size_t i = 0; i < arrlenu(fns); i++) {
+        if (fns[i].emit) {
+            arrpush(emit, fns[i]);
+        } else {
+            ir_free_fn(&fns[i]);
+        }
+    }
+    arrfree(fns);
+
+    if (emit != NULL) qsort(emit, arrlenu(emit), sizeof(IrFn), ir_body_cmp);
+    return emit;
+}
@@ -31,13 +31,21 @@ Keyword keyword_map(const char *str) {
     } else if (streq(str, "and")) {
         return KwAnd;
     } else if (streq(str, "or")) {
-        return KwFor;
+        return KwOr;
     } else if (streq(str, "defer")) {
         return KwDefer;
     } else if (streq(str, "cast")) {
         return KwCast;
     } else if (streq(str, "sizeof")) {
         return KwSizeof;
+    } else if (streq(str, "union")) {
+        return KwUnion;
+    } else if (streq(str, "switch")) {
+        return KwSwitch;
+    } else if (streq(str, "case")) {
+        return KwCase;
+    } else if (streq(str, "default")) {
+        return KwDefault;
     }
 
     return KwNone;
@@ -64,6 +72,10 @@ const char *keyword_stringify(Keyword k) {
         case KwDefer: return "Defer";
         case KwCast: return "Cast";
         case KwSizeof: return "Sizeof";
+        case KwUnion: return "Union";
+        case KwSwitch: return "Switch";
+        case KwCase: return "Case";
+        case KwDefault: return "Default";
     }
 
     return "";
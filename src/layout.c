@@ -0,0 +1,410 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "include/layout.h"
+#include "include/exprs.h"
+#include "include/sema.h"
+#include "include/stmnts.h"
+#include "include/types.h"
+#include "include/utils.h"
+#include "include/stb_ds.h"
+
+static size_t align_up(size_t n, size_t align) {
+    if (align <= 1) return n;
+    return (n + align - 1) / align * align;
+}
+
+static bool field_is_hot(StructAttrs *attrs, const char *name) {
+    if (attrs == NULL) return false;
+
+    for (size_t i = 0; i < arrlenu(attrs->hot); i++) {
+        if (streq(attrs->hot[i], name)) return true;
+    }
+    return false;
+}
+
+static size_t array_len(Type type) {
+    assert(type.kind == TkArray);
+    if (type.array.len == NULL || type.array.len->kind != EkIntLit) return 0;
+    return (size_t)type.array.len->intlit;
+}
+
+static size_t layout_alignof_type(Arr(Stmnt) ast, Type type) {
+    switch (type.kind) {
+        case TkBool:
+        case TkChar:
+        case TkI8:
+        case TkU8:
+            return 1;
+        case TkI16:
+        case TkU16:
+            return 2;
+        case TkI32:
+        case TkU32:
+        case TkF32:
+            return 4;
+        case TkI64:
+        case TkU64:
+        case TkIsize:
+        case TkUsize:
+        case TkF64:
+        case TkUntypedInt:
+        case TkUntypedFloat:
+        case TkCstring:
+        case TkPtr:
+        case TkString:
+        case TkSlice:
+        case TkSoa:
+            return 8;
+        case TkArray:
+            return layout_alignof(ast, *type.array.of);
+        case TkOption:
+            return layout_alignof(ast, *type.option.subtype);
+        case TkTypeDef: {
+            Stmnt decl = ast_find_decl(ast, type.typedeff);
+            if (decl.kind == SkEnumDecl) return 4;
+            if (decl.kind == SkUnionDecl) {
+                StructLayout layout = layout_union(ast, &decl.uniondecl);
+                size_t align = layout.align;
+                layout_struct_free(layout);
+                return align;
+            }
+            if (decl.kind != SkStructDecl) return 1;
+
+            StructAttrs *attrs = decl.structdecl.attrs;
+            size_t align = 1;
+            if (attrs == NULL || !attrs->packed) {
+                for (size_t i = 0; i < arrlenu(decl.structdecl.fields); i++) {
+                    size_t a = layout_alignof(ast, decl.structdecl.fields[i].vardecl.type);
+                    if (a > align) align = a;
+                }
+            }
+            if (attrs != NULL && attrs->align > align) align = attrs->align;
+            return align;
+        }
+        case TkVoid:
+        case TkNone:
+        case TkRange:
+        case TkTypeId:
+        case TkPoison:
+            return 1;
+    }
+
+    return 1;
+}
+
+static size_t layout_sizeof_type(Arr(Stmnt) ast, Type type) {
+    switch (type.kind) {
+        case TkBool:
+        case TkChar:
+        case TkI8:
+        case TkU8:
+            return 1;
+        case TkI16:
+        case TkU16:
+            return 2;
+        case TkI32:
+        case TkU32:
+        case TkF32:
+            return 4;
+        case TkI64:
+        case TkU64:
+        case TkIsize:
+        case TkUsize:
+        case TkF64:
+        case TkUntypedInt:
+        case TkUntypedFloat:
+        case TkCstring:
+        case TkPtr:
+            return 8;
+        case TkString:
+        case TkSlice:
+            // {ptr, len}
+            return 16;
+        case TkSoa: {
+            // a pointer per field, then len and cap
+            Stmnt decl = ast_find_decl(ast, type.soa.of->typedeff);
+            if (decl.kind != SkStructDecl) return 16;
+            return 8 * arrlenu(decl.structdecl.fields) + 16;
+        }
+        case TkArray:
+            return array_len(type) * layout_sizeof(ast, *type.array.of);
+        case TkOption: {
+            // {some, ok}, the option itself isn't cached yet so its alignment comes from the subtype
+            size_t align = layout_alignof(ast, *type.option.subtype);
+            return align_up(layout_sizeof(ast, *type.option.subtype) + 1, align);
+        }
+        case TkTypeDef: {
+            Stmnt decl = ast_find_decl(ast, type.typedeff);
+            if (decl.kind == SkEnumDecl) return 4;
+            if (decl.kind != SkStructDecl && decl.kind != SkUnionDecl) return 0;
+
+            StructLayout layout = decl.kind == SkStructDecl
+                ? layout_struct(ast, &decl.structdecl)
+                : layout_union(ast, &decl.uniondecl);
+            size_t size = layout.size;
+            layout_struct_free(layout);
+            return size;
+        }
+        case TkVoid:
+        case TkNone:
+        case TkRange:
+        case TkTypeId:
+        case TkPoison:
+            return 0;
+    }
+
+    return 0;
+}
+
+// sizeof in function bodies gets here from every thread checking them
+static pthread_mutex_t layout_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// nested structs would otherwise be laid out again every time they're used
+// returns false if the type isn't settled, it's laid out every time then
+static bool layout_cached(Arr(Stmnt) ast, Type type, size_t *size, size_t *align) {
+    TypeId id = type_cache_id(&type);
+    if (id == 0) return false;
+
+    TypeInfo *info = type_info(id);
+    uint64_t epoch = type_layout_epoch;
+
+    pthread_mutex_lock(&layout_lock);
+    bool stale = info->layout_epoch != epoch;
+    *size = info->size;
+    *align = info->align;
+    pthread_mutex_unlock(&layout_lock);
+    if (!stale) return true;
+
+    // not under the lock, nested types are cached on the way
+    *size = layout_sizeof_type(ast, type);
+    *align = layout_alignof_type(ast, type);
+
+    pthread_mutex_lock(&layout_lock);
+    info->size = *size;
+    info->align = *align;
+    info->layout_epoch = epoch;
+    pthread_mutex_unlock(&layout_lock);
+    return true;
+}
+
+size_t layout_alignof(Arr(Stmnt) ast, Type type) {
+    size_t size, align;
+    return layout_cached(ast, type, &size, &align) ? align : layout_alignof_type(ast, type);
+}
+
+size_t layout_sizeof(Arr(Stmnt) ast, Type type) {
+    size_t size, align;
+    return layout_cached(ast, type, &size, &align) ? size : layout_sizeof_type(ast, type);
+}
+
+void layout_seed(Type type, size_t size, size_t align) {
+    TypeId id = type_cache_id(&type);
+    if (id == 0) return;
+
+    TypeInfo *info = type_info(id);
+    pthread_mutex_lock(&layout_lock);
+    info->size = size;
+    info->align = align;
+    info->layout_epoch = type_layout_epoch;
+    pthread_mutex_unlock(&layout_lock);
+}
+
+StructLayout layout_struct(Arr(Stmnt) ast, StructDecl *structd) {
+    StructAttrs *attrs = structd->attrs;
+    bool packed = attrs != NULL && attrs->packed;
+    size_t fields_len = arrlenu(structd->fields);
+
+    StructLayout layout = {
+        .size = 0,
+        .align = 1,
+        .padding = 0,
+        .fields = NULL,
+    };
+
+    size_t offset = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < fields_len; i++) {
+        size_t idx = (attrs != NULL && attrs->order != NULL) ? attrs->order[i] : i;
+        Stmnt f = structd->fields[idx];
+
+        FieldLayout field = {
+            .name = f.vardecl.name.ident,
+            .size = layout_sizeof(ast, f.vardecl.type),
+            .align = packed ? 1 : layout_alignof(ast, f.vardecl.type),
+            .hot = field_is_hot(attrs, f.vardecl.name.ident),
+        };
+
+        offset = align_up(offset, field.align);
+        field.offset = offset;
+        offset += field.size;
+        used += field.size;
+
+        if (field.align > layout.align) layout.align = field.align;
+        arrpush(layout.fields, field);
+    }
+
+    if (attrs != NULL && attrs->align > layout.align) {
+        layout.align = attrs->align;
+    }
+
+    layout.size = align_up(offset, layout.align);
+    layout.padding = layout.size - used;
+    return layout;
+}
+
+void layout_struct_free(StructLayout layout) {
+    arrfree(layout.fields);
+}
+
+size_t layout_union_tag_size(size_t variants) {
+    return variants <= UINT8_MAX + 1 ? 1 : 2;
+}
+
+StructLayout layout_union(Arr(Stmnt) ast, UnionDecl *uniond) {
+    StructLayout layout = {
+        .size = 0,
+        .align = 1,
+        .padding = 0,
+        .fields = NULL,
+    };
+
+    size_t payload = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < arrlenu(uniond->fields); i++) {
+        Stmnt v = uniond->fields[i];
+
+        FieldLayout field = {
+            .name = v.vardecl.name.ident,
+            .offset = 0,
+            .size = layout_sizeof(ast, v.vardecl.type),
+            .align = layout_alignof(ast, v.vardecl.type),
+            .hot = false,
+        };
+
+        if (field.size > payload) payload = field.size;
+        if (field.align > layout.align) layout.align = field.align;
+        arrpush(layout.fields, field);
+    }
+    payload = align_up(payload, layout.align);
+    used = payload;
+
+    // payload first at offset 0, the tag is packed in right after it
+    size_t tag_size = layout_union_tag_size(arrlenu(uniond->fields));
+    FieldLayout tag = {
+        .name = "tag",
+        .offset = align_up(payload, tag_size),
+        .size = tag_size,
+        .align = tag_size,
+        .hot = false,
+    };
+    if (tag.align > layout.align) layout.align = tag.align;
+    arrpush(layout.fields, tag);
+    used += tag_size;
+
+    layout.size = align_up(tag.offset + tag.size, layout.align);
+    layout.padding = layout.size - used;
+    return layout;
+}
+
+// hot fields first, then by descending alignment
+// packed structs have no padding to remove so only hotness is taken into account
+static bool field_before(bool packed, bool a_hot, size_t a_align, bool b_hot, size_t b_align) {
+    if (a_hot != b_hot) return a_hot;
+    if (packed) return false;
+    return a_align > b_align;
+}
+
+void layout_order(Arr(Stmnt) ast, StructDecl *structd, bool reorder_all) {
+    StructAttrs *attrs = structd->attrs;
+    if (attrs == NULL || attrs->laid_out) return;
+    attrs->laid_out = true;
+
+    if (!attrs->reorder && !reorder_all) return;
+
+    size_t fields_len = arrlenu(structd->fields);
+    Arr(size_t) order = NULL;
+    Arr(size_t) aligns = NULL;
+
+    for (size_t i = 0; i < fields_len; i++) {
+        arrpush(aligns, layout_alignof(ast, structd->fields[i].vardecl.type));
+    }
+
+    // insertion sort, keeps declaration order between equal fields
+    for (size_t i = 0; i < fields_len; i++) {
+        bool hot = field_is_hot(attrs, structd->fields[i].vardecl.name.ident);
+
+        arrpush(order, i);
+        size_t at = arrlenu(order) - 1;
+        while (at > 0) {
+            size_t prev = order[at - 1];
+            bool prev_hot = field_is_hot(attrs, structd->fields[prev].vardecl.name.ident);
+            if (!field_before(attrs->packed, hot, aligns[i], prev_hot, aligns[prev])) break;
+
+            order[at] = prev;
+            at--;
+        }
+        order[at] = i;
+    }
+
+    arrfree(aligns);
+    attrs->order = order;
+    type_layout_epoch++;
+}
+
+static void layout_report_union(Arr(Stmnt) ast, UnionDecl uniond) {
+    StructLayout layout = layout_union(ast, &uniond);
+    size_t lines = (layout.size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+
+    printfln("union %s", uniond.name.ident);
+    printfln("    size %zu, align %zu, padding %zu bytes, %zu cache line%s", layout.size, layout.align, layout.padding, lines, lines == 1 ? "" : "s");
+    printfln("    %6s %6s %6s  %s", "offset", "size", "align", "variant");
+
+    for (size_t j = 0; j < arrlenu(layout.fields); j++) {
+        FieldLayout f = layout.fields[j];
+        printfln("    %6zu %6zu %6zu  %s", f.offset, f.size, f.align, f.name);
+    }
+
+    layout_struct_free(layout);
+}
+
+void layout_report(Arr(Stmnt) ast, Dgraph dgraph) {
+    for (size_t i = 0; i < arrlenu(dgraph.children); i++) {
+        Stmnt stmnt = dgraph.children[i].us;
+        if (stmnt.kind == SkUnionDecl) {
+            layout_report_union(ast, stmnt.uniondecl);
+            continue;
+        }
+        if (stmnt.kind != SkStructDecl) continue;
+
+        StructDecl structd = stmnt.structdecl;
+        StructAttrs *attrs = structd.attrs;
+        StructLayout layout = layout_struct(ast, &structd);
+
+        size_t lines = (layout.size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+
+        printfln("struct %s%s%s", structd.name.ident,
+            attrs != NULL && attrs->order != NULL ? " (reordered)" : "",
+            attrs != NULL && attrs->packed ? " (packed)" : ""
+        );
+        printfln("    size %zu, align %zu, padding %zu bytes, %zu cache line%s", layout.size, layout.align, layout.padding, lines, lines == 1 ? "" : "s");
+        printfln("    %6s %6s %6s  %s", "offset", "size", "align", "field");
+
+        for (size_t j = 0; j < arrlenu(layout.fields); j++) {
+            FieldLayout f = layout.fields[j];
+
+            size_t first = f.offset / CACHE_LINE_SIZE;
+            size_t last = f.size == 0 ? first : (f.offset + f.size - 1) / CACHE_LINE_SIZE;
+
+            if (first == last) {
+                printfln("    %6zu %6zu %6zu  %s%s (line %zu)", f.offset, f.size, f.align, f.name, f.hot ? " #hot" : "", first);
+            } else {
+                printfln("    %6zu %6zu %6zu  %s%s (lines %zu-%zu)", f.offset, f.size, f.align, f.name, f.hot ? " #hot" : "", first, last);
+            }
+        }
+
+        layout_struct_free(layout);
+    }
+}
@@ -1,31 +1,22 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 #include "include/stb_ds.h"
 #include "include/lexer.h"
 #include "include/strb.h"
 #include "include/utils.h"
-#include "string.h"
 
-#define BUF_CAP 255
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 Token token_none(void) {
     return (Token){.kind = TokNone};
 }
-Token token_ident(const char *s) {
-    return (Token){.kind = TokIdent, .ident = s};
-}
-Token token_intlit(uint64_t n) {
-    return (Token){.kind = TokIntLit, .numlit = (double)n};
-}
-Token token_floatlit(double n) {
-    return (Token){.kind = TokFloatLit, .numlit = n};
-}
-Token token_charlit(char s) {
-    return (Token){.kind = TokCharLit, .charlit = s};
-}
-Token token_strlit(const char *s) {
-    return (Token){.kind = TokStrLit, .strlit = s};
-}
-Token token_directive(const char *s) {
-    return (Token){.kind = TokDirective, .directive = s};
+Token token_new(TokenKind kind, size_t offset, size_t len) {
+    return (Token){.kind = kind, .offset = (uint32_t)offset, .len = (uint32_t)len};
 }
 
 const char *tokenkind_stringify(TokenKind kind) {
@@ -69,33 +60,33 @@ const char *tokenkind_stringify(TokenKind kind) {
 }
 
 // returns strb, needs to be freed
-strb token_stringify(Token tok) {
+strb token_stringify(Lexer *lex, Token tok) {
     strb s = NULL;
 
     switch (tok.kind) {
         case TokIdent:
         {
-            strbprintf(&s, "Ident(%s)", tok.ident);
+            strbprintf(&s, "Ident(%s)", token_text(lex, tok));
         } break;
         case TokIntLit:
         {
-            strbprintf(&s, "IntLit(%lu)", (uint64_t)tok.numlit);
+            strbprintf(&s, "IntLit(%lu)", token_int(lex, tok));
         } break;
         case TokFloatLit:
         {
-            strbprintf(&s, "FloatLit(%f)", tok.numlit);
+            strbprintf(&s, "FloatLit(%f)", token_number(lex, tok));
         } break;
         case TokCharLit:
         {
-            strbprintf(&s, "CharLit('%c')", tok.charlit);
+            strbprintf(&s, "CharLit('%c')", token_char(lex, tok));
         } break;
         case TokStrLit:
         {
-            strbprintf(&s, "StrLit(\"%s\")", tok.strlit);
+            strbprintf(&s, "StrLit(\"%s\")", token_text(lex, tok));
         } break;
         case TokDirective:
         {
-            strbprintf(&s, "Directive(\"%s\")", tok.directive);
+            strbprintf(&s, "Directive(\"%s\")", token_text(lex, tok));
         } break;
         case TokColon:
         case TokSemiColon:
@@ -133,69 +124,190 @@ strb token_stringify(Token tok) {
     return s;
 }
 
-void print_tokens(Token *tokens) {
-    for (size_t i = 0; i < arrlenu(tokens); i++) {
-        Token tok = tokens[i];
-        strb s = token_stringify(tok);
+void print_tokens(Lexer *lex) {
+    for (size_t i = 0; i < arrlenu(lex->tokens); i++) {
+        Token tok = lex->tokens[i];
+        strb s = token_stringify(lex, tok);
         printfln("%s", s);
         strbfree(s);
     }
 }
 
-static void move_cursor(Lexer *lex) {
-    if (lex->ch == '\n') {
-        lex->cursor.row += 1;
-        lex->cursor.col = 1;
-    } else {
-        lex->cursor.col += 1;
-    }
+// NOTE: the scans below look at 16 (sse2) or 32 (avx2) bytes at a time
+// they never load past len, the tail is always done a byte at a time
+
+#if defined(__AVX2__)
+#define SCAN_WIDTH 32
+typedef __m256i ScanVec;
+#define scan_load(p) _mm256_loadu_si256((const __m256i*)(p))
+#define scan_set1(c) _mm256_set1_epi8((char)(c))
+#define scan_eq(a, b) _mm256_cmpeq_epi8((a), (b))
+#define scan_gt(a, b) _mm256_cmpgt_epi8((a), (b))
+#define scan_or(a, b) _mm256_or_si256((a), (b))
+#define scan_and(a, b) _mm256_and_si256((a), (b))
+#define scan_mask(v) ((uint32_t)_mm256_movemask_epi8(v))
+#define SCAN_ALL 0xFFFFFFFFu
+#elif defined(__SSE2__)
+#define SCAN_WIDTH 16
+typedef __m128i ScanVec;
+#define scan_load(p) _mm_loadu_si128((const __m128i*)(p))
+#define scan_set1(c) _mm_set1_epi8((char)(c))
+#define scan_eq(a, b) _mm_cmpeq_epi8((a), (b))
+#define scan_gt(a, b) _mm_cmpgt_epi8((a), (b))
+#define scan_or(a, b) _mm_or_si128((a), (b))
+#define scan_and(a, b) _mm_and_si128((a), (b))
+#define scan_mask(v) ((uint32_t)_mm_movemask_epi8(v))
+#define SCAN_ALL 0xFFFFu
+#endif
+
+static bool is_space(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
 }
 
-static void push_buffer(Lexer *lex) {
-    STRPUSH(lex->buf, BUF_CAP, lex->buf_len, lex->ch);
-    move_cursor(lex);
+// anything that doesn't end a word is part of it, idents, numbers and directives
+static bool is_word(char ch) {
+    switch (ch) {
+        case ' ': case '\t': case '\r': case '\n':
+        case '#': case '\'': case '"': case '.': case '?': case ':':
+        case '(': case ')': case '{': case '}': case '<': case '>': case '[': case ']':
+        case '=': case '!': case ';': case ',': case '+': case '-': case '*': case '^':
+        case '|': case '&': case '~': case '/': case '%': case '\\':
+        case '\0':
+            return false;
+        default:
+            return true;
+    }
 }
 
-static void reset_buffer(Lexer *lex) {
-    strclear(lex->buf);
-    lex->buf_len = 0;
+#if defined(SCAN_WIDTH)
+static ScanVec scan_in_range(ScanVec v, char lo, char hi) {
+    // signed compares, bytes >= 0x80 are never in range and fall back to the scalar loop
+    return scan_and(scan_gt(v, scan_set1(lo - 1)), scan_gt(scan_set1(hi + 1), v));
+}
+#endif
+
+static size_t scan_space(const char *src, size_t i, size_t len) {
+#if defined(SCAN_WIDTH)
+    for (; i + SCAN_WIDTH <= len; i += SCAN_WIDTH) {
+        ScanVec v = scan_load(src + i);
+        ScanVec space = scan_or(
+            scan_or(scan_eq(v, scan_set1(' ')), scan_eq(v, scan_set1('\n'))),
+            scan_or(scan_eq(v, scan_set1('\t')), scan_eq(v, scan_set1('\r')))
+        );
+        uint32_t mask = scan_mask(space);
+        if (mask != SCAN_ALL) return i + (size_t)__builtin_ctz(~mask);
+    }
+#endif
+    while (i < len && is_space(src[i])) i++;
+    return i;
 }
 
-static void resolve_buffer(Lexer *lex) {
-    if (strlen(lex->buf) > 0) {
-        arrpush(lex->cursors, lex->cursor);
-
-        Token tok;
-        uint64_t u64 = 0;
-        double f64 = 0;
-
-        if (streq(lex->buf, "_")) {
-            tok = (Token){ .kind = TokUnderscore };
-        } else if (parse_u64(lex->buf, &u64)) {
-            tok = token_intlit(u64);
-        }  else if (parse_f64(lex->buf, &f64)) {
-            tok = token_floatlit(f64);
-        } else if (lex->is_directive) {
-            tok = token_directive(strdup(lex->buf));
-            lex->is_directive = false;
-        } else {
-            tok = token_ident(strdup(lex->buf));
+// [A-Za-z0-9_$] in bulk, then whatever else is_word allows
+static size_t scan_word(const char *src, size_t i, size_t len) {
+    for (;;) {
+#if defined(SCAN_WIDTH)
+        for (; i + SCAN_WIDTH <= len; i += SCAN_WIDTH) {
+            ScanVec v = scan_load(src + i);
+            ScanVec word = scan_or(
+                scan_or(scan_in_range(v, 'a', 'z'), scan_in_range(v, 'A', 'Z')),
+                scan_or(scan_in_range(v, '0', '9'), scan_or(scan_eq(v, scan_set1('_')), scan_eq(v, scan_set1('$'))))
+            );
+            uint32_t mask = scan_mask(word);
+            if (mask != SCAN_ALL) {
+                i += (size_t)__builtin_ctz(~mask);
+                break;
+            }
         }
-        arrpush(lex->tokens, tok);
+#endif
+        if (i >= len || !is_word(src[i])) return i;
+        i++;
+    }
+}
+
+// index of the first a or b from i, len if neither
+static size_t scan_until(const char *src, size_t i, size_t len, char a, char b) {
+#if defined(SCAN_WIDTH)
+    ScanVec va = scan_set1(a);
+    ScanVec vb = scan_set1(b);
+    for (; i + SCAN_WIDTH <= len; i += SCAN_WIDTH) {
+        ScanVec v = scan_load(src + i);
+        uint32_t mask = scan_mask(scan_or(scan_eq(v, va), scan_eq(v, vb)));
+        if (mask != 0) return i + (size_t)__builtin_ctz(mask);
+    }
+#endif
+    while (i < len && src[i] != a && src[i] != b) i++;
+    return i;
+}
+
+// from after the opening quote, returns the index of the closing quote or len
+static size_t scan_quoted(const char *src, size_t i, size_t len, char quote) {
+    for (i = scan_until(src, i, len, quote, '\\'); i < len && src[i] == '\\'; i = scan_until(src, i, len, quote, '\\')) {
+        i += 2;
+        if (i >= len) return len;
+    }
+    return i;
+}
+
+static size_t scan_block_comment(const char *src, size_t i, size_t len) {
+    for (i = scan_until(src, i, len, '*', '*'); i + 1 < len; i = scan_until(src, i + 1, len, '*', '*')) {
+        if (src[i + 1] == '/') return i + 2;
+    }
+    return len;
+}
+
+// ints are plain digits, 0x, 0o, 0b and _ separators, anything parse_u64 accepts
+static bool word_is_int(const char *word, size_t len) {
+    if (len == 0 || word[0] < '0' || word[0] > '9') return false;
+    for (size_t i = 1; i < len; i++) {
+        if (word[i] == '.') return false;
+    }
+    return true;
+}
+
+// TokIntLit, TokFloatLit or TokNone if the word isn't a number, only the value of that kind is set
+static TokenKind word_number(const char *word, size_t len, uint64_t *int_value, double *float_value) {
+    if (len == 0 || word[0] < '0' || word[0] > '9') return TokNone;
+
+    char buf[128];
+    char *str = len < sizeof(buf) ? buf : ealloc(len + 1);
+    memcpy(str, word, len);
+    str[len] = '\0';
+
+    TokenKind kind = TokNone;
+    uint64_t u64 = 0;
+    double f64 = 0;
+    if (word_is_int(word, len) && parse_u64(str, &u64)) {
+        kind = TokIntLit;
+        *int_value = u64;
+    } else if (parse_f64(str, &f64)) {
+        kind = TokFloatLit;
+        *float_value = f64;
     }
 
-    reset_buffer(lex);
+    if (str != buf) free(str);
+    return kind;
 }
 
-static void push_token(Lexer *lex, Token tok) {
-    lex->cursor.col += 1;
-    arrpush(lex->cursors, lex->cursor);
-    arrpush(lex->tokens, tok);
+static void push_token(Lexer *lex, TokenKind kind, size_t offset, size_t len) {
+    arrpush(lex->tokens, token_new(kind, offset, len));
 }
 
-static void resolve_buffer_push_token(Lexer *lex, Token tok) {
-    resolve_buffer(lex);
-    push_token(lex, tok);
+static void push_word(Lexer *lex, size_t start, size_t end, bool directive) {
+    const char *word = lex->source + start;
+    size_t len = end - start;
+
+    uint64_t int_value = 0;
+    double float_value = 0;
+    TokenKind kind = word_number(word, len, &int_value, &float_value);
+    if (kind != TokNone) {
+        push_token(lex, kind, start, len);
+    } else if (len == 1 && word[0] == '_') {
+        push_token(lex, TokUnderscore, start, len);
+    } else if (directive) {
+        push_token(lex, TokDirective, start, len);
+    } else {
+        push_token(lex, TokIdent, start, len);
+    }
 }
 
 // exits with 1 if failed
@@ -233,251 +345,222 @@ static char strtochar(const char *s) {
     exit(1);
 }
 
-Lexer lexer_init(void) {
+Lexer lexer_init(const char *source) {
     Lexer lex = {
+        .source = source,
         .tokens = NULL,
-        .cursors = NULL,
-
-        .ch = 0,
-        .buf = {0},
-        .buf_len = 0,
-        .cursor = (Cursor){1, 1},
-
-        .ignore_index = -1,
-        .in_single_line_comment = false,
-        .in_block_comment = false,
-        .escaped = false,
-        .in_quotes = false,
-        .in_double_quotes = false,
-        .is_directive = false,
+        .lines = NULL,
+        .texts = NULL,
+        .error = NULL,
     };
 
     return lex;
 }
 
-Lexer lexer(const char *source) {
-    Lexer lex = lexer_init();
+static void lexer_lines(Lexer *lex, size_t len) {
+    arrpush(lex->lines, 0);
+    for (const char *newline = memchr(lex->source, '\n', len); newline != NULL; newline = memchr(newline + 1, '\n', len - (size_t)(newline + 1 - lex->source))) {
+        arrpush(lex->lines, (uint32_t)(newline + 1 - lex->source));
+    }
+}
 
-    for (size_t i = 0; i < strlen(source); i++) {
-        const char ch = source[i];
-        lex.ch = ch;
+// shared by every module's lexer, modules are lexed and parsed on different threads
+static struct { char *key; bool value; } *interned = NULL;
+static pthread_mutex_t interned_lock = PTHREAD_MUTEX_INITIALIZER;
+
+const char *lexer_intern(const char *start, size_t len) {
+    char buf[128];
+    char *key = len < sizeof(buf) ? buf : ealloc(len + 1);
+    memcpy(key, start, len);
+    key[len] = '\0';
+
+    pthread_mutex_lock(&interned_lock);
+    const char *text = NULL;
+    ptrdiff_t i = shgeti(interned, key);
+    if (i != -1) {
+        text = interned[i].key;
+    } else {
+        char *copy = strdup(key);
+        shput(interned, copy, true);
+        text = copy;
+    }
+    pthread_mutex_unlock(&interned_lock);
 
-        if (lex.ignore_index != -1 && i == (size_t)lex.ignore_index)  {
-            lex.ignore_index = -1;
-            move_cursor(&lex);
-            continue;
-        }
+    if (key != buf) free(key);
+    return text;
+}
 
-        if (lex.in_single_line_comment) {
-            move_cursor(&lex);
-            if (ch == '\n') lex.in_single_line_comment = false;
-            continue;
-        }
+const char *token_text(Lexer *lex, Token tok) {
+    if (tok.kind == TokNone) return "";
 
-        if (lex.in_block_comment && ch == '*' && AT(source, strlen(source), i + 1) == '/') {
-            lex.ignore_index = i + 1;
-            lex.in_block_comment = false;
-            move_cursor(&lex);
-            continue;
-        } else if (lex.in_block_comment) {
-            move_cursor(&lex);
-            continue;
-        }
+    ptrdiff_t i = hmgeti(lex->texts, tok.offset);
+    if (i != -1) return lex->texts[i].value;
 
-        if (lex.escaped) {
-            lex.escaped = false;
-            push_buffer(&lex);
-            continue;
+    // quotes aren't part of the text, escapes are kept as written, they're passed through to c
+    const char *start = lex->source + tok.offset;
+    size_t len = tok.len;
+    if (tok.kind == TokStrLit || tok.kind == TokCharLit) {
+        start += 1;
+        len -= 2;
+    }
+
+    const char *text = lexer_intern(start, len);
+    hmput(lex->texts, tok.offset, text);
+    return text;
+}
+
+uint64_t token_int(Lexer *lex, Token tok) {
+    uint64_t value = 0;
+    double unused = 0;
+    word_number(lex->source + tok.offset, tok.len, &value, &unused);
+    return value;
+}
+
+double token_number(Lexer *lex, Token tok) {
+    uint64_t unused = 0;
+    double value = 0;
+    word_number(lex->source + tok.offset, tok.len, &unused, &value);
+    return value;
+}
+
+char token_char(Lexer *lex, Token tok) {
+    return strtochar(token_text(lex, tok));
+}
+
+Cursor lexer_cursor(Lexer *lex, size_t token_idx) {
+    if (arrlenu(lex->tokens) == 0) return (Cursor){1, 1};
+    if (token_idx >= arrlenu(lex->tokens)) token_idx = arrlenu(lex->tokens) - 1;
+
+    uint32_t offset = lex->tokens[token_idx].offset;
+    size_t lo = 0;
+    size_t hi = arrlenu(lex->lines);
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (lex->lines[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
         }
+    }
+
+    return (Cursor){
+        .row = (uint32_t)lo + 1,
+        .col = offset - lex->lines[lo] + 1,
+    };
+}
+
+Lexer lexer(const char *source) {
+    Lexer lex = lexer_init(source);
+    const size_t len = strlen(source);
+    bool directive = false;
+
+    if (len > UINT32_MAX) {
+        comp_elog("source files can't be bigger than 4 GiB");
+    }
+    lexer_lines(&lex, len);
+
+    size_t i = 0;
+    while (i < len) {
+        const char ch = source[i];
 
-        if (lex.in_quotes && ch != '\'' && ch != '\\') {
-            push_buffer(&lex);
+        if (is_space(ch)) {
+            i = scan_space(source, i, len);
             continue;
         }
 
-        if (lex.in_double_quotes && ch != '"' && ch != '\\') {
-            push_buffer(&lex);
+        if (is_word(ch)) {
+            size_t end = scan_word(source, i, len);
+            // 1.5, the dot is part of the number if it's not a range
+            while (end + 1 < len && source[end] == '.' && source[end + 1] != '.' && word_is_int(source + i, end - i)) {
+                end = scan_word(source, end + 1, len);
+            }
+
+            push_word(&lex, i, end, directive);
+            directive = false;
+            i = end;
             continue;
         }
 
+        char next = i + 1 < len ? source[i + 1] : '\0';
+        TokenKind kind = TokNone;
         switch (ch) {
-            case ' ':
-            case '\r':
-            case '\t':
-            case '\n':
-            {
-                if (ch == '\r') continue;
-                resolve_buffer(&lex);
-                move_cursor(&lex);
-            } break;
             case '#':
             {
-                resolve_buffer(&lex);
-                lex.is_directive = true;
-                move_cursor(&lex);
-            } break;
+                directive = true;
+                i += 1;
+            } continue;
             case '\'':
             {
-                if (lex.in_quotes) {
-                    lex.in_quotes = false;
-                    arrpush(lex.cursors, lex.cursor);
-                    arrpush(lex.tokens, token_charlit(strtochar(lex.buf)));
-                    reset_buffer(&lex);
-                } else {
-                    resolve_buffer(&lex);
-                    lex.in_quotes = true;
-                    move_cursor(&lex);
+                size_t end = scan_quoted(source, i + 1, len, '\'');
+                if (end >= len) {
+                    push_token(&lex, TokCharLit, i, 1);
+                    lex.error = "unterminated char literal";
+                    return lex;
                 }
-            } break;
+
+                push_token(&lex, TokCharLit, i, end + 1 - i);
+                i = end + 1;
+            } continue;
             case '"':
             {
-                if (lex.in_double_quotes) {
-                    lex.in_double_quotes = false;
-                    arrpush(lex.cursors, lex.cursor);
-                    arrpush(lex.tokens, token_strlit(strdup(lex.buf)));
-                    reset_buffer(&lex);
-                } else {
-                    resolve_buffer(&lex);
-                    lex.in_double_quotes = true;
-                    move_cursor(&lex);
-                }
-            } break;
-            case '.':
-            {
-                uint64_t u64 = 0;
-                if (AT(source, strlen(source), i + 1) == '.') {
-                    lex.ignore_index = i + 1;
-                    resolve_buffer_push_token(&lex, (Token){.kind = TokDot});
-                    move_cursor(&lex);
-                    push_token(&lex, (Token){.kind = TokDot});
-                } else if (parse_u64(lex.buf, &u64)) {
-                    push_buffer(&lex);
-                } else {
-                    resolve_buffer_push_token(&lex, (Token){.kind = TokDot});
+                size_t end = scan_quoted(source, i + 1, len, '"');
+                if (end >= len) {
+                    push_token(&lex, TokStrLit, i, 1);
+                    lex.error = "unterminated string literal";
+                    return lex;
                 }
-            } break;
-            case '?':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokQuestion});
-            } break;
-            case ':':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokColon});
-            } break;
-            case '(':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokLeftBracket});
-            } break;
-            case ')':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokRightBracket});
-            } break;
-            case '{':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokLeftCurl});
-            } break;
-            case '}':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokRightCurl});
-            } break;
-            case '<':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokLeftAngle});
-            } break;
-            case '>':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokRightAngle});
-            } break;
-            case '[':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokLeftSquare});
-            } break;
-            case ']':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokRightSquare});
-            } break;
-            case '=':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokEqual});
-            } break;
-            case '!':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokExclaim});
-            } break;
-            case ';':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokSemiColon});
-            } break;
-            case ',':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokComma});
-            } break;
-            case '+':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokPlus});
-            } break;
-            case '-':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokMinus});
-            } break;
-            case '*':
-            {
-                if (AT(source, strlen(source), i + 1) == '/') {
-                    lex.ignore_index = i + 1;
-                    lex.in_block_comment = false;
-                    move_cursor(&lex);
-                } else {
-                    resolve_buffer_push_token(&lex, (Token){.kind = TokStar});
-                }
-            } break;
-            case '^':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokCaret});
-            } break;
-            case '|':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokBar});
-            } break;
-            case '&':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokAmpersand});
-            } break;
-            case '~':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokTilde});
-            } break;
+
+                push_token(&lex, TokStrLit, i, end + 1 - i);
+                i = end + 1;
+            } continue;
             case '/':
             {
-                char next = AT(source, strlen(source), i + 1);
                 if (next == '/') {
-                    lex.ignore_index = i + 1;
-                    lex.in_single_line_comment = true;
-                    move_cursor(&lex);
+                    i = scan_until(source, i + 2, len, '\n', '\n');
+                    continue;
                 } else if (next == '*') {
-                    lex.ignore_index = i + 1;
-                    lex.in_block_comment = true;
-                } else {
-                    resolve_buffer_push_token(&lex, (Token){.kind = TokSlash});
+                    i = scan_block_comment(source, i + 2, len);
+                    continue;
                 }
+                kind = TokSlash;
             } break;
-            case '%':
-            {
-                resolve_buffer_push_token(&lex, (Token){.kind = TokPercent});
-            } break;
-            case '\\':
+            case '*':
             {
-                if (lex.in_double_quotes || lex.in_quotes) {
-                    lex.escaped = true;
-                    push_buffer(&lex);
-                } else {
-                    resolve_buffer_push_token(&lex, (Token){.kind = TokBackSlash});
+                // stray end of a block comment
+                if (next == '/') {
+                    i += 2;
+                    continue;
                 }
+                kind = TokStar;
             } break;
-            default:
-            {
-                push_buffer(&lex);
-            } break;
+            case '.': kind = TokDot; break;
+            case '?': kind = TokQuestion; break;
+            case ':': kind = TokColon; break;
+            case '(': kind = TokLeftBracket; break;
+            case ')': kind = TokRightBracket; break;
+            case '{': kind = TokLeftCurl; break;
+            case '}': kind = TokRightCurl; break;
+            case '<': kind = TokLeftAngle; break;
+            case '>': kind = TokRightAngle; break;
+            case '[': kind = TokLeftSquare; break;
+            case ']': kind = TokRightSquare; break;
+            case '=': kind = TokEqual; break;
+            case '!': kind = TokExclaim; break;
+            case ';': kind = TokSemiColon; break;
+            case ',': kind = TokComma; break;
+            case '+': kind = TokPlus; break;
+            case '-': kind = TokMinus; break;
+            case '^': kind = TokCaret; break;
+            case '|': kind = TokBar; break;
+            case '&': kind = TokAmpersand; break;
+            case '~': kind = TokTilde; break;
+            case '%': kind = TokPercent; break;
+            case '\\': kind = TokBackSlash; break;
         }
+
+        assert(kind != TokNone);
+        push_token(&lex, kind, i, 1);
+        i += 1;
     }
 
     return lex;
@@ -1,6 +1,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include "include/arena.h"
 #include "include/exprs.h"
 #include "include/lexer.h"
 #include "include/stmnts.h"
@@ -9,18 +11,31 @@
 #include "include/cli.h"
 #include "include/parser.h"
 #include "include/sema.h"
+#include "include/shake.h"
+#include "include/alias.h"
 #include "include/gen.h"
+#include "include/ir.h"
+#include "include/layout.h"
+#include "include/module.h"
+#include "include/native.h"
+#include "include/pmi.h"
+#include "include/pool.h"
 
 #define STB_DS_IMPLEMENTATION
 #include "include/stb_ds.h"
 
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
 void compile(CompileFlags flags) {
     const char *cc = get_c_compiler();
     strb com = NULL;
-    strbprintf(&com, "%s -o %s output.c ", cc, flags.output);
+    strbprintf(&com, "%s %s-o %s %s ", cc, flags.object ? "-c " : "", flags.output, flags.native ? "output.s" : "output.c");
 
+    // nothing left to optimise, and -g would have the assembler add its own line info on top of ours
     char *op = "";
-    switch (flags.optimisation) {
+    switch (flags.native ? OlZero : flags.optimisation) {
         case OlZero:
             op = "-O0";
             break;
@@ -43,9 +58,9 @@ void compile(CompileFlags flags) {
             op = "-Os";
             break;
     }
-    strbprintf(&com, "%s", op);
+    if (!flags.native) strbprintf(&com, "%s", op);
 
-    for (size_t i = 0; i < arrlenu(flags.links); i++) {
+    for (size_t i = 0; i < arrlenu(flags.links) && !flags.object; i++) {
         strbprintf(&com, " %s", flags.links[i]);
     }
 
@@ -65,57 +80,160 @@ void compile(CompileFlags flags) {
     if (!flags.keepc) {
         remove("output.c");
         remove("output.h");
+        remove("output.s");
     }
 
     strbfree(com);
 }
 
-// returns executable name
-const char *build(Cli cli) {
-    char *content = {0};
-    bool content_ok = read_entire_file(cli.filename, &content);
-    if (!content_ok) {
-        comp_elog("failed to read %s", cli.filename);
+void memory_report(Arr(Stmnt) ast) {
+    size_t tokens = 0;
+    size_t lines = 0;
+    for (size_t i = 0; i < arrlenu(modules); i++) {
+        tokens += arrlenu(modules[i]->lex.tokens);
+        lines += arrlenu(modules[i]->lex.lines);
     }
+    Arena usage = arena_usage();
 
-    Lexer lex = lexer(content);
-    if (arrlen(lex.tokens) != arrlen(lex.cursors)) comp_elog("expected length of tokens and length of cursors to be the same");
+    printfln("sizeof: Stmnt %zu, Expr %zu, Type %zu, Token %zu", sizeof(Stmnt), sizeof(Expr), sizeof(Type), sizeof(Token));
+    printfln("modules: %zu", arrlenu(modules));
+    printfln("tokens: %zu (%zu KiB), lines: %zu (%zu KiB)", tokens, tokens * sizeof(Token) / 1024, lines, lines * sizeof(uint32_t) / 1024);
+    printfln("top level statements: %zu (%zu KiB)", arrlenu(ast), arrlenu(ast) * sizeof(Stmnt) / 1024);
+    printfln("ast nodes: %zu (%zu KiB used, %zu KiB reserved)", usage.allocs, usage.used / 1024, usage.reserved / 1024);
+}
 
-    // if (DEBUG_MODE) {
-    //     print_tokens(lex.tokens);
-    //     printfln("");
-    // }
+// peak resident memory of the whole build, everything malloc'd and not just the ast, printed once it's done
+// the c compiler isn't counted, it's forked from pine so its peak starts at ours
+void memory_report_rss(void) {
+#if !defined(_WIN32)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printfln("max rss: %ld KiB", usage.ru_maxrss);
+#endif
+}
 
-    Arr(Stmnt) ast = NULL;
-    Parser parser = parser_init(lex, cli.filename);
-    for (Stmnt stmnt = parser_parse(&parser); stmnt.kind != SkNone; stmnt = parser_parse(&parser)) {
-        arrpush(ast, stmnt);
+// writes output.s if the optimisation level allows it and the native backend can generate the whole program
+// returns false with gen untouched otherwise, so it can be compiled through C
+bool build_native(Sema *sema, Gen *gen) {
+    Gen flags = gen_init(gen->ast, gen->dgraph);
+    Arr(Stmnt) directives = native_directives(sema->ast);
+    for (size_t i = 0; i < arrlenu(directives); i++) {
+        gen_directive(&flags, directives[i]);
     }
+    arrfree(directives);
+
+    OptLevel level = flags.compile_flags.optimisation;
+    if (level != OlZero && level != OlDebug) {
+        arrfree(flags.compile_flags.links);
+        return false;
+    }
+
+    strb out = NULL;
+    strb why = NULL;
+    size_t cursor_idx = 0;
+    if (!native_generate(sema, level == OlDebug, &out, &why, &cursor_idx)) {
+        Cursor cursor;
+        const char *filename = module_cursor(cursor_idx, &cursor);
+        eprintfln("%s:%lu:%lu " TERM_YELLOW "note" TERM_END ": %s, compiling through C instead", filename, cursor.row, cursor.col, why);
+
+        arrfree(flags.compile_flags.links);
+        strbfree(why);
+        return false;
+    }
+
+    write_entire_file("output.s", out);
+    strbfree(out);
+
+    gen->compile_flags = flags.compile_flags;
+    gen->compile_flags.native = true;
+    return true;
+}
+
+// returns executable name
+const char *build(Cli cli) {
+    size_t threads = cli.threads != 0 ? cli.threads : pool_default_threads();
+
+    Parser parser = {0};
+    Arr(Stmnt) ast = module_load(cli.filename, threads, &parser);
+    parser_instantiate(&parser, &ast);
 
     if (parser.error_count > 0) {
         exit(1);
     }
 
-    Sema sema = sema_init(ast, cli.filename, lex.cursors, parser.error_count);
+    Sema sema = sema_init(ast, parser.error_count);
+    sema.threads = threads;
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
     sema_analyse(&sema);
+    if (cli.pass_timing) {
+        struct timespec end;
+        timespec_get(&end, TIME_UTC);
+        printfln("%-6s %9.3f ms", "sema", (double)(end.tv_sec - start.tv_sec) * 1000.0 + (double)(end.tv_nsec - start.tv_nsec) / 1000000.0);
+    }
 
     if (sema.error_count > 0) {
         exit(1);
     }
 
+    // #if can splice declarations into the ast
+    ast = sema.ast;
+
+    if (cli.layout_report) {
+        layout_report(ast, sema.dgraph);
+    }
+    if (cli.switch_report) {
+        sema_switch_report(&sema);
+    }
+    if (cli.instantiation_report) {
+        parser_instantiation_report(&parser);
+    }
+    if (cli.memory_report) {
+        memory_report(ast);
+    }
+
+    tree_shake(&sema, cli.pmi, cli.tree_shake_report);
+    Arr(IrFn) ir = ir_optimise(&sema, threads, cli.ir, cli.pass_timing);
+    alias_analyse(&sema, cli.pmi, cli.alias_report);
+
     Gen gen = gen_init(ast, sema.dgraph);
-    gen_generate(&gen);
+    gen.threads = threads;
+    gen.byref_size = cli.byref_size;
+    gen.compile_flags.object = cli.pmi;
+    gen.ir = ir;
+    if (!cli.native || !build_native(&sema, &gen)) {
+        gen_generate(&gen);
+        write_entire_file("output.h", gen.defs);
+        write_entire_file("output.c", gen.code);
+    }
+    ir_free(ir);
+    gen.ir = NULL;
     gen.compile_flags.keepc = cli.keepc;
 
-    write_entire_file("output.h", gen.defs);
-    write_entire_file("output.c", gen.code);
-
     if (strlen(gen.compile_flags.output) == 0) {
         gen.compile_flags.output = filename_from_path(cli.filename);
     }
+
+    // a library, programs #import the interface and link the object
+    if (cli.pmi) {
+        strb object = NULL;
+        strbprintf(&object, "%s.o", gen.compile_flags.output);
+        strb pmi = NULL;
+        strbprintf(&pmi, "%s.pmi", gen.compile_flags.output);
+
+        if (!pmi_write(&sema, pmi, object, gen.compile_flags.links)) {
+            comp_elog("failed to write %s", pmi);
+        }
+        strbfree(pmi);
+
+        gen.compile_flags.output = object;
+    }
     compile(gen.compile_flags);
 
-    free(content);
+    if (cli.memory_report) {
+        memory_report_rss();
+    }
+
     return gen.compile_flags.output;
 }
 
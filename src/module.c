@@ -0,0 +1,233 @@
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/module.h"
+#include "include/lexer.h"
+#include "include/parser.h"
+#include "include/pmi.h"
+#include "include/pool.h"
+#include "include/stmnts.h"
+#include "include/strb.h"
+#include "include/utils.h"
+#include "include/stb_ds.h"
+
+Arr(Module*) modules = NULL;
+
+static void elog(int *error_count, size_t i, const char *msg, ...) {
+    (*error_count)++;
+    Cursor cursor;
+    const char *filename = module_cursor(i, &cursor);
+    eprintf("%s:%lu:%lu " TERM_RED "error" TERM_END ": ", filename, cursor.row, cursor.col);
+
+    va_list args;
+    va_start(args, msg);
+
+    veprintfln(msg, args);
+
+    va_end(args);
+}
+
+const char *module_cursor(size_t cursors_idx, Cursor *cursor) {
+    if (arrlenu(modules) == 0) {
+        *cursor = (Cursor){1, 1};
+        return "";
+    }
+
+    // last module starting at or before cursors_idx, modules are registered in order of first_token
+    size_t lo = 0;
+    size_t hi = arrlenu(modules);
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (modules[mid]->first_token <= cursors_idx) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    Module *module = modules[lo];
+    *cursor = lexer_cursor(&module->lex, cursors_idx - module->first_token);
+    return module->path;
+}
+
+static char *module_realpath(const char *path) {
+#if defined(_WIN32)
+    return _fullpath(NULL, path, 0);
+#else
+    return realpath(path, NULL);
+#endif
+}
+
+const char *module_resolve(const char *importer, const char *path) {
+    bool absolute = path[0] == '/' || path[0] == '\\';
+#if defined(_WIN32)
+    absolute = absolute || (path[0] != '\0' && path[1] == ':');
+#endif
+    if (absolute) return strdup(path);
+
+    size_t dir = 0;
+    for (size_t i = 0; importer[i] != '\0'; i++) {
+        if (importer[i] == '/' || importer[i] == '\\') dir = i + 1;
+    }
+
+    strb resolved = NULL;
+    strbprintf(&resolved, "%.*s%s", (int)dir, importer, path);
+    return resolved;
+}
+
+static Module *module_new(const char *path, char *realpath, size_t import_cursor) {
+    Module *module = ealloc(sizeof(Module));
+    *module = (Module){
+        .path = path,
+        .realpath = realpath,
+        .source = NULL,
+        .first_token = 0,
+        .ast = NULL,
+        .interface = false,
+        .error = NULL,
+        .imports = NULL,
+        .import_cursor = import_cursor,
+        .read_ok = false,
+        .visited = false,
+    };
+    return module;
+}
+
+static void module_lex(void *ctx, size_t i) {
+    Module *module = ((Module**)ctx)[i];
+
+    // nothing to lex or parse, every declaration is at the #import
+    if (module->interface) {
+        module->error = pmi_load(module->path, module->import_cursor, &module->ast);
+        module->read_ok = module->error == NULL;
+        return;
+    }
+
+    module->read_ok = read_entire_file(module->path, &module->source);
+    if (module->read_ok) {
+        module->lex = lexer(module->source);
+    }
+}
+
+static void module_parse(void *ctx, size_t i) {
+    Module *module = ((Module**)ctx)[i];
+    if (!module->read_ok || module->interface) return;
+
+    module->parser = parser_init(&module->lex, module->first_token);
+    // already reported, what's left of the file would only give more errors about the same thing
+    if (module->lex.error != NULL) return;
+
+    for (Stmnt stmnt = parser_parse(&module->parser); stmnt.kind != SkNone; stmnt = parser_parse(&module->parser)) {
+        arrpush(module->ast, stmnt);
+    }
+}
+
+// imports come before the module importing them, a module imported more than once is only added once
+static void module_order(Module *module, Arr(Stmnt) *ast) {
+    if (module->visited) return;
+    module->visited = true;
+
+    for (size_t i = 0; i < arrlenu(module->imports); i++) {
+        module_order(module->imports[i], ast);
+    }
+    for (size_t i = 0; i < arrlenu(module->ast); i++) {
+        arrpush(*ast, module->ast[i]);
+    }
+}
+
+Arr(Stmnt) module_load(const char *path, size_t threads, Parser *parser) {
+    struct { char *key; Module *value; } *loaded = NULL;
+    int error_count = 0;
+    size_t tokens = 0;
+
+    char *entry_realpath = module_realpath(path);
+    if (entry_realpath == NULL) {
+        comp_elog("failed to read %s", path);
+    }
+    Module *entry = module_new(path, entry_realpath, 0);
+    shput(loaded, entry_realpath, entry);
+
+    Arr(Module*) wave = NULL;
+    arrpush(wave, entry);
+    while (arrlenu(wave) > 0) {
+        pool_for(threads, arrlenu(wave), module_lex, wave);
+
+        // cursors are handed out in load order, so they're the same no matter how many threads there are
+        for (size_t i = 0; i < arrlenu(wave); i++) {
+            Module *module = wave[i];
+            if (!module->read_ok) {
+                if (module == entry) comp_elog("failed to read %s", module->path);
+                if (module->error != NULL) {
+                    elog(&error_count, module->import_cursor, "%s", module->error);
+                } else {
+                    elog(&error_count, module->import_cursor, "failed to read %s", module->path);
+                }
+                continue;
+            }
+            // doesn't take up any cursors, errors in it point at the #import
+            if (module->interface) continue;
+
+            module->first_token = tokens;
+            tokens += arrlenu(module->lex.tokens);
+            arrpush(modules, module);
+
+            if (module->lex.error != NULL) {
+                elog(&error_count, module->first_token + arrlenu(module->lex.tokens) - 1, "%s", module->lex.error);
+            }
+        }
+
+        pool_for(threads, arrlenu(wave), module_parse, wave);
+
+        Arr(Module*) next = NULL;
+        for (size_t i = 0; i < arrlenu(wave); i++) {
+            Module *module = wave[i];
+            if (!module->read_ok) continue;
+
+            // imports are dropped as the rest is moved down over them, deleting each one would move everything after it
+            size_t kept = 0;
+            for (size_t j = 0; j < arrlenu(module->ast); j++) {
+                Stmnt stmnt = module->ast[j];
+                if (stmnt.kind != SkDirective || stmnt.directive.kind != DkImport) {
+                    module->ast[kept++] = stmnt;
+                    continue;
+                }
+
+                const char *import_path = module_resolve(module->path, stmnt.directive.str);
+                char *import_realpath = module_realpath(import_path);
+                if (import_realpath == NULL) {
+                    elog(&error_count, stmnt.cursors_idx, "failed to read %s", import_path);
+                    continue;
+                }
+
+                Module *import = shget(loaded, import_realpath);
+                if (import == NULL) {
+                    import = module_new(import_path, import_realpath, stmnt.cursors_idx);
+                    import->interface = strendswith(import_path, ".pmi");
+                    shput(loaded, import_realpath, import);
+                    arrpush(next, import);
+                } else {
+                    free(import_realpath);
+                }
+                arrpush(module->imports, import);
+            }
+            arrsetlen(module->ast, kept);
+        }
+
+        arrfree(wave);
+        wave = next;
+    }
+    shfree(loaded);
+
+    *parser = modules[0]->parser;
+    for (size_t i = 1; i < arrlenu(modules); i++) {
+        parser_merge(parser, &modules[i]->parser);
+    }
+    parser->error_count += error_count;
+
+    Arr(Stmnt) ast = NULL;
+    module_order(entry, &ast);
+    return ast;
+}
@@ -0,0 +1,1601 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/arena.h"
+#include "include/eval.h"
+#include "include/exprs.h"
+#include "include/layout.h"
+#include "include/module.h"
+#include "include/native.h"
+#include "include/sema.h"
+#include "include/stb_ds.h"
+#include "include/stmnts.h"
+#include "include/strb.h"
+#include "include/types.h"
+#include "include/utils.h"
+
+#define NATIVE_MAX_ARGS 6
+
+// registers by size, 1, 2, 4 and 8 bytes
+typedef enum NativeReg {
+    NrAx,
+    NrCx,
+    NrDx,
+    NrSi,
+    NrDi,
+    NrR8,
+    NrR9,
+} NativeReg;
+
+static const char *native_regs[][4] = {
+    [NrAx] = {"al", "ax", "eax", "rax"},
+    [NrCx] = {"cl", "cx", "ecx", "rcx"},
+    [NrDx] = {"dl", "dx", "edx", "rdx"},
+    [NrSi] = {"sil", "si", "esi", "rsi"},
+    [NrDi] = {"dil", "di", "edi", "rdi"},
+    [NrR8] = {"r8b", "r8w", "r8d", "r8"},
+    [NrR9] = {"r9b", "r9w", "r9d", "r9"},
+};
+
+static const NativeReg native_arg_regs[NATIVE_MAX_ARGS] = {NrDi, NrSi, NrDx, NrCx, NrR8, NrR9};
+
+// how an argument or return value is passed
+typedef enum NativeClass {
+    NcScalar, // one register
+    NcPointer, // arrays decay to a pointer to their first element, same as C
+    NcRegs, // structs up to 16 bytes, one register for every 8 bytes
+    NcMemory, // bigger structs, copied onto the stack, returned through a hidden pointer
+} NativeClass;
+
+typedef struct NativeArg {
+    Type type;
+    NativeClass class;
+    int64_t offset; // of the evaluated argument in the caller's frame
+    size_t reg; // first register, NATIVE_MAX_ARGS if it's passed on the stack
+    size_t stack; // from the stack pointer at the call
+} NativeArg;
+
+typedef struct NativeLocal {
+    const char *name;
+    int64_t offset; // from rbp, arguments passed on the stack are above it
+    Type type;
+    bool indirect; // the slot holds the address, arrays passed as arguments
+} NativeLocal;
+
+typedef struct NativeFile {
+    char *key;
+    size_t value;
+} NativeFile;
+
+typedef struct Native {
+    Sema *sema;
+    Arr(Stmnt) ast;
+    bool debug;
+
+    Arr(char) text;
+    Arr(char) rodata;
+    Arr(char) data;
+    Arr(char) bss;
+    size_t labels;
+    NativeFile *files; // .file number of every path in .loc
+    struct { char *key; bool value; } *statics; // constant arrays and structs already in .rodata
+
+    strb why;
+    size_t why_cursor;
+
+    // the function being generated, its body is written before the frame size is known
+    Arr(char) body;
+    Arr(NativeLocal) locals;
+    size_t frame;
+    size_t pushed; // 8 byte values on the stack, calls need it 16 byte aligned
+    Arr(size_t) breaks; // labels of the innermost loop last
+    Arr(size_t) continues;
+    size_t ret_label;
+    Type ret;
+    NativeClass ret_class;
+    int64_t ret_ptr; // slot holding the caller's address for NcMemory results
+} Native;
+
+static bool native_expr(Native *n, Expr *expr, Type *out);
+static bool native_addr(Native *n, Expr *expr, Type *out);
+static bool native_block(Native *n, Arr(Stmnt) body);
+
+// only keeps the first reason, the rest are a consequence of it
+static bool native_fail(Native *n, size_t cursor_idx, const char *fmt, ...) {
+    if (n->why != NULL) return false;
+
+    va_list args;
+    va_start(args, fmt);
+    vstrbprintf(&n->why, fmt, args);
+    va_end(args);
+
+    n->why_cursor = cursor_idx;
+    return false;
+}
+
+static bool native_fail_type(Native *n, Type type, size_t cursor_idx) {
+    strb t = string_from_type(type);
+    native_fail(n, cursor_idx, "%s can't be compiled natively", t);
+    strbfree(t);
+    return false;
+}
+
+// strbprintf is linear in what's already written, the assembly is too big for that
+static void native_vwrite(Arr(char) *buf, const char *fmt, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+    assert(len >= 0);
+
+    size_t at = arrlenu(*buf);
+    arrsetlen(*buf, at + (size_t)len + 1);
+    vsnprintf(*buf + at, (size_t)len + 1, fmt, args);
+    arrsetlen(*buf, at + (size_t)len);
+}
+
+static void native_write(Arr(char) *buf, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    native_vwrite(buf, fmt, args);
+    va_end(args);
+}
+
+// one instruction in the body of the current function
+static void native_op(Native *n, const char *fmt, ...) {
+    native_write(&n->body, "    ");
+    va_list args;
+    va_start(args, fmt);
+    native_vwrite(&n->body, fmt, args);
+    va_end(args);
+    native_write(&n->body, "\n");
+}
+
+static size_t native_label(Native *n) {
+    return n->labels++;
+}
+
+static void native_place(Native *n, size_t label) {
+    native_write(&n->body, ".L%zu:\n", label);
+}
+
+static void native_push(Native *n) {
+    native_op(n, "pushq %%rax");
+    n->pushed++;
+}
+
+static void native_pop(Native *n, NativeReg reg) {
+    assert(n->pushed > 0);
+    native_op(n, "popq %%%s", native_regs[reg][3]);
+    n->pushed--;
+}
+
+static void native_loc(Native *n, size_t cursor_idx) {
+    if (!n->debug) return;
+
+    Cursor cursor;
+    const char *path = module_cursor(cursor_idx, &cursor);
+    if (path[0] == '\0') return;
+
+    ptrdiff_t found = shgeti(n->files, path);
+    size_t file;
+    if (found < 0) {
+        file = shlenu(n->files) + 1;
+        shput(n->files, path, file);
+        native_write(&n->text, "    .file %zu \"%s\"\n", file, path);
+    } else {
+        file = n->files[found].value;
+    }
+    native_op(n, ".loc %zu %lu %lu", file, cursor.row, cursor.col);
+}
+
+// typedefs that get this far are enums, which are ints in C
+static bool native_signed(Type type) {
+    switch (type.kind) {
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkUntypedInt:
+        case TkTypeDef:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool native_is_enum(Native *n, Type type) {
+    return type.kind == TkTypeDef && ast_find_decl(n->ast, type.typedeff).kind == SkEnumDecl;
+}
+
+// fits in a register
+static bool native_scalar(Native *n, Type type) {
+    switch (type.kind) {
+        case TkBool:
+        case TkChar:
+        case TkCstring:
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkU8:
+        case TkU16:
+        case TkU32:
+        case TkU64:
+        case TkUsize:
+        case TkUntypedInt:
+        case TkPtr:
+            return true;
+        case TkTypeDef:
+            return native_is_enum(n, type);
+        default:
+            return false;
+    }
+}
+
+// scalars, or arrays and structs of them
+static bool native_check_type(Native *n, Type type, size_t cursor_idx) {
+    if (native_scalar(n, type)) return true;
+
+    if (type.kind == TkArray) {
+        if (type.array.len == NULL || type.array.len->kind != EkIntLit) {
+            return native_fail(n, cursor_idx, "array length is not known");
+        }
+        return native_check_type(n, *type.array.of, cursor_idx);
+    }
+
+    if (type.kind == TkTypeDef) {
+        Stmnt decl = ast_find_decl(n->ast, type.typedeff);
+        if (decl.kind != SkStructDecl) return native_fail_type(n, type, cursor_idx);
+
+        for (size_t i = 0; i < arrlenu(decl.structdecl.fields); i++) {
+            if (!native_check_type(n, decl.structdecl.fields[i].vardecl.type, cursor_idx)) return false;
+        }
+        return true;
+    }
+
+    return native_fail_type(n, type, cursor_idx);
+}
+
+static size_t native_size(Native *n, Type type) {
+    if (type.kind == TkUntypedInt) return 8;
+    return layout_sizeof(n->ast, type);
+}
+
+static size_t native_size_idx(size_t size) {
+    switch (size) {
+        case 1: return 0;
+        case 2: return 1;
+        case 4: return 2;
+        default: return 3;
+    }
+}
+
+// untyped ints are INT64_C in the generated C
+static Type native_concrete(Type type) {
+    if (type.kind == TkUntypedInt) return type_integer(TkI64, TYPEVAR, 0);
+    return type;
+}
+
+// every scalar is kept in a register sign or zero extended to 64 bits from the width of its type
+static void native_extend(Native *n, Type type, NativeReg reg) {
+    size_t size = native_size(n, type);
+    if (size >= 8) return;
+
+    const char **r = native_regs[reg];
+    if (native_signed(type)) {
+        native_op(n, "movs%cq %%%s, %%%s", size == 1 ? 'b' : size == 2 ? 'w' : 'l', r[native_size_idx(size)], r[3]);
+    } else if (size == 4) {
+        native_op(n, "movl %%%s, %%%s", r[2], r[2]);
+    } else {
+        native_op(n, "movz%cl %%%s, %%%s", size == 1 ? 'b' : 'w', r[native_size_idx(size)], r[2]);
+    }
+}
+
+static void native_convert(Native *n, Type from, Type to, NativeReg reg) {
+    // already extended from the same width
+    if (to.kind == TkNone || to.kind == TkVoid || from.kind == to.kind) return;
+
+    const char **r = native_regs[reg];
+    if (to.kind == TkBool) {
+        if (from.kind == TkBool) return;
+        native_op(n, "testq %%%s, %%%s", r[3], r[3]);
+        native_op(n, "setne %%%s", r[0]);
+        native_op(n, "movzbl %%%s, %%%s", r[0], r[2]);
+        return;
+    }
+    native_extend(n, to, reg);
+}
+
+// loads a scalar at mem into rax
+static void native_load(Native *n, Type type, const char *mem) {
+    size_t size = native_size(n, type);
+    bool sign = native_signed(type);
+
+    switch (size) {
+        case 1:
+            native_op(n, sign ? "movsbq %s, %%rax" : "movzbl %s, %%eax", mem);
+            break;
+        case 2:
+            native_op(n, sign ? "movswq %s, %%rax" : "movzwl %s, %%eax", mem);
+            break;
+        case 4:
+            native_op(n, sign ? "movslq %s, %%rax" : "movl %s, %%eax", mem);
+            break;
+        default:
+            native_op(n, "movq %s, %%rax", mem);
+            break;
+    }
+}
+
+static void native_store(Native *n, Type type, NativeReg reg, const char *mem) {
+    size_t size = native_size(n, type);
+    static const char suffix[] = {'b', 'w', 'l', 'q'};
+    size_t idx = native_size_idx(size);
+    native_op(n, "mov%c %%%s, %s", suffix[idx], native_regs[reg][idx], mem);
+}
+
+// size bytes from rax to rcx
+static void native_copy(Native *n, size_t size) {
+    native_op(n, "movq %%rax, %%rsi");
+    native_op(n, "movq %%rcx, %%rdi");
+    native_op(n, "movq $%zu, %%rcx", size);
+    native_op(n, "rep movsb");
+}
+
+static void native_zero(Native *n, int64_t offset, size_t size) {
+    native_op(n, "leaq %" PRIi64 "(%%rbp), %%rdi", offset);
+    native_op(n, "xorl %%eax, %%eax");
+    native_op(n, "movq $%zu, %%rcx", size);
+    native_op(n, "rep stosb");
+}
+
+static void native_imm(Native *n, uint64_t bits, NativeReg reg) {
+    int64_t i = (int64_t)bits;
+    if (i >= INT32_MIN && i <= INT32_MAX) {
+        native_op(n, "movq $%" PRIi64 ", %%%s", i, native_regs[reg][3]);
+    } else {
+        native_op(n, "movabsq $%" PRIi64 ", %%%s", i, native_regs[reg][3]);
+    }
+}
+
+static int64_t native_alloc_bytes(Native *n, size_t size, size_t align) {
+    if (align == 0) align = 1;
+
+    n->frame += size;
+    n->frame = (n->frame + align - 1) / align * align;
+    return -(int64_t)n->frame;
+}
+
+static int64_t native_alloc(Native *n, Type type) {
+    size_t align = type.kind == TkUntypedInt ? 8 : layout_alignof(n->ast, type);
+    return native_alloc_bytes(n, native_size(n, type), align);
+}
+
+// whole registers can be moved in and out of it
+static int64_t native_alloc_words(Native *n, size_t size) {
+    return native_alloc_bytes(n, (size + 7) / 8 * 8, 8);
+}
+
+static NativeLocal *native_find_local(Native *n, const char *name) {
+    for (size_t i = arrlenu(n->locals); i > 0; i--) {
+        if (streq(n->locals[i - 1].name, name)) return &n->locals[i - 1];
+    }
+    return NULL;
+}
+
+static bool native_field(Native *n, Type type, const char *name, size_t cursor_idx, size_t *offset, Type *field) {
+    Stmnt decl = type.kind == TkTypeDef ? ast_find_decl(n->ast, type.typedeff) : stmnt_none();
+    if (decl.kind != SkStructDecl) return native_fail_type(n, type, cursor_idx);
+
+    bool found = false;
+    for (size_t i = 0; i < arrlenu(decl.structdecl.fields); i++) {
+        if (streq(decl.structdecl.fields[i].vardecl.name.ident, name)) {
+            *field = decl.structdecl.fields[i].vardecl.type;
+            found = true;
+            break;
+        }
+    }
+
+    StructLayout layout = layout_struct(n->ast, &decl.structdecl);
+    for (size_t i = 0; i < arrlenu(layout.fields) && found; i++) {
+        if (streq(layout.fields[i].name, name)) *offset = layout.fields[i].offset;
+    }
+    layout_struct_free(layout);
+
+    if (!found) return native_fail(n, cursor_idx, "%s has no field \"%s\"", type.typedeff, name);
+    return native_check_type(n, *field, cursor_idx);
+}
+
+// System V, every type that gets this far is made of integers
+static bool native_class(Native *n, Type type, size_t cursor_idx, NativeClass *out) {
+    if (native_scalar(n, type)) {
+        *out = NcScalar;
+        return true;
+    }
+    if (!native_check_type(n, type, cursor_idx)) return false;
+    if (type.kind == TkArray) {
+        *out = NcPointer;
+        return true;
+    }
+
+    StructAttrs *attrs = ast_find_decl(n->ast, type.typedeff).structdecl.attrs;
+    size_t size = native_size(n, type);
+    if ((attrs != NULL && attrs->packed) || layout_alignof(n->ast, type) > 8 || size == 0) {
+        return native_fail(n, cursor_idx, "%s can't be passed by value natively", type.typedeff);
+    }
+
+    *out = size <= 16 ? NcRegs : NcMemory;
+    return true;
+}
+
+static size_t native_words(Native *n, Type type, NativeClass class) {
+    if (class == NcRegs || class == NcMemory) return (native_size(n, type) + 7) / 8;
+    return 1;
+}
+
+// value in rax that has to fit in a register
+static bool native_value(Native *n, Expr *expr, Type *out) {
+    if (!native_expr(n, expr, out)) return false;
+    if (!native_scalar(n, *out)) return native_fail_type(n, *out, expr->cursors_idx);
+    return true;
+}
+
+// raw source escapes, the same ones C understands
+static void native_string(Native *n, const char *raw, size_t label) {
+    native_write(&n->rodata, ".L%zu:\n    .byte ", label);
+
+    for (size_t i = 0; raw[i] != '\0'; i++) {
+        uint8_t c = (uint8_t)raw[i];
+        if (c == '\\' && raw[i + 1] != '\0') {
+            i++;
+            switch (raw[i]) {
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'v': c = '\v'; break;
+                case 'f': c = '\f'; break;
+                case 'a': c = '\a'; break;
+                case 'b': c = '\b'; break;
+                case 'e': c = 27; break;
+                case '0': c = 0; break;
+                default: c = (uint8_t)raw[i]; break;
+            }
+        }
+        native_write(&n->rodata, "%u,", c);
+    }
+    native_write(&n->rodata, "0\n");
+}
+
+// writes value into the frame at offset
+static bool native_init(Native *n, Type type, Expr *value, int64_t offset) {
+    char mem[32];
+    snprintf(mem, sizeof(mem), "%" PRIi64 "(%%rbp)", offset);
+
+    if (value->kind == EkNone) {
+        native_zero(n, offset, native_size(n, type));
+        return true;
+    }
+
+    if (!native_scalar(n, type) && value->kind == EkLiteral) {
+        // missing elements and fields are zero, same as C
+        native_zero(n, offset, native_size(n, type));
+
+        if (type.kind == TkArray) {
+            if (value->literal.kind != LitkExprs) return native_fail(n, value->cursors_idx, "expected an array literal");
+
+            size_t step = native_size(n, *type.array.of);
+            for (size_t i = 0; i < arrlenu(value->literal.exprs); i++) {
+                if (!native_init(n, *type.array.of, &value->literal.exprs[i], offset + (int64_t)(i * step))) return false;
+            }
+            return true;
+        }
+
+        Stmnt decl = ast_find_decl(n->ast, type.typedeff);
+        size_t len = value->literal.kind == LitkVars ? arrlenu(value->literal.vars) : arrlenu(value->literal.exprs);
+        for (size_t i = 0; i < len; i++) {
+            const char *name;
+            Expr *field_value;
+            if (value->literal.kind == LitkVars) {
+                name = value->literal.vars[i].varreassign.name.ident;
+                field_value = &value->literal.vars[i].varreassign.value;
+            } else {
+                if (i >= arrlenu(decl.structdecl.fields)) return native_fail(n, value->cursors_idx, "too many fields");
+                name = decl.structdecl.fields[i].vardecl.name.ident;
+                field_value = &value->literal.exprs[i];
+            }
+
+            size_t field_offset = 0;
+            Type field;
+            if (!native_field(n, type, name, field_value->cursors_idx, &field_offset, &field)) return false;
+            if (!native_init(n, field, field_value, offset + (int64_t)field_offset)) return false;
+        }
+        return true;
+    }
+
+    Type from;
+    if (!native_expr(n, value, &from)) return false;
+
+    if (!native_scalar(n, type)) {
+        if (native_scalar(n, from)) return native_fail_type(n, from, value->cursors_idx);
+        native_op(n, "leaq %s, %%rcx", mem);
+        native_copy(n, native_size(n, type));
+        return true;
+    }
+
+    if (!native_scalar(n, from)) return native_fail_type(n, from, value->cursors_idx);
+    native_convert(n, from, type, NrAx);
+    native_store(n, type, NrAx, mem);
+    return true;
+}
+
+// bytes of a constant array or struct, missing elements and fields are zero
+static bool native_static_fill(Native *n, Type type, Expr *value, uint8_t *bytes) {
+    if (value->kind == EkNone) return true;
+
+    if (value->kind == EkIdent) {
+        Stmnt decl = ast_find_decl(n->ast, value->ident);
+        if (decl.kind == SkConstDecl && !native_scalar(n, type)) return native_static_fill(n, type, &decl.constdecl.value, bytes);
+    }
+
+    if (native_scalar(n, type)) {
+        ConstValue v;
+        if (type.kind == TkPtr || type.kind == TkCstring || !eval_value(n->sema, value, &v) || !eval_convert(v, type, &v)) {
+            return native_fail(n, value->cursors_idx, "value is not known at compile time");
+        }
+        // little endian
+        for (size_t i = 0; i < native_size(n, type); i++) bytes[i] = (uint8_t)(v.u >> (i * 8));
+        return true;
+    }
+
+    if (value->kind != EkLiteral) return native_fail(n, value->cursors_idx, "constant must be a literal to be compiled natively");
+
+    if (type.kind == TkArray) {
+        if (value->literal.kind != LitkExprs) return native_fail(n, value->cursors_idx, "expected an array literal");
+
+        size_t step = native_size(n, *type.array.of);
+        for (size_t i = 0; i < arrlenu(value->literal.exprs); i++) {
+            if (!native_static_fill(n, *type.array.of, &value->literal.exprs[i], bytes + i * step)) return false;
+        }
+        return true;
+    }
+
+    Stmnt decl = ast_find_decl(n->ast, type.typedeff);
+    size_t len = value->literal.kind == LitkVars ? arrlenu(value->literal.vars) : arrlenu(value->literal.exprs);
+    for (size_t i = 0; i < len; i++) {
+        const char *name;
+        Expr *field_value;
+        if (value->literal.kind == LitkVars) {
+            name = value->literal.vars[i].varreassign.name.ident;
+            field_value = &value->literal.vars[i].varreassign.value;
+        } else {
+            if (i >= arrlenu(decl.structdecl.fields)) return native_fail(n, value->cursors_idx, "too many fields");
+            name = decl.structdecl.fields[i].vardecl.name.ident;
+            field_value = &value->literal.exprs[i];
+        }
+
+        size_t offset = 0;
+        Type field;
+        if (!native_field(n, type, name, field_value->cursors_idx, &offset, &field)) return false;
+        if (!native_static_fill(n, field, field_value, bytes + offset)) return false;
+    }
+    return true;
+}
+
+// global constant arrays and structs go in .rodata once, under the same name as in C
+static bool native_static(Native *n, ConstDecl constdecl) {
+    const char *name = constdecl.name.ident;
+    if (shgeti(n->statics, name) >= 0) return true;
+    if (!native_check_type(n, constdecl.type, constdecl.name.cursors_idx)) return false;
+
+    size_t size = native_size(n, constdecl.type);
+    uint8_t *bytes = ealloc(size + 1);
+    memset(bytes, 0, size + 1);
+
+    bool ok = native_static_fill(n, constdecl.type, &constdecl.value, bytes);
+    if (ok) {
+        native_write(&n->rodata, "    .balign %zu\n%s:\n    .byte ", layout_alignof(n->ast, constdecl.type), name);
+        for (size_t i = 0; i < size; i++) {
+            native_write(&n->rodata, i + 1 == size ? "%u\n" : "%u,", bytes[i]);
+        }
+        if (size == 0) native_write(&n->rodata, "0\n");
+        shput(n->statics, name, true);
+    }
+
+    free(bytes);
+    return ok;
+}
+
+static bool native_ident(Native *n, Expr *expr, Type *out) {
+    assert(expr->kind == EkIdent);
+
+    NativeLocal *local = native_find_local(n, expr->ident);
+    if (local != NULL) {
+        char mem[32];
+        snprintf(mem, sizeof(mem), "%" PRIi64 "(%%rbp)", local->offset);
+
+        if (native_scalar(n, local->type)) {
+            native_load(n, local->type, mem);
+        } else {
+            native_op(n, local->indirect ? "movq %s, %%rax" : "leaq %s, %%rax", mem);
+        }
+        *out = local->type;
+        return true;
+    }
+
+    Stmnt decl = ast_find_decl(n->ast, expr->ident);
+    if (decl.kind == SkVarDecl) {
+        if (!native_check_type(n, decl.vardecl.type, expr->cursors_idx)) return false;
+
+        char mem[256];
+        snprintf(mem, sizeof(mem), "%s(%%rip)", expr->ident);
+        if (native_scalar(n, decl.vardecl.type)) {
+            native_load(n, decl.vardecl.type, mem);
+        } else {
+            native_op(n, "leaq %s, %%rax", mem);
+        }
+        *out = decl.vardecl.type;
+        return true;
+    }
+
+    ConstValue value;
+    if (decl.kind == SkConstDecl && native_scalar(n, decl.constdecl.type) && eval_value(n->sema, &decl.constdecl.value, &value) && eval_convert(value, decl.constdecl.type, &value)) {
+        native_imm(n, value.u, NrAx);
+        *out = native_concrete(value.type);
+        return true;
+    }
+
+    if (decl.kind == SkConstDecl && !native_scalar(n, decl.constdecl.type)) {
+        if (!native_static(n, decl.constdecl)) return false;
+        native_op(n, "leaq %s(%%rip), %%rax", expr->ident);
+        *out = decl.constdecl.type;
+        return true;
+    }
+
+    return native_fail(n, expr->cursors_idx, "\"%s\" can't be compiled natively", expr->ident);
+}
+
+// <struct>.<field>, <ptr>.<field> and <ptr>.*
+static bool native_field_addr(Native *n, Expr *expr, Type *out) {
+    assert(expr->kind == EkFieldAccess);
+
+    Type type;
+    if (!native_expr(n, expr->fieldacc.accessing, &type)) return false;
+
+    if (expr->fieldacc.deref) {
+        if (type.kind != TkPtr) return native_fail_type(n, type, expr->cursors_idx);
+        if (!native_check_type(n, *type.ptr_to, expr->cursors_idx)) return false;
+        *out = *type.ptr_to;
+        return true;
+    }
+
+    // a struct is already its address
+    if (type.kind == TkPtr) type = *type.ptr_to;
+
+    size_t offset = 0;
+    if (!native_field(n, type, expr->fieldacc.field->ident, expr->cursors_idx, &offset, out)) return false;
+    if (offset != 0) native_op(n, "addq $%zu, %%rax", offset);
+    return true;
+}
+
+static bool native_index_addr(Native *n, Expr *expr, Type *out) {
+    assert(expr->kind == EkArrayIndex);
+
+    Type accessing;
+    if (!native_expr(n, expr->arrayidx.accessing, &accessing)) return false;
+
+    Type of;
+    if (accessing.kind == TkArray) {
+        of = *accessing.array.of;
+    } else if (accessing.kind == TkPtr && accessing.ptr_to->kind == TkArray) {
+        of = *accessing.ptr_to->array.of;
+    } else if (accessing.kind == TkCstring) {
+        of = type_char(TYPEVAR, 0);
+    } else {
+        return native_fail_type(n, accessing, expr->cursors_idx);
+    }
+    if (!native_check_type(n, of, expr->cursors_idx)) return false;
+
+    native_push(n);
+    Type index;
+    if (!native_value(n, expr->arrayidx.index, &index)) return false;
+
+    size_t size = native_size(n, of);
+    if (size != 1) native_op(n, "imulq $%zu, %%rax", size);
+    native_pop(n, NrCx);
+    native_op(n, "addq %%rcx, %%rax");
+
+    *out = of;
+    return true;
+}
+
+static bool native_addr(Native *n, Expr *expr, Type *out) {
+    switch (expr->kind) {
+        case EkGrouping:
+            return native_addr(n, expr->group, out);
+        case EkIdent: {
+            NativeLocal *local = native_find_local(n, expr->ident);
+            if (local != NULL) {
+                native_op(n, local->indirect ? "movq %" PRIi64 "(%%rbp), %%rax" : "leaq %" PRIi64 "(%%rbp), %%rax", local->offset);
+                *out = local->type;
+                return true;
+            }
+
+            Stmnt decl = ast_find_decl(n->ast, expr->ident);
+            if (decl.kind == SkVarDecl && native_check_type(n, decl.vardecl.type, expr->cursors_idx)) {
+                native_op(n, "leaq %s(%%rip), %%rax", expr->ident);
+                *out = decl.vardecl.type;
+                return true;
+            }
+            return native_fail(n, expr->cursors_idx, "\"%s\" can't be compiled natively", expr->ident);
+        }
+        case EkFieldAccess:
+            return native_field_addr(n, expr, out);
+        case EkArrayIndex:
+            return native_index_addr(n, expr, out);
+        default:
+            return native_fail(n, expr->cursors_idx, "expression has no address");
+    }
+}
+
+// the registers an argument or return value of class is moved through, words of it starting at offset
+static void native_words_to_regs(Native *n, int64_t offset, size_t words, const NativeReg *regs) {
+    for (size_t i = 0; i < words; i++) {
+        native_op(n, "movq %" PRIi64 "(%%rbp), %%%s", offset + (int64_t)(i * 8), native_regs[regs[i]][3]);
+    }
+}
+
+static void native_regs_to_words(Native *n, int64_t offset, size_t words, const NativeReg *regs) {
+    for (size_t i = 0; i < words; i++) {
+        native_op(n, "movq %%%s, %" PRIi64 "(%%rbp)", native_regs[regs[i]][3], offset + (int64_t)(i * 8));
+    }
+}
+
+// every argument is evaluated into the frame first, nothing else is on the stack while they're moved into place
+static bool native_args(Native *n, FnDecl fndecl, Arr(Expr) exprs, size_t regs, Arr(NativeArg) *args, size_t *stack) {
+    for (size_t i = 0; i < arrlenu(fndecl.args); i++) {
+        Expr *arg = &exprs[i];
+        NativeArg a = {.type = fndecl.args[i].constdecl.type};
+        if (!native_class(n, a.type, arg->cursors_idx, &a.class)) return false;
+
+        Type type;
+        if (!native_expr(n, arg, &type)) return false;
+        if ((a.class == NcScalar) != native_scalar(n, type)) return native_fail_type(n, type, arg->cursors_idx);
+
+        size_t words = native_words(n, a.type, a.class);
+        a.offset = native_alloc_words(n, words * 8);
+        if (a.class == NcScalar) {
+            native_convert(n, type, a.type, NrAx);
+            native_op(n, "movq %%rax, %" PRIi64 "(%%rbp)", a.offset);
+        } else if (a.class == NcPointer) {
+            native_op(n, "movq %%rax, %" PRIi64 "(%%rbp)", a.offset);
+        } else {
+            native_op(n, "leaq %" PRIi64 "(%%rbp), %%rcx", a.offset);
+            native_copy(n, native_size(n, a.type));
+        }
+
+        // registers are handed out in order, a struct that doesn't fit in what's left goes on the stack
+        if (a.class != NcMemory && regs + words <= NATIVE_MAX_ARGS) {
+            a.reg = regs;
+            regs += words;
+        } else {
+            a.reg = NATIVE_MAX_ARGS;
+            a.stack = *stack;
+            *stack += words * 8;
+        }
+        arrpush(*args, a);
+    }
+    return true;
+}
+
+static bool native_call(Native *n, Expr *expr, Type *out) {
+    assert(expr->kind == EkFnCall);
+
+    if (expr->fncall.name->kind != EkIdent) {
+        return native_fail(n, expr->cursors_idx, "call can't be compiled natively");
+    }
+    const char *name = expr->fncall.name->ident;
+
+    Stmnt decl = ast_find_decl(n->ast, name);
+    if (decl.kind != SkFnDecl) {
+        return native_fail(n, expr->cursors_idx, "expected \"%s\" to be a function", name);
+    }
+    FnDecl fndecl = decl.fndecl;
+
+    if (expr->fncall.arg_kind == LitkVars || arrlenu(expr->fncall.args.exprs) != arrlenu(fndecl.args)) {
+        return native_fail(n, expr->cursors_idx, "arguments to \"%s\" can't be compiled natively", name);
+    }
+
+    NativeClass ret = NcScalar;
+    if (fndecl.type.kind != TkVoid && !native_class(n, fndecl.type, expr->cursors_idx, &ret)) return false;
+    if (ret == NcPointer) return native_fail_type(n, fndecl.type, expr->cursors_idx);
+
+    // the hidden pointer is the first argument
+    int64_t result = 0;
+    if (ret == NcMemory) result = native_alloc_words(n, native_size(n, fndecl.type));
+
+    Arr(NativeArg) args = NULL;
+    size_t stack = 0;
+    if (!native_args(n, fndecl, expr->fncall.args.exprs, ret == NcMemory ? 1 : 0, &args, &stack)) {
+        arrfree(args);
+        return false;
+    }
+
+    size_t misaligned = (n->pushed % 2) * 8;
+    size_t reserve = stack + (16 - (misaligned + stack) % 16) % 16;
+    if (reserve != 0) native_op(n, "subq $%zu, %%rsp", reserve);
+
+    for (size_t i = 0; i < arrlenu(args); i++) {
+        NativeArg a = args[i];
+        if (a.reg != NATIVE_MAX_ARGS) continue;
+
+        native_op(n, "leaq %" PRIi64 "(%%rbp), %%rax", a.offset);
+        native_op(n, "leaq %zu(%%rsp), %%rcx", a.stack);
+        native_copy(n, native_words(n, a.type, a.class) * 8);
+    }
+    for (size_t i = 0; i < arrlenu(args); i++) {
+        NativeArg a = args[i];
+        if (a.reg == NATIVE_MAX_ARGS) continue;
+        native_words_to_regs(n, a.offset, native_words(n, a.type, a.class), &native_arg_regs[a.reg]);
+    }
+    if (ret == NcMemory) native_op(n, "leaq %" PRIi64 "(%%rbp), %%rdi", result);
+    arrfree(args);
+
+    // the number of vector registers used, for variadic functions
+    native_op(n, "xorl %%eax, %%eax");
+    native_op(n, "call %s@PLT", name);
+    if (reserve != 0) native_op(n, "addq $%zu, %%rsp", reserve);
+
+    if (ret == NcScalar && fndecl.type.kind != TkVoid) {
+        // only the bits of the return type are defined
+        native_extend(n, fndecl.type, NrAx);
+    } else if (ret == NcRegs) {
+        static const NativeReg ret_regs[] = {NrAx, NrDx};
+        result = native_alloc_words(n, native_size(n, fndecl.type));
+        native_regs_to_words(n, result, native_words(n, fndecl.type, ret), ret_regs);
+        native_op(n, "leaq %" PRIi64 "(%%rbp), %%rax", result);
+    } else if (ret == NcMemory) {
+        native_op(n, "leaq %" PRIi64 "(%%rbp), %%rax", result);
+    }
+
+    *out = fndecl.type;
+    return true;
+}
+
+static bool native_sizeof(Native *n, Expr *expr, Type *out) {
+    Expr *of = expr->unop.val->kind == EkGrouping ? expr->unop.val->group : expr->unop.val;
+
+    ConstValue size = {.type = type_integer(TkUsize, TYPEVAR, 0)};
+    NativeLocal *local = of->kind == EkIdent ? native_find_local(n, of->ident) : NULL;
+
+    if (local != NULL) {
+        // an array argument is a pointer in C
+        size.u = local->indirect ? 8 : native_size(n, local->type);
+    } else if (!eval_value(n->sema, expr, &size)) {
+        return native_fail(n, expr->cursors_idx, "size is not known at compile time");
+    }
+
+    native_imm(n, size.u, NrAx);
+    *out = size.type;
+    return true;
+}
+
+static bool native_unop(Native *n, Expr *expr, Type *out) {
+    assert(expr->kind == EkUnop);
+
+    switch (expr->unop.kind) {
+        case UkSizeof:
+            return native_sizeof(n, expr, out);
+        case UkAddress: {
+            Type type;
+            if (!native_addr(n, expr->unop.val, &type)) return false;
+
+            Type *to = arena_alloc(&ast_arena, sizeof(Type));
+            *to = type;
+            *out = type_ptr(to, TYPEVAR, expr->cursors_idx);
+            return true;
+        }
+        case UkCast: {
+            Type val;
+            if (!native_value(n, expr->unop.val, &val)) return false;
+            if (!native_scalar(n, expr->type)) return native_fail_type(n, expr->type, expr->cursors_idx);
+
+            native_convert(n, val, expr->type, NrAx);
+            *out = expr->type;
+            return true;
+        }
+        case UkNot: {
+            Type val;
+            if (!native_value(n, expr->unop.val, &val)) return false;
+
+            native_op(n, "testq %%rax, %%rax");
+            native_op(n, "sete %%al");
+            native_op(n, "movzbl %%al, %%eax");
+            *out = type_bool(TYPEVAR, 0);
+            return true;
+        }
+        case UkNegate:
+        case UkBitNot: {
+            Type val;
+            if (!native_value(n, expr->unop.val, &val)) return false;
+            if (val.kind == TkPtr || val.kind == TkCstring) return native_fail_type(n, val, expr->cursors_idx);
+
+            Type type = native_concrete(eval_unop_type(expr->unop.kind, val));
+            native_convert(n, val, type, NrAx);
+            native_op(n, expr->unop.kind == UkNegate ? "negq %%rax" : "notq %%rax");
+            native_extend(n, type, NrAx);
+            *out = type;
+            return true;
+        }
+    }
+
+    assert(false);
+}
+
+static bool native_logical(Native *n, Expr *expr, Type *out) {
+    size_t end = native_label(n);
+    Type type;
+
+    // lhs && rhs is false without evaluating rhs, lhs || rhs is true
+    if (!native_value(n, expr->binop.left, &type)) return false;
+    native_convert(n, type, type_bool(TYPEVAR, 0), NrAx);
+    native_op(n, "testq %%rax, %%rax");
+    native_op(n, expr->binop.kind == BkAnd ? "je .L%zu" : "jne .L%zu", end);
+
+    if (!native_value(n, expr->binop.right, &type)) return false;
+    native_convert(n, type, type_bool(TYPEVAR, 0), NrAx);
+    native_place(n, end);
+
+    *out = type_bool(TYPEVAR, 0);
+    return true;
+}
+
+static bool native_binop(Native *n, Expr *expr, Type *out) {
+    assert(expr->kind == EkBinop);
+    BinopKind kind = expr->binop.kind;
+    if (kind == BkAnd || kind == BkOr) return native_logical(n, expr, out);
+
+    Type lhs, rhs;
+    if (!native_value(n, expr->binop.left, &lhs)) return false;
+    native_push(n);
+    if (!native_value(n, expr->binop.right, &rhs)) return false;
+    native_op(n, "movq %%rax, %%rcx");
+    native_pop(n, NrAx);
+
+    bool pointers = lhs.kind == TkPtr || lhs.kind == TkCstring || rhs.kind == TkPtr || rhs.kind == TkCstring;
+    if (pointers && kind != BkEquals && kind != BkInequals) {
+        return native_fail(n, expr->cursors_idx, "pointer arithmetic can't be compiled natively");
+    }
+
+    // operands are converted to the usual arithmetic type, shifts only promote the lhs
+    Type common = pointers ? type_integer(TkU64, TYPEVAR, 0) : native_concrete(eval_binop_type(BkPlus, lhs, rhs));
+    if (kind == BkLeftShift || kind == BkRightShift) common = native_concrete(eval_binop_type(kind, lhs, rhs));
+    native_convert(n, lhs, common, NrAx);
+    if (kind != BkLeftShift && kind != BkRightShift) native_convert(n, rhs, common, NrCx);
+
+    bool sign = native_signed(common);
+    switch (kind) {
+        case BkPlus:
+            native_op(n, "addq %%rcx, %%rax");
+            break;
+        case BkMinus:
+            native_op(n, "subq %%rcx, %%rax");
+            break;
+        case BkMultiply:
+            native_op(n, "imulq %%rcx, %%rax");
+            break;
+        case BkDivide:
+        case BkMod:
+            if (sign) {
+                native_op(n, "cqto");
+                native_op(n, "idivq %%rcx");
+            } else {
+                native_op(n, "xorl %%edx, %%edx");
+                native_op(n, "divq %%rcx");
+            }
+            if (kind == BkMod) native_op(n, "movq %%rdx, %%rax");
+            break;
+        case BkBitOr:
+            native_op(n, "orq %%rcx, %%rax");
+            break;
+        case BkBitAnd:
+            native_op(n, "andq %%rcx, %%rax");
+            break;
+        case BkBitXor:
+            native_op(n, "xorq %%rcx, %%rax");
+            break;
+        case BkLeftShift:
+            native_op(n, "salq %%cl, %%rax");
+            break;
+        case BkRightShift:
+            native_op(n, sign ? "sarq %%cl, %%rax" : "shrq %%cl, %%rax");
+            break;
+        case BkLess:
+        case BkLessEqual:
+        case BkGreater:
+        case BkGreaterEqual:
+        case BkEquals:
+        case BkInequals: {
+            const char *cc = "";
+            switch (kind) {
+                case BkLess: cc = sign ? "l" : "b"; break;
+                case BkLessEqual: cc = sign ? "le" : "be"; break;
+                case BkGreater: cc = sign ? "g" : "a"; break;
+                case BkGreaterEqual: cc = sign ? "ge" : "ae"; break;
+                case BkEquals: cc = "e"; break;
+                default: cc = "ne"; break;
+            }
+            native_op(n, "cmpq %%rcx, %%rax");
+            native_op(n, "set%s %%al", cc);
+            native_op(n, "movzbl %%al, %%eax");
+            *out = type_bool(TYPEVAR, 0);
+            return true;
+        }
+        case BkAnd:
+        case BkOr:
+            assert(false && "handled in native_logical");
+    }
+
+    native_extend(n, common, NrAx);
+    *out = common;
+    return true;
+}
+
+// scalars end up in rax, arrays and structs leave their address there
+static bool native_expr(Native *n, Expr *expr, Type *out) {
+    switch (expr->kind) {
+        case EkIntLit:
+        case EkCharLit:
+        case EkTrue:
+        case EkFalse: {
+            ConstValue value;
+            if (!eval_value(n->sema, expr, &value)) {
+                return native_fail(n, expr->cursors_idx, "literal can't be compiled natively");
+            }
+
+            native_imm(n, value.u, NrAx);
+            *out = native_concrete(value.type);
+            return true;
+        }
+        case EkCstrLit: {
+            size_t label = native_label(n);
+            native_string(n, expr->cstrlit, label);
+            native_op(n, "leaq .L%zu(%%rip), %%rax", label);
+            *out = type_cstring(TYPEVAR, 0);
+            return true;
+        }
+        case EkGrouping:
+            return native_expr(n, expr->group, out);
+        case EkIdent:
+            return native_ident(n, expr, out);
+        case EkFieldAccess: {
+            Expr *accessing = expr->fieldacc.accessing;
+
+            // <enum>.<field> and .<field>
+            if (!expr->fieldacc.deref && (accessing->kind == EkNone || (accessing->kind == EkIdent && native_find_local(n, accessing->ident) == NULL))) {
+                ConstValue value;
+                if (eval_value(n->sema, expr, &value)) {
+                    native_imm(n, value.u, NrAx);
+                    *out = value.type;
+                    return true;
+                }
+            }
+
+            // <array>.len, same as gen
+            Type array = accessing->type.kind == TkPtr ? *accessing->type.ptr_to : accessing->type;
+            if (!expr->fieldacc.deref && array.kind == TkArray && streq(expr->fieldacc.field->ident, "len")) {
+                if (!native_check_type(n, array, expr->cursors_idx)) return false;
+                native_imm(n, array.array.len->intlit, NrAx);
+                *out = type_integer(TkUsize, TYPEVAR, 0);
+                return true;
+            }
+
+            if (!native_field_addr(n, expr, out)) return false;
+            if (native_scalar(n, *out)) native_load(n, *out, "(%rax)");
+            return true;
+        }
+        case EkArrayIndex:
+            if (!native_index_addr(n, expr, out)) return false;
+            if (native_scalar(n, *out)) native_load(n, *out, "(%rax)");
+            return true;
+        case EkLiteral: {
+            if (native_scalar(n, expr->type) || !native_check_type(n, expr->type, expr->cursors_idx)) {
+                return native_fail(n, expr->cursors_idx, "literal can't be compiled natively");
+            }
+
+            int64_t offset = native_alloc(n, expr->type);
+            if (!native_init(n, expr->type, expr, offset)) return false;
+            native_op(n, "leaq %" PRIi64 "(%%rbp), %%rax", offset);
+            *out = expr->type;
+            return true;
+        }
+        case EkFnCall:
+            return native_call(n, expr, out);
+        case EkUnop:
+            return native_unop(n, expr, out);
+        case EkBinop:
+            return native_binop(n, expr, out);
+        case EkFloatLit:
+            return native_fail(n, expr->cursors_idx, "floats can't be compiled natively");
+        case EkStrLit:
+            return native_fail(n, expr->cursors_idx, "strings can't be compiled natively");
+        case EkArraySlice:
+        case EkRangeLit:
+            return native_fail(n, expr->cursors_idx, "slices can't be compiled natively");
+        case EkNull:
+            return native_fail(n, expr->cursors_idx, "options can't be compiled natively");
+        case EkNone:
+        case EkType:
+            return native_fail(n, expr->cursors_idx, "expression can't be compiled natively");
+    }
+
+    assert(false);
+}
+
+static bool native_reassign(Native *n, Stmnt *stmnt) {
+    Expr *name = &stmnt->varreassign.name;
+
+    Type type;
+    if (!native_addr(n, name, &type)) return false;
+    native_push(n);
+
+    Type from;
+    if (!native_expr(n, &stmnt->varreassign.value, &from)) return false;
+
+    if (!native_scalar(n, type)) {
+        if (native_scalar(n, from)) return native_fail_type(n, from, stmnt->cursors_idx);
+        native_pop(n, NrCx);
+        native_copy(n, native_size(n, type));
+        return true;
+    }
+
+    if (!native_scalar(n, from)) return native_fail_type(n, from, stmnt->cursors_idx);
+    native_convert(n, from, type, NrAx);
+    native_pop(n, NrCx);
+    native_store(n, type, NrAx, "(%rcx)");
+    return true;
+}
+
+static bool native_return(Native *n, Stmnt *stmnt) {
+    Expr *value = &stmnt->returnf.value;
+
+    if (value->kind != EkNone) {
+        Type from;
+        if (n->ret_class == NcScalar) {
+            if (!native_value(n, value, &from)) return false;
+            native_convert(n, from, n->ret, NrAx);
+        } else {
+            if (!native_expr(n, value, &from)) return false;
+            if (native_scalar(n, from)) return native_fail_type(n, from, value->cursors_idx);
+
+            size_t size = native_size(n, n->ret);
+            if (n->ret_class == NcRegs) {
+                // copied out first so nothing past the end of the struct is read
+                static const NativeReg ret_regs[] = {NrAx, NrDx};
+                int64_t words = native_alloc_words(n, size);
+                native_op(n, "leaq %" PRIi64 "(%%rbp), %%rcx", words);
+                native_copy(n, size);
+                native_words_to_regs(n, words, native_words(n, n->ret, n->ret_class), ret_regs);
+            } else {
+                native_op(n, "movq %" PRIi64 "(%%rbp), %%rcx", n->ret_ptr);
+                native_copy(n, size);
+                native_op(n, "movq %" PRIi64 "(%%rbp), %%rax", n->ret_ptr);
+            }
+        }
+    }
+
+    native_op(n, "jmp .L%zu", n->ret_label);
+    return true;
+}
+
+static bool native_condition(Native *n, Expr *condition, size_t if_false) {
+    Type type;
+    if (!native_value(n, condition, &type)) return false;
+
+    native_op(n, "testq %%rax, %%rax");
+    native_op(n, "je .L%zu", if_false);
+    return true;
+}
+
+static bool native_if(Native *n, Stmnt *stmnt) {
+    If *iff = &stmnt->iff;
+    if (iff->capturekind != CkNone) {
+        return native_fail(n, stmnt->cursors_idx, "if captures can't be compiled natively");
+    }
+
+    size_t els = native_label(n);
+    if (!native_condition(n, &iff->condition, els)) return false;
+    if (!native_block(n, iff->body)) return false;
+
+    if (iff->els == NULL) {
+        native_place(n, els);
+        return true;
+    }
+
+    size_t end = native_label(n);
+    native_op(n, "jmp .L%zu", end);
+    native_place(n, els);
+    if (!native_block(n, iff->els)) return false;
+    native_place(n, end);
+    return true;
+}
+
+static bool native_local(Native *n, Stmnt *stmnt) {
+    VarDecl decl = stmnt->vardecl;
+    if (!native_check_type(n, decl.type, stmnt->cursors_idx)) return false;
+
+    int64_t offset = native_alloc(n, decl.type);
+    if (!native_init(n, decl.type, &decl.value, offset)) return false;
+    arrpush(n->locals, ((NativeLocal){.name = decl.name.ident, .offset = offset, .type = decl.type}));
+    return true;
+}
+
+static bool native_for(Native *n, Stmnt *stmnt) {
+    For *forf = &stmnt->forf;
+    size_t locals = arrlenu(n->locals);
+    size_t breaks = arrlenu(n->breaks);
+    size_t continues = arrlenu(n->continues);
+
+    // the loop variable stays in scope for the whole loop
+    if (forf->decl != NULL && forf->decl->kind == SkVarDecl) {
+        if (!native_local(n, forf->decl)) return false;
+    }
+
+    size_t top = native_label(n);
+    size_t next = native_label(n);
+    size_t end = native_label(n);
+    arrpush(n->breaks, end);
+    arrpush(n->continues, next);
+
+    native_place(n, top);
+    if (forf->condition.kind != EkNone) {
+        if (!native_condition(n, &forf->condition, end)) return false;
+    }
+
+    if (!native_block(n, forf->body)) return false;
+
+    native_place(n, next);
+    if (forf->reassign != NULL && forf->reassign->kind == SkVarReassign) {
+        native_loc(n, forf->reassign->cursors_idx);
+        if (!native_reassign(n, forf->reassign)) return false;
+    }
+    native_op(n, "jmp .L%zu", top);
+    native_place(n, end);
+
+    arrsetlen(n->breaks, breaks);
+    arrsetlen(n->continues, continues);
+    arrsetlen(n->locals, locals);
+    return true;
+}
+
+static bool native_switch(Native *n, Stmnt *stmnt) {
+    Switch *sw = &stmnt->switchf;
+
+    Type type;
+    if (!native_value(n, &sw->value, &type)) return false;
+    if (type.kind == TkPtr || type.kind == TkCstring) return native_fail_type(n, type, stmnt->cursors_idx);
+
+    // ranges hold two's complement bits, values are already extended to 64 bits
+    native_op(n, "movq %%rax, %%rdx");
+
+    size_t base = n->labels;
+    n->labels += arrlenu(sw->cases);
+    size_t end = native_label(n);
+
+    for (size_t i = 0; i < arrlenu(sw->ranges); i++) {
+        CaseRange range = sw->ranges[i];
+        size_t next = native_label(n);
+
+        native_imm(n, range.lo, NrCx);
+        native_op(n, "cmpq %%rcx, %%rdx");
+        if (range.lo == range.hi) {
+            native_op(n, "jne .L%zu", next);
+        } else {
+            native_op(n, sw->is_signed ? "jl .L%zu" : "jb .L%zu", next);
+            native_imm(n, range.hi, NrCx);
+            native_op(n, "cmpq %%rcx, %%rdx");
+            native_op(n, sw->is_signed ? "jg .L%zu" : "ja .L%zu", next);
+        }
+        native_op(n, "jmp .L%zu", base + range.case_idx);
+        native_place(n, next);
+    }
+
+    size_t no_match = end;
+    for (size_t i = 0; i < arrlenu(sw->cases); i++) {
+        if (sw->cases[i].values == NULL) no_match = base + i;
+    }
+    native_op(n, "jmp .L%zu", no_match);
+
+    for (size_t i = 0; i < arrlenu(sw->cases); i++) {
+        Case *c = &sw->cases[i];
+        if (c->capture.kind != EkNone) {
+            return native_fail(n, c->cursors_idx, "switch captures can't be compiled natively");
+        }
+
+        native_place(n, base + i);
+        if (!native_block(n, c->body)) return false;
+        native_op(n, "jmp .L%zu", end);
+    }
+
+    native_place(n, end);
+    return true;
+}
+
+static bool native_stmnt(Native *n, Stmnt *stmnt) {
+    assert(n->pushed == 0);
+    if (stmnt->kind != SkNone && stmnt->kind != SkBlock && stmnt->kind != SkDirective) {
+        native_loc(n, stmnt->cursors_idx);
+    }
+
+    switch (stmnt->kind) {
+        case SkNone:
+        case SkDirective:
+            return true;
+        case SkVarDecl:
+        case SkConstDecl:
+            return native_local(n, stmnt);
+        case SkVarReassign:
+            return native_reassign(n, stmnt);
+        case SkReturn:
+            return native_return(n, stmnt);
+        case SkIf:
+            return native_if(n, stmnt);
+        case SkFor:
+            return native_for(n, stmnt);
+        case SkSwitch:
+            return native_switch(n, stmnt);
+        case SkBreak:
+            if (arrlenu(n->breaks) == 0) return native_fail(n, stmnt->cursors_idx, "break outside of a loop");
+            native_op(n, "jmp .L%zu", arrlast(n->breaks));
+            return true;
+        case SkContinue:
+            if (arrlenu(n->continues) == 0) return native_fail(n, stmnt->cursors_idx, "continue outside of a loop");
+            native_op(n, "jmp .L%zu", arrlast(n->continues));
+            return true;
+        case SkBlock:
+            return native_block(n, stmnt->block);
+        case SkFnCall: {
+            Expr call = expr_fncall(stmnt->fncall, type_none(), stmnt->cursors_idx);
+            Type type;
+            return native_call(n, &call, &type);
+        }
+        case SkDefer:
+            return native_fail(n, stmnt->cursors_idx, "defer can't be compiled natively");
+        case SkExtern:
+        case SkFnDecl:
+        case SkStructDecl:
+        case SkEnumDecl:
+        case SkUnionDecl:
+            return native_fail(n, stmnt->cursors_idx, "statement can't be compiled natively");
+    }
+
+    assert(false);
+}
+
+static bool native_block(Native *n, Arr(Stmnt) body) {
+    size_t locals = arrlenu(n->locals);
+
+    for (size_t i = 0; i < arrlenu(body); i++) {
+        if (!native_stmnt(n, &body[i])) return false;
+    }
+
+    arrsetlen(n->locals, locals);
+    return true;
+}
+
+static bool native_fn(Native *n, Stmnt stmnt) {
+    FnDecl fndecl = stmnt.fndecl;
+    const char *name = fndecl.name.ident;
+    bool is_main = streq(name, "main");
+
+    if (is_main && arrlenu(fndecl.args) != 0) {
+        return native_fail(n, stmnt.cursors_idx, "main's arguments can't be compiled natively");
+    }
+
+    arrfree(n->body);
+    arrfree(n->locals);
+    n->frame = 0;
+    n->pushed = 0;
+    n->ret = fndecl.type;
+    n->ret_class = NcScalar;
+    n->ret_label = native_label(n);
+
+    if (fndecl.type.kind != TkVoid && !native_class(n, fndecl.type, stmnt.cursors_idx, &n->ret_class)) return false;
+    if (n->ret_class == NcPointer) return native_fail_type(n, fndecl.type, stmnt.cursors_idx);
+
+    native_loc(n, stmnt.cursors_idx);
+    size_t regs = 0;
+    if (n->ret_class == NcMemory) {
+        n->ret_ptr = native_alloc_words(n, 8);
+        native_regs_to_words(n, n->ret_ptr, 1, native_arg_regs);
+        regs = 1;
+    }
+
+    // past the saved rbp and the return address
+    int64_t stack = 16;
+    for (size_t i = 0; i < arrlenu(fndecl.args); i++) {
+        Stmnt arg = fndecl.args[i];
+        NativeLocal local = {.name = arg.constdecl.name.ident, .type = arg.constdecl.type};
+
+        NativeClass class;
+        if (!native_class(n, local.type, arg.cursors_idx, &class)) return false;
+        size_t words = native_words(n, local.type, class);
+        local.indirect = class == NcPointer;
+
+        if (class != NcMemory && regs + words <= NATIVE_MAX_ARGS) {
+            if (class == NcScalar) {
+                local.offset = native_alloc(n, local.type);
+                char mem[32];
+                snprintf(mem, sizeof(mem), "%" PRIi64 "(%%rbp)", local.offset);
+                native_store(n, local.type, native_arg_regs[regs], mem);
+            } else {
+                local.offset = native_alloc_words(n, words * 8);
+                native_regs_to_words(n, local.offset, words, &native_arg_regs[regs]);
+            }
+            regs += words;
+        } else {
+            local.offset = stack;
+            stack += (int64_t)words * 8;
+        }
+        arrpush(n->locals, local);
+    }
+
+    if (!native_block(n, fndecl.body)) return false;
+
+    native_place(n, n->ret_label);
+    if (is_main) native_op(n, "xorl %%eax, %%eax");
+    native_op(n, "leave");
+    native_op(n, "ret");
+
+    size_t frame = (n->frame + 15) / 16 * 16;
+    native_write(&n->text, "\n    .globl %s\n    .type %s, @function\n%s:\n", name, name, name);
+    native_write(&n->text, "    pushq %%rbp\n    movq %%rsp, %%rbp\n");
+    if (frame != 0) native_write(&n->text, "    subq $%zu, %%rsp\n", frame);
+    native_write(&n->text, "%.*s", (int)arrlenu(n->body), n->body);
+    native_write(&n->text, "    .size %s, .-%s\n", name, name);
+    return true;
+}
+
+static bool native_global(Native *n, Stmnt stmnt) {
+    VarDecl decl = stmnt.vardecl;
+    const char *name = decl.name.ident;
+    if (!native_check_type(n, decl.type, stmnt.cursors_idx)) return false;
+
+    size_t size = native_size(n, decl.type);
+    size_t align = layout_alignof(n->ast, decl.type);
+    if (decl.value.kind == EkNone) {
+        native_write(&n->bss, "    .globl %s\n    .balign %zu\n%s:\n    .zero %zu\n", name, align, name, size);
+        return true;
+    }
+
+    // baked by the compiler, same as gen
+    uint8_t *bytes = ealloc(size + 1);
+    memset(bytes, 0, size + 1);
+
+    bool ok = native_static_fill(n, decl.type, &decl.value, bytes);
+    if (ok) {
+        native_write(&n->data, "    .globl %s\n    .balign %zu\n%s:\n    .byte ", name, align, name);
+        for (size_t i = 0; i < size; i++) {
+            native_write(&n->data, i + 1 == size ? "%u\n" : "%u,", bytes[i]);
+        }
+    }
+
+    free(bytes);
+    return ok;
+}
+
+static void native_collect(Arr(Stmnt) body, Arr(Stmnt) *directives) {
+    for (size_t i = 0; i < arrlenu(body); i++) {
+        Stmnt stmnt = body[i];
+        switch (stmnt.kind) {
+            case SkDirective:
+                arrpush(*directives, stmnt);
+                break;
+            case SkFnDecl:
+                native_collect(stmnt.fndecl.body, directives);
+                break;
+            case SkBlock:
+                native_collect(stmnt.block, directives);
+                break;
+            case SkIf:
+                native_collect(stmnt.iff.body, directives);
+                native_collect(stmnt.iff.els, directives);
+                break;
+            case SkFor:
+                native_collect(stmnt.forf.body, directives);
+                break;
+            case SkSwitch:
+                for (size_t j = 0; j < arrlenu(stmnt.switchf.cases); j++) {
+                    native_collect(stmnt.switchf.cases[j].body, directives);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+Arr(Stmnt) native_directives(Arr(Stmnt) ast) {
+    Arr(Stmnt) directives = NULL;
+    native_collect(ast, &directives);
+    return directives;
+}
+
+static void native_free(Native *n) {
+    arrfree(n->text);
+    arrfree(n->rodata);
+    arrfree(n->data);
+    arrfree(n->bss);
+    shfree(n->files);
+    shfree(n->statics);
+    arrfree(n->body);
+    arrfree(n->locals);
+    arrfree(n->breaks);
+    arrfree(n->continues);
+    strbfree(n->why);
+}
+
+bool native_generate(Sema *sema, bool debug, strb *out, strb *why, size_t *cursor_idx) {
+    Native n = {
+        .sema = sema,
+        .ast = sema->ast,
+        .debug = debug,
+    };
+    sh_new_arena(n.files);
+
+#if !defined(__x86_64__) || !defined(__linux__)
+    native_fail(&n, 0, "the native backend only targets x86-64 linux");
+#endif
+
+    native_write(&n.text, "    .text\n");
+    for (size_t i = 0; i < arrlenu(n.ast) && n.why == NULL; i++) {
+        Stmnt stmnt = n.ast[i];
+        switch (stmnt.kind) {
+            case SkFnDecl:
+                // C can't return arrays, every call to these was evaluated at compile time
+                if (stmnt.fndecl.type.kind == TkArray || !stmnt.fndecl.has_body) break;
+                native_fn(&n, stmnt);
+                break;
+            case SkVarDecl:
+                native_global(&n, stmnt);
+                break;
+            case SkExtern:
+                if (stmnt.externf->kind != SkFnDecl) {
+                    native_fail(&n, stmnt.cursors_idx, "extern variables can't be compiled natively");
+                }
+                break;
+            case SkConstDecl:
+            case SkStructDecl:
+            case SkEnumDecl:
+            case SkUnionDecl:
+            case SkDirective:
+                break;
+            default:
+                native_fail(&n, stmnt.cursors_idx, "statement can't be compiled natively");
+                break;
+        }
+    }
+
+    bool ok = n.why == NULL;
+    if (ok) {
+        native_write(&n.text, "\n    .section .rodata\n%.*s", (int)arrlenu(n.rodata), n.rodata);
+        native_write(&n.text, "\n    .data\n%.*s", (int)arrlenu(n.data), n.data);
+        native_write(&n.text, "\n    .bss\n%.*s", (int)arrlenu(n.bss), n.bss);
+        native_write(&n.text, "\n    .section .note.GNU-stack,\"\",@progbits\n");
+
+        arrpush(n.text, '\0');
+        strbappend(out, n.text);
+    } else {
+        strbprintf(why, "%s", n.why);
+        *cursor_idx = n.why_cursor;
+    }
+
+    native_free(&n);
+    return ok;
+}
@@ -1,10 +1,13 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "include/arena.h"
 #include "include/exprs.h"
 #include "include/keywords.h"
+#include "include/module.h"
 #include "include/parser.h"
 #include "include/lexer.h"
 #include "include/stmnts.h"
@@ -16,7 +19,13 @@
 #define ERRORS_MAX 5
 
 static void warn(Parser *parser, size_t i, const char *msg, ...) {
-    eprintf("%s:%lu:%lu " TERM_YELLOW "warning" TERM_END ": ", parser->filename, parser->cursors[i].row, parser->cursors[i].col);
+    (void)parser;
+    Cursor cursor;
+    const char *filename = module_cursor(i, &cursor);
+
+    // modules are parsed in parallel, keep the lines of one message together
+    flockfile(stderr);
+    eprintf("%s:%lu:%lu " TERM_YELLOW "warning" TERM_END ": ", filename, cursor.row, cursor.col);
 
     va_list args;
     va_start(args, msg);
@@ -24,11 +33,16 @@ static void warn(Parser *parser, size_t i, const char *msg, ...) {
     veprintfln(msg, args);
 
     va_end(args);
+    funlockfile(stderr);
 }
 
 static void elog(Parser *parser, size_t i, const char *msg, ...) {
     parser->error_count++;
-    eprintf("%s:%lu:%lu " TERM_RED "error" TERM_END ": ", parser->filename, parser->cursors[i].row, parser->cursors[i].col);
+    Cursor cursor;
+    const char *filename = module_cursor(i, &cursor);
+
+    flockfile(stderr);
+    eprintf("%s:%lu:%lu " TERM_RED "error" TERM_END ": ", filename, cursor.row, cursor.col);
 
     va_list args;
     va_start(args, msg);
@@ -36,6 +50,7 @@ static void elog(Parser *parser, size_t i, const char *msg, ...) {
     veprintfln(msg, args);
 
     va_end(args);
+    funlockfile(stderr);
 
     if (parser->error_count > ERRORS_MAX) {
         exit(1);
@@ -49,7 +64,7 @@ Expr expr_from_keyword(Parser *parser, Keyword kw) {
         case KwFalse:
             return expr_false((size_t)parser->cursors_idx);
         case KwNull: {
-            Type *subtype = ealloc(sizeof(Type)); subtype->kind = TkNone;
+            Type *subtype = arena_alloc(&ast_arena, sizeof(Type)); subtype->kind = TkNone;
             return expr_null(
                 type_option(
                     (Option){
@@ -90,6 +105,12 @@ static Directive directive_map(const char *str) {
         return (Directive){ .kind = DkOfast };
     } else if (streq(str, "Osmall")) {
         return (Directive){ .kind = DkOsmall };
+    } else if (streq(str, "reorder")) {
+        return (Directive){ .kind = DkReorder };
+    } else if (streq(str, "if")) {
+        return (Directive){ .kind = DkIf };
+    } else if (streq(str, "import")) {
+        return (Directive){ .kind = DkImport };
     }
 
     return (Directive){ .kind = DkNone };
@@ -103,44 +124,51 @@ Directive parser_get_directive(Parser *parser, const char *word) {
     return d;
 }
 
-Parser parser_init(Lexer lex, const char *filename) {
+// first_token is the cursor index of the lexer's first token, every module gets its own range
+Parser parser_init(Lexer *lex, size_t first_token) {
     return (Parser){
-        .tokens = lex.tokens,
+        .tokens = lex->tokens,
+        .tokens_idx = 0,
         .in_func_decl_args = false,
         .in_enum_decl = false,
+        .in_case_values = false,
 
-        .filename = filename,
-        .cursors = lex.cursors,
-        .cursors_idx = -1,
+        .templates = NULL,
+        .instances = NULL,
+        .instance_map = NULL,
+        .subst_names = NULL,
+        .subst_types = NULL,
+
+        .lex = lex,
+        .cursors_idx = (long)first_token - 1,
         .error_count = 0,
     };
 }
 
-Token peek(Parser *parser) {
-    if (arrlen(parser->tokens) == 0) {
+// n tokens ahead of the next one
+Token peek_nth(Parser *parser, size_t n) {
+    if (parser->tokens_idx + n >= arrlenu(parser->tokens)) {
         return token_none();
     }
 
-    return parser->tokens[0];
+    return parser->tokens[parser->tokens_idx + n];
 }
 
-Token peek_after(Parser *parser) {
-    if (arrlen(parser->tokens) == 0) {
-        return token_none();
-    }
+Token peek(Parser *parser) {
+    return peek_nth(parser, 0);
+}
 
-    return parser->tokens[1];
+Token peek_after(Parser *parser) {
+    return peek_nth(parser, 1);
 }
 
 Token next(Parser *parser) {
-    if (arrlen(parser->tokens) == 0) {
+    if (parser->tokens_idx >= arrlenu(parser->tokens)) {
         return token_none();
     }
 
     parser->cursors_idx += 1;
-    Token tok = parser->tokens[0];
-    arrdel(parser->tokens, 0);
-    return tok;
+    return parser->tokens[parser->tokens_idx++];
 }
 
 Token expect(Parser *parser, TokenKind expected) {
@@ -190,7 +218,7 @@ static Identifiers convert_ident(Parser *parser, Token tok) {
         };
     }
 
-    Keyword k = keyword_map(tok.ident);
+    Keyword k = keyword_map(token_text(parser->lex, tok));
     if (k != KwNone) {
         return (Identifiers){
             .kind = IkKeyword,
@@ -198,7 +226,7 @@ static Identifiers convert_ident(Parser *parser, Token tok) {
         };
     }
 
-    Type t = type_from_string(tok.ident);
+    Type t = type_from_string(token_text(parser->lex, tok));
     if (t.kind != TkNone) {
         return (Identifiers){
             .kind = IkType,
@@ -208,7 +236,7 @@ static Identifiers convert_ident(Parser *parser, Token tok) {
 
     return (Identifiers){
         .kind = IkIdent,
-        .expr = expr_ident(tok.ident, type_none(), (size_t)parser->cursors_idx),
+        .expr = expr_ident(token_text(parser->lex, tok), type_none(), (size_t)parser->cursors_idx),
     };
 }
 
@@ -323,6 +351,105 @@ Type typedef_from_ident(Expr ident) {
     return type_typedef(ident.ident, TYPEVAR, ident.cursors_idx);
 }
 
+// T inside a generic being instantiated
+bool parser_subst(Parser *parser, const char *name, Type *out) {
+    for (size_t i = 0; i < arrlenu(parser->subst_names); i++) {
+        if (streq(parser->subst_names[i], name)) {
+            *out = parser->subst_types[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+// part of an instance's name, every distinct type gets a distinct C identifier
+void mangle_type(strb *out, Type type) {
+    switch (type.kind) {
+        case TkTypeDef:
+            strbprintf(out, "%s", type.typedeff);
+            break;
+        case TkPtr:
+            strbprintf(out, type.constant ? "cptr_" : "ptr_");
+            mangle_type(out, *type.ptr_to);
+            break;
+        case TkSlice:
+            strbprintf(out, "slice_");
+            mangle_type(out, *type.slice.of);
+            break;
+        case TkArray:
+            if (type.array.len->kind == EkIntLit) {
+                strbprintf(out, "arr%lu_", type.array.len->intlit);
+            } else {
+                strbprintf(out, "arr_");
+            }
+            mangle_type(out, *type.array.of);
+            break;
+        case TkOption:
+            strbprintf(out, "opt_");
+            mangle_type(out, *type.option.subtype);
+            break;
+        case TkSoa:
+            strbprintf(out, "soa_");
+            mangle_type(out, *type.soa.of);
+            break;
+        default: {
+            strb t = string_from_type(type);
+            strbprintf(out, "%s", t);
+            strbfree(t);
+        } break;
+    }
+}
+
+// <generic>(<args>), the struct and its methods are parsed once per distinct instance by parser_instantiate
+Type parser_instance(Parser *parser, const char *generic, Arr(Type) args, size_t index) {
+    strb name = NULL;
+    strbprintf(&name, "%s", generic);
+    for (size_t i = 0; i < arrlenu(args); i++) {
+        strbprintf(&name, "_");
+        mangle_type(&name, args[i]);
+    }
+
+    ptrdiff_t found = shgeti(parser->instance_map, name);
+    if (found >= 0) {
+        Instance *instance = &parser->instances[parser->instance_map[found].value];
+        instance->uses++;
+
+        strbfree(name);
+        arrfree(args);
+        return type_typedef(instance->name, TYPEVAR, index);
+    }
+
+    shput(parser->instance_map, name, arrlenu(parser->instances));
+    arrpush(parser->instances, ((Instance){
+        .name = name,
+        .generic = generic,
+        .args = args,
+        .uses = 1,
+        .methods = 0,
+        .cursors_idx = index,
+    }));
+
+    return type_typedef(name, TYPEVAR, index);
+}
+
+// <ident>(<types>){, a literal of a generic struct instead of a call
+bool parser_generic_literal(Parser *parser) {
+    if (parser->in_case_values || peek_after(parser).kind != TokLeftBracket) return false;
+
+    size_t depth = 0;
+    for (size_t i = 1; peek_nth(parser, i).kind != TokNone; i++) {
+        Token tok = peek_nth(parser, i);
+        if (tok.kind == TokLeftBracket) {
+            depth++;
+        } else if (tok.kind == TokRightBracket && --depth == 0) {
+            return peek_nth(parser, i + 1).kind == TokLeftCurl;
+        } else if (tok.kind == TokLeftCurl || tok.kind == TokSemiColon) {
+            return false;
+        }
+    }
+    return false;
+}
+
 Type parse_type(Parser *parser) {
     Type type = type_none();
     Token tok = peek(parser);
@@ -332,7 +459,7 @@ Type parse_type(Parser *parser) {
             size_t index = (size_t)parser->cursors_idx;
 
             next(parser);
-            Type *subtype = ealloc(sizeof(Type)); *subtype = parse_type(parser);
+            Type *subtype = arena_alloc(&ast_arena, sizeof(Type)); *subtype = parse_type(parser);
 
             type = type_option((Option){
                 .subtype = subtype,
@@ -342,52 +469,48 @@ Type parse_type(Parser *parser) {
         } break;
         case TokStar:
         case TokCaret: {
-            Type *of = ealloc(sizeof(Type)); of->kind = TkNone;
+            // the pointee is parsed first, the type is interned when it's built
+            size_t index = (size_t)parser->cursors_idx;
+            next(parser);
+            Type *subtype = arena_alloc(&ast_arena, sizeof(Type)); *subtype = parse_type(parser);
 
             type = type_ptr(
-                of,
+                subtype,
                 TYPECONST ? tok.kind == TokCaret : TYPEVAR,
-                (size_t)parser->cursors_idx
+                index
             );
-            next(parser);
-            Type *subtype = ealloc(sizeof(Type)); *subtype = parse_type(parser);
-            type.ptr_to = subtype;
         } break;
         case TokLeftSquare: {
-            Type *of = ealloc(sizeof(Type)); of->kind = TkNone;
             next(parser);
             Token after = peek(parser);
 
+            Expr *len = NULL;
             if (after.kind == TokRightSquare) {
                 next(parser);
-                type = type_slice((Slice){
-                    .of = of,
-                }, TYPEVAR, (size_t)parser->cursors_idx);
             } else {
-                Expr *len = ealloc(sizeof(Expr)); 
-                if (after.kind == TokIntLit) {
-                    *len = parse_expr(parser);
-                    expect(parser, TokRightSquare);
-                } else if (after.kind == TokUnderscore) {
+                len = arena_alloc(&ast_arena, sizeof(Expr));
+                if (after.kind == TokUnderscore) {
                     next(parser);
                     expect(parser, TokRightSquare);
                     len->kind = EkNone;
                 } else {
-                    elog(parser, (size_t)parser->cursors_idx, "expected an integer, underscore, or empty []");
-                    len->kind = EkNone;
+                    // any constant expression, sema folds it to an integer
+                    *len = parse_expr(parser);
+                    expect(parser, TokRightSquare);
                 }
+            }
+            size_t index = (size_t)parser->cursors_idx;
 
+            Type *subtype = arena_alloc(&ast_arena, sizeof(Type)); *subtype = parse_type(parser);
+            if (len == NULL) {
+                type = type_slice((Slice){
+                    .of = subtype,
+                }, TYPEVAR, index);
+            } else {
                 type = type_array((Array){
                     .len = len,
-                    .of = of,
-                }, TYPEVAR, (size_t)parser->cursors_idx);
-            }
-
-            Type *subtype = ealloc(sizeof(Type)); *subtype = parse_type(parser);
-            if (type.kind == TkSlice) {
-                type.slice.of = subtype;
-            } else if (type.kind == TkArray) {
-                type.array.of = subtype;
+                    .of = subtype,
+                }, TYPEVAR, index);
             }
         } break;
         case TokIdent: {
@@ -399,10 +522,52 @@ Type parse_type(Parser *parser) {
             } else if (convert.kind == IkKeyword) {
                 elog(parser, parser->cursors_idx, "expected a type, got %s", tokenkind_stringify(tok.kind));
                 type = type_none();
+            } else if (parser_subst(parser, token_text(parser->lex, tok), &type)) {
+                type.cursors_idx = (size_t)parser->cursors_idx;
+            } else if (peek(parser).kind == TokLeftBracket) {
+                // <generic>(<types>)
+                size_t index = (size_t)parser->cursors_idx;
+                next(parser);
+
+                Arr(Type) args = NULL;
+                while (peek(parser).kind != TokRightBracket && peek(parser).kind != TokNone) {
+                    Type arg = parse_type(parser);
+                    if (arg.kind == TkNone) {
+                        elog(parser, parser->cursors_idx, "expected a type argument for \"%s\"", token_text(parser->lex, tok));
+                        break;
+                    }
+                    arrpush(args, arg);
+
+                    if (peek(parser).kind != TokComma) break;
+                    next(parser);
+                }
+                expect(parser, TokRightBracket);
+
+                type = parser_instance(parser, token_text(parser->lex, tok), args, index);
             } else {
                 type = typedef_from_ident(convert.expr);
             }
         } break;
+        case TokDirective: {
+            // #soa <struct>
+            if (!streq(token_text(parser->lex, tok), "soa")) {
+                elog(parser, parser->cursors_idx, "expected a type, got directive \"#%s\"", token_text(parser->lex, tok));
+                break;
+            }
+
+            next(parser);
+            size_t index = (size_t)parser->cursors_idx;
+            Type *of = arena_alloc(&ast_arena, sizeof(Type)); *of = parse_type(parser);
+            if (of->kind != TkTypeDef) {
+                strb t = string_from_type(*of);
+                elog(parser, parser->cursors_idx, "expected a struct after #soa, got %s", t);
+                strbfree(t);
+            }
+
+            type = type_soa((Soa){
+                .of = of,
+            }, TYPEVAR, index);
+        } break;
         default: break;
     }
 
@@ -431,11 +596,20 @@ Expr parse_primary(Parser *parser) {
         } break;
         case TokIdent: {
             Identifiers convert = convert_ident(parser, tok);
-            if (convert.kind == IkIdent) {
+            Type subst;
+            if (convert.kind == IkIdent && (parser_generic_literal(parser) || parser_subst(parser, token_text(parser->lex, tok), &subst))) {
+                // <generic>(<types>){ or T inside a generic
+                Type type = parse_type(parser);
+                if (peek(parser).kind == TokLeftCurl && !parser->in_case_values) {
+                    next(parser);
+                    return parse_end_literal(parser, type);
+                }
+                return expr_type(type, (size_t)parser->cursors_idx);
+            } else if (convert.kind == IkIdent) {
                 next(parser);
                 tok = peek(parser);
 
-                if (tok.kind == TokDot) {
+                if (tok.kind == TokDot && peek_after(parser).kind != TokDot) {
                     // <ident>.
                     next(parser);
                     return parse_field_access(parser, convert.expr);
@@ -443,7 +617,7 @@ Expr parse_primary(Parser *parser) {
                     // <ident>[
                     next(parser);
                     return parse_array_index(parser, convert.expr);
-                } else if (tok.kind == TokLeftCurl) {
+                } else if (tok.kind == TokLeftCurl && !parser->in_case_values) {
                     // <ident>{
                     // ident must be a typedef
                     next(parser);
@@ -451,7 +625,7 @@ Expr parse_primary(Parser *parser) {
                     return parse_end_literal(parser, type);
                 } else if (streq(convert.expr.ident, "c") && tok.kind == TokStrLit) {
                     next(parser);
-                    return expr_cstrlit(tok.strlit, (size_t)parser->cursors_idx);
+                    return expr_cstrlit(token_text(parser->lex, tok), (size_t)parser->cursors_idx);
                 }
 
                 // <ident>
@@ -470,14 +644,14 @@ Expr parse_primary(Parser *parser) {
                     return expr_type(type, (size_t)parser->cursors_idx);
                 }
             } else {
-                elog(parser, parser->cursors_idx, "unexpected identifier %s", tok.ident);
+                elog(parser, parser->cursors_idx, "unexpected identifier %s", token_text(parser->lex, tok));
                 return expr_none();
             }
         } break;
         case TokIntLit: {
             next(parser);
             return expr_intlit(
-                tok.numlit,
+                token_int(parser->lex, tok),
                 type_integer(
                     TkUntypedInt,
                     TYPECONST,
@@ -489,7 +663,7 @@ Expr parse_primary(Parser *parser) {
         case TokFloatLit: {
             next(parser);
             Expr expr = expr_floatlit(
-                tok.numlit,
+                token_number(parser->lex, tok),
                 type_decimal(
                     TkUntypedFloat,
                     TYPECONST,
@@ -501,16 +675,16 @@ Expr parse_primary(Parser *parser) {
         } break;
         case TokCharLit: {
             next(parser);
-            return expr_charlit(tok.charlit, (size_t)parser->cursors_idx);
+            return expr_charlit(token_char(parser->lex, tok), (size_t)parser->cursors_idx);
         } break;
         case TokStrLit: {
             next(parser);
-            return expr_strlit(tok.strlit, (size_t)parser->cursors_idx);
+            return expr_strlit(token_text(parser->lex, tok), (size_t)parser->cursors_idx);
         } break;
         case TokLeftBracket: {
             next(parser);
             size_t index = (size_t)parser->cursors_idx;
-            Expr *expr = ealloc(sizeof(Expr)); *expr = parse_expr(parser);
+            Expr *expr = arena_alloc(&ast_arena, sizeof(Expr)); *expr = parse_expr(parser);
             expect(parser, TokRightBracket);
 
             return expr_group(expr, type_none(), index);
@@ -573,7 +747,7 @@ Expr parse_end_fn_call(Parser *parser, Expr ident) {
     }
 
     expect(parser, TokRightBracket);
-    Expr *name = ealloc(sizeof(Expr)); *name = ident;
+    Expr *name = arena_alloc(&ast_arena, sizeof(Expr)); *name = ident;
     FnCall fncall = {
         .name = name,
     };
@@ -626,7 +800,7 @@ Expr parse_unary(Parser *parser) {
         op.kind != TokAmpersand &&
         op.kind != TokTilde
     ) {
-        if (op.kind == TokIdent && (streq(op.ident, "cast") || streq(op.ident, "sizeof"))) {
+        if (op.kind == TokIdent && (streq(token_text(parser->lex, op), "cast") || streq(token_text(parser->lex, op), "sizeof"))) {
             goto resume;
         }
         return parse_fn_call(parser, expr_none());
@@ -635,12 +809,12 @@ Expr parse_unary(Parser *parser) {
 resume:
     next(parser);
     // handle cast first
-    if (op.kind == TokIdent && streq(op.ident, "cast")) {
+    if (op.kind == TokIdent && streq(token_text(parser->lex, op), "cast")) {
         expect(parser, TokLeftBracket);
         Type type = parse_type(parser);
         expect(parser, TokRightBracket);
 
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_unary(parser);
+        Expr *right = arena_alloc(&ast_arena, sizeof(Expr)); *right = parse_unary(parser);
 
         return expr_unop((Unop){
             .kind = UkCast,
@@ -648,7 +822,7 @@ resume:
         }, type, index);
     }
 
-    Expr *right = ealloc(sizeof(Expr)); *right = parse_unary(parser);
+    Expr *right = arena_alloc(&ast_arena, sizeof(Expr)); *right = parse_unary(parser);
     switch (op.kind) {
         case TokExclaim:
             return expr_unop((Unop){
@@ -671,7 +845,7 @@ resume:
                 .val = right,
             }, type_none(), index);
         case TokIdent:
-            if (streq(op.ident, "sizeof")) {
+            if (streq(token_text(parser->lex, op), "sizeof")) {
                 if (right->kind != EkGrouping) {
                     elog(parser, right->cursors_idx, "expected () after `sizeof`");
                     return expr_none();
@@ -691,309 +865,100 @@ resume:
     return expr_none();
 }
 
-Expr parse_factor(Parser *parser) {
-    Expr expr = parse_unary(parser);
-
-    for (Token op = peek(parser); op.kind != TokNone; op = peek(parser)) {
-        if (op.kind != TokStar && op.kind != TokSlash && op.kind != TokPercent) {
-            break;
-        }
-        next(parser);
-
-        size_t index = (size_t)parser->cursors_idx;
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_unary(parser);
-
-        if (op.kind == TokStar) {
-            expr = expr_binop((Binop){
-                .kind = BkMultiply,
-                .left = left,
-                .right = right,
-            }, type_none(), index);
-        } else if (op.kind == TokSlash) {
-            expr = expr_binop((Binop){
-                .kind = BkDivide,
-                .left = left,
-                .right = right,
-            }, type_none(), index);
-        } else {
-            expr = expr_binop((Binop){
-                .kind = BkMod,
-                .left = left,
-                .right = right,
-            }, type_none(), index);
-        }
-    }
-
-    return expr;
-}
-
-Expr parse_term(Parser *parser) {
-    Expr expr = parse_factor(parser);
-
-    for (Token op = peek(parser); op.kind != TokNone; op = peek(parser)) {
-        if (op.kind != TokPlus && op.kind != TokMinus) {
-            break;
-        }
-        next(parser);
-
-        size_t index = (size_t)parser->cursors_idx;
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_factor(parser);
-
-        if (op.kind == TokPlus) {
-            expr = expr_binop((Binop){
-                .kind = BkPlus,
-                .left = left,
-                .right = right,
-            }, type_none(), index);
-        } else {
-            expr = expr_binop((Binop){
-                .kind = BkMinus,
-                .left = left,
-                .right = right,
-            }, type_none(), index);
-        }
-    }
-
-    return expr;
-}
-
-Expr parse_shift(Parser *parser) {
-    Expr expr = parse_term(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        size_t index = parser->cursors_idx;
-        Token after = peek_after(parser);
-        
-        if (tok.kind != TokLeftAngle && tok.kind != TokRightAngle) {
-            break;
-        } else if (tok.kind == TokLeftAngle && after.kind != TokLeftAngle) {
-            break;
-        } else if (tok.kind == TokRightAngle && after.kind != TokRightAngle) {
-            break;
-        }
-        next(parser); next(parser);
-
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_term(parser);
-
-        if (tok.kind == TokLeftAngle) {
-            expr = expr_binop((Binop){
-                .kind = BkLeftShift,
-                .left = left,
-                .right = right,
-            }, type_integer(TkUntypedInt, TYPEVAR, index), index);
-        } else {
-            expr = expr_binop((Binop){
-                .kind = BkRightShift,
-                .left = left,
-                .right = right,
-            }, type_integer(TkUntypedInt, TYPEVAR, index), index);
-        }
-    }
-
-    return expr;
-}
-
-Expr parse_comparison(Parser *parser) {
-    Expr expr = parse_shift(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        size_t index = (size_t)parser->cursors_idx;
-        if (tok.kind != TokLeftAngle && tok.kind != TokRightAngle) {
-            break;
-        }
-        next(parser);
-
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_shift(parser);
-
-        Token after = peek(parser);
-        if (after.kind == TokEqual) {
-            next(parser);
-
-            if (tok.kind == TokLeftAngle) {
-                expr = expr_binop((Binop){
-                    .kind = BkLessEqual,
-                    .left = left,
-                    .right = right,
-                }, type_bool(TYPEVAR, index), index);
-            } else {
-                expr = expr_binop((Binop){
-                    .kind = BkGreaterEqual,
-                    .left = left,
-                    .right = right,
-                }, type_bool(TYPEVAR, index), index);
-            }
-        } else {
-            if (tok.kind == TokLeftAngle) {
-                expr = expr_binop((Binop){
-                    .kind = BkLess,
-                    .left = left,
-                    .right = right,
-                }, type_bool(TYPEVAR, index), index);
-            } else {
-                expr = expr_binop((Binop){
-                    .kind = BkGreater,
-                    .left = left,
-                    .right = right,
-                }, type_bool(TYPEVAR, index), index);
-            }
-        }
-    }
-
-    return expr;
-}
-
-Expr parse_equality(Parser *parser) {
-    Expr expr = parse_comparison(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        size_t index = (size_t)parser->cursors_idx;
-        if (tok.kind != TokExclaim && tok.kind != TokEqual) {
-            break;
-        }
-        next(parser);
-
-        Token after = next(parser);
-        if (after.kind != TokEqual) {
-            break;
-        }
-
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_comparison(parser);
-        if (tok.kind == TokExclaim) {
-            expr = expr_binop((Binop){
-                .kind = BkInequals,
-                .left = left,
-                .right = right,
-            }, type_bool(TYPEVAR, index), index);
-        } else {
-            expr = expr_binop((Binop){
-                .kind = BkEquals,
-                .left = left,
-                .right = right,
-            }, type_bool(TYPEVAR, index), index);
-        }
-    }
-
-    return expr;
-}
-
-Expr parse_bitwise_and(Parser *parser) {
-    Expr expr = parse_equality(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        if (tok.kind != TokAmpersand) {
-            break;
-        }
-        next(parser);
-
-        size_t index = (size_t)parser->cursors_idx;
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_equality(parser);
-        expr = expr_binop((Binop){
-            .kind = BkBitAnd,
-            .left = left,
-            .right = right,
-        }, type_integer(TkUntypedInt, TYPEVAR, index), index);
-    }
-
-    return expr;
-}
-
-Expr parse_bitwise_xor(Parser *parser) {
-    Expr expr = parse_bitwise_and(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        if (tok.kind != TokTilde) {
-            break;
-        }
-        next(parser);
+typedef struct BinopEntry {
+    BinopKind kind;
+    TokenKind first;
+    TokenKind second; // TokNone if the operator is one token
+    const char *ident; // and, or
+    uint8_t bp; // binding power, higher binds tighter
+} BinopEntry;
+
+// NOTE: two token operators come before the one token operator they start with
+static const BinopEntry binops[] = {
+    {BkOr, TokIdent, TokNone, "or", 1},
+    {BkAnd, TokIdent, TokNone, "and", 2},
+
+    {BkBitOr, TokBar, TokNone, NULL, 3},
+    {BkBitXor, TokTilde, TokNone, NULL, 4},
+    {BkBitAnd, TokAmpersand, TokNone, NULL, 5},
+
+    {BkEquals, TokEqual, TokEqual, NULL, 6},
+    {BkInequals, TokExclaim, TokEqual, NULL, 6},
+
+    {BkLeftShift, TokLeftAngle, TokLeftAngle, NULL, 8},
+    {BkRightShift, TokRightAngle, TokRightAngle, NULL, 8},
+    {BkLessEqual, TokLeftAngle, TokEqual, NULL, 7},
+    {BkGreaterEqual, TokRightAngle, TokEqual, NULL, 7},
+    {BkLess, TokLeftAngle, TokNone, NULL, 7},
+    {BkGreater, TokRightAngle, TokNone, NULL, 7},
+
+    {BkPlus, TokPlus, TokNone, NULL, 9},
+    {BkMinus, TokMinus, TokNone, NULL, 9},
+
+    {BkMultiply, TokStar, TokNone, NULL, 10},
+    {BkDivide, TokSlash, TokNone, NULL, 10},
+    {BkMod, TokPercent, TokNone, NULL, 10},
+};
+
+// NULL if the next tokens aren't a binary operator
+static const BinopEntry *peek_binop(Parser *parser) {
+    Token tok = peek(parser);
+    Token after = peek_after(parser);
 
-        size_t index = (size_t)parser->cursors_idx;
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_bitwise_and(parser);
-        expr = expr_binop((Binop){
-            .kind = BkBitXor,
-            .left = left,
-            .right = right,
-        }, type_integer(TkUntypedInt, TYPEVAR, index), index);
+    for (size_t i = 0; i < sizeof(binops) / sizeof(binops[0]); i++) {
+        const BinopEntry *entry = &binops[i];
+        if (entry->first != tok.kind) continue;
+        if (entry->second != TokNone && entry->second != after.kind) continue;
+        if (entry->ident != NULL && !streq(entry->ident, token_text(parser->lex, tok))) continue;
+        return entry;
     }
-
-    return expr;
+    return NULL;
 }
 
-Expr parse_bitwise_or(Parser *parser) {
-    Expr expr = parse_bitwise_xor(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        if (tok.kind != TokBar) {
-            break;
-        }
-        next(parser);
-
-        size_t index = (size_t)parser->cursors_idx;
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_bitwise_xor(parser);
-        expr = expr_binop((Binop){
-            .kind = BkBitOr,
-            .left = left,
-            .right = right,
-        }, type_integer(TkUntypedInt, TYPEVAR, index), index);
-    }
-
-    return expr;
+static Type binop_type(BinopKind kind, size_t index) {
+    switch (kind) {
+        case BkPlus:
+        case BkMinus:
+        case BkDivide:
+        case BkMultiply:
+        case BkMod:
+            return type_none();
+        case BkLess:
+        case BkLessEqual:
+        case BkGreater:
+        case BkGreaterEqual:
+        case BkEquals:
+        case BkInequals:
+        case BkAnd:
+        case BkOr:
+            return type_bool(TYPEVAR, index);
+        case BkBitOr:
+        case BkBitAnd:
+        case BkBitXor:
+        case BkLeftShift:
+        case BkRightShift:
+            return type_integer(TkUntypedInt, TYPEVAR, index);
+    }
+    return type_none();
 }
 
-Expr parse_and(Parser *parser) {
-    Expr expr = parse_bitwise_or(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        if (tok.kind != TokIdent) {
-            break;
-        }
+// precedence climbing, operators binding tighter than min_bp are folded into the left side
+Expr parse_binop(Parser *parser, uint8_t min_bp) {
+    Expr expr = parse_unary(parser);
 
-        if (!streq(tok.ident, "and")) {
-            break;
-        }
+    for (const BinopEntry *op = peek_binop(parser); op != NULL && op->bp >= min_bp; op = peek_binop(parser)) {
         next(parser);
-
         size_t index = (size_t)parser->cursors_idx;
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_bitwise_or(parser);
-        expr = expr_binop((Binop){
-            .kind = BkAnd,
-            .left = left,
-            .right = right,
-        }, type_bool(TYPEVAR, index), index);
-    }
-
-    return expr;
-}
+        if (op->second != TokNone) next(parser);
 
-Expr parse_or(Parser *parser) {
-    Expr expr = parse_and(parser);
-
-    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
-        if (tok.kind != TokIdent) {
-            break;
-        }
-
-        if (!streq(tok.ident, "or")) {
-            break;
-        }
-        next(parser);
-
-        size_t index = (size_t)parser->cursors_idx;
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = parse_equality(parser);
+        // all binary operators are left associative
+        Expr *left = arena_alloc(&ast_arena, sizeof(Expr)); *left = expr;
+        Expr *right = arena_alloc(&ast_arena, sizeof(Expr)); *right = parse_binop(parser, op->bp + 1);
         expr = expr_binop((Binop){
-            .kind = BkOr,
+            .kind = op->kind,
             .left = left,
             .right = right,
-        }, type_bool(TYPEVAR, index), index);
+        }, binop_type(op->kind, index), index);
     }
 
     return expr;
@@ -1004,7 +969,7 @@ Expr parse_range(Parser *parser) {
     if (peek(parser).kind == TokDot && peek_after(parser).kind == TokDot) {
         expr = expr_none();
     } else {
-        expr = parse_or(parser);
+        expr = parse_binop(parser, 1);
     }
 
     for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
@@ -1019,37 +984,30 @@ Expr parse_range(Parser *parser) {
         }
         next(parser); next(parser);
 
-        Expr *left = ealloc(sizeof(Expr)); *left = expr;
-        Expr *right = ealloc(sizeof(Expr)); *right = expr_none();
+        Expr *left = arena_alloc(&ast_arena, sizeof(Expr)); *left = expr;
+        Expr *right = arena_alloc(&ast_arena, sizeof(Expr)); *right = expr_none();
         bool inclusive = false;
 
         if (peek(parser).kind == TokEqual) {
             next(parser);
-
-            switch (peek(parser).kind) {
-                case TokIdent:
-                case TokIntLit:
-                case TokFloatLit:
-                case TokCharLit:
-                    *right = parse_or(parser);
-                    break;
-                default: break;
-            }
-
             inclusive = true;
-        } else {
-            switch (peek(parser).kind) {
-                case TokIdent:
-                case TokIntLit:
-                case TokFloatLit:
-                case TokCharLit:
-                    *right = parse_or(parser);
-                    break;
-                default: break;
-            }
         }
 
-        Type *subtype = ealloc(sizeof(Type)); *subtype = type_integer(TkUntypedInt, TYPECONST, index);
+        // the end can be any expression, 1..N + 1, unless it's left out as in xs[1..]
+        switch (peek(parser).kind) {
+            case TokNone:
+            case TokLeftCurl:
+            case TokRightSquare:
+            case TokRightBracket:
+            case TokComma:
+            case TokSemiColon:
+                break;
+            default:
+                *right = parse_binop(parser, 1);
+                break;
+        }
+
+        Type *subtype = arena_alloc(&ast_arena, sizeof(Type)); *subtype = type_integer(TkUntypedInt, TYPECONST, index);
         expr = expr_range((RangeLit){
             .start = left,
             .end = right,
@@ -1067,7 +1025,7 @@ Expr parse_expr(Parser *parser) {
 }
 
 Expr parse_array_slice(Parser *parser, Expr expr, Expr *range) {
-    Expr *e = ealloc(sizeof(Expr)); *e = expr;
+    Expr *e = arena_alloc(&ast_arena, sizeof(Expr)); *e = expr;
     Expr arrslice = expr_arrayslice((ArraySlice){
         .accessing = e,
         .slice = range,
@@ -1078,21 +1036,21 @@ Expr parse_array_slice(Parser *parser, Expr expr, Expr *range) {
 // expects [ already nexted
 // <expr>[
 Expr parse_array_index(Parser *parser, Expr expr) {
-    Expr *index = ealloc(sizeof(Expr)); *index = parse_expr(parser);
+    Expr *index = arena_alloc(&ast_arena, sizeof(Expr)); *index = parse_expr(parser);
     expect(parser, TokRightSquare);
 
     if (index->kind == EkRangeLit) {
         return parse_array_slice(parser, expr, index);
     }
 
-    Expr *e = ealloc(sizeof(Expr)); *e = expr;
+    Expr *e = arena_alloc(&ast_arena, sizeof(Expr)); *e = expr;
     Expr arrindex = expr_arrayindex((ArrayIndex){
         .accessing = e,
         .index = index,
     }, type_none(), (size_t)parser->cursors_idx);
 
     Token tok = peek(parser);
-    if (tok.kind == TokDot) {
+    if (tok.kind == TokDot && peek_after(parser).kind != TokDot) {
         next(parser);
         return parse_field_access(parser, arrindex);
     } else if (tok.kind == TokLeftSquare) {
@@ -1108,8 +1066,8 @@ Expr parse_array_index(Parser *parser, Expr expr) {
 Expr parse_field_access(Parser *parser, Expr expr) {
     size_t index = parser->cursors_idx;
 
-    Expr *front = ealloc(sizeof(Expr)); *front = expr;
-    Expr *field = ealloc(sizeof(Expr)); *field = expr_none();
+    Expr *front = arena_alloc(&ast_arena, sizeof(Expr)); *front = expr;
+    Expr *field = arena_alloc(&ast_arena, sizeof(Expr)); *field = expr_none();
 
     Expr fa = expr_fieldaccess((FieldAccess){
         .accessing = front,
@@ -1137,7 +1095,7 @@ Expr parse_field_access(Parser *parser, Expr expr) {
     tok = peek(parser);
     if (tok.kind == TokNone) {
         elog(parser, parser->cursors_idx, "expected more tokens");
-    } else if (tok.kind == TokDot) {
+    } else if (tok.kind == TokDot && peek_after(parser).kind != TokDot) {
         next(parser); // already checked if none
         return parse_field_access(parser, fa);
     } else if (tok.kind == TokLeftSquare) {
@@ -1151,9 +1109,9 @@ Expr parse_field_access(Parser *parser, Expr expr) {
 // <expr> [+-*/%|&~<<>>]=
 Stmnt parse_compound_assignment(Parser *parser, Expr expr, Token op, bool expect_semicolon) {
     size_t op_idx = (size_t)parser->cursors_idx;
-    Expr *var = ealloc(sizeof(Expr)); *var = expr;
-    Expr *val = ealloc(sizeof(Expr)); *val = parse_expr(parser);
-    Expr *group = ealloc(sizeof(Expr));
+    Expr *var = arena_alloc(&ast_arena, sizeof(Expr)); *var = expr;
+    Expr *val = arena_alloc(&ast_arena, sizeof(Expr)); *val = parse_expr(parser);
+    Expr *group = arena_alloc(&ast_arena, sizeof(Expr));
     *group = expr_group(val, type_none(), parser->cursors_idx);
 
     if (expect_semicolon) expect(parser, TokSemiColon);
@@ -1288,13 +1246,29 @@ Stmnt *parse_block_curls(Parser *parser) {
     return parse_block(parser, TokLeftCurl, TokRightCurl);
 }
 
-Stmnt parse_fn_decl(Parser *parser, Expr ident) {
-    size_t index = (size_t)parser->cursors_idx;
+// <ident> :: fn(<args>) <type> #inline #noinline #flatten {
+void parse_fn_attrs(Parser *parser, FnAttrs *attrs) {
+    for (Token tok = peek(parser); tok.kind == TokDirective; tok = peek(parser)) {
+        next(parser);
 
-    parser->in_func_decl_args = true;
-    Stmnt *args = parse_block(parser, TokLeftBracket, TokRightBracket);
-    parser->in_func_decl_args = false;
+        if (streq(token_text(parser->lex, tok), "inline")) {
+            attrs->inline_always = true;
+        } else if (streq(token_text(parser->lex, tok), "noinline")) {
+            attrs->noinline = true;
+        } else if (streq(token_text(parser->lex, tok), "flatten")) {
+            attrs->flatten = true;
+        } else {
+            elog(parser, parser->cursors_idx, "\"#%s\" is not a function attribute", token_text(parser->lex, tok));
+        }
+    }
+
+    if (attrs->inline_always && attrs->noinline) {
+        elog(parser, parser->cursors_idx, "a function can't be both #inline and #noinline");
+    }
+}
 
+// <ident> :: fn(<args>) after the args
+Stmnt parse_end_fn_decl(Parser *parser, Expr ident, Arr(Stmnt) args, size_t index) {
     Type type = parse_type(parser);
     if (type.kind == TkNone) {
         elog(parser, parser->cursors_idx, "expected return type in function declaration");
@@ -1306,6 +1280,7 @@ Stmnt parse_fn_decl(Parser *parser, Expr ident) {
         .args = args,
         .type = type,
     };
+    parse_fn_attrs(parser, &fndecl.attrs);
 
     Token tok = peek(parser);
     if (tok.kind == TokLeftCurl) {
@@ -1319,6 +1294,10 @@ Stmnt parse_fn_decl(Parser *parser, Expr ident) {
         fndecl.body = NULL;
         fndecl.has_body = false;
 
+        if (fndecl.attrs.inline_always || fndecl.attrs.noinline || fndecl.attrs.flatten) {
+            elog(parser, parser->cursors_idx, "function attributes need a body to apply to");
+        }
+
         return stmnt_fndecl(fndecl, index);
     } else {
         elog(parser, parser->cursors_idx, "expected ';' or '{', got %s", tokenkind_stringify(tok.kind));
@@ -1326,13 +1305,218 @@ Stmnt parse_fn_decl(Parser *parser, Expr ident) {
     }
 }
 
+Stmnt parse_fn_decl(Parser *parser, Expr ident) {
+    size_t index = (size_t)parser->cursors_idx;
+
+    parser->in_func_decl_args = true;
+    Stmnt *args = parse_block(parser, TokLeftBracket, TokRightBracket);
+    parser->in_func_decl_args = false;
+
+    return parse_end_fn_decl(parser, ident, args, index);
+}
+
+// fn(self, <args>), fn(*self, <args>) or fn(^self, <args>)
+// ident is already mangled to <struct>_<method>
+Stmnt parse_method_decl(Parser *parser, Expr ident, Type receiver) {
+    Token tok = expect(parser, TokIdent);
+    if (keyword_map(token_text(parser->lex, tok)) != KwFn) {
+        elog(parser, parser->cursors_idx, "expected a function after method name");
+        return parse_next_stmnt(parser);
+    }
+
+    size_t index = (size_t)parser->cursors_idx;
+    expect(parser, TokLeftBracket);
+
+    Type self = receiver;
+    tok = peek(parser);
+    if (tok.kind == TokStar || tok.kind == TokCaret) {
+        next(parser);
+        Type *of = arena_alloc(&ast_arena, sizeof(Type)); *of = receiver;
+        self = type_ptr(of, tok.kind == TokCaret, (size_t)parser->cursors_idx);
+    }
+
+    tok = expect(parser, TokIdent);
+    if (!streq(token_text(parser->lex, tok), "self")) {
+        elog(parser, parser->cursors_idx, "expected self as the first argument of a method");
+    }
+
+    Arr(Stmnt) args = NULL;
+    arrpush(args, stmnt_constdecl((ConstDecl){
+        .name = expr_ident("self", type_none(), (size_t)parser->cursors_idx),
+        .type = self,
+        .value = expr_none(),
+    }, (size_t)parser->cursors_idx));
+
+    if (peek(parser).kind == TokComma) {
+        next(parser);
+
+        parser->in_func_decl_args = true;
+        Arr(Stmnt) rest = parse_block(parser, TokNone, TokRightBracket);
+        parser->in_func_decl_args = false;
+
+        for (size_t i = 0; i < arrlenu(rest); i++) {
+            arrpush(args, rest[i]);
+        }
+        arrfree(rest);
+    } else {
+        expect(parser, TokRightBracket);
+    }
+
+    Stmnt stmnt = parse_end_fn_decl(parser, ident, args, index);
+    if (stmnt.kind == SkFnDecl) {
+        stmnt.fndecl.method = true;
+    }
+    return stmnt;
+}
+
+// copies the tokens up to the curl closing the first block, they're parsed again per instance
+Template parse_template(Parser *parser, const char *name, const char *method, Arr(const char*) params) {
+    Template template = {
+        .name = name,
+        .method = method,
+        .params = params,
+        .tokens = NULL,
+        .lex = parser->lex,
+        .cursors_idx = parser->cursors_idx,
+    };
+
+    size_t depth = 0;
+    for (Token tok = peek(parser); tok.kind != TokNone; tok = peek(parser)) {
+        arrpush(template.tokens, next(parser));
+
+        if (tok.kind == TokLeftCurl) {
+            depth++;
+        } else if (tok.kind == TokRightCurl && --depth == 0) {
+            return template;
+        } else if (tok.kind == TokSemiColon && depth == 0) {
+            elog(parser, parser->cursors_idx, "generic \"%s\" must have a body", name);
+            return template;
+        }
+    }
+
+    expect(parser, TokRightCurl);
+    return template;
+}
+
+// <ident> :: struct(<T>: type, ...) {
+// nothing is emitted for the template, the next statement is returned instead
+Stmnt parse_generic_struct(Parser *parser, Expr ident) {
+    expect(parser, TokLeftBracket);
+
+    Arr(const char*) params = NULL;
+    while (peek(parser).kind != TokRightBracket && peek(parser).kind != TokNone) {
+        Token param = expect(parser, TokIdent);
+        expect(parser, TokColon);
+        Token kind = expect(parser, TokIdent);
+        if (kind.kind == TokIdent && !streq(token_text(parser->lex, kind), "type")) {
+            elog(parser, parser->cursors_idx, "generic parameters must be types, \"%s: type\"", token_text(parser->lex, param));
+        }
+        arrpush(params, token_text(parser->lex, param));
+
+        if (peek(parser).kind != TokComma) break;
+        next(parser);
+    }
+    expect(parser, TokRightBracket);
+
+    arrpush(parser->templates, parse_template(parser, ident.ident, NULL, params));
+    return parser_parse(parser);
+}
+
+// <ident>($T, ...).<method> :: fn(
+// params don't need the same names as the struct's, they're matched by position
+Stmnt parse_generic_method(Parser *parser, Expr ident) {
+    expect(parser, TokLeftBracket);
+
+    Arr(const char*) params = NULL;
+    while (peek(parser).kind != TokRightBracket && peek(parser).kind != TokNone) {
+        Token param = expect(parser, TokIdent);
+        if (param.kind != TokIdent || token_text(parser->lex, param)[0] != '$') {
+            elog(parser, parser->cursors_idx, "expected a type parameter starting with '$'");
+        } else {
+            arrpush(params, token_text(parser->lex, param) + 1);
+        }
+
+        if (peek(parser).kind != TokComma) break;
+        next(parser);
+    }
+    expect(parser, TokRightBracket);
+    expect(parser, TokDot);
+    Token method = expect(parser, TokIdent);
+    expect(parser, TokColon);
+    expect(parser, TokColon);
+
+    arrpush(parser->templates, parse_template(parser, ident.ident, token_text(parser->lex, method), params));
+    return parser_parse(parser);
+}
+
+// <ident> :: struct #packed #align(N) #reorder #soa {
+void parse_struct_attrs(Parser *parser, StructAttrs *attrs) {
+    for (Token tok = peek(parser); tok.kind == TokDirective; tok = peek(parser)) {
+        next(parser);
+
+        if (streq(token_text(parser->lex, tok), "packed")) {
+            attrs->packed = true;
+        } else if (streq(token_text(parser->lex, tok), "reorder")) {
+            attrs->reorder = true;
+        } else if (streq(token_text(parser->lex, tok), "soa")) {
+            attrs->soa = true;
+        } else if (streq(token_text(parser->lex, tok), "align")) {
+            expect(parser, TokLeftBracket);
+            Token n = expect(parser, TokIntLit);
+            expect(parser, TokRightBracket);
+
+            uint64_t align = token_int(parser->lex, n);
+            if (align == 0 || (align & (align - 1)) != 0) {
+                elog(parser, parser->cursors_idx, "struct alignment must be a power of two, got %lu", align);
+            }
+            attrs->align = align;
+        } else {
+            elog(parser, parser->cursors_idx, "\"#%s\" is not a struct attribute", token_text(parser->lex, tok));
+        }
+    }
+}
+
 Stmnt parse_struct_decl(Parser *parser, Expr ident) {
     size_t index = (size_t)parser->cursors_idx;
-    Stmnt *fields = parse_block_curls(parser);
+
+    StructAttrs *attrs = arena_alloc(&ast_arena, sizeof(StructAttrs));
+    *attrs = (StructAttrs){0};
+    parse_struct_attrs(parser, attrs);
+
+    // same as parse_block_curls but fields can be prefixed with #hot
+    expect(parser, TokLeftCurl);
+    Arr(Stmnt) fields = NULL;
+
+    for (Token tok = peek(parser); tok.kind != TokRightCurl; tok = peek(parser)) {
+        if (tok.kind == TokNone) {
+            expect(parser, TokRightCurl);
+            break;
+        }
+
+        bool hot = false;
+        if (tok.kind == TokDirective && streq(token_text(parser->lex, tok), "hot")) {
+            next(parser);
+            hot = true;
+        }
+
+        Stmnt field = parser_parse(parser);
+        if (field.kind == SkNone) break;
+
+        if (hot) {
+            if (field.kind == SkVarDecl) {
+                arrpush(attrs->hot, field.vardecl.name.ident);
+            } else {
+                elog(parser, field.cursors_idx, "#hot can only be used on struct fields");
+            }
+        }
+        arrpush(fields, field);
+    }
+    if (peek(parser).kind == TokRightCurl) next(parser);
 
     return stmnt_structdecl((StructDecl){
         .name = ident,
         .fields = fields,
+        .attrs = attrs,
     }, index);
 }
 
@@ -1348,6 +1532,34 @@ Stmnt parse_enum_decl(Parser *parser, Expr ident) {
     }, index);
 }
 
+// <ident> :: union { <variant>: <type>; <variant>; }
+Stmnt parse_union_decl(Parser *parser, Expr ident) {
+    size_t index = (size_t)parser->cursors_idx;
+
+    // bare variants parse the same way as enum fields
+    parser->in_enum_decl = true;
+    Stmnt *variants = parse_block_curls(parser);
+    parser->in_enum_decl = false;
+
+    for (size_t i = 0; i < arrlenu(variants); i++) {
+        Stmnt *v = &variants[i];
+        if (v->kind == SkConstDecl && v->constdecl.value.kind == EkNone) {
+            *v = stmnt_vardecl((VarDecl){
+                .name = v->constdecl.name,
+                .type = type_void(TYPEVAR, v->cursors_idx),
+                .value = expr_none(),
+            }, v->cursors_idx);
+        } else if (v->kind != SkVarDecl) {
+            elog(parser, v->cursors_idx, "expected union variant, either \"<name>: <type>;\" or \"<name>;\"");
+        }
+    }
+
+    return stmnt_uniondecl((UnionDecl){
+        .name = ident,
+        .fields = variants,
+    }, index);
+}
+
 // <ident> : <type?> :
 // type can be none
 Stmnt parse_const_decl(Parser *parser, Expr ident, Type type) {
@@ -1364,10 +1576,16 @@ Stmnt parse_const_decl(Parser *parser, Expr ident, Type type) {
                     return parse_fn_decl(parser, ident);
                 case KwStruct:
                     next(parser);
+                    if (peek(parser).kind == TokLeftBracket) {
+                        return parse_generic_struct(parser, ident);
+                    }
                     return parse_struct_decl(parser, ident);
                 case KwEnum:
                     next(parser);
                     return parse_enum_decl(parser, ident);
+                case KwUnion:
+                    next(parser);
+                    return parse_union_decl(parser, ident);
                 case KwTrue:
                 case KwFalse:
                 case KwNull:
@@ -1459,12 +1677,22 @@ Stmnt parse_decl(Parser *parser, Expr ident) {
         tok = peek(parser);
         if (tok.kind == TokNone) return stmnt_none();
 
+        // <ident>: <type> #noalias, only for arguments
+        bool noalias = false;
+        if (parser->in_func_decl_args && tok.kind == TokDirective && streq(token_text(parser->lex, tok), "noalias")) {
+            next(parser);
+            noalias = true;
+            tok = peek(parser);
+        }
+
         if (tok.kind == TokColon) {
             next(parser);
             return parse_const_decl(parser, ident, type);
         } else if (tok.kind == TokEqual) {
             next(parser);
-            return parse_var_decl(parser, ident, type, true);
+            Stmnt arg = parse_var_decl(parser, ident, type, true);
+            if (arg.kind == SkVarDecl) arg.vardecl.noalias = noalias;
+            return arg;
         } else if (tok.kind == TokSemiColon) {
             next(parser);
             if (type.kind == TkNone) {
@@ -1478,13 +1706,17 @@ Stmnt parse_decl(Parser *parser, Expr ident) {
                 elog(parser, parser->cursors_idx, "unexpected comma during declaration");
                 return parse_next_stmnt(parser);
             }
-            return parse_const_decl(parser, ident, type);
+            Stmnt arg = parse_const_decl(parser, ident, type);
+            if (arg.kind == SkConstDecl) arg.constdecl.noalias = noalias;
+            return arg;
         } else if (tok.kind == TokRightBracket) {
             if (!parser->in_func_decl_args) {
                 elog(parser, parser->cursors_idx, "unexpected TokenRb during declaration");
                 return parse_next_stmnt(parser);
             }
-            return parse_const_decl(parser, ident, type);
+            Stmnt arg = parse_const_decl(parser, ident, type);
+            if (arg.kind == SkConstDecl) arg.constdecl.noalias = noalias;
+            return arg;
         } else {
             elog(parser, parser->cursors_idx, "unexpected token %s", tokenkind_stringify(tok.kind));
             return parse_next_stmnt(parser);
@@ -1499,6 +1731,11 @@ Stmnt parse_ident(Parser *parser, Expr ident) {
 
     Token tok = peek(parser);
     if (tok.kind == TokNone) return stmnt_none();
+
+    // <ident>($T).<method> ::
+    if (tok.kind == TokLeftBracket && peek_after(parser).kind == TokIdent && token_text(parser->lex, peek_after(parser))[0] == '$') {
+        return parse_generic_method(parser, ident);
+    }
     
     // <ident>. OR <ident>[
     if (tok.kind == TokDot) {
@@ -1508,6 +1745,24 @@ Stmnt parse_ident(Parser *parser, Expr ident) {
         tok = peek(parser);
         if (tok.kind == TokNone) return stmnt_none();
 
+        // <struct>.<method> ::
+        if (tok.kind == TokColon && peek_after(parser).kind == TokColon && reassigned.fieldacc.field->kind == EkIdent && reassigned.fieldacc.accessing->kind == EkIdent) {
+            next(parser);
+            next(parser);
+
+            strb name = NULL;
+            strbprintf(&name, "%s_%s", ident.ident, reassigned.fieldacc.field->ident);
+            return parse_method_decl(parser, expr_ident(name, type_none(), ident.cursors_idx), typedef_from_ident(ident));
+        }
+
+        // <ident>.<method>(
+        if (tok.kind == TokLeftBracket) {
+            Expr expr = parse_fn_call(parser, reassigned);
+            Stmnt stmnt = stmnt_from_fncall(expr);
+            expect(parser, TokSemiColon);
+            return stmnt;
+        }
+
         return parse_possible_assignment(parser, reassigned, true);
     } else if (tok.kind == TokLeftSquare) {
         next(parser);
@@ -1574,7 +1829,7 @@ Stmnt parse_return(Parser *parser) {
 Stmnt parse_defer(Parser *parser) {
     size_t index = (size_t)parser->cursors_idx;
 
-    Stmnt *defered = ealloc(sizeof(Stmnt));
+    Stmnt *defered = arena_alloc(&ast_arena, sizeof(Stmnt));
     *defered = parser_parse(parser);
 
     return stmnt_defer(defered, index);
@@ -1633,7 +1888,7 @@ Stmnt parse_if(Parser *parser) {
                     next(parser);
                     arrpush(else_block, parse_if(parser));
                 } else {
-                    elog(parser, parser->cursors_idx, "unexpected identifier %s after `else`", after.ident);
+                    elog(parser, parser->cursors_idx, "unexpected identifier %s after `else`", token_text(parser->lex, after));
                     return parse_next_stmnt(parser);
                 }
             } else {
@@ -1642,10 +1897,15 @@ Stmnt parse_if(Parser *parser) {
         }
     }
 
+    Expr *captured = NULL;
+    if (capture.kind != EkNone) {
+        captured = arena_alloc(&ast_arena, sizeof(Expr)); *captured = capture;
+    }
+
     return stmnt_if((If){
         .condition = cond,
         .body = body,
-        .capture.ident = capture,
+        .capture.ident = captured,
         .capturekind = capture.kind == EkNone ? CkNone : CkIdent,
         .els = else_block,
     }, index);
@@ -1653,10 +1913,102 @@ Stmnt parse_if(Parser *parser) {
 
 Stmnt parse_extern(Parser *parser) {
     size_t index = (size_t)parser->cursors_idx;
-    Stmnt *stmnt = ealloc(sizeof(Stmnt)); *stmnt = parser_parse(parser);
+    Stmnt *stmnt = arena_alloc(&ast_arena, sizeof(Stmnt)); *stmnt = parser_parse(parser);
     return stmnt_extern(stmnt, index);
 }
 
+// case .<variant>, .<variant> [capture] { }
+// case 1, 'a'..='z', MAX { }
+Case parse_case(Parser *parser, bool is_default) {
+    Case c = {
+        .values = NULL,
+        .capture = expr_none(),
+        .capture_decl = NULL,
+        .body = NULL,
+        .cursors_idx = (size_t)parser->cursors_idx,
+    };
+
+    parser->in_case_values = true;
+    while (!is_default) {
+        Token tok = peek(parser);
+        if (tok.kind == TokDot && peek_after(parser).kind == TokIdent) {
+            next(parser);
+            size_t index = (size_t)parser->cursors_idx;
+            Token name = expect(parser, TokIdent);
+
+            Expr *accessing = arena_alloc(&ast_arena, sizeof(Expr)); *accessing = expr_none();
+            Expr *field = arena_alloc(&ast_arena, sizeof(Expr)); *field = expr_ident(token_text(parser->lex, name), type_none(), index);
+            arrpush(c.values, expr_fieldaccess((FieldAccess){
+                .accessing = accessing,
+                .field = field,
+                .deref = false,
+            }, type_none(), index));
+        } else {
+            Expr value = parse_expr(parser);
+            if (value.kind == EkNone) {
+                elog(parser, parser->cursors_idx, "expected case value");
+                break;
+            }
+            arrpush(c.values, value);
+        }
+
+        if (peek(parser).kind != TokComma) break;
+        next(parser);
+    }
+    parser->in_case_values = false;
+
+    if (peek(parser).kind == TokLeftSquare) {
+        next(parser);
+        Token capture_tok = expect(parser, TokIdent);
+
+        Identifiers convert = convert_ident(parser, capture_tok);
+        if (convert.kind == IkIdent) {
+            c.capture = convert.expr;
+        } else {
+            elog(parser, parser->cursors_idx, "capture must be a unique identifier");
+        }
+        expect(parser, TokRightSquare);
+    }
+
+    c.body = parse_block_curls(parser);
+    return c;
+}
+
+// switch (<expr>) { case <values> [capture] { } default { } }
+Stmnt parse_switch(Parser *parser) {
+    size_t index = (size_t)parser->cursors_idx;
+
+    expect(parser, TokLeftBracket);
+    Expr value = parse_expr(parser);
+    expect(parser, TokRightBracket);
+    expect(parser, TokLeftCurl);
+
+    Arr(Case) cases = NULL;
+    for (Token tok = peek(parser); tok.kind != TokRightCurl; tok = peek(parser)) {
+        if (tok.kind == TokNone) {
+            expect(parser, TokRightCurl);
+            break;
+        }
+
+        next(parser);
+        Identifiers convert = convert_ident(parser, tok);
+        if (tok.kind != TokIdent || convert.kind != IkKeyword || (convert.keyword != KwCase && convert.keyword != KwDefault)) {
+            elog(parser, parser->cursors_idx, "expected case or default in switch, got %s", tokenkind_stringify(tok.kind));
+            return parse_next_stmnt(parser);
+        }
+
+        arrpush(cases, parse_case(parser, convert.keyword == KwDefault));
+    }
+    if (peek(parser).kind == TokRightCurl) next(parser);
+
+    return stmnt_switch((Switch){
+        .value = value,
+        .cases = cases,
+        .lowering = SlNone,
+        .ranges = NULL,
+    }, index);
+}
+
 Stmnt parse_for(Parser *parser) {
     size_t index = (size_t)parser->cursors_idx;
 
@@ -1677,7 +2029,7 @@ Stmnt parse_for(Parser *parser) {
         next(parser);
         tok = peek(parser);
 
-        Stmnt *vardecl = ealloc(sizeof(Stmnt));
+        Stmnt *vardecl = arena_alloc(&ast_arena, sizeof(Stmnt));
         if (tok.kind == TokEqual) {
             // for (i :=
             next(parser);
@@ -1696,7 +2048,7 @@ Stmnt parse_for(Parser *parser) {
         Expr cond = parse_expr(parser);
         expect(parser, TokSemiColon);
 
-        Stmnt *reassign = ealloc(sizeof(Stmnt));
+        Stmnt *reassign = arena_alloc(&ast_arena, sizeof(Stmnt));
         tok = peek(parser);
         if (tok.kind == TokIdent) {
             next(parser);
@@ -1720,21 +2072,57 @@ Stmnt parse_for(Parser *parser) {
     }
 }
 
+// #if (<cond>) {...} else #if (<cond>) {...} else {...}
+If parse_directive_if(Parser *parser) {
+    expect(parser, TokLeftBracket);
+    Expr cond = parse_expr(parser);
+    expect(parser, TokRightBracket);
+
+    Stmnt *body = parse_block_curls(parser);
+    Arr(Stmnt) else_block = NULL;
+
+    Token tok = peek(parser);
+    if (tok.kind == TokIdent) {
+        Identifiers convert = convert_ident(parser, tok);
+        if (convert.kind == IkKeyword && convert.keyword == KwElse) {
+            next(parser);
+            Token after = peek(parser);
+            if (after.kind == TokDirective && streq(token_text(parser->lex, after), "if")) {
+                arrpush(else_block, parser_parse(parser));
+            } else {
+                else_block = parse_block_curls(parser);
+            }
+        }
+    }
+
+    return (If){
+        .condition = cond,
+        .capturekind = CkNone,
+        .body = body,
+        .els = else_block,
+    };
+}
+
 Stmnt parse_directive(Parser *parser) {
     Token tok = next(parser);
 
     assert(tok.kind == TokDirective);
-    Directive directive = parser_get_directive(parser, tok.ident);
+    Directive directive = parser_get_directive(parser, token_text(parser->lex, tok));
     Stmnt d = stmnt_directive(directive, parser->cursors_idx);
 
     switch (directive.kind) {
         case DkOutput:
         case DkLink:
-        case DkSyslink: {
+        case DkSyslink:
+        case DkImport: {
             tok = expect(parser, TokStrLit);
             expect(parser, TokSemiColon);
-            d.directive.str = tok.strlit;
+            d.directive.str = token_text(parser->lex, tok);
         } break;
+        case DkIf:
+            d.directive.iff = arena_alloc(&ast_arena, sizeof(If));
+            *d.directive.iff = parse_directive_if(parser);
+            break;
         default:
             expect(parser, TokSemiColon);
             break;
@@ -1771,8 +2159,10 @@ Stmnt parser_parse(Parser *parser) {
                         return parse_extern(parser);
                     case KwFor:
                         return parse_for(parser);
+                    case KwSwitch:
+                        return parse_switch(parser);
                     default:
-                        elog(parser, parser->cursors_idx, "unexpected keyword \"%s\"", tok.ident);
+                        elog(parser, parser->cursors_idx, "unexpected keyword \"%s\"", token_text(parser->lex, tok));
                         return parse_next_stmnt(parser);
                 }
             }
@@ -1791,3 +2181,114 @@ Stmnt parser_parse(Parser *parser) {
 
     return stmnt_none();
 }
+
+// templates and instances of every module go into one parser before instantiating
+// an instance used by more than one module is only instantiated once
+void parser_merge(Parser *into, Parser *from) {
+    for (size_t i = 0; i < arrlenu(from->templates); i++) {
+        arrpush(into->templates, from->templates[i]);
+    }
+
+    for (size_t i = 0; i < arrlenu(from->instances); i++) {
+        Instance instance = from->instances[i];
+
+        ptrdiff_t found = shgeti(into->instance_map, instance.name);
+        if (found >= 0) {
+            into->instances[into->instance_map[found].value].uses += instance.uses;
+            continue;
+        }
+
+        shput(into->instance_map, (char*)instance.name, arrlenu(into->instances));
+        arrpush(into->instances, instance);
+    }
+
+    into->error_count += from->error_count;
+}
+
+// parses every generic struct instance and its methods, instances found while parsing these are added to the end
+void parser_instantiate(Parser *parser, Arr(Stmnt) *ast) {
+    for (size_t i = 0; i < arrlenu(parser->instances); i++) {
+        Instance instance = parser->instances[i];
+
+        Template *generic = NULL;
+        for (size_t j = 0; j < arrlenu(parser->templates); j++) {
+            if (parser->templates[j].method == NULL && streq(parser->templates[j].name, instance.generic)) {
+                generic = &parser->templates[j];
+                break;
+            }
+        }
+
+        if (generic == NULL) {
+            elog(parser, instance.cursors_idx, "\"%s\" is not a generic struct", instance.generic);
+            continue;
+        }
+
+        if (arrlenu(generic->params) != arrlenu(instance.args)) {
+            elog(parser, instance.cursors_idx, "\"%s\" expects %zu type arguments, got %zu", instance.generic, arrlenu(generic->params), arrlenu(instance.args));
+            continue;
+        }
+
+        for (size_t j = 0; j < arrlenu(parser->templates); j++) {
+            Template *template = &parser->templates[j];
+            if (!streq(template->name, instance.generic)) continue;
+
+            if (arrlenu(template->params) != arrlenu(instance.args)) {
+                elog(parser, (size_t)template->cursors_idx, "method \"%s\" expects %zu type parameters, \"%s\" has %zu", template->method, arrlenu(template->params), instance.generic, arrlenu(instance.args));
+                continue;
+            }
+
+            Arr(Token) tokens = parser->tokens;
+            size_t tokens_idx = parser->tokens_idx;
+            long cursors_idx = parser->cursors_idx;
+            Lexer *lex = parser->lex;
+
+            parser->lex = template->lex;
+            parser->tokens = template->tokens;
+            parser->tokens_idx = 0;
+            parser->cursors_idx = template->cursors_idx;
+            parser->subst_names = template->params;
+            parser->subst_types = instance.args;
+
+            if (template->method == NULL) {
+                arrpush(*ast, parse_struct_decl(parser, expr_ident(instance.name, type_none(), instance.cursors_idx)));
+            } else {
+                strb name = NULL;
+                strbprintf(&name, "%s_%s", instance.name, template->method);
+
+                Type receiver = type_typedef(instance.name, TYPEVAR, (size_t)template->cursors_idx);
+                arrpush(*ast, parse_method_decl(parser, expr_ident(name, type_none(), (size_t)template->cursors_idx), receiver));
+                parser->instances[i].methods++;
+            }
+
+            parser->lex = lex;
+            parser->tokens = tokens;
+            parser->tokens_idx = tokens_idx;
+            parser->cursors_idx = cursors_idx;
+            parser->subst_names = NULL;
+            parser->subst_types = NULL;
+        }
+    }
+}
+
+void parser_instantiation_report(Parser *parser) {
+    size_t uses = 0;
+    size_t methods = 0;
+
+    for (size_t i = 0; i < arrlenu(parser->instances); i++) {
+        Instance instance = parser->instances[i];
+        uses += instance.uses;
+        methods += instance.methods;
+
+        strb args = NULL;
+        for (size_t j = 0; j < arrlenu(instance.args); j++) {
+            strb t = string_from_type(instance.args[j]);
+            strbprintf(&args, j == 0 ? "%s" : ", %s", t);
+            strbfree(t);
+        }
+
+        printfln("%s(%s) as %s: %zu uses, %zu methods", instance.generic, args, instance.name, instance.uses, instance.methods);
+        strbfree(args);
+    }
+
+    printfln("%zu instances of %zu uses, %zu methods generated", arrlenu(parser->instances), uses, methods);
+}
@@ -0,0 +1,708 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "include/pmi.h"
+#include "include/arena.h"
+#include "include/eval.h"
+#include "include/exprs.h"
+#include "include/layout.h"
+#include "include/lexer.h"
+#include "include/module.h"
+#include "include/sema.h"
+#include "include/stmnts.h"
+#include "include/strb.h"
+#include "include/types.h"
+#include "include/utils.h"
+#include "include/stb_ds.h"
+
+typedef struct PmiWriter {
+    Sema *sema;
+
+    Arr(char) strings;
+    struct { char *key; uint32_t value; } *string_offs;
+    struct { char *key; uint32_t value; } *type_idxs;
+
+    Arr(uint32_t) links;
+    Arr(PmiType) types;
+    Arr(PmiField) fields;
+    Arr(uint32_t) orders;
+    Arr(PmiDecl) decls;
+} PmiWriter;
+
+static uint32_t pmi_string(PmiWriter *w, const char *str) {
+    ptrdiff_t found = shgeti(w->string_offs, str);
+    if (found >= 0) return w->string_offs[found].value;
+
+    uint32_t off = (uint32_t)arrlenu(w->strings);
+    size_t len = strlen(str) + 1;
+    memcpy(arraddnptr(w->strings, len), str, len);
+    shput(w->string_offs, str, off);
+    return off;
+}
+
+static uint32_t pmi_type(PmiWriter *w, Type type) {
+    strb name = string_from_type(type);
+    strb key = NULL;
+    strbprintf(&key, "%d %d %d %s", type.kind, type.constant, type.kind == TkOption && type.option.is_null, name == NULL ? "" : name);
+    strbfree(name);
+
+    ptrdiff_t found = shgeti(w->type_idxs, key);
+    if (found >= 0) {
+        strbfree(key);
+        return w->type_idxs[found].value;
+    }
+
+    PmiType record = {
+        .kind = (uint8_t)type.kind,
+        .constant = type.constant,
+        .of = PMI_NONE,
+        .name = PMI_NONE,
+    };
+
+    switch (type.kind) {
+        case TkPtr:
+            record.of = pmi_type(w, *type.ptr_to);
+            break;
+        case TkArray:
+            record.of = pmi_type(w, *type.array.of);
+            if (type.array.len != NULL && type.array.len->kind == EkIntLit) {
+                record.len = type.array.len->intlit;
+            }
+            break;
+        case TkSlice:
+            record.of = pmi_type(w, *type.slice.of);
+            break;
+        case TkOption:
+            record.is_null = type.option.is_null;
+            record.gen_option = type.option.gen_option;
+            if (type.option.subtype != NULL) record.of = pmi_type(w, *type.option.subtype);
+            break;
+        case TkSoa:
+            record.of = pmi_type(w, *type.soa.of);
+            break;
+        case TkRange:
+            record.of = pmi_type(w, *type.range.subtype);
+            break;
+        case TkTypeDef:
+            record.name = pmi_string(w, type.typedeff);
+            break;
+        default:
+            break;
+    }
+
+    uint32_t idx = (uint32_t)arrlenu(w->types);
+    arrpush(w->types, record);
+    shput(w->type_idxs, key, idx);
+    strbfree(key);
+    return idx;
+}
+
+// only scalars eval_to_expr can write back as a literal
+static bool pmi_value(PmiWriter *w, Expr expr, PmiValue *out) {
+    ConstValue value;
+    if (!eval_value(w->sema, &expr, &value)) return false;
+
+    Expr literal;
+    if (!eval_to_expr(value, value.type, expr.cursors_idx, &literal)) return false;
+
+    *out = (PmiValue){
+        .type = pmi_type(w, value.type),
+        .bits = value.u,
+    };
+    return true;
+}
+
+static void pmi_layout(PmiWriter *w, PmiDecl *decl, const char *name) {
+    Type type = type_typedef(name, TYPEVAR, 0);
+    decl->size = layout_sizeof(w->sema->ast, type);
+    decl->layout_align = layout_alignof(w->sema->ast, type);
+}
+
+static void pmi_struct(PmiWriter *w, StructDecl structd) {
+    StructAttrs *attrs = structd.attrs;
+    PmiDecl decl = {
+        .kind = PdkStruct,
+        .name = pmi_string(w, structd.name.ident),
+        .type = PMI_NONE,
+        .fields = (uint32_t)arrlenu(w->fields),
+        .fields_len = (uint32_t)arrlenu(structd.fields),
+        .order = PMI_NONE,
+        .value = {.type = PMI_NONE},
+    };
+
+    for (size_t i = 0; i < arrlenu(structd.fields); i++) {
+        VarDecl field = structd.fields[i].vardecl;
+        bool hot = false;
+        for (size_t j = 0; attrs != NULL && j < arrlenu(attrs->hot); j++) {
+            if (streq(attrs->hot[j], field.name.ident)) hot = true;
+        }
+
+        arrpush(w->fields, ((PmiField){
+            .name = pmi_string(w, field.name.ident),
+            .type = pmi_type(w, field.type),
+            .hot = hot,
+            .value = {.type = PMI_NONE},
+        }));
+    }
+
+    if (attrs != NULL) {
+        decl.packed = attrs->packed;
+        decl.reorder = attrs->reorder;
+        decl.soa = attrs->soa;
+        decl.align = attrs->align;
+
+        if (attrs->order != NULL) {
+            decl.order = (uint32_t)arrlenu(w->orders);
+            for (size_t i = 0; i < arrlenu(attrs->order); i++) {
+                arrpush(w->orders, (uint32_t)attrs->order[i]);
+            }
+        }
+    }
+
+    pmi_layout(w, &decl, structd.name.ident);
+    arrpush(w->decls, decl);
+}
+
+static void pmi_enum(PmiWriter *w, EnumDecl enumd) {
+    PmiDecl decl = {
+        .kind = PdkEnum,
+        .name = pmi_string(w, enumd.name.ident),
+        .type = PMI_NONE,
+        .fields = (uint32_t)arrlenu(w->fields),
+        .fields_len = (uint32_t)arrlenu(enumd.fields),
+        .order = PMI_NONE,
+        .value = {.type = PMI_NONE},
+    };
+
+    uint32_t untyped = pmi_type(w, type_integer(TkUntypedInt, TYPECONST, 0));
+    for (size_t i = 0; i < arrlenu(enumd.fields); i++) {
+        const char *name = enumd.fields[i].constdecl.name.ident;
+        uint64_t value = 0;
+        eval_enum_field(w->sema, enumd, name, &value);
+
+        arrpush(w->fields, ((PmiField){
+            .name = pmi_string(w, name),
+            .type = PMI_NONE,
+            .value = {.type = untyped, .bits = value},
+        }));
+    }
+
+    arrpush(w->decls, decl);
+}
+
+static void pmi_union(PmiWriter *w, UnionDecl uniond) {
+    PmiDecl decl = {
+        .kind = PdkUnion,
+        .name = pmi_string(w, uniond.name.ident),
+        .type = PMI_NONE,
+        .fields = (uint32_t)arrlenu(w->fields),
+        .fields_len = (uint32_t)arrlenu(uniond.fields),
+        .order = PMI_NONE,
+        .value = {.type = PMI_NONE},
+    };
+
+    for (size_t i = 0; i < arrlenu(uniond.fields); i++) {
+        VarDecl variant = uniond.fields[i].vardecl;
+        arrpush(w->fields, ((PmiField){
+            .name = pmi_string(w, variant.name.ident),
+            .type = pmi_type(w, variant.type),
+            .value = {.type = PMI_NONE},
+        }));
+    }
+
+    pmi_layout(w, &decl, uniond.name.ident);
+    arrpush(w->decls, decl);
+}
+
+static void pmi_const(PmiWriter *w, ConstDecl constdecl) {
+    PmiValue value;
+    if (!pmi_value(w, constdecl.value, &value)) return;
+
+    arrpush(w->decls, ((PmiDecl){
+        .kind = PdkConst,
+        .name = pmi_string(w, constdecl.name.ident),
+        .type = constdecl.type.kind == TkNone ? PMI_NONE : pmi_type(w, constdecl.type),
+        .fields = PMI_NONE,
+        .order = PMI_NONE,
+        .value = value,
+    }));
+}
+
+static void pmi_fn(PmiWriter *w, FnDecl fndecl) {
+    // arrays are only returned at compile time, the call needs the body
+    if (!fndecl.has_body || fndecl.type.kind == TkArray || fndecl.name.kind != EkIdent) return;
+    if (streq(fndecl.name.ident, "main")) return;
+
+    Arr(PmiField) args = NULL;
+    for (size_t i = 0; i < arrlenu(fndecl.args); i++) {
+        Stmnt arg = fndecl.args[i];
+        VarDecl decl = arg.kind == SkVarDecl ? arg.vardecl : arg.constdecl;
+
+        PmiField field = {
+            .name = pmi_string(w, decl.name.ident),
+            .type = pmi_type(w, decl.type),
+            .var = arg.kind == SkVarDecl,
+            .value = {.type = PMI_NONE},
+        };
+
+        // the default is filled in at every call
+        if (arg.kind == SkVarDecl && decl.value.kind != EkNone && !pmi_value(w, decl.value, &field.value)) {
+            arrfree(args);
+            return;
+        }
+        arrpush(args, field);
+    }
+
+    arrpush(w->decls, ((PmiDecl){
+        .kind = PdkFn,
+        .method = fndecl.method,
+        .name = pmi_string(w, fndecl.name.ident),
+        .type = pmi_type(w, fndecl.type),
+        .fields = (uint32_t)arrlenu(w->fields),
+        .fields_len = (uint32_t)arrlenu(args),
+        .order = PMI_NONE,
+        .value = {.type = PMI_NONE},
+    }));
+
+    for (size_t i = 0; i < arrlenu(args); i++) {
+        arrpush(w->fields, args[i]);
+    }
+    arrfree(args);
+}
+
+static void pmi_section(Arr(char) *out, PmiSection *section, const void *records, size_t size, size_t len) {
+    while (arrlenu(*out) % 8 != 0) arrpush(*out, 0);
+
+    section->off = (uint32_t)arrlenu(*out);
+    section->len = (uint32_t)len;
+    size_t bytes = size * len;
+    if (bytes > 0) memcpy(arraddnptr(*out, bytes), records, bytes);
+}
+
+bool pmi_write(Sema *sema, const char *path, const char *object, Arr(const char*) links) {
+    PmiWriter w = {.sema = sema};
+    sh_new_strdup(w.string_offs);
+    sh_new_strdup(w.type_idxs);
+
+    // the object is written next to the interface
+    const char *object_name = object;
+    for (const char *c = object; *c != '\0'; c++) {
+        if (*c == '/' || *c == '\\') object_name = c + 1;
+    }
+
+    PmiHeader header = {
+        .magic = PMI_MAGIC,
+        .version = PMI_VERSION,
+        .object = pmi_string(&w, object_name),
+    };
+    for (size_t i = 0; i < arrlenu(links); i++) {
+        arrpush(w.links, pmi_string(&w, links[i]));
+    }
+
+    for (size_t i = 0; i < arrlenu(sema->ast); i++) {
+        Stmnt stmnt = sema->ast[i];
+        switch (stmnt.kind) {
+            case SkStructDecl:
+                pmi_struct(&w, stmnt.structdecl);
+                break;
+            case SkEnumDecl:
+                pmi_enum(&w, stmnt.enumdecl);
+                break;
+            case SkUnionDecl:
+                pmi_union(&w, stmnt.uniondecl);
+                break;
+            case SkConstDecl:
+                pmi_const(&w, stmnt.constdecl);
+                break;
+            case SkFnDecl:
+                pmi_fn(&w, stmnt.fndecl);
+                break;
+            default:
+                break;
+        }
+    }
+
+    Arr(char) out = NULL;
+    arrsetlen(out, sizeof(PmiHeader));
+    pmi_section(&out, &header.strings, w.strings, 1, arrlenu(w.strings));
+    pmi_section(&out, &header.links, w.links, sizeof(uint32_t), arrlenu(w.links));
+    pmi_section(&out, &header.types, w.types, sizeof(PmiType), arrlenu(w.types));
+    pmi_section(&out, &header.fields, w.fields, sizeof(PmiField), arrlenu(w.fields));
+    pmi_section(&out, &header.orders, w.orders, sizeof(uint32_t), arrlenu(w.orders));
+    pmi_section(&out, &header.decls, w.decls, sizeof(PmiDecl), arrlenu(w.decls));
+    memcpy(out, &header, sizeof(PmiHeader));
+
+    FILE *fd = fopen(path, "wb");
+    bool ok = fd != NULL && fwrite(out, 1, arrlenu(out), fd) == arrlenu(out);
+    if (fd != NULL) ok = fclose(fd) == 0 && ok;
+
+    arrfree(out);
+    arrfree(w.strings);
+    shfree(w.string_offs);
+    shfree(w.type_idxs);
+    arrfree(w.links);
+    arrfree(w.types);
+    arrfree(w.fields);
+    arrfree(w.orders);
+    arrfree(w.decls);
+    return ok;
+}
+
+typedef struct PmiReader {
+    const char *base;
+    size_t size;
+    PmiHeader header;
+
+    const char *strings;
+    const uint32_t *links;
+    const PmiType *types;
+    const PmiField *fields;
+    const uint32_t *orders;
+    const PmiDecl *decls;
+
+    Type *built; // one per PmiType
+    size_t cursors_idx;
+} PmiReader;
+
+// NOTE: never unmapped, the links point into it
+static const char *pmi_map(const char *path, size_t *size) {
+#if defined(_WIN32)
+    FILE *fd = fopen(path, "rb");
+    if (fd == NULL) return NULL;
+
+    fseek(fd, 0, SEEK_END);
+    long len = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    if (len <= 0) {
+        fclose(fd);
+        return NULL;
+    }
+
+    char *data = ealloc((size_t)len);
+    bool ok = fread(data, 1, (size_t)len, fd) == (size_t)len;
+    fclose(fd);
+    if (!ok) {
+        free(data);
+        return NULL;
+    }
+
+    *size = (size_t)len;
+    return data;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    *size = (size_t)st.st_size;
+    return data;
+#endif
+}
+
+static bool pmi_section_ok(PmiReader *r, PmiSection section, size_t size) {
+    return section.off % 8 == 0 && (uint64_t)section.off + (uint64_t)section.len * size <= r->size;
+}
+
+static bool pmi_range_ok(uint32_t start, uint32_t len, uint32_t section_len) {
+    return (uint64_t)start + len <= section_len;
+}
+
+static const char *pmi_str(PmiReader *r, uint32_t off) {
+    if (off >= r->header.strings.len) return NULL;
+
+    const char *str = r->strings + off;
+    return lexer_intern(str, strlen(str));
+}
+
+static bool pmi_type_at(PmiReader *r, uint32_t idx, Type *out) {
+    if (idx == PMI_NONE) {
+        *out = type_none();
+        return true;
+    }
+    if (idx >= r->header.types.len) return false;
+
+    *out = r->built[idx];
+    return true;
+}
+
+static bool pmi_value_at(PmiReader *r, PmiValue value, Expr *out) {
+    if (value.type == PMI_NONE) {
+        *out = expr_none();
+        return true;
+    }
+
+    ConstValue cv = {.u = value.bits};
+    if (!pmi_type_at(r, value.type, &cv.type)) return false;
+    return eval_to_expr(cv, cv.type, r->cursors_idx, out);
+}
+
+// children always come first, so every type only points back at ones already built
+static bool pmi_build_types(PmiReader *r) {
+    size_t cursor = r->cursors_idx;
+    size_t len = r->header.types.len;
+    r->built = arena_alloc(&ast_arena, sizeof(Type) * (len > 0 ? len : 1));
+
+    for (size_t i = 0; i < len; i++) {
+        PmiType record = r->types[i];
+        if (record.kind > TkPoison) return false;
+
+        bool compound = record.kind == TkPtr || record.kind == TkArray || record.kind == TkSlice || record.kind == TkSoa || record.kind == TkRange || (record.kind == TkOption && !record.is_null);
+        if (compound && record.of >= i) return false;
+        Type *of = compound ? &r->built[record.of] : NULL;
+
+        switch (record.kind) {
+            case TkPtr:
+                r->built[i] = type_ptr(of, record.constant, cursor);
+                break;
+            case TkArray: {
+                Expr *len = NULL;
+                if (record.len != 0) {
+                    len = arena_alloc(&ast_arena, sizeof(Expr));
+                    *len = expr_intlit(record.len, type_integer(TkUsize, TYPECONST, cursor), cursor);
+                }
+                r->built[i] = type_array((Array){.of = of, .len = len}, record.constant, cursor);
+            } break;
+            case TkSlice:
+                r->built[i] = type_slice((Slice){.of = of}, record.constant, cursor);
+                break;
+            case TkOption:
+                r->built[i] = type_option((Option){
+                    .subtype = of,
+                    .is_null = record.is_null,
+                    .gen_option = record.gen_option,
+                }, record.constant, cursor);
+                break;
+            case TkSoa:
+                r->built[i] = type_soa((Soa){.of = of}, record.constant, cursor);
+                break;
+            case TkRange:
+                r->built[i] = type_range((Range){.subtype = of}, record.constant, cursor);
+                break;
+            case TkTypeDef: {
+                const char *name = pmi_str(r, record.name);
+                if (name == NULL) return false;
+                r->built[i] = type_typedef(name, record.constant, cursor);
+            } break;
+            default:
+                r->built[i] = (Type){
+                    .kind = (TypeKind)record.kind,
+                    .constant = record.constant,
+                    .cursors_idx = cursor,
+                };
+                break;
+        }
+    }
+
+    return true;
+}
+
+static bool pmi_build_decl(PmiReader *r, PmiDecl decl, Arr(Stmnt) *ast) {
+    size_t cursor = r->cursors_idx;
+    const char *name = pmi_str(r, decl.name);
+    if (name == NULL) return false;
+    Expr ident = expr_ident(name, type_none(), cursor);
+
+    if (decl.kind != PdkConst && !pmi_range_ok(decl.fields, decl.fields_len, r->header.fields.len)) return false;
+    const PmiField *fields = decl.kind != PdkConst ? &r->fields[decl.fields] : NULL;
+
+    Type type;
+    if (!pmi_type_at(r, decl.type, &type)) return false;
+
+    switch (decl.kind) {
+        case PdkStruct: {
+            StructAttrs *attrs = arena_alloc(&ast_arena, sizeof(StructAttrs));
+            *attrs = (StructAttrs){
+                .reorder = decl.reorder,
+                .packed = decl.packed,
+                .soa = decl.soa,
+                .align = decl.align,
+                .laid_out = true, // the library decided the order, the object was compiled with it
+            };
+
+            Arr(Stmnt) vars = NULL;
+            for (uint32_t i = 0; i < decl.fields_len; i++) {
+                const char *field = pmi_str(r, fields[i].name);
+                Type field_type;
+                if (field == NULL || !pmi_type_at(r, fields[i].type, &field_type)) return false;
+
+                if (fields[i].hot) arrpush(attrs->hot, field);
+                arrpush(vars, stmnt_vardecl((VarDecl){
+                    .name = expr_ident(field, type_none(), cursor),
+                    .type = field_type,
+                    .value = expr_none(),
+                }, cursor));
+            }
+
+            if (decl.order != PMI_NONE) {
+                if (!pmi_range_ok(decl.order, decl.fields_len, r->header.orders.len)) return false;
+                for (uint32_t i = 0; i < decl.fields_len; i++) {
+                    if (r->orders[decl.order + i] >= decl.fields_len) return false;
+                    arrpush(attrs->order, r->orders[decl.order + i]);
+                }
+            }
+
+            arrpush(*ast, stmnt_structdecl((StructDecl){
+                .name = ident,
+                .fields = vars,
+                .attrs = attrs,
+            }, cursor));
+            layout_seed(type_typedef(name, TYPEVAR, cursor), decl.size, decl.layout_align);
+        } break;
+        case PdkEnum: {
+            Arr(Stmnt) consts = NULL;
+            for (uint32_t i = 0; i < decl.fields_len; i++) {
+                const char *field = pmi_str(r, fields[i].name);
+                if (field == NULL) return false;
+
+                // numbered the same way sema_enum_decl numbers fields without a value
+                Expr value = expr_intlit(fields[i].value.bits, type_integer(TkUntypedInt, TYPECONST, cursor), cursor);
+                arrpush(consts, stmnt_constdecl((ConstDecl){
+                    .name = expr_ident(field, type_none(), cursor),
+                    .type = type_none(),
+                    .value = value,
+                }, cursor));
+            }
+
+            arrpush(*ast, stmnt_enumdecl((EnumDecl){
+                .name = ident,
+                .fields = consts,
+                .attrs = NULL,
+            }, cursor));
+        } break;
+        case PdkUnion: {
+            Arr(Stmnt) variants = NULL;
+            for (uint32_t i = 0; i < decl.fields_len; i++) {
+                const char *variant = pmi_str(r, fields[i].name);
+                Type variant_type;
+                if (variant == NULL || !pmi_type_at(r, fields[i].type, &variant_type)) return false;
+
+                arrpush(variants, stmnt_vardecl((VarDecl){
+                    .name = expr_ident(variant, type_none(), cursor),
+                    .type = variant_type,
+                    .value = expr_none(),
+                }, cursor));
+            }
+
+            arrpush(*ast, stmnt_uniondecl((UnionDecl){
+                .name = ident,
+                .fields = variants,
+                .attrs = NULL,
+            }, cursor));
+            layout_seed(type_typedef(name, TYPEVAR, cursor), decl.size, decl.layout_align);
+        } break;
+        case PdkConst: {
+            Expr value;
+            if (!pmi_value_at(r, decl.value, &value)) return false;
+
+            arrpush(*ast, stmnt_constdecl((ConstDecl){
+                .name = ident,
+                .type = type,
+                .value = value,
+            }, cursor));
+        } break;
+        case PdkFn: {
+            Arr(Stmnt) args = NULL;
+            for (uint32_t i = 0; i < decl.fields_len; i++) {
+                const char *arg = pmi_str(r, fields[i].name);
+                VarDecl var = {.name = expr_ident(arg, type_none(), cursor)};
+                if (arg == NULL || !pmi_type_at(r, fields[i].type, &var.type) || !pmi_value_at(r, fields[i].value, &var.value)) {
+                    return false;
+                }
+
+                arrpush(args, fields[i].var ? stmnt_vardecl(var, cursor) : stmnt_constdecl(var, cursor));
+            }
+
+            // the body is in the object
+            Stmnt *fn = arena_alloc(&ast_arena, sizeof(Stmnt));
+            *fn = stmnt_fndecl((FnDecl){
+                .name = ident,
+                .type = type,
+                .args = args,
+                .body = NULL,
+                .has_body = false,
+                .method = decl.method,
+            }, cursor);
+            arrpush(*ast, stmnt_extern(fn, cursor));
+        } break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+const char *pmi_load(const char *path, size_t cursors_idx, Arr(Stmnt) *ast) {
+    PmiReader r = {.cursors_idx = cursors_idx};
+    r.base = pmi_map(path, &r.size);
+
+    strb err = NULL;
+    if (r.base == NULL) {
+        strbprintf(&err, "failed to read %s", path);
+        return err;
+    }
+
+    if (r.size < sizeof(PmiHeader)) goto corrupt;
+    memcpy(&r.header, r.base, sizeof(PmiHeader));
+    if (memcmp(r.header.magic, PMI_MAGIC, sizeof(PMI_MAGIC)) != 0 || r.header.version != PMI_VERSION) {
+        strbprintf(&err, "%s was not written by this version of pine, build the library again with -pmi", path);
+        return err;
+    }
+
+    if (!pmi_section_ok(&r, r.header.strings, 1)) goto corrupt;
+    if (!pmi_section_ok(&r, r.header.links, sizeof(uint32_t))) goto corrupt;
+    if (!pmi_section_ok(&r, r.header.types, sizeof(PmiType))) goto corrupt;
+    if (!pmi_section_ok(&r, r.header.fields, sizeof(PmiField))) goto corrupt;
+    if (!pmi_section_ok(&r, r.header.orders, sizeof(uint32_t))) goto corrupt;
+    if (!pmi_section_ok(&r, r.header.decls, sizeof(PmiDecl))) goto corrupt;
+
+    r.strings = r.base + r.header.strings.off;
+    r.links = (const uint32_t*)(r.base + r.header.links.off);
+    r.types = (const PmiType*)(r.base + r.header.types.off);
+    r.fields = (const PmiField*)(r.base + r.header.fields.off);
+    r.orders = (const uint32_t*)(r.base + r.header.orders.off);
+    r.decls = (const PmiDecl*)(r.base + r.header.decls.off);
+
+    // every string read with strlen stays inside the section
+    if (r.header.strings.len == 0 || r.strings[r.header.strings.len - 1] != '\0') goto corrupt;
+
+    if (r.header.object >= r.header.strings.len) goto corrupt;
+    arrpush(*ast, stmnt_directive((Directive){
+        .kind = DkLink,
+        .str = module_resolve(path, r.strings + r.header.object),
+    }, cursors_idx));
+    for (uint32_t i = 0; i < r.header.links.len; i++) {
+        if (r.links[i] >= r.header.strings.len) goto corrupt;
+        arrpush(*ast, stmnt_directive((Directive){
+            .kind = DkLink,
+            .str = r.strings + r.links[i],
+        }, cursors_idx));
+    }
+
+    if (!pmi_build_types(&r)) goto corrupt;
+    for (uint32_t i = 0; i < r.header.decls.len; i++) {
+        if (!pmi_build_decl(&r, r.decls[i], ast)) goto corrupt;
+    }
+
+    return NULL;
+
+corrupt:
+    strbprintf(&err, "%s is not a valid module interface", path);
+    return err;
+}
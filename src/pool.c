@@ -0,0 +1,71 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "include/arena.h"
+#include "include/pool.h"
+#include "include/utils.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef struct Pool {
+    PoolJob job;
+    void *ctx;
+    size_t jobs;
+    atomic_size_t next;
+} Pool;
+
+size_t pool_default_threads(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long n = (long)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n > 0 ? (size_t)n : 1;
+}
+
+static void pool_work(Pool *pool) {
+    for (size_t i = atomic_fetch_add(&pool->next, 1); i < pool->jobs; i = atomic_fetch_add(&pool->next, 1)) {
+        pool->job(pool->ctx, i);
+    }
+}
+
+static void *pool_worker(void *arg) {
+    pool_work(arg);
+    arena_retire(&ast_arena);
+    return NULL;
+}
+
+void pool_for(size_t threads, size_t jobs, PoolJob job, void *ctx) {
+    Pool pool = {
+        .job = job,
+        .ctx = ctx,
+        .jobs = jobs,
+    };
+    atomic_init(&pool.next, 0);
+
+    if (threads > jobs) threads = jobs;
+    if (threads <= 1) {
+        pool_work(&pool);
+        return;
+    }
+
+    pthread_t *workers = ealloc(sizeof(pthread_t) * (threads - 1));
+    size_t spawned = 0;
+    for (; spawned < threads - 1; spawned++) {
+        // fewer threads is fine, whatever's left runs on this one
+        if (pthread_create(&workers[spawned], NULL, pool_worker, &pool) != 0) break;
+    }
+
+    pool_work(&pool);
+    for (size_t i = 0; i < spawned; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+}
@@ -1,10 +1,15 @@
 #include <inttypes.h>
 #include <stddef.h>
 #include <assert.h>
+#include <setjmp.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include "include/arena.h"
 #include "include/eval.h"
 #include "include/exprs.h"
+#include "include/layout.h"
+#include "include/pool.h"
 #include "include/stb_ds.h"
 #include "include/sema.h"
 #include "include/stmnts.h"
@@ -12,16 +17,26 @@
 #include "include/types.h"
 #include "include/utils.h"
 #include "include/typecheck.h"
+#include "include/vm.h"
+#include "include/module.h"
 
 #define ERRORS_MAX 5
 
 static void elog(Sema *sema, size_t i, const char *msg, ...) {
     sema->error_count++;
-    eprintf("%s:%lu:%lu " TERM_RED "error" TERM_END ": ", sema->filename, sema->cursors[i].row, sema->cursors[i].col);
 
     va_list args;
     va_start(args, msg);
 
+    if (sema_buffer_error(sema, i, false, msg, args)) {
+        va_end(args);
+        return;
+    }
+
+    Cursor cursor;
+    const char *filename = module_cursor(i, &cursor);
+    eprintf("%s:%lu:%lu " TERM_RED "error" TERM_END ": ", filename, cursor.row, cursor.col);
+
     veprintfln(msg, args);
 
     va_end(args);
@@ -43,6 +58,8 @@ static bool decl_has_name(Stmnt stmnt, const char *key) {
             return streq(key, stmnt.structdecl.name.ident);
         case SkEnumDecl:
             return streq(key, stmnt.enumdecl.name.ident);
+        case SkUnionDecl:
+            return streq(key, stmnt.uniondecl.name.ident);
         default:
             return false;
     }
@@ -72,27 +89,37 @@ SymTab symtab_init(void) {
     SymTab symtab = {
         .stmnts = NULL,
         .keys = NULL,
+        .visible = NULL,
         .cur_scope = 0,
     };
     arrpush(symtab.keys, NULL);
     arrpush(symtab.stmnts, NULL);
+    arrpush(symtab.visible, 0);
 
     return symtab;
 }
 
-Stmnt symtab_find(Sema *sema, const char *key, size_t cursor_idx) {
-    size_t index = 0;
-    bool found = false;
-
-    for (size_t i = 0; i < arrlenu(sema->symtab.keys[sema->symtab.cur_scope]); i++) {
-        if (streq(key, sema->symtab.keys[sema->symtab.cur_scope][i])) {
-            index = i;
-            found = true;
-            break;
+// the scope key is declared in, with its index in there, or false if it isn't in scope
+static bool symtab_lookup(SymTab *symtab, const char *key, size_t *scope, size_t *index) {
+    size_t len = arrlenu(symtab->keys[symtab->cur_scope]);
+    for (size_t s = symtab->cur_scope + 1; s-- > 0;) {
+        for (size_t i = 0; i < len; i++) {
+            if (streq(key, symtab->keys[s][i])) {
+                *scope = s;
+                *index = i;
+                return true;
+            }
         }
+        len = symtab->visible[s];
     }
 
-    if (found) return sema->symtab.stmnts[sema->symtab.cur_scope][index];
+    return false;
+}
+
+Stmnt symtab_find(Sema *sema, const char *key, size_t cursor_idx) {
+    size_t scope = 0;
+    size_t index = 0;
+    if (symtab_lookup(&sema->symtab, key, &scope, &index)) return sema->symtab.stmnts[scope][index];
 
     // if not in symtab, see if it's defined at least
     Stmnt stmnt = ast_find_decl(sema->ast, key);
@@ -103,12 +130,19 @@ Stmnt symtab_find(Sema *sema, const char *key, size_t cursor_idx) {
 }
 
 void symtab_push(Sema *sema, const char *key, Stmnt value) {
-    for (size_t i = 0; i < arrlenu(sema->symtab.keys[sema->symtab.cur_scope]); i++) {
-        if (streq(key, sema->symtab.keys[sema->symtab.cur_scope][i])) {
-            size_t index = sema->symtab.stmnts[sema->symtab.cur_scope][i].cursors_idx;
-            elog(sema, value.cursors_idx, "redeclaration of \"%s\" from %zu:%zu", key, sema->cursors[index].row, sema->cursors[index].col);
-            return;
+    // shadowing counts as a redeclaration
+    size_t scope = 0;
+    size_t i = 0;
+    if (symtab_lookup(&sema->symtab, key, &scope, &i)) {
+        Cursor cursor, redecl;
+        const char *filename = module_cursor(sema->symtab.stmnts[scope][i].cursors_idx, &cursor);
+        const char *redecl_filename = module_cursor(value.cursors_idx, &redecl);
+        if (streq(filename, redecl_filename)) {
+            elog(sema, value.cursors_idx, "redeclaration of \"%s\" from %u:%u", key, cursor.row, cursor.col);
+        } else {
+            elog(sema, value.cursors_idx, "redeclaration of \"%s\" from %s:%u:%u", key, filename, cursor.row, cursor.col);
         }
+        return;
     }
 
     arrpush(sema->symtab.keys[sema->symtab.cur_scope], key);
@@ -116,23 +150,19 @@ void symtab_push(Sema *sema, const char *key, Stmnt value) {
 }
 
 void symtab_new_scope(Sema *sema) {
-    Arr(const char*) keys = NULL;
-    Arr(Stmnt) stmnts = NULL;
-
-    for (size_t i = 0; i < arrlenu(sema->symtab.keys[sema->symtab.cur_scope]); i++) {
-        arrpush(keys, sema->symtab.keys[sema->symtab.cur_scope][i]);
-        arrpush(stmnts, sema->symtab.stmnts[sema->symtab.cur_scope][i]);
-    }
-
-    arrpush(sema->symtab.keys, keys);
-    arrpush(sema->symtab.stmnts, stmnts);
+    arrpush(sema->symtab.visible, arrlenu(sema->symtab.keys[sema->symtab.cur_scope]));
+    arrpush(sema->symtab.keys, NULL);
+    arrpush(sema->symtab.stmnts, NULL);
     sema->symtab.cur_scope++;
 }
 
 void symtab_pop_scope(Sema *sema) {
+    arrfree(sema->symtab.keys[sema->symtab.cur_scope]);
+    arrfree(sema->symtab.stmnts[sema->symtab.cur_scope]);
     // (void) to silence warnings
     (void)arrpop(sema->symtab.keys);
     (void)arrpop(sema->symtab.stmnts);
+    (void)arrpop(sema->symtab.visible);
     sema->symtab.cur_scope--;
 }
 
@@ -157,26 +187,50 @@ void dgraph_push(Dgraph *graph, Dnode node) {
     }
 }
 
-Sema sema_init(Arr(Stmnt) ast, const char *filename, Arr(Cursor) cursors, int error_count) {
+Sema sema_init(Arr(Stmnt) ast, int error_count) {
     return (Sema){
         .ast = ast,
         .symtab = symtab_init(),
         .envinfo = {
             .fn = stmnt_none(),
             .forl = false,
+            .const_call = false,
         },
         .compile_flags = {
             .output = false,
             .optimise = false,
+            .reorder = false,
         },
         .dgraph = dgraph_init(),
+        .switches = NULL,
+        .comptime = NULL,
+        .vm = NULL,
+
+        .bodies = NULL,
+        .threads = 1,
+
+        .worker = false,
+        .diagnostics = NULL,
+        .directives = NULL,
 
-        .filename = filename,
-        .cursors = cursors,
         .error_count = error_count,
     };
 }
 
+bool sema_buffer_error(Sema *sema, size_t cursor_idx, bool fatal, const char *msg, va_list args) {
+    if (!sema->worker) return false;
+
+    strb text = NULL;
+    vstrbprintf(&text, msg, args);
+    arrpush(sema->diagnostics, ((Diagnostic){
+        .cursors_idx = cursor_idx,
+        .order = 0, // set when merged in sema_bodies
+        .msg = text,
+        .fatal = fatal,
+    }));
+    return true;
+}
+
 static Type *deref_ptr(Type *type) {
     if (type->kind == TkPtr) {
         return type->ptr_to;
@@ -185,55 +239,61 @@ static Type *deref_ptr(Type *type) {
     return type;
 }
 
-static Type type_of_stmnt(Sema *sema, Stmnt stmnt) {
-    switch (stmnt.kind) {
+static TypeId type_of_stmnt(Sema *sema, Stmnt *stmnt) {
+    switch (stmnt->kind) {
         case SkFnDecl:
-            return stmnt.fndecl.type;
+            return type_intern(&stmnt->fndecl.type);
         case SkFnCall:
-            assert(stmnt.fncall.name->kind == EkIdent);
-            Stmnt decl = symtab_find(sema, stmnt.fncall.name->ident, stmnt.cursors_idx);
+            assert(stmnt->fncall.name->kind == EkIdent);
+            Stmnt decl = symtab_find(sema, stmnt->fncall.name->ident, stmnt->cursors_idx);
             assert(decl.kind == SkFnDecl);
-            return decl.fndecl.type;
+            return type_intern(&decl.fndecl.type);
         case SkVarDecl:
-            return stmnt.vardecl.type;
+            return type_intern(&stmnt->vardecl.type);
         case SkVarReassign:
-            return stmnt.varreassign.type;
+            return type_intern(&stmnt->varreassign.type);
         case SkConstDecl:
-            return stmnt.constdecl.type;
+            return type_intern(&stmnt->constdecl.type);
         case SkReturn:
-            return stmnt.returnf.type;
+            return type_intern(&stmnt->returnf.type);
         case SkStructDecl:
-            elog(sema, stmnt.cursors_idx, "unexpected struct declaration");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected struct declaration");
+            return TkPoison;
         case SkEnumDecl:
-            elog(sema, stmnt.cursors_idx, "unexpected enum declaration");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected enum declaration");
+            return TkPoison;
+        case SkUnionDecl:
+            elog(sema, stmnt->cursors_idx, "unexpected union declaration");
+            return TkPoison;
         case SkContinue:
-            elog(sema, stmnt.cursors_idx, "unexpected continue statement");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected continue statement");
+            return TkPoison;
         case SkBreak:
-            elog(sema, stmnt.cursors_idx, "unexpected break statement");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected break statement");
+            return TkPoison;
         case SkBlock:
-            elog(sema, stmnt.cursors_idx, "unexpected scope block");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected scope block");
+            return TkPoison;
         case SkIf:
-            elog(sema, stmnt.cursors_idx, "unexpected if statement");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected if statement");
+            return TkPoison;
         case SkFor:
-            elog(sema, stmnt.cursors_idx, "unexpected for loop");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected for loop");
+            return TkPoison;
+        case SkSwitch:
+            elog(sema, stmnt->cursors_idx, "unexpected switch statement");
+            return TkPoison;
         case SkExtern:
-            elog(sema, stmnt.cursors_idx, "unexpected extern statement");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected extern statement");
+            return TkPoison;
         case SkDirective:
-            elog(sema, stmnt.cursors_idx, "unexpected directive");
-            return type_poison();
+            elog(sema, stmnt->cursors_idx, "unexpected directive");
+            return TkPoison;
         default:
-            return type_poison();
+            return TkPoison;
     }
 
-    return type_poison();
+    return TkPoison;
 }
 
 bool stmnt_is_constant(Stmnt stmnt) {
@@ -284,7 +344,7 @@ Type *resolve_expr_type(Sema *sema, Expr *expr) {
             } else {
                 elog(sema, expr->cursors_idx, "expected ident to be a variable or constant");
                 // NOTE: This leaks memory but after sema, the program will exit(1)
-                Type *type = ealloc(sizeof(Type)); *type = type_poison();
+                Type *type = arena_alloc(&ast_arena, sizeof(Type)); *type = type_poison();
                 return type;
             }
             return &expr->type;
@@ -299,7 +359,7 @@ Type *resolve_expr_type(Sema *sema, Expr *expr) {
         case EkType:
             // NOTE: this might not be the right way to do things
             // watch this carefully
-            return &expr->type_expr;
+            return expr->type_expr;
         case EkNone:
             assert(false);
     }
@@ -308,14 +368,114 @@ Type *resolve_expr_type(Sema *sema, Expr *expr) {
     return NULL;
 }
 
+static bool type_is_signed(TypeId type) {
+    switch (type_canon(type)->kind) {
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkUntypedInt:
+        case TkTypeDef: // enums are ints in C
+            return true;
+        default:
+            return false;
+    }
+}
+
+// replaces expr with its value if it's known at compile time
+// so the generated code gets a literal instead of the whole expression
+void sema_fold(Sema *sema, Expr *expr) {
+    if (expr->type.kind == TkPoison || expr->type.kind == TkNone) return;
+
+    ConstValue value;
+    Expr folded;
+    if (!eval_value(sema, expr, &value)) return;
+
+    // C does integer arithmetic in int or wider and only truncates on assignment or a cast,
+    // a result that doesn't fit the expression's type is left for whatever it ends up in to fold
+    bool is_float = value.type.kind == TkF32 || value.type.kind == TkF64 || value.type.kind == TkUntypedFloat;
+    ConstValue narrowed, widened;
+    if (!eval_convert(value, expr->type, &narrowed) || !eval_convert(narrowed, value.type, &widened)) return;
+    if (!is_float && widened.u != value.u) return;
+
+    if (!eval_to_expr(value, expr->type, expr->cursors_idx, &folded)) return;
+
+    *expr = folded;
+}
+
+// array lengths have to be known at compile time, they're folded into a usize literal
+void sema_array_len(Sema *sema, Type *type, size_t cursor_idx) {
+    switch (type->kind) {
+        case TkPtr:
+            sema_array_len(sema, type->ptr_to, cursor_idx);
+            return;
+        case TkSlice:
+            sema_array_len(sema, type->slice.of, cursor_idx);
+            return;
+        case TkOption:
+            sema_array_len(sema, type->option.subtype, cursor_idx);
+            return;
+        case TkArray:
+            break;
+        default:
+            return;
+    }
+
+    sema_array_len(sema, type->array.of, cursor_idx);
+
+    Expr *len = type->array.len;
+    if (len->kind == EkNone) return;
+    // already folded, the type can be shared with a global that's read by other function bodies
+    if (len->kind == EkIntLit && len->type.kind == TkUsize) return;
+
+    sema_expr(sema, len);
+    if (len->type.kind == TkPoison) return;
+
+    ConstValue value;
+    if (!eval_value(sema, len, &value)) {
+        elog(sema, len->cursors_idx, "array length must be known at compile time");
+        return;
+    }
+    if (value.type.kind == TkF32 || value.type.kind == TkF64 || value.type.kind == TkUntypedFloat) {
+        elog(sema, len->cursors_idx, "array length must be an integer");
+        return;
+    }
+    if (type_is_signed(type_intern(&value.type)) && value.i < 0) {
+        elog(sema, len->cursors_idx, "array length cannot be negative, got %" PRIi64, value.i);
+        return;
+    }
+
+    Expr folded;
+    if (!eval_to_expr(value, type_integer(TkUsize, TYPECONST, len->cursors_idx), len->cursors_idx, &folded)) {
+        elog(sema, len->cursors_idx, "array length %" PRIu64 " is too large", value.u);
+        return;
+    }
+    // a struct holding this array may have had its layout cached with a zero length
+    if (len->kind != EkIntLit) type_layout_epoch++;
+    *len = folded;
+}
+
 void sema_directive(Sema *sema, Stmnt *stmnt) {
     assert(stmnt->kind == SkDirective);
 
     switch (stmnt->directive.kind) {
         case DkLink:
         case DkSyslink:
+        case DkReorder: // checked before analysis in sema_analyse
             return;
+        case DkImport: // taken out of the ast while loading modules
+            elog(sema, stmnt->cursors_idx, "#import must be at the top level of a file and outside of #if");
+            break;
+        case DkIf:
+            assert(false && "resolved before analysis in sema_resolve_ifs");
         case DkOutput:
+            // the flags are shared by every function, directives in bodies are checked once they're all done
+            if (sema->worker) {
+                arrpush(sema->directives, stmnt);
+                break;
+            }
+
             if (!sema->compile_flags.output) {
                 sema->compile_flags.output = true;
             } else {
@@ -329,6 +489,11 @@ void sema_directive(Sema *sema, Stmnt *stmnt) {
         case DkOdebug:
         case DkOfast:
         case DkOsmall:
+            if (sema->worker) {
+                arrpush(sema->directives, stmnt);
+                break;
+            }
+
             if (!sema->compile_flags.optimise) {
                 sema->compile_flags.optimise = true;
             } else {
@@ -339,10 +504,11 @@ void sema_directive(Sema *sema, Stmnt *stmnt) {
     }
 }
 
-static Expr get_field(Sema *sema, Type type, const char *fieldname, size_t cursor_idx) {
-    switch (type.kind) {
+static Expr get_field(Sema *sema, TypeId type, const char *fieldname, size_t cursor_idx) {
+    const Type *t = type_canon(type);
+    switch (t->kind) {
         case TkPtr:
-            return get_field(sema, *type.ptr_to, fieldname, cursor_idx);
+            return get_field(sema, t->ptr_to->id, fieldname, cursor_idx);
         case TkString: {
             enum { StringFieldsLen = 2 };
             Expr StringFields[StringFieldsLen] = {
@@ -357,6 +523,27 @@ static Expr get_field(Sema *sema, Type type, const char *fieldname, size_t curso
             }
             elog(sema, cursor_idx, "string does not have field \"%s\"", fieldname);
         } break;
+        case TkSoa: {
+            enum { SoaFieldsLen = 2 };
+            Expr SoaFields[SoaFieldsLen] = {
+                expr_ident("len", type_integer(TkUsize, TYPECONST, cursor_idx), cursor_idx),
+                expr_ident("cap", type_integer(TkUsize, TYPECONST, cursor_idx), cursor_idx),
+            };
+
+            for (size_t i = 0; i < SoaFieldsLen; i++) {
+                if (streq(fieldname, SoaFields[i].ident)) {
+                    return SoaFields[i];
+                }
+            }
+
+            // <soa>.<field> is the whole column as a slice
+            Expr field = get_field(sema, t->soa.of->id, fieldname, cursor_idx);
+            if (field.kind == EkNone) return field;
+
+            Type *of = arena_alloc(&ast_arena, sizeof(Type)); *of = field.type;
+            field.type = type_slice((Slice){ .of = of }, TYPEVAR, cursor_idx);
+            return field;
+        } break;
         case TkSlice: {
             Expr slice_len = expr_ident("len", type_integer(TkUsize, TYPECONST, cursor_idx), cursor_idx);
             if (streq(fieldname, slice_len.ident)) {
@@ -381,7 +568,7 @@ static Expr get_field(Sema *sema, Type type, const char *fieldname, size_t curso
             elog(sema, cursor_idx, "array does not have field \"%s\"", fieldname);
         } break;
         case TkTypeDef: {
-            Stmnt typedeff = symtab_find(sema, type.typedeff, cursor_idx);
+            Stmnt typedeff = symtab_find(sema, t->typedeff, cursor_idx);
 
             if (typedeff.kind == SkStructDecl) {
                 for (size_t i = 0; i < arrlenu(typedeff.structdecl.fields); i++) {
@@ -391,23 +578,27 @@ static Expr get_field(Sema *sema, Type type, const char *fieldname, size_t curso
                         return expr_ident(fieldname, decl.vardecl.type, cursor_idx);
                     }
                 }
-                strb t = string_from_type(type);
-                elog(sema, cursor_idx, "%s does not have field \"%s\" ", t, fieldname);
-                strbfree(t);
+                strb name = string_from_type(*t);
+                elog(sema, cursor_idx, "%s does not have field \"%s\" ", name, fieldname);
+                strbfree(name);
             } else if (typedeff.kind == SkEnumDecl) {
                 for (size_t i = 0; i < arrlenu(typedeff.enumdecl.fields); i++) {
                     Stmnt decl = typedeff.enumdecl.fields[i];
                     assert(decl.kind == SkConstDecl);
                     if (decl_has_name(decl, fieldname)) {
-                        return expr_ident(fieldname, type, cursor_idx);
+                        return expr_ident(fieldname, *t, cursor_idx);
                     }
                 }
-                strb t = string_from_type(type);
-                elog(sema, cursor_idx, "%s does not have field \"%s\" ", t, fieldname);
+                strb name = string_from_type(*t);
+                elog(sema, cursor_idx, "%s does not have field \"%s\" ", name, fieldname);
+            } else if (typedeff.kind == SkUnionDecl) {
+                strb name = string_from_type(*t);
+                elog(sema, cursor_idx, "cannot access variant \"%s\" of %s directly, use a switch", fieldname, name);
+                strbfree(name);
             } else {
-                strb t = string_from_type(type);
-                comp_elog("get_field unreachable type: %s", t);
-                // strbfree(t);
+                strb name = string_from_type(*t);
+                comp_elog("get_field unreachable type: %s", name);
+                // strbfree(name);
             }
         } break;
         default:
@@ -432,26 +623,69 @@ void sema_range_lit(Sema *sema, Expr *expr, bool slice) {
         elog(sema, expr->cursors_idx, "range slice cannot be inclusive when end is the length of element");
     }
 
-    if (expr->rangelit.start->kind != EkNone && !tc_is_unsigned(sema, *expr->rangelit.start)) {
+    if (expr->rangelit.start->kind != EkNone && !tc_is_unsigned(sema, expr->rangelit.start)) {
         elog(sema, expr->cursors_idx, "range literals must be unsigned integers");
     }
 
-    if (expr->rangelit.end->kind != EkNone && !tc_is_unsigned(sema, *expr->rangelit.end)) {
+    if (expr->rangelit.end->kind != EkNone && !tc_is_unsigned(sema, expr->rangelit.end)) {
         elog(sema, expr->cursors_idx, "range literals must be unsigned integers");
     }
 }
 
+// returns -1 if not found
+static ptrdiff_t union_variant_index(UnionDecl uniond, const char *name) {
+    for (size_t i = 0; i < arrlenu(uniond.fields); i++) {
+        if (streq(uniond.fields[i].vardecl.name.ident, name)) return (ptrdiff_t)i;
+    }
+    return -1;
+}
+
+// <union>.<variant>, only for variants without a payload
+void sema_union_variant_access(Sema *sema, Expr *expr, UnionDecl uniond) {
+    assert(expr->kind == EkFieldAccess);
+    const char *name = expr->fieldacc.field->ident;
+
+    ptrdiff_t i = union_variant_index(uniond, name);
+    if (i < 0) {
+        elog(sema, expr->cursors_idx, "%s does not have variant \"%s\"", uniond.name.ident, name);
+        expr->type = type_poison();
+        return;
+    }
+
+    if (uniond.fields[i].vardecl.type.kind != TkVoid) {
+        elog(sema, expr->cursors_idx, "variant \"%s\" has a payload, use %s{.%s = <value>}", name, uniond.name.ident, name);
+        expr->type = type_poison();
+        return;
+    }
+
+    expr->type = type_typedef(uniond.name.ident, TYPEVAR, expr->cursors_idx);
+    expr->fieldacc.field->type = expr->type;
+}
+
 void sema_field_access(Sema *sema, Expr *expr) {
     assert(expr->kind == EkFieldAccess);
 
     sema_expr(sema, expr->fieldacc.accessing);
+    if (expr->fieldacc.accessing->kind == EkIdent && expr->fieldacc.accessing->type.kind == TkTypeDef) {
+        Stmnt decl = symtab_find(sema, expr->fieldacc.accessing->ident, expr->cursors_idx);
+        if (decl.kind == SkUnionDecl) {
+            sema_union_variant_access(sema, expr, decl.uniondecl);
+            return;
+        }
+    }
+
     Type *type = resolve_expr_type(sema, expr->fieldacc.accessing);
     if (!expr->fieldacc.deref) {
         assert(expr->fieldacc.field->kind == EkIdent);
-        Expr field = get_field(sema, *type, expr->fieldacc.field->ident, expr->cursors_idx);
+        Expr field = get_field(sema, type_intern(type), expr->fieldacc.field->ident, expr->cursors_idx);
         *expr->fieldacc.field = field;
         expr->type = field.type;
         sema_expr(sema, expr->fieldacc.field);
+
+        // <array>.len is known at compile time
+        if (type->kind == TkArray && field.kind == EkIdent && streq(field.ident, "len")) {
+            sema_fold(sema, expr);
+        }
         return;
     }
 
@@ -482,18 +716,19 @@ void sema_array_slice(Sema *sema, Expr *expr) {
 
         uint64_t len_n = eval_expr(sema, arrtype->array.len);
 
-        uint64_t start_n;
-        if (start->kind == EkNone) start_n = 0;
-        else start_n = eval_expr(sema, start);
+        // bounds can only be checked when they're known at compile time
+        uint64_t start_n = 0;
+        bool start_known = start->kind == EkNone || eval_const(sema, start, &start_n);
 
-        uint64_t end_n;
-        if (end->kind == EkNone) end_n = len_n - 1;
-        else end_n = eval_expr(sema, end);
+        // an exclusive end can be the length itself
+        bool inclusive = expr->arrayslice.slice->rangelit.inclusive && end->kind != EkNone;
+        uint64_t end_n = len_n;
+        bool end_known = end->kind == EkNone || eval_const(sema, end, &end_n);
 
-        if (start_n >= len_n) {
+        if (start_known && start_n >= len_n) {
             elog(sema, expr->cursors_idx, "slice out of bounds, array length is %" PRIu64 ", slice start is %" PRIu64, len_n, start_n);
         }
-        if (end_n >= len_n) {
+        if (end_known && (inclusive ? end_n >= len_n : end_n > len_n)) {
             elog(sema, expr->cursors_idx, "slice out of bounds, array length is %" PRIu64 ", slice end is %" PRIu64, len_n, end_n);
         }
     } else if (arrtype->kind == TkSlice) {
@@ -529,11 +764,15 @@ void sema_array_index(Sema *sema, Expr *expr) {
     if (arrtype->kind == TkArray) {
         expr->type = *arrtype->array.of;
 
-        if (eval_expr(sema, expr->arrayidx.index) >= eval_expr(sema, arrtype->array.len)) {
+        uint64_t index;
+        if (eval_const(sema, expr->arrayidx.index, &index) && index >= eval_expr(sema, arrtype->array.len)) {
             elog(sema, expr->cursors_idx, "index out of bounds");
         }
     } else if (arrtype->kind == TkSlice) {
         expr->type = *arrtype->slice.of;
+    } else if (arrtype->kind == TkSoa) {
+        // element proxy, <soa>[i].<field> only touches that field's column
+        expr->type = *arrtype->soa.of;
     } else {
         strb t = string_from_type(*arrtype);
         elog(sema, expr->cursors_idx, "cannot index into %s, not an array", t);
@@ -563,13 +802,13 @@ void sema_slice_literal(Sema *sema, Expr *expr) {
             continue;
         }
 
-        if (!tc_equals(sema, *slice->of, valtype)) {
+        if (!tc_equals(sema, type_intern(slice->of), valtype)) {
             strb t1 = string_from_type(*valtype);
             strb t2 = string_from_type(*slice->of);
             elog(sema, expr->cursors_idx, "slice element %zu type is %s, but expected %s", i + 1, t1, t2);
             strbfree(t1); strbfree(t2);
         } else {
-            tc_number_within_bounds(sema, *slice->of, expr->literal.exprs[i]);
+            tc_number_within_bounds(sema, type_intern(slice->of), &expr->literal.exprs[i]);
         }
     }
 }
@@ -611,20 +850,66 @@ void sema_array_literal(Sema *sema, Expr *expr) {
             continue;
         }
 
-        if (!tc_equals(sema, *array->of, valtype)) {
+        if (!tc_equals(sema, type_intern(array->of), valtype)) {
             strb t1 = string_from_type(*valtype);
             strb t2 = string_from_type(*array->of);
             elog(sema, expr->cursors_idx, "array element %zu type is %s, but expected %s", i + 1, t1, t2);
             strbfree(t1); strbfree(t2);
         } else {
-            tc_number_within_bounds(sema, *array->of, expr->literal.exprs[i]);
+            tc_number_within_bounds(sema, type_intern(array->of), &expr->literal.exprs[i]);
         }
     }
 }
 
+// <union>{.<variant> = <value>}
+void sema_union_literal(Sema *sema, Expr *expr, UnionDecl uniond) {
+    assert(expr->kind == EkLiteral);
+
+    if (expr->literal.kind != LitkVars || arrlenu(expr->literal.vars) != 1) {
+        elog(sema, expr->cursors_idx, "union literals must set exactly one variant, %s{.<variant> = <value>}", uniond.name.ident);
+        return;
+    }
+
+    Stmnt *var = &expr->literal.vars[0];
+    const char *name = var->varreassign.name.ident;
+
+    ptrdiff_t i = union_variant_index(uniond, name);
+    if (i < 0) {
+        elog(sema, var->cursors_idx, "%s does not have variant \"%s\"", uniond.name.ident, name);
+        return;
+    }
+
+    Type *vtype = &uniond.fields[i].vardecl.type;
+    if (vtype->kind == TkVoid) {
+        elog(sema, var->cursors_idx, "variant \"%s\" does not have a payload, use %s.%s", name, uniond.name.ident, name);
+        return;
+    }
+
+    Type *valtype = resolve_expr_type(sema, &var->varreassign.value);
+    if (valtype->kind == TkPoison) return;
+
+    if (valtype->kind == TkNone) {
+        *valtype = *vtype;
+        sema_expr(sema, &var->varreassign.value);
+        return;
+    }
+
+    if (!tc_equals(sema, type_intern(vtype), valtype)) {
+        strb t1 = string_from_type(*valtype);
+        strb t2 = string_from_type(*vtype);
+        elog(sema, var->cursors_idx, "variant %s type is %s, but expected %s", name, t1, t2);
+        strbfree(t1); strbfree(t2);
+    }
+}
+
 void sema_typedef_literal(Sema *sema, Expr *expr) {
     assert(expr->kind == EkLiteral);
     Stmnt typedeff = symtab_find(sema, expr->type.typedeff, expr->cursors_idx);
+    if (typedeff.kind == SkUnionDecl) {
+        sema_union_literal(sema, expr, typedeff.uniondecl);
+        return;
+    }
+
     if (typedeff.kind != SkStructDecl) {
         elog(sema, expr->cursors_idx, "expected literal type to be from a struct");
         return;
@@ -638,15 +923,15 @@ void sema_typedef_literal(Sema *sema, Expr *expr) {
 
         for (size_t i = 0; i < arrlenu(expr->literal.exprs); i++) {
             Type *valtype = resolve_expr_type(sema, &expr->literal.exprs[i]);
-            Type fieldtype = type_of_stmnt(sema, typedeff.structdecl.fields[i]);
+            TypeId fieldtype = type_of_stmnt(sema, &typedeff.structdecl.fields[i]);
 
-            if (valtype->kind == TkPoison || fieldtype.kind == TkPoison) {
+            if (valtype->kind == TkPoison || fieldtype == TkPoison) {
                 continue;
             }
 
             if (!tc_equals(sema, fieldtype, valtype)) {
                 strb t1 = string_from_type(*valtype);
-                strb t2 = string_from_type(fieldtype);
+                strb t2 = string_from_type(*type_canon(fieldtype));
                 elog(sema, expr->literal.exprs[i].cursors_idx, "field %zu type is %s, but expected %s", i + 1, t1, t2);
                 strbfree(t1); strbfree(t2);
             }
@@ -659,7 +944,7 @@ void sema_typedef_literal(Sema *sema, Expr *expr) {
 
         for (size_t i = 0; i < arrlenu(expr->literal.vars); i++) {
             Type *valtype = resolve_expr_type(sema, &expr->literal.vars[i].varreassign.value);
-            Expr field = get_field(sema, expr->type, expr->literal.vars[i].varreassign.name.ident, expr->literal.vars[i].cursors_idx);
+            Expr field = get_field(sema, type_intern(&expr->type), expr->literal.vars[i].varreassign.name.ident, expr->literal.vars[i].cursors_idx);
 
             if (valtype->kind == TkPoison || field.type.kind == TkPoison) {
                 continue;
@@ -671,7 +956,7 @@ void sema_typedef_literal(Sema *sema, Expr *expr) {
                 continue;
             }
 
-            if (!tc_equals(sema, field.type, valtype)) {
+            if (!tc_equals(sema, type_intern(&field.type), valtype)) {
                 strb t1 = string_from_type(*valtype);
                 strb t2 = string_from_type(field.type);
                 elog(sema, expr->literal.vars[i].cursors_idx, "field %s type is %s, but expected %s", field.ident, t1, t2);
@@ -697,6 +982,7 @@ void sema_literal(Sema *sema, Expr *expr) {
     if (expr->type.kind == TkPoison) {
         return;
     }
+    sema_array_len(sema, &expr->type, expr->cursors_idx);
 
     if (expr->type.kind == TkArray) {
         sema_array_literal(sema, expr);
@@ -707,9 +993,160 @@ void sema_literal(Sema *sema, Expr *expr) {
     }
 }
 
+// <soa>.push(value), <soa>.reserve(cap), <soa>.free()
+void sema_soa_method_call(Sema *sema, Expr *expr, TypeId soa) {
+    const Type *t = type_canon(soa);
+    assert(expr->kind == EkFnCall && t->kind == TkSoa);
+
+    const char *method = expr->fncall.name->fieldacc.field->ident;
+    expr->type = type_void(TYPEVAR, expr->cursors_idx);
+
+    if (expr->fncall.arg_kind == LitkVars) {
+        elog(sema, expr->cursors_idx, "#soa methods do not take named arguments");
+        return;
+    }
+
+    TypeId arg_type;
+    size_t args_len = arrlenu(expr->fncall.args.exprs);
+    if (streq(method, "push")) {
+        arg_type = t->soa.of->id;
+    } else if (streq(method, "reserve")) {
+        arg_type = TkUsize;
+    } else if (streq(method, "free")) {
+        if (args_len != 0) {
+            elog(sema, expr->cursors_idx, "too many arugments, expected 0, got %zu", args_len);
+        }
+        return;
+    } else {
+        strb name = string_from_type(*t);
+        elog(sema, expr->cursors_idx, "%s does not have method \"%s\"", name, method);
+        strbfree(name);
+        return;
+    }
+
+    if (args_len != 1) {
+        elog(sema, expr->cursors_idx, "expected 1 argument, got %zu", args_len);
+        return;
+    }
+
+    sema_expr(sema, &expr->fncall.args.exprs[0]);
+    Type *carg_type = resolve_expr_type(sema, &expr->fncall.args.exprs[0]);
+    if (carg_type->kind == TkPoison) return;
+
+    if (!tc_equals(sema, arg_type, carg_type)) {
+        strb t1 = string_from_type(*type_canon(arg_type));
+        strb t2 = string_from_type(*carg_type);
+        elog(sema, expr->cursors_idx, "mismatch types, argument 1 is expected to be of type %s, got %s", t1, t2);
+        strbfree(t1); strbfree(t2);
+    }
+}
+
+// <value>.<method>(...) -> <struct>_<method>(<value>, ...), self is taken by address if the method wants a pointer
+bool sema_method_call(Sema *sema, Expr *expr, TypeId receiver) {
+    const char *typename = type_canon(receiver)->typedeff;
+    Expr *name = expr->fncall.name;
+    Expr *accessing = name->fieldacc.accessing;
+    if (name->fieldacc.field->kind != EkIdent) {
+        elog(sema, expr->cursors_idx, "expected a method name");
+        return false;
+    }
+
+    strb fn_name = NULL;
+    strbprintf(&fn_name, "%s_%s", typename, name->fieldacc.field->ident);
+
+    Stmnt fn = ast_find_decl(sema->ast, fn_name);
+    if (fn.kind != SkFnDecl || !fn.fndecl.method) {
+        elog(sema, expr->cursors_idx, "%s does not have a method \"%s\"", typename, name->fieldacc.field->ident);
+        strbfree(fn_name);
+        return false;
+    }
+
+    Type *self = &fn.fndecl.args[0].constdecl.type;
+    bool is_ptr = accessing->type.kind == TkPtr;
+
+    Expr arg;
+    if (self->kind == TkPtr && !is_ptr) {
+        if (!self->constant && accessing->type.constant) {
+            elog(sema, expr->cursors_idx, "cannot mutate constant variable");
+            strbfree(fn_name);
+            return false;
+        }
+        arg = expr_unop((Unop){
+            .kind = UkAddress,
+            .val = accessing,
+        }, type_none(), accessing->cursors_idx);
+    } else if (self->kind != TkPtr && is_ptr) {
+        // <ptr>.&
+        Expr *field = arena_alloc(&ast_arena, sizeof(Expr)); *field = expr_none();
+        arg = expr_fieldaccess((FieldAccess){
+            .accessing = accessing,
+            .field = field,
+            .deref = true,
+        }, type_none(), accessing->cursors_idx);
+    } else {
+        arg = *accessing;
+    }
+
+    // self goes in front of the other arguments
+    if (expr->fncall.arg_kind == LitkVars) {
+        Arr(Stmnt) vars = expr->fncall.args.vars;
+        arrpush(vars, (Stmnt){0});
+        memmove(&vars[1], &vars[0], sizeof(Stmnt) * (arrlenu(vars) - 1));
+        vars[0] = stmnt_varreassign((VarReassign){
+            .name = expr_ident("self", type_none(), accessing->cursors_idx),
+            .type = type_none(),
+            .value = arg,
+        }, accessing->cursors_idx);
+        expr->fncall.args.vars = vars;
+    } else {
+        Arr(Expr) exprs = expr->fncall.args.exprs;
+        arrpush(exprs, arg);
+        memmove(&exprs[1], &exprs[0], sizeof(Expr) * (arrlenu(exprs) - 1));
+        exprs[0] = arg;
+        expr->fncall.args.exprs = exprs;
+    }
+
+    *name = expr_ident(fn_name, type_none(), name->cursors_idx);
+    return true;
+}
+
 void sema_fn_call(Sema *sema, Expr *expr) {
     assert(expr->kind == EkFnCall);
 
+    bool const_call = sema->envinfo.const_call;
+    sema->envinfo.const_call = false;
+
+    if (expr->fncall.name->kind == EkFieldAccess) {
+        Expr *accessing = expr->fncall.name->fieldacc.accessing;
+        sema_expr(sema, accessing);
+        Type *type = deref_ptr(resolve_expr_type(sema, accessing));
+
+        if (type->kind == TkPoison) {
+            expr->type = type_poison();
+            return;
+        }
+
+        if (type->kind == TkTypeDef) {
+            if (!sema_method_call(sema, expr, type_intern(type))) {
+                expr->type = type_poison();
+                return;
+            }
+        } else if (type->kind != TkSoa) {
+            strb t = string_from_type(*type);
+            elog(sema, expr->cursors_idx, "%s does not have methods", t);
+            strbfree(t);
+            expr->type = type_poison();
+            return;
+        } else {
+            if (accessing->type.kind == TkPtr ? accessing->type.ptr_to->constant : accessing->type.constant) {
+                elog(sema, expr->cursors_idx, "cannot mutate constant variable");
+            }
+
+            sema_soa_method_call(sema, expr, type_intern(type));
+            return;
+        }
+    }
+
     Stmnt stmnt = symtab_find(sema, expr->fncall.name->ident, expr->cursors_idx);
     if (stmnt.kind != SkFnDecl) {
         elog(sema, expr->cursors_idx, "expected \"%s\" to be a function", expr->fncall.name->ident);
@@ -720,6 +1157,12 @@ void sema_fn_call(Sema *sema, Expr *expr) {
         return;
     }
 
+    // C can't return arrays, so these only run at compile time
+    bool in_comptime_fn = sema->envinfo.fn.kind == SkFnDecl && sema->envinfo.fn.fndecl.type.kind == TkArray;
+    if (stmnt.fndecl.type.kind == TkArray && !const_call && !in_comptime_fn) {
+        elog(sema, expr->cursors_idx, "\"%s\" returns an array, it can only be called as the value of a constant", expr->fncall.name->ident);
+    }
+
     if (expr->type.kind == TkNone) {
         expr->type = stmnt.fndecl.type;
     }
@@ -744,17 +1187,17 @@ void sema_fn_call(Sema *sema, Expr *expr) {
                 continue;
             }
 
-            Type darg_type = darg->kind == SkConstDecl ? darg->constdecl.type : darg->vardecl.type;
+            Type *darg_type = darg->kind == SkConstDecl ? &darg->constdecl.type : &darg->vardecl.type;
             sema_expr(sema, &expr->fncall.args.exprs[i]);
             Type *carg_type = resolve_expr_type(sema, &expr->fncall.args.exprs[i]);
 
-            if (darg_type.kind == TkPoison || carg_type->kind == TkPoison) {
+            if (darg_type->kind == TkPoison || carg_type->kind == TkPoison) {
                 pos_args[i] = expr_none();
                 continue;
             }
 
-            if (!tc_equals(sema, darg_type, carg_type)) {
-                strb t1 = string_from_type(darg_type);
+            if (!tc_equals(sema, type_intern(darg_type), carg_type)) {
+                strb t1 = string_from_type(*darg_type);
                 strb t2 = string_from_type(*carg_type);
                 elog(sema, expr->cursors_idx, "mismatch types, argument %zu is expected to be of type %s, got %s", i + 1, t1, t2);
                 strbfree(t1); strbfree(t2);
@@ -777,19 +1220,19 @@ void sema_fn_call(Sema *sema, Expr *expr) {
                 break;
             }
 
-            Type darg_type = darg->kind == SkConstDecl ? darg->constdecl.type : darg->vardecl.type;
+            Type *darg_type = darg->kind == SkConstDecl ? &darg->constdecl.type : &darg->vardecl.type;
             sema_expr(sema, &expr->fncall.args.vars[i].varreassign.value);
             Type *carg_type = resolve_expr_type(sema, &expr->fncall.args.vars[i].varreassign.value);
 
             bool bad_type = false;
-            if (darg_type.kind == TkPoison || carg_type->kind == TkPoison) {
+            if (darg_type->kind == TkPoison || carg_type->kind == TkPoison) {
                 bad_type = true;
                 goto after_typecheck;
             }
 
-            if (!tc_equals(sema, darg_type, carg_type)) {
+            if (!tc_equals(sema, type_intern(darg_type), carg_type)) {
                 bad_type = true;
-                strb t1 = string_from_type(darg_type);
+                strb t1 = string_from_type(*darg_type);
                 strb t2 = string_from_type(*carg_type);
                 elog(sema, expr->cursors_idx, "mismatch types, argument %zu is expected to be of type %s, got %s", i + 1, t1, t2);
                 strbfree(t1); strbfree(t2);
@@ -833,13 +1276,17 @@ void sema_fn_call_stmnt(Sema *sema, Stmnt *stmnt) {
 void sema_unop(Sema *sema, Expr *expr) {
     assert(expr->kind == EkUnop);
 
-    sema_expr(sema, expr->unop.val);
+    // sizeof can take a type name, which isn't an expression on its own
+    if (expr->unop.kind != UkSizeof) {
+        sema_expr(sema, expr->unop.val);
+    }
     switch (expr->unop.kind) {
         case UkCast:
             if (expr->unop.val->type.kind == TkPoison || expr->type.kind == TkPoison) {
                 return;
             }
-            if (!tc_can_cast(sema, &expr->unop.val->type, expr->type)) {
+            sema_array_len(sema, &expr->type, expr->cursors_idx);
+            if (!tc_can_cast(sema, &expr->unop.val->type, type_intern(&expr->type))) {
                 strb t1 = string_from_type(expr->unop.val->type);
                 strb t2 = string_from_type(expr->type);
                 elog(sema, expr->cursors_idx, "cannot cast %s to %s", t1, t2);
@@ -847,21 +1294,25 @@ void sema_unop(Sema *sema, Expr *expr) {
             }
             // expr->unop.val->type = expr->type;
             break;
-        case UkSizeof:
-            if (expr->unop.val->group->kind != EkType && expr->unop.val->group->kind != EkIdent) {
+        case UkSizeof: {
+            Expr *of = expr->unop.val->group;
+            if (of->kind == EkIdent) {
+                symtab_find(sema, of->ident, of->cursors_idx);
+            } else if (of->kind != EkType) {
                 elog(sema, expr->cursors_idx, "expected type or identifier in sizeof");
             }
-
-            break;
+        } break;
         case UkAddress:
             if (expr->unop.val->kind == EkIdent) {
                 Stmnt stmnt = symtab_find(sema, expr->unop.val->ident, expr->unop.val->cursors_idx);
-                Type *type = ealloc(sizeof(Type)); *type = type_of_stmnt(sema, stmnt);
 
-                if (type->kind == TkPoison) {
+                if (type_of_stmnt(sema, &stmnt) == TkPoison) {
                     expr->type = type_poison();
                 } else {
-                    expr->type = type_ptr(type, stmnt_is_constant(stmnt), stmnt.cursors_idx);
+                    // the declared type is copied, constness of what it points to comes with it
+                    bool constant = stmnt_is_constant(stmnt);
+                    Type *type = arena_alloc(&ast_arena, sizeof(Type)); *type = constant ? stmnt.constdecl.type : stmnt.vardecl.type;
+                    expr->type = type_ptr(type, constant, stmnt.cursors_idx);
                 }
             } else {
                 elog(sema, expr->cursors_idx, "cannot take address of expression not on stack");
@@ -873,7 +1324,7 @@ void sema_unop(Sema *sema, Expr *expr) {
                 expr->type = type_poison();
                 return;
             }
-            if (tc_is_unsigned(sema, *expr->unop.val)) {
+            if (tc_is_unsigned(sema, expr->unop.val)) {
                 elog(sema, expr->cursors_idx, "cannot negate unsigned integers");
                 expr->type = type_poison();
             } else {
@@ -890,7 +1341,7 @@ void sema_unop(Sema *sema, Expr *expr) {
                 return;
             }
 
-            if (!tc_equals(sema, type_bool(TYPEVAR, 0), type)) {
+            if (!tc_equals(sema, TkBool, type)) {
                 strb t = string_from_type(*type);
                 elog(sema, expr->cursors_idx, "expected a boolean after '!' operator, got %s", t);
                 strbfree(t);
@@ -907,7 +1358,7 @@ void sema_unop(Sema *sema, Expr *expr) {
                 return;
             }
 
-            if (!tc_can_bitwise(*type, *type)) {
+            if (!tc_can_bitwise(type_intern(type), type_intern(type))) {
                 strb t = string_from_type(*type);
                 elog(sema, expr->cursors_idx, "cannot do bitwise not (~) on %s", t);
                 strbfree(t);
@@ -917,6 +1368,8 @@ void sema_unop(Sema *sema, Expr *expr) {
             }
         } break;
     }
+
+    sema_fold(sema, expr);
 }
 
 void sema_binop(Sema *sema, Expr *expr) {
@@ -990,7 +1443,7 @@ void sema_binop(Sema *sema, Expr *expr) {
             break;
     }
 
-    if (!tc_equals(sema, *lt, rt)) {
+    if (!tc_equals(sema, type_intern(lt), rt)) {
         strb t1 = string_from_type(*lt);
         strb t2 = string_from_type(*rt);
         elog(sema, expr->cursors_idx, "mismatch types, %s %s %s", t1, binopstr, t2);
@@ -1000,21 +1453,21 @@ void sema_binop(Sema *sema, Expr *expr) {
     }
 
     if (expr->binop.kind == BkEquals || expr->binop.kind == BkInequals) {
-        if (!tc_can_compare_equality(*lt, *rt)) {
+        if (!tc_can_compare_equality(type_intern(lt), type_intern(rt))) {
             strb t1 = string_from_type(*lt);
             strb t2 = string_from_type(*rt);
             elog(sema, expr->cursors_idx, "cannot compare equality of %s and %s", t1, t2);
             strbfree(t1); strbfree(t2);
         }
     } else if (expr->binop.kind == BkLess || expr->binop.kind == BkLessEqual || expr->binop.kind == BkGreater || expr->binop.kind == BkGreaterEqual) {
-        if (!tc_can_compare_order(*lt, *rt)) {
+        if (!tc_can_compare_order(type_intern(lt), type_intern(rt))) {
             strb t1 = string_from_type(*lt);
             strb t2 = string_from_type(*rt);
             elog(sema, expr->cursors_idx, "cannot compare order of %s and %s", t1, t2);
             strbfree(t1); strbfree(t2);
         }
     } else if (expr->binop.kind == BkPlus || expr->binop.kind == BkMinus || expr->binop.kind == BkMultiply || expr->binop.kind == BkDivide) {
-        if (!tc_can_arithmetic(*lt, *rt, false)) {
+        if (!tc_can_arithmetic(type_intern(lt), type_intern(rt), false)) {
             strb t1 = string_from_type(*lt);
             strb t2 = string_from_type(*rt);
             elog(sema, expr->cursors_idx, "cannot perform arithmetic operations on %s and %s", t1, t2);
@@ -1027,7 +1480,7 @@ void sema_binop(Sema *sema, Expr *expr) {
             expr->type = *rt;
         }
     }  else if (expr->binop.kind == BkMod) {
-        if (!tc_can_arithmetic(*lt, *rt, true)) {
+        if (!tc_can_arithmetic(type_intern(lt), type_intern(rt), true)) {
             strb t1 = string_from_type(*lt);
             strb t2 = string_from_type(*rt);
             elog(sema, expr->cursors_idx, "cannot perform modulo on %s and %s", t1, t2);
@@ -1047,7 +1500,7 @@ void sema_binop(Sema *sema, Expr *expr) {
             strbfree(t1); strbfree(t2);
         }
     } else if (expr->binop.kind == BkBitAnd || expr->binop.kind == BkBitOr || expr->binop.kind == BkBitXor || expr->binop.kind == BkLeftShift || expr->binop.kind == BkRightShift) {
-        if (!tc_can_bitwise(*lt, *rt)) {
+        if (!tc_can_bitwise(type_intern(lt), type_intern(rt))) {
             strb t1 = string_from_type(*lt);
             strb t2 = string_from_type(*rt);
             elog(sema, expr->cursors_idx, "cannot use bitwise operations on %s and %s", t1, t2);
@@ -1057,6 +1510,8 @@ void sema_binop(Sema *sema, Expr *expr) {
             expr->type = expr->binop.left->type;
         }
     }
+
+    sema_fold(sema, expr);
 }
 
 void sema_expr(Sema *sema, Expr *expr) {
@@ -1107,6 +1562,9 @@ void sema_expr(Sema *sema, Expr *expr) {
             } else if (stmnt.kind == SkEnumDecl) {
                 expr->type = type_typedef(stmnt.enumdecl.name.ident, TYPEVAR, stmnt.cursors_idx);
                 break;
+            } else if (stmnt.kind == SkUnionDecl) {
+                expr->type = type_typedef(stmnt.uniondecl.name.ident, TYPEVAR, stmnt.cursors_idx);
+                break;
             } else {
                 elog(sema, expr->cursors_idx, "expected \"%s\" to be a variable", expr->ident);
                 expr->type = type_poison();
@@ -1142,10 +1600,30 @@ void sema_return(Sema *sema, Stmnt *stmnt) {
     tc_return(sema, stmnt);
 }
 
+// #soa <struct> can only be used with structs declared with #soa
+void sema_soa_type(Sema *sema, TypeId type, size_t cursor_idx) {
+    const Type *t = type_canon(type);
+    if (t->kind == TkPtr) {
+        sema_soa_type(sema, t->ptr_to->id, cursor_idx);
+        return;
+    }
+    if (t->kind != TkSoa || t->soa.of->kind != TkTypeDef) return;
+
+    Stmnt decl = symtab_find(sema, t->soa.of->typedeff, cursor_idx);
+    if (decl.kind != SkStructDecl) {
+        elog(sema, cursor_idx, "expected \"%s\" to be a struct", t->soa.of->typedeff);
+    } else if (!decl.structdecl.attrs->soa) {
+        elog(sema, cursor_idx, "struct \"%s\" is not declared with #soa", t->soa.of->typedeff);
+    }
+}
+
 void sema_var_decl(Sema *sema, Stmnt *stmnt) {
     assert(stmnt->kind == SkVarDecl);
     VarDecl *vardecl = &stmnt->vardecl;
 
+    sema_soa_type(sema, type_intern(&vardecl->type), stmnt->cursors_idx);
+    sema_array_len(sema, &vardecl->type, stmnt->cursors_idx);
+
     if (vardecl->value.kind == EkLiteral) {
         if (vardecl->value.type.kind == TkNone) {
             if (vardecl->type.kind == TkNone) {
@@ -1158,7 +1636,7 @@ void sema_var_decl(Sema *sema, Stmnt *stmnt) {
             }
         } else if (vardecl->type.kind != TkNone) {
             // <name>: <type> = <type>{...};
-            if (!tc_equals(sema, vardecl->type, &vardecl->value.type)) {
+            if (!tc_equals(sema, type_intern(&vardecl->type), &vardecl->value.type)) {
                 strb t1 = string_from_type(vardecl->type);
                 strb t2 = string_from_type(vardecl->value.type);
                 elog(sema, stmnt->cursors_idx, "mismatch types, variable \"%s\" type %s, expression type %s", vardecl->name.ident, t1, t2);
@@ -1209,7 +1687,7 @@ void sema_var_reassign(Sema *sema, Stmnt *stmnt) {
             return;
         }
 
-        if (!tc_equals(sema, stmnt->varreassign.type, &stmnt->varreassign.value.type)) {
+        if (!tc_equals(sema, type_intern(&stmnt->varreassign.type), &stmnt->varreassign.value.type)) {
             strb t1 = string_from_type(stmnt->varreassign.type);
             strb t2 = string_from_type(stmnt->varreassign.value.type);
             elog(sema, stmnt->cursors_idx, "mismatch types, variable type %s, expression type %s", t1, t2);
@@ -1234,7 +1712,7 @@ void sema_var_reassign(Sema *sema, Stmnt *stmnt) {
         return;
     }
 
-    if (!tc_equals(sema, stmnt->varreassign.type, &stmnt->varreassign.value.type)) {
+    if (!tc_equals(sema, type_intern(&stmnt->varreassign.type), &stmnt->varreassign.value.type)) {
         strb t1 = string_from_type(stmnt->varreassign.type);
         strb t2 = string_from_type(stmnt->varreassign.value.type);
         elog(sema, stmnt->cursors_idx, "mismatch types, variable \"%s\" type %s, expression type %s", stmnt->varreassign.name.ident, t1, t2);
@@ -1242,55 +1720,207 @@ void sema_var_reassign(Sema *sema, Stmnt *stmnt) {
     }
 }
 
-void sema_const_decl(Sema *sema, Stmnt *stmnt) {
-    assert(stmnt->kind == SkConstDecl);
-    ConstDecl *constdecl = &stmnt->constdecl;
-
-    if (constdecl->value.kind == EkLiteral) {
-        if (constdecl->value.type.kind == TkNone) {
-            if (constdecl->type.kind == TkNone) {
-                // <name> := {...}; can't do that
-                elog(sema, stmnt->cursors_idx, "missing type for literal");
-                return;
-            } else {
-                // <name>: <type> = {...};
-                constdecl->value.type = constdecl->type;
-            }
-        } else if (constdecl->type.kind != TkNone) {
-            // <name>: <type> = <type>{...};
-            if (!tc_equals(sema, constdecl->type, &constdecl->value.type)) {
-                strb t1 = string_from_type(constdecl->type);
-                strb t2 = string_from_type(constdecl->value.type);
-                elog(sema, stmnt->cursors_idx, "mismatch types, variable \"%s\" type %s, expression type %s", constdecl->name.ident, t1, t2);
-                strbfree(t1); strbfree(t2);
-                return;
+// folds constant names inside expr, returns true if it can be emitted as static data
+bool sema_bake(Sema *sema, Expr *expr) {
+    switch (expr->kind) {
+        case EkIntLit:
+        case EkFloatLit:
+        case EkCharLit:
+        case EkStrLit:
+        case EkCstrLit:
+        case EkTrue:
+        case EkFalse:
+        case EkNull:
+            return true;
+        case EkLiteral: {
+            // slice literals are built by a function call
+            if (expr->type.kind == TkSlice) return false;
+
+            bool baked = true;
+            if (expr->literal.kind == LitkExprs) {
+                for (size_t i = 0; i < arrlenu(expr->literal.exprs); i++) {
+                    baked = sema_bake(sema, &expr->literal.exprs[i]) && baked;
+                }
+            } else if (expr->literal.kind == LitkVars) {
+                for (size_t i = 0; i < arrlenu(expr->literal.vars); i++) {
+                    baked = sema_bake(sema, &expr->literal.vars[i].varreassign.value) && baked;
+                }
             }
-        } else {
-            // <name> := <type>{...};
-            constdecl->type = constdecl->value.type;
+            return baked;
         }
+        case EkFieldAccess: {
+            // <enum>.<field>
+            Expr *accessing = expr->fieldacc.accessing;
+            if (accessing->kind == EkIdent && ast_find_decl(sema->ast, accessing->ident).kind == SkEnumDecl) {
+                return true;
+            }
+        } break;
+        default:
+            break;
     }
 
-    sema_expr(sema, &constdecl->value);
-    tc_const_decl(sema, stmnt);
-
-    assert(constdecl->name.kind == EkIdent);
-    symtab_push(sema, constdecl->name.ident, *stmnt);
+    sema_fold(sema, expr);
+    switch (expr->kind) {
+        case EkIntLit:
+        case EkFloatLit:
+        case EkCharLit:
+        case EkTrue:
+        case EkFalse:
+            return true;
+        default:
+            return false;
+    }
 }
 
-void sema_if(Sema *sema, Stmnt *stmnt) {
-    assert(stmnt->kind == SkIf);
-    If *iff = &stmnt->iff;
+// <name> :: <fn>(...); runs once every function has been analysed
+// arguments are folded now, while local constants are still in scope
+bool sema_comptime_call(Sema *sema, Stmnt *stmnt) {
+    Expr *call = &stmnt->constdecl.value;
+    if (call->fncall.name->kind != EkIdent) return false;
 
-    sema_expr(sema, &iff->condition);
+    Stmnt fn = ast_find_decl(sema->ast, call->fncall.name->ident);
+    if (fn.kind != SkFnDecl || !fn.fndecl.has_body || arrlenu(call->fncall.args.exprs) != arrlenu(fn.fndecl.args)) return false;
 
-    if (iff->condition.type.kind == TkPoison) {
-        return;
+    for (size_t i = 0; i < arrlenu(call->fncall.args.exprs); i++) {
+        Expr *arg = &call->fncall.args.exprs[i];
+        if (arg->kind == EkNone) return false;
+
+        ConstValue value;
+        Expr folded;
+        if (eval_value(sema, arg, &value) && eval_to_expr(value, fn.fndecl.args[i].constdecl.type, arg->cursors_idx, &folded)) {
+            *arg = folded;
+        }
     }
 
-    if (
-        !tc_equals(sema, type_bool(TYPEVAR, 0), &iff->condition.type) &&
-        iff->condition.type.kind != TkOption
+    arrpush(sema->comptime, stmnt);
+    return true;
+}
+
+// a constant expression in C that eval can't fold, like the address of another global, still works as an initialiser
+bool sema_c_constant(Sema *sema, Expr *expr) {
+    switch (expr->kind) {
+        case EkIntLit:
+        case EkFloatLit:
+        case EkCharLit:
+        case EkStrLit:
+        case EkCstrLit:
+        case EkTrue:
+        case EkFalse:
+        case EkNull:
+        case EkType:
+            return true;
+        case EkIdent: {
+            // functions decay to their address
+            StmntKind kind = ast_find_decl(sema->ast, expr->ident).kind;
+            return kind == SkConstDecl || kind == SkFnDecl;
+        }
+        case EkGrouping:
+            return sema_c_constant(sema, expr->group);
+        case EkBinop:
+            return sema_c_constant(sema, expr->binop.left) && sema_c_constant(sema, expr->binop.right);
+        case EkUnop:
+            if (expr->unop.kind == UkAddress) {
+                Expr *of = expr->unop.val;
+                return of->kind == EkIdent && ast_find_decl(sema->ast, of->ident).kind == SkVarDecl;
+            }
+            return sema_c_constant(sema, expr->unop.val);
+        case EkLiteral:
+            if (expr->type.kind == TkSlice) return false;
+            if (expr->literal.kind == LitkExprs) {
+                for (size_t i = 0; i < arrlenu(expr->literal.exprs); i++) {
+                    if (!sema_c_constant(sema, &expr->literal.exprs[i])) return false;
+                }
+            } else if (expr->literal.kind == LitkVars) {
+                for (size_t i = 0; i < arrlenu(expr->literal.vars); i++) {
+                    if (!sema_c_constant(sema, &expr->literal.vars[i].varreassign.value)) return false;
+                }
+            }
+            return true;
+        case EkFieldAccess: {
+            // <enum>.<field>
+            Expr *accessing = expr->fieldacc.accessing;
+            return accessing->kind == EkIdent && ast_find_decl(sema->ast, accessing->ident).kind == SkEnumDecl;
+        }
+        default:
+            return false;
+    }
+}
+
+// C can only initialise globals with constant expressions
+// <name>: <type> = <fn>(...); is evaluated by sema_comptime like a constant
+void sema_global_init(Sema *sema, Stmnt *stmnt) {
+    VarDecl *decl = &stmnt->vardecl;
+    if (decl->value.kind == EkNone || decl->value.type.kind == TkPoison || decl->type.kind == TkPoison) return;
+
+    bool baked = decl->value.kind == EkFnCall ? sema_comptime_call(sema, stmnt) : sema_bake(sema, &decl->value);
+    // what eval can't fold is emitted as written, as long as C takes it
+    if (!baked && !sema_c_constant(sema, &decl->value)) {
+        elog(sema, stmnt->cursors_idx, "global \"%s\" must be initialised with a value known at compile time", decl->name.ident);
+    }
+}
+
+void sema_const_decl(Sema *sema, Stmnt *stmnt) {
+    assert(stmnt->kind == SkConstDecl);
+    ConstDecl *constdecl = &stmnt->constdecl;
+
+    sema_array_len(sema, &constdecl->type, stmnt->cursors_idx);
+
+    if (constdecl->value.kind == EkLiteral) {
+        if (constdecl->value.type.kind == TkNone) {
+            if (constdecl->type.kind == TkNone) {
+                // <name> := {...}; can't do that
+                elog(sema, stmnt->cursors_idx, "missing type for literal");
+                return;
+            } else {
+                // <name>: <type> = {...};
+                constdecl->value.type = constdecl->type;
+            }
+        } else if (constdecl->type.kind != TkNone) {
+            // <name>: <type> = <type>{...};
+            if (!tc_equals(sema, type_intern(&constdecl->type), &constdecl->value.type)) {
+                strb t1 = string_from_type(constdecl->type);
+                strb t2 = string_from_type(constdecl->value.type);
+                elog(sema, stmnt->cursors_idx, "mismatch types, variable \"%s\" type %s, expression type %s", constdecl->name.ident, t1, t2);
+                strbfree(t1); strbfree(t2);
+                return;
+            }
+        } else {
+            // <name> := <type>{...};
+            constdecl->type = constdecl->value.type;
+        }
+    }
+
+    sema->envinfo.const_call = constdecl->value.kind == EkFnCall;
+    sema_expr(sema, &constdecl->value);
+    sema->envinfo.const_call = false;
+    tc_const_decl(sema, stmnt);
+
+    if (sema->symtab.cur_scope > 0 && constdecl->value.type.kind != TkPoison) {
+        if (constdecl->value.kind == EkFnCall) {
+            sema_comptime_call(sema, stmnt);
+        } else if (constdecl->value.kind == EkLiteral) {
+            // fold names so constant literals can be baked into static data
+            sema_bake(sema, &constdecl->value);
+        }
+    }
+
+    assert(constdecl->name.kind == EkIdent);
+    symtab_push(sema, constdecl->name.ident, *stmnt);
+}
+
+void sema_if(Sema *sema, Stmnt *stmnt) {
+    assert(stmnt->kind == SkIf);
+    If *iff = &stmnt->iff;
+
+    sema_expr(sema, &iff->condition);
+
+    if (iff->condition.type.kind == TkPoison) {
+        return;
+    }
+
+    if (
+        !tc_equals(sema, TkBool, &iff->condition.type) &&
+        iff->condition.type.kind != TkOption
     ) {
         strb t = string_from_type(iff->condition.type);
         elog(sema, stmnt->cursors_idx, "condition must be bool or option, got %s", t);
@@ -1298,15 +1928,14 @@ void sema_if(Sema *sema, Stmnt *stmnt) {
         return;
     }
 
-    Stmnt *captured = ealloc(sizeof(Stmnt)); *captured = stmnt_none();
+    Stmnt *captured = arena_alloc(&ast_arena, sizeof(Stmnt)); *captured = stmnt_none();
     if (iff->capturekind != CkNone) {
         assert(iff->condition.type.kind == TkOption);
-        Type subtype = *iff->condition.type.option.subtype;
         *captured = stmnt_constdecl((ConstDecl){
-            .name = iff->capture.ident,
-            .type = subtype,
-            .value = expr_null(type_none(), iff->capture.ident.cursors_idx),
-        }, iff->capture.ident.cursors_idx);
+            .name = *iff->capture.ident,
+            .type = *iff->condition.type.option.subtype,
+            .value = expr_null(type_none(), iff->capture.ident->cursors_idx),
+        }, iff->capture.ident->cursors_idx);
         iff->capture.constdecl = captured;
         iff->capturekind = CkConstDecl;
     }
@@ -1337,7 +1966,7 @@ void sema_for(Sema *sema, Stmnt *stmnt) {
         return;
     }
 
-    if (!tc_equals(sema, type_bool(TYPEVAR, 0), &forf->condition.type)) {
+    if (!tc_equals(sema, TkBool, &forf->condition.type)) {
         strb t = string_from_type(forf->condition.type);
         elog(sema,forf->condition.cursors_idx, "condition must be bool, got %s", t);
         strbfree(t); 
@@ -1356,6 +1985,404 @@ void sema_for(Sema *sema, Stmnt *stmnt) {
     symtab_pop_scope(sema);
 }
 
+void sema_case_body(Sema *sema, Case *c) {
+    symtab_new_scope(sema);
+    if (c->capture_decl != NULL) {
+        symtab_push(sema, c->capture_decl->constdecl.name.ident, *c->capture_decl);
+    }
+
+    sema_block(sema, c->body);
+    symtab_pop_scope(sema);
+}
+
+// every variant must be handled, either by a case or by default
+void sema_union_switch(Sema *sema, Stmnt *stmnt, UnionDecl uniond) {
+    Switch *sw = &stmnt->switchf;
+
+    Arr(bool) covered = NULL;
+    for (size_t i = 0; i < arrlenu(uniond.fields); i++) {
+        arrpush(covered, false);
+    }
+
+    bool has_default = false;
+    for (size_t i = 0; i < arrlenu(sw->cases); i++) {
+        Case *c = &sw->cases[i];
+
+        if (c->values == NULL) {
+            if (has_default) {
+                elog(sema, c->cursors_idx, "switch already has a default case");
+            }
+            if (c->capture.kind != EkNone) {
+                elog(sema, c->cursors_idx, "default case cannot capture a payload");
+            }
+
+            has_default = true;
+            sema_case_body(sema, c);
+            continue;
+        }
+
+        ptrdiff_t captured = -1;
+        for (size_t j = 0; j < arrlenu(c->values); j++) {
+            Expr *value = &c->values[j];
+            if (value->kind != EkFieldAccess || value->fieldacc.accessing->kind != EkNone) {
+                elog(sema, value->cursors_idx, "expected .<variant> when switching on union %s", uniond.name.ident);
+                continue;
+            }
+
+            const char *name = value->fieldacc.field->ident;
+            ptrdiff_t variant = union_variant_index(uniond, name);
+            if (variant < 0) {
+                elog(sema, value->cursors_idx, "%s does not have variant \"%s\"", uniond.name.ident, name);
+                continue;
+            }
+
+            if (covered[variant]) {
+                elog(sema, value->cursors_idx, "duplicate case .%s", name);
+            }
+            covered[variant] = true;
+            captured = variant;
+
+            value->type = type_typedef(uniond.name.ident, TYPECONST, value->cursors_idx);
+            value->fieldacc.field->type = value->type;
+        }
+
+        if (c->capture.kind != EkNone) {
+            if (arrlenu(c->values) != 1) {
+                elog(sema, c->cursors_idx, "can only capture the payload of a case with a single variant");
+            } else if (captured >= 0 && uniond.fields[captured].vardecl.type.kind == TkVoid) {
+                elog(sema, c->cursors_idx, "variant .%s does not have a payload to capture", uniond.fields[captured].vardecl.name.ident);
+            } else if (captured >= 0) {
+                c->capture_decl = arena_alloc(&ast_arena, sizeof(Stmnt));
+                *c->capture_decl = stmnt_constdecl((ConstDecl){
+                    .name = c->capture,
+                    .type = uniond.fields[captured].vardecl.type,
+                    .value = expr_null(type_none(), c->capture.cursors_idx),
+                }, c->capture.cursors_idx);
+            }
+        }
+
+        sema_case_body(sema, c);
+    }
+
+    if (!has_default) {
+        strb missing = NULL;
+        for (size_t i = 0; i < arrlenu(covered); i++) {
+            if (covered[i]) continue;
+            strbprintf(&missing, "%s.%s", missing == NULL ? "" : ", ", uniond.fields[i].vardecl.name.ident);
+        }
+
+        if (missing != NULL) {
+            elog(sema, stmnt->cursors_idx, "switch on %s is not exhaustive, missing %s", uniond.name.ident, missing);
+            strbfree(missing);
+        }
+    }
+
+    sw->lowering = SlTagTable;
+    arrfree(covered);
+}
+
+static bool switch_less(bool is_signed, uint64_t a, uint64_t b) {
+    if (is_signed) return (int64_t)a < (int64_t)b;
+    return a < b;
+}
+
+// saturates instead of wrapping
+static uint64_t range_count(uint64_t lo, uint64_t hi) {
+    uint64_t n = hi - lo;
+    return n == UINT64_MAX ? UINT64_MAX : n + 1;
+}
+
+// every arm, including default, is a single `<ident> = <constant>;` to the same variable
+static bool switch_is_lookup(Sema *sema, Switch *sw) {
+    const char *target = NULL;
+
+    for (size_t i = 0; i < arrlenu(sw->cases); i++) {
+        Case c = sw->cases[i];
+        if (arrlenu(c.body) != 1) return false;
+
+        Stmnt arm = c.body[0];
+        if (arm.kind != SkVarReassign || arm.varreassign.name.kind != EkIdent) return false;
+        if (target != NULL && !streq(target, arm.varreassign.name.ident)) return false;
+        target = arm.varreassign.name.ident;
+
+        uint64_t value;
+        if (!eval_const(sema, &arm.varreassign.value, &value)) return false;
+    }
+
+    return target != NULL;
+}
+
+// NOTE: roughly the thresholds gcc and llvm use when deciding on jump tables
+#define SWITCH_DENSE_PERCENT 40
+#define SWITCH_JUMP_MAX 4096
+#define SWITCH_LOOKUP_MAX 256
+
+void sema_pick_lowering(Sema *sema, Switch *sw, bool has_default) {
+    if (arrlenu(sw->ranges) == 0) {
+        sw->lowering = SlJumpTable;
+        return;
+    }
+
+    uint64_t lo = sw->ranges[0].lo;
+    uint64_t hi = sw->ranges[arrlenu(sw->ranges) - 1].hi;
+    sw->span = range_count(lo, hi);
+
+    // every tag between lo and hi needs a value, either from a case or from default
+    if (sw->span <= SWITCH_LOOKUP_MAX && (has_default || sw->covered == sw->span) && switch_is_lookup(sema, sw)) {
+        sw->lowering = SlLookupTable;
+    } else if (sw->span <= SWITCH_JUMP_MAX && (double)sw->covered * 100.0 >= (double)sw->span * SWITCH_DENSE_PERCENT) {
+        sw->lowering = SlJumpTable;
+    } else {
+        sw->lowering = SlDecisionTree;
+    }
+}
+
+static bool type_is_switchable(TypeId type) {
+    switch (type_canon(type)->kind) {
+        case TkChar:
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkU8:
+        case TkU16:
+        case TkU32:
+        case TkU64:
+        case TkUsize:
+        case TkUntypedInt:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// .<field> for enums, <constant> or <constant>..<constant> for both
+bool sema_case_range(Sema *sema, Expr *value, TypeId type, Stmnt enumd, CaseRange *range) {
+    if (value->kind == EkFieldAccess && value->fieldacc.accessing->kind == EkNone) {
+        const char *name = value->fieldacc.field->ident;
+        if (enumd.kind != SkEnumDecl) {
+            elog(sema, value->cursors_idx, "expected a value, .%s can only be used when switching on an enum or union", name);
+            return false;
+        }
+
+        if (!eval_enum_field(sema, enumd.enumdecl, name, &range->lo)) {
+            elog(sema, value->cursors_idx, "%s does not have field \"%s\"", enumd.enumdecl.name.ident, name);
+            return false;
+        }
+
+        range->hi = range->lo;
+        value->type = *type_canon(type);
+        value->fieldacc.field->type = value->type;
+        return true;
+    }
+
+    Expr *start = value;
+    Expr *end = value;
+    if (value->kind == EkRangeLit) {
+        start = value->rangelit.start;
+        end = value->rangelit.end;
+
+        if (start->kind == EkNone || end->kind == EkNone) {
+            elog(sema, value->cursors_idx, "range cases must have both a start and an end");
+            return false;
+        }
+    }
+
+    Expr *bounds[2] = {start, end};
+    for (size_t i = 0; i < (start == end ? 1 : 2); i++) {
+        sema_expr(sema, bounds[i]);
+        Type *btype = resolve_expr_type(sema, bounds[i]);
+        if (btype->kind == TkPoison) return false;
+
+        // integer constants default to i64, so any integer is fine as long as the scrutinee is one too
+        bool ok = enumd.kind == SkNone ? type_is_switchable(type_intern(btype)) : tc_equals(sema, type, btype);
+        if (!ok) {
+            strb t1 = string_from_type(*btype);
+            strb t2 = string_from_type(*type_canon(type));
+            elog(sema, bounds[i]->cursors_idx, "case value type is %s, but expected %s", t1, t2);
+            strbfree(t1); strbfree(t2);
+            return false;
+        }
+    }
+
+    if (!eval_const(sema, start, &range->lo) || !eval_const(sema, end, &range->hi)) {
+        elog(sema, value->cursors_idx, "case values must be known at compile time");
+        return false;
+    }
+
+    // case 300 on a u8 could never be taken
+    for (size_t i = 0; enumd.kind == SkNone && type != TkUntypedInt && i < (start == end ? 1 : 2); i++) {
+        ConstValue bound, narrowed, widened;
+        if (!eval_value(sema, bounds[i], &bound)) continue;
+        if (eval_convert(bound, *type_canon(type), &narrowed) && eval_convert(narrowed, bound.type, &widened) && widened.u == bound.u) continue;
+
+        strb t = string_from_type(*type_canon(type));
+        if (type_is_signed(type_intern(&bound.type))) {
+            elog(sema, bounds[i]->cursors_idx, "case value %ld doesn't fit in %s", bound.i, t);
+        } else {
+            elog(sema, bounds[i]->cursors_idx, "case value %lu doesn't fit in %s", bound.u, t);
+        }
+        strbfree(t);
+        return false;
+    }
+
+    if (value->kind == EkRangeLit && !value->rangelit.inclusive) {
+        if (range->lo == range->hi) {
+            elog(sema, value->cursors_idx, "empty range in case");
+            return false;
+        }
+        range->hi--;
+    }
+
+    return true;
+}
+
+// enumd is SkNone when switching on an integer
+void sema_int_switch(Sema *sema, Stmnt *stmnt, TypeId type, Stmnt enumd) {
+    Switch *sw = &stmnt->switchf;
+    sw->is_signed = type_is_signed(type);
+
+    bool has_default = false;
+    for (size_t i = 0; i < arrlenu(sw->cases); i++) {
+        Case *c = &sw->cases[i];
+
+        if (c->values == NULL) {
+            if (has_default) {
+                elog(sema, c->cursors_idx, "switch already has a default case");
+            }
+            has_default = true;
+        }
+
+        if (c->capture.kind != EkNone) {
+            elog(sema, c->cursors_idx, "can only capture a payload when switching on a union");
+        }
+
+        for (size_t j = 0; j < arrlenu(c->values); j++) {
+            CaseRange range = {
+                .case_idx = i,
+                .cursors_idx = c->values[j].cursors_idx,
+            };
+            if (!sema_case_range(sema, &c->values[j], type, enumd, &range)) continue;
+
+            if (switch_less(sw->is_signed, range.hi, range.lo)) {
+                elog(sema, range.cursors_idx, "empty range in case, start is greater than end");
+                continue;
+            }
+
+            // insertion sort by start, keeps the ranges ready for overlap checks and lowering
+            arrpush(sw->ranges, range);
+            size_t at = arrlenu(sw->ranges) - 1;
+            while (at > 0 && switch_less(sw->is_signed, range.lo, sw->ranges[at - 1].lo)) {
+                sw->ranges[at] = sw->ranges[at - 1];
+                at--;
+            }
+            sw->ranges[at] = range;
+        }
+
+        sema_case_body(sema, c);
+    }
+
+    sw->covered = 0;
+    for (size_t i = 0; i < arrlenu(sw->ranges); i++) {
+        CaseRange r = sw->ranges[i];
+        if (i > 0 && !switch_less(sw->is_signed, sw->ranges[i - 1].hi, r.lo)) {
+            elog(sema, r.cursors_idx, "case overlaps with an earlier case");
+        }
+
+        uint64_t n = range_count(r.lo, r.hi);
+        sw->covered = sw->covered > UINT64_MAX - n ? UINT64_MAX : sw->covered + n;
+    }
+
+    if (enumd.kind == SkEnumDecl && !has_default) {
+        strb missing = NULL;
+        for (size_t i = 0; i < arrlenu(enumd.enumdecl.fields); i++) {
+            const char *name = enumd.enumdecl.fields[i].constdecl.name.ident;
+            uint64_t value;
+            if (!eval_enum_field(sema, enumd.enumdecl, name, &value)) continue;
+
+            bool found = false;
+            for (size_t j = 0; j < arrlenu(sw->ranges); j++) {
+                CaseRange r = sw->ranges[j];
+                if (!switch_less(true, value, r.lo) && !switch_less(true, r.hi, value)) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) strbprintf(&missing, "%s.%s", missing == NULL ? "" : ", ", name);
+        }
+
+        if (missing != NULL) {
+            elog(sema, stmnt->cursors_idx, "switch on %s is not exhaustive, missing %s", enumd.enumdecl.name.ident, missing);
+            strbfree(missing);
+        }
+    }
+
+    sema_pick_lowering(sema, sw, has_default);
+}
+
+void sema_switch(Sema *sema, Stmnt *stmnt) {
+    assert(stmnt->kind == SkSwitch);
+    Switch *sw = &stmnt->switchf;
+
+    sema_expr(sema, &sw->value);
+    Type *type = resolve_expr_type(sema, &sw->value);
+    if (type->kind == TkPoison) return;
+
+    if (type->kind == TkTypeDef) {
+        Stmnt decl = symtab_find(sema, type->typedeff, sw->value.cursors_idx);
+        if (decl.kind == SkUnionDecl) {
+            sema_union_switch(sema, stmnt, decl.uniondecl);
+            arrpush(sema->switches, stmnt);
+            return;
+        } else if (decl.kind == SkEnumDecl) {
+            sema_int_switch(sema, stmnt, type_intern(type), decl);
+            arrpush(sema->switches, stmnt);
+            return;
+        }
+    } else if (type_is_switchable(type_intern(type))) {
+        sema_int_switch(sema, stmnt, type_intern(type), stmnt_none());
+        arrpush(sema->switches, stmnt);
+        return;
+    }
+
+    strb t = string_from_type(*type);
+    elog(sema, sw->value.cursors_idx, "cannot switch on %s, expected an integer, enum or union", t);
+    strbfree(t);
+}
+
+static const char *switch_lowering_stringify(SwitchLowering lowering) {
+    switch (lowering) {
+        case SlNone: return "none";
+        case SlTagTable: return "tag jump table";
+        case SlJumpTable: return "jump table";
+        case SlDecisionTree: return "decision tree";
+        case SlLookupTable: return "lookup table";
+    }
+
+    return "";
+}
+
+void sema_switch_report(Sema *sema) {
+    for (size_t i = 0; i < arrlenu(sema->switches); i++) {
+        Stmnt *stmnt = sema->switches[i];
+        Switch sw = stmnt->switchf;
+        Cursor cursor;
+        const char *filename = module_cursor(stmnt->cursors_idx, &cursor);
+
+        strb t = string_from_type(sw.value.type);
+        strb line = NULL;
+        strbprintf(&line, "%s:%lu:%lu switch on %s: %s, %zu case%s", filename, cursor.row, cursor.col, t, switch_lowering_stringify(sw.lowering), arrlenu(sw.cases), arrlenu(sw.cases) == 1 ? "" : "s");
+        if (sw.lowering != SlTagTable && sw.span != 0) {
+            strbprintf(&line, ", %" PRIu64 " of %" PRIu64 " values covered", sw.covered, sw.span);
+        }
+
+        printfln("%s", line);
+        strbfree(line);
+        strbfree(t);
+    }
+}
+
 void sema_block(Sema *sema, Arr(Stmnt) body) {
     for (size_t i = 0; i < arrlenu(body); i++) {
         Stmnt *stmnt = &body[i];
@@ -1411,6 +2438,9 @@ void sema_block(Sema *sema, Arr(Stmnt) body) {
             case SkFor:
                 sema_for(sema, stmnt);
                 break;
+            case SkSwitch:
+                sema_switch(sema, stmnt);
+                break;
             case SkFnDecl:
                 elog(sema, stmnt->cursors_idx, "illegal function declaration inside another function");
                 break;
@@ -1420,6 +2450,9 @@ void sema_block(Sema *sema, Arr(Stmnt) body) {
             case SkEnumDecl:
                 elog(sema, stmnt->cursors_idx, "illegal enum declaration inside a function");
                 break;
+            case SkUnionDecl:
+                elog(sema, stmnt->cursors_idx, "illegal union declaration inside a function");
+                break;
         }
     }
 }
@@ -1429,6 +2462,7 @@ void sema_fn_decl(Sema *sema, Stmnt *stmnt) {
 
     symtab_push(sema, stmnt->fndecl.name.ident, *stmnt);
     symtab_new_scope(sema);
+    sema_array_len(sema, &stmnt->fndecl.type, stmnt->cursors_idx);
 
     bool must_be_vardecls = false;
     for (size_t i = 0; i < arrlenu(stmnt->fndecl.args); i++) {
@@ -1447,10 +2481,19 @@ void sema_fn_decl(Sema *sema, Stmnt *stmnt) {
             }
         }
 
+        Type *argtype = &arg->constdecl.type;
+        if (arg->constdecl.noalias && argtype->kind != TkPtr && argtype->kind != TkSlice) {
+            strb t = string_from_type(*argtype);
+            elog(sema, arg->cursors_idx, "#noalias only applies to pointer and slice arguments, got %s", t);
+            strbfree(t);
+        }
+
         if (arg->kind == SkVarDecl) {
             must_be_vardecls = true;
             sema_var_decl(sema, arg);
         } else {
+            sema_soa_type(sema, type_intern(&arg->constdecl.type), arg->cursors_idx);
+            sema_array_len(sema, &arg->constdecl.type, arg->cursors_idx);
             symtab_push(sema, arg->constdecl.name.ident, *arg);
         }
     }
@@ -1466,12 +2509,116 @@ void sema_fn_decl(Sema *sema, Stmnt *stmnt) {
     }
 
 after_main_fn_check:
-    sema->envinfo.fn = *stmnt;
-    sema_block(sema, stmnt->fndecl.body);
+    // externs don't have a body
+    if (arrlenu(stmnt->fndecl.body) > 0) {
+        arrpush(sema->bodies, ((FnBody){
+            .fn = stmnt,
+            .keys = sema->symtab.keys[sema->symtab.cur_scope],
+            .stmnts = sema->symtab.stmnts[sema->symtab.cur_scope],
+            .globals = sema->symtab.visible[sema->symtab.cur_scope],
+        }));
+        // the body owns them now
+        sema->symtab.keys[sema->symtab.cur_scope] = NULL;
+        sema->symtab.stmnts[sema->symtab.cur_scope] = NULL;
+    }
 
     symtab_pop_scope(sema);
 }
 
+static void sema_body(void *ctx, size_t i) {
+    Sema *worker = &((Sema*)ctx)[i];
+
+    if (setjmp(worker->bail) == 0) {
+        sema_block(worker, worker->envinfo.fn.fndecl.body);
+    }
+}
+
+static int diagnostic_cmp(const void *a, const void *b) {
+    const Diagnostic *x = a;
+    const Diagnostic *y = b;
+
+    if (x->cursors_idx != y->cursors_idx) return x->cursors_idx < y->cursors_idx ? -1 : 1;
+    if (x->order != y->order) return x->order < y->order ? -1 : 1;
+    return 0;
+}
+
+// every body only reads globals and writes to its own statements, so they're checked in parallel
+// errors are printed in order of their cursor afterwards, so the output doesn't depend on the number of threads
+void sema_bodies(Sema *sema) {
+    size_t len = arrlenu(sema->bodies);
+    if (len == 0) return;
+
+    Sema *workers = ealloc(sizeof(Sema) * len);
+    for (size_t i = 0; i < len; i++) {
+        FnBody body = sema->bodies[i];
+        Sema *worker = &workers[i];
+        *worker = *sema;
+
+        // scope 0 is left empty, constants in a body must not look global
+        // the globals are shared, every top level declaration has been pushed by now and they're only read
+        worker->symtab = symtab_init();
+        arrpush(worker->symtab.keys, sema->symtab.keys[0]);
+        arrpush(worker->symtab.stmnts, sema->symtab.stmnts[0]);
+        arrpush(worker->symtab.visible, 0);
+        arrpush(worker->symtab.keys, body.keys);
+        arrpush(worker->symtab.stmnts, body.stmnts);
+        arrpush(worker->symtab.visible, body.globals);
+        worker->symtab.cur_scope = 2;
+
+        worker->envinfo.fn = *body.fn;
+        worker->envinfo.forl = false;
+        worker->envinfo.const_call = false;
+
+        worker->switches = NULL;
+        worker->comptime = NULL;
+        worker->bodies = NULL;
+        worker->worker = true;
+        worker->diagnostics = NULL;
+        worker->directives = NULL;
+        worker->error_count = 0;
+    }
+
+    pool_for(sema->threads, len, sema_body, workers);
+
+    Arr(Diagnostic) diagnostics = NULL;
+    for (size_t i = 0; i < len; i++) {
+        Sema *worker = &workers[i];
+
+        for (size_t j = 0; j < arrlenu(worker->switches); j++) {
+            arrpush(sema->switches, worker->switches[j]);
+        }
+        for (size_t j = 0; j < arrlenu(worker->comptime); j++) {
+            arrpush(sema->comptime, worker->comptime[j]);
+        }
+        for (size_t j = 0; j < arrlenu(worker->diagnostics); j++) {
+            Diagnostic diagnostic = worker->diagnostics[j];
+            diagnostic.order = arrlenu(diagnostics);
+            arrpush(diagnostics, diagnostic);
+        }
+    }
+
+    // diagnostics is NULL when there are none
+    if (arrlenu(diagnostics) > 1) qsort(diagnostics, arrlenu(diagnostics), sizeof(Diagnostic), diagnostic_cmp);
+    for (size_t i = 0; i < arrlenu(diagnostics); i++) {
+        Diagnostic diagnostic = diagnostics[i];
+        sema->error_count++;
+
+        Cursor cursor;
+        const char *filename = module_cursor(diagnostic.cursors_idx, &cursor);
+        eprintfln("%s:%lu:%lu " TERM_RED "error" TERM_END ": %s", filename, cursor.row, cursor.col, diagnostic.msg);
+
+        if (diagnostic.fatal || sema->error_count > ERRORS_MAX) {
+            exit(1);
+        }
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        for (size_t j = 0; j < arrlenu(workers[i].directives); j++) {
+            sema_directive(sema, workers[i].directives[j]);
+        }
+    }
+}
+
 void sema_defer(Sema *sema, Stmnt *stmnt) {
     assert(stmnt->kind == SkDefer);
 
@@ -1490,6 +2637,9 @@ void sema_defer(Sema *sema, Stmnt *stmnt) {
         case SkFor:
             sema_for(sema, stmnt->defer);
             break;
+        case SkSwitch:
+            sema_switch(sema, stmnt->defer);
+            break;
         case SkBlock:
             sema_block(sema, stmnt->defer->block);
             break;
@@ -1506,6 +2656,7 @@ void sema_defer(Sema *sema, Stmnt *stmnt) {
         case SkConstDecl:
         case SkEnumDecl:
         case SkStructDecl:
+        case SkUnionDecl:
         case SkFnDecl:
         case SkExtern:
             elog(sema, stmnt->externf->cursors_idx, "cannot defer a declaration");
@@ -1567,6 +2718,12 @@ void sema_extern(Sema *sema, Stmnt *stmnt) {
         case SkFor:
             elog(sema, stmnt->externf->cursors_idx, "illegal use of for loop, not inside a function");
             break;
+        case SkSwitch:
+            elog(sema, stmnt->externf->cursors_idx, "illegal use of switch statement, not inside a function");
+            break;
+        case SkUnionDecl:
+            elog(sema, stmnt->externf->cursors_idx, "illegal union declaration, cannot be external");
+            break;
         case SkExtern:
             elog(sema, stmnt->externf->cursors_idx, "illegal use of extern, already inside extern");
             break;
@@ -1576,6 +2733,8 @@ void sema_extern(Sema *sema, Stmnt *stmnt) {
     }
 }
 
+void sema_union_decl_deps(Sema *sema, Stmnt *stmnt, Arr(const char*) visited);
+
 // catching cyclic dependencies and finding all children
 // remember to free visited
 void sema_struct_decl_deps(Sema *sema, Stmnt *stmnt, Arr(const char*) visited) {
@@ -1616,6 +2775,9 @@ void sema_struct_decl_deps(Sema *sema, Stmnt *stmnt, Arr(const char*) visited) {
                     .us = decl,
                     .children = NULL,
                 });
+            } else if (decl.kind == SkUnionDecl) {
+                name = decl.uniondecl.name;
+                sema_union_decl_deps(sema, &decl, new_visited);
             }
 
             arrpush(children, name.ident);
@@ -1624,9 +2786,12 @@ void sema_struct_decl_deps(Sema *sema, Stmnt *stmnt, Arr(const char*) visited) {
             // we need to explicitly check if it's an option between we need to generate the underlying type
             if (f->vardecl.type.option.subtype->kind == TkTypeDef) {
                 Stmnt decl = ast_find_decl(sema->ast, f->vardecl.type.option.subtype->typedeff);
-                if (decl.kind != SkNone) {
+                if (decl.kind == SkStructDecl) {
                     sema_struct_decl_deps(sema, &decl, visited);
                     arrpush(children, decl.structdecl.name.ident);
+                } else if (decl.kind == SkUnionDecl) {
+                    sema_union_decl_deps(sema, &decl, visited);
+                    arrpush(children, decl.uniondecl.name.ident);
                 }
             }
         }
@@ -1665,10 +2830,107 @@ void sema_struct_decl(Sema *sema, Stmnt *stmnt) {
 
     sema_struct_decl_deps(sema, stmnt, visited);
 
+    // cyclic structs would never finish being laid out
+    if (sema->error_count == 0) {
+        layout_order(sema->ast, structd, sema->compile_flags.reorder);
+    }
+
     arrfree(visited);
     symtab_pop_scope(sema);
 }
 
+// same as sema_struct_decl_deps, payloads are stored inline so they need to be defined first
+void sema_union_decl_deps(Sema *sema, Stmnt *stmnt, Arr(const char*) visited) {
+    assert(stmnt->kind == SkUnionDecl);
+
+    Arr(const char*) new_visited = NULL;
+    for (size_t i = 0; i < arrlenu(visited); i++) {
+        arrpush(new_visited, visited[i]);
+    }
+    arrpush(new_visited, stmnt->uniondecl.name.ident);
+
+    Arr(const char*) children = NULL;
+    for (size_t i = 0; i < arrlenu(stmnt->uniondecl.fields); i++) {
+        Stmnt *v = &stmnt->uniondecl.fields[i];
+        Type *type = &v->vardecl.type;
+        if (type->kind == TkOption) type = type->option.subtype;
+        if (type->kind != TkTypeDef) continue;
+
+        Stmnt decl = ast_find_decl(sema->ast, type->typedeff);
+        if (decl.kind == SkNone) continue;
+
+        bool cyclic = false;
+        for (size_t j = 0; j < arrlenu(new_visited); j++) {
+            if (streq(new_visited[j], type->typedeff)) {
+                elog(sema, stmnt->cursors_idx, "cyclic dependency between union \"%s\" and variant \"%s\" of type \"%s\"", stmnt->uniondecl.name.ident, v->vardecl.name.ident, type->typedeff);
+                cyclic = true;
+                break;
+            }
+        }
+        if (cyclic) continue;
+
+        if (decl.kind == SkStructDecl) {
+            sema_struct_decl_deps(sema, &decl, new_visited);
+        } else if (decl.kind == SkUnionDecl) {
+            sema_union_decl_deps(sema, &decl, new_visited);
+        } else if (decl.kind == SkEnumDecl) {
+            dgraph_push(&sema->dgraph, (Dnode){
+                .name = decl.enumdecl.name.ident,
+                .us = decl,
+                .children = NULL,
+            });
+        }
+
+        arrpush(children, type->typedeff);
+    }
+
+    arrfree(new_visited);
+    dgraph_push(&sema->dgraph, (Dnode){
+        .name = stmnt->uniondecl.name.ident,
+        .us = *stmnt,
+        .children = children,
+    });
+}
+
+void sema_union_decl(Sema *sema, Stmnt *stmnt) {
+    assert(stmnt->kind == SkUnionDecl);
+    UnionDecl *uniond = &stmnt->uniondecl;
+
+    symtab_push(sema, uniond->name.ident, *stmnt);
+    symtab_new_scope(sema);
+
+    size_t variants = arrlenu(uniond->fields);
+    if (variants == 0) {
+        elog(sema, stmnt->cursors_idx, "union %s must have at least one variant", uniond->name.ident);
+    } else if (variants > UINT16_MAX + 1) {
+        elog(sema, stmnt->cursors_idx, "union %s has %zu variants, the most a union can have is %d", uniond->name.ident, variants, UINT16_MAX + 1);
+    }
+
+    for (size_t i = 0; i < variants; i++) {
+        Stmnt *v = &uniond->fields[i];
+        assert(v->kind == SkVarDecl);
+
+        if (v->vardecl.value.kind != EkNone) {
+            elog(sema, v->cursors_idx, "cannot have default values in unions, got one for variant %s", v->vardecl.name.ident);
+            continue;
+        }
+
+        if (v->vardecl.type.kind == TkTypeDef) {
+            Stmnt found = symtab_find(sema, v->vardecl.type.typedeff, v->cursors_idx);
+            if (found.kind == SkNone) continue;
+        }
+
+        if (v->vardecl.type.kind == TkVoid) {
+            symtab_push(sema, v->vardecl.name.ident, *v);
+        } else {
+            sema_var_decl(sema, v);
+        }
+    }
+
+    sema_union_decl_deps(sema, stmnt, NULL);
+    symtab_pop_scope(sema);
+}
+
 void sema_enum_decl(Sema *sema, Stmnt *stmnt) {
     assert(stmnt->kind == SkEnumDecl);
 
@@ -1684,7 +2946,7 @@ void sema_enum_decl(Sema *sema, Stmnt *stmnt) {
             f->constdecl.value = expr_intlit(counter, type_integer(TkUntypedInt, TYPECONST, f->cursors_idx), f->cursors_idx);
             counter++;
         } else {
-            f->constdecl.type.kind = TkI32;
+            f->constdecl.type = type_integer(TkI32, f->constdecl.type.constant, f->constdecl.type.cursors_idx);
             counter = eval_expr(sema, &f->constdecl.value);
             counter++;
         }
@@ -1699,7 +2961,117 @@ void sema_enum_decl(Sema *sema, Stmnt *stmnt) {
     symtab_pop_scope(sema);
 }
 
+void sema_comptime(Sema *sema) {
+    for (size_t i = 0; i < arrlenu(sema->comptime); i++) {
+        Stmnt *stmnt = sema->comptime[i];
+        ConstDecl *constdecl = &stmnt->constdecl;
+
+        Expr value;
+        strb why = NULL;
+        size_t cursor_idx = stmnt->cursors_idx;
+        if (vm_eval_call(sema, &constdecl->value, &value, &why, &cursor_idx)) {
+            constdecl->value = value;
+            strbfree(why);
+            continue;
+        }
+
+        // a local scalar can still be called at runtime, C can't initialise globals with a call or copy arrays
+        bool global = stmnt >= sema->ast && stmnt < sema->ast + arrlenu(sema->ast);
+        if (global || constdecl->type.kind == TkArray) {
+            elog(sema, cursor_idx, "cannot evaluate \"%s\" at compile time, %s", constdecl->name.ident, why);
+        }
+        strbfree(why);
+    }
+}
+
+// returns the branch of a #if that is taken, NULL if the condition is invalid
+static Arr(Stmnt) sema_if_branch(Sema *sema, Stmnt *stmnt) {
+    If *iff = stmnt->directive.iff;
+
+    ConstValue value;
+    if (!eval_value(sema, &iff->condition, &value)) {
+        elog(sema, stmnt->cursors_idx, "#if condition must be known at compile time");
+        return NULL;
+    }
+
+    if (value.type.kind != TkBool) {
+        strb t = string_from_type(value.type);
+        elog(sema, stmnt->cursors_idx, "#if condition must be bool, got %s", t);
+        strbfree(t);
+        return NULL;
+    }
+
+    return value.u ? iff->body : iff->els;
+}
+
+// replaces every #if with the branch it takes, the other branch is never analysed or generated
+// NOTE: runs before analysis, so conditions can only use global constants
+void sema_resolve_ifs(Sema *sema, Arr(Stmnt) *body) {
+    for (size_t i = 0; i < arrlenu(*body);) {
+        Stmnt *stmnt = &(*body)[i];
+
+        if (stmnt->kind == SkDirective && stmnt->directive.kind == DkIf) {
+            Arr(Stmnt) taken = sema_if_branch(sema, stmnt);
+            size_t len = arrlenu(taken);
+
+            // the branch takes the directive's place, what follows moves along to make room
+            size_t old_len = arrlenu(*body);
+            if (len > 1) arrsetlen(*body, old_len + len - 1);
+            memmove(&(*body)[i + len], &(*body)[i + 1], sizeof(Stmnt) * (old_len - i - 1));
+            if (len == 0) arrsetlen(*body, old_len - 1);
+            for (size_t j = 0; j < len; j++) {
+                (*body)[i + j] = taken[j];
+            }
+            // the taken branch can have #ifs of its own
+            continue;
+        }
+
+        switch (stmnt->kind) {
+            case SkFnDecl:
+                sema_resolve_ifs(sema, &stmnt->fndecl.body);
+                break;
+            case SkBlock:
+                sema_resolve_ifs(sema, &stmnt->block);
+                break;
+            case SkIf:
+                sema_resolve_ifs(sema, &stmnt->iff.body);
+                sema_resolve_ifs(sema, &stmnt->iff.els);
+                break;
+            case SkFor:
+                sema_resolve_ifs(sema, &stmnt->forf.body);
+                break;
+            case SkSwitch:
+                for (size_t j = 0; j < arrlenu(stmnt->switchf.cases); j++) {
+                    sema_resolve_ifs(sema, &stmnt->switchf.cases[j].body);
+                }
+                break;
+            case SkDefer:
+                if (stmnt->defer->kind == SkBlock) {
+                    sema_resolve_ifs(sema, &stmnt->defer->block);
+                }
+                break;
+            default:
+                break;
+        }
+        i++;
+    }
+}
+
 void sema_analyse(Sema *sema) {
+    sema_resolve_ifs(sema, &sema->ast);
+
+    // #reorder; applies to every struct, so it needs to be known before any of them are analysed
+    for (size_t i = 0; i < arrlenu(sema->ast); i++) {
+        Stmnt *stmnt = &sema->ast[i];
+        if (stmnt->kind != SkDirective || stmnt->directive.kind != DkReorder) continue;
+
+        if (!sema->compile_flags.reorder) {
+            sema->compile_flags.reorder = true;
+        } else {
+            elog(sema, stmnt->cursors_idx, "reorder already set, cannot have more than one reorder directive");
+        }
+    }
+
     for (size_t i = 0; i < arrlenu(sema->ast); i++) {
         Stmnt *stmnt = &sema->ast[i];
         switch (stmnt->kind) {
@@ -1720,14 +3092,21 @@ void sema_analyse(Sema *sema) {
             case SkEnumDecl:
                 sema_enum_decl(sema, stmnt);
                 break;
+            case SkUnionDecl:
+                sema_union_decl(sema, stmnt);
+                break;
             case SkVarDecl:
+                sema->envinfo.const_call = stmnt->vardecl.value.kind == EkFnCall;
                 sema_var_decl(sema, stmnt);
+                sema->envinfo.const_call = false;
+                sema_global_init(sema, stmnt);
                 break;
             case SkVarReassign:
                 sema_var_reassign(sema, stmnt);
                 break;
             case SkConstDecl:
                 sema_const_decl(sema, stmnt);
+                sema_global_init(sema, stmnt);
                 break;
             case SkBlock:
                 elog(sema, stmnt->cursors_idx, "illegal use of scope block, not inside a function");
@@ -1753,6 +3132,16 @@ void sema_analyse(Sema *sema) {
             case SkFor:
                 elog(sema, stmnt->cursors_idx, "illegal use of for loop, not inside a function");
                 break;
+            case SkSwitch:
+                elog(sema, stmnt->cursors_idx, "illegal use of switch statement, not inside a function");
+                break;
         }
     }
+
+    sema_bodies(sema);
+
+    // every function has to be analysed before any of them can run
+    if (sema->error_count == 0) {
+        sema_comptime(sema);
+    }
 }
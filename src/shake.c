@@ -0,0 +1,352 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "include/shake.h"
+#include "include/exprs.h"
+#include "include/sema.h"
+#include "include/stb_ds.h"
+#include "include/stmnts.h"
+#include "include/strb.h"
+#include "include/types.h"
+#include "include/utils.h"
+
+typedef struct Shake {
+    Sema *sema;
+
+    struct { const char *key; size_t value; } *fns; // name to index in the ast
+    struct { const char *key; size_t value; } *types; // name to index in the dgraph
+    bool *fn_live;
+    bool *type_live;
+    Arr(size_t) work; // functions found live but not walked yet
+
+    // slice and option instantiations, string_from_type to whether anything live uses them
+    struct { char *key; bool value; } *generics;
+
+    // false while walking dropped functions, only their instantiations are collected
+    bool marking;
+} Shake;
+
+static void shake_expr(Shake *s, Expr *expr);
+static void shake_stmnt(Shake *s, Stmnt *stmnt);
+
+static void shake_mark_type(Shake *s, const char *name);
+
+static void shake_type(Shake *s, Type *type) {
+    if (type == NULL) return;
+
+    switch (type->kind) {
+        case TkSlice:
+        case TkOption: {
+            strb key = string_from_type(*type);
+            ptrdiff_t at = shgeti(s->generics, key);
+            if (at < 0) {
+                shput(s->generics, key, s->marking);
+            } else {
+                s->generics[at].value |= s->marking;
+                strbfree(key);
+            }
+
+            shake_type(s, type->kind == TkSlice ? type->slice.of : type->option.subtype);
+        } break;
+        case TkArray:
+            shake_type(s, type->array.of);
+            if (type->array.len != NULL) shake_expr(s, type->array.len);
+            break;
+        case TkPtr:
+            shake_type(s, type->ptr_to);
+            break;
+        case TkRange:
+            shake_type(s, type->range.subtype);
+            break;
+        case TkSoa:
+            shake_type(s, type->soa.of);
+            break;
+        case TkTypeDef:
+            shake_mark_type(s, type->typedeff);
+            break;
+        default: break;
+    }
+}
+
+static void shake_mark_fn(Shake *s, const char *name) {
+    if (!s->marking) return;
+
+    ptrdiff_t at = shgeti(s->fns, name);
+    if (at < 0) return;
+
+    size_t i = s->fns[at].value;
+    if (s->fn_live[i]) return;
+    s->fn_live[i] = true;
+    arrpush(s->work, i);
+}
+
+// the fields of a struct are walked right away, types can't reach functions so there's no need for a worklist
+static void shake_mark_type(Shake *s, const char *name) {
+    if (!s->marking) return;
+
+    ptrdiff_t at = shgeti(s->types, name);
+    if (at < 0) return;
+
+    size_t i = s->types[at].value;
+    if (s->type_live[i]) return;
+    s->type_live[i] = true;
+
+    Dnode node = s->sema->dgraph.children[i];
+    for (size_t j = 0; j < arrlenu(node.children); j++) {
+        shake_mark_type(s, node.children[j]);
+    }
+
+    // pointer fields aren't dependencies but still need their type declared
+    if (node.us.kind == SkStructDecl || node.us.kind == SkEnumDecl || node.us.kind == SkUnionDecl) {
+        for (size_t j = 0; j < arrlenu(node.us.structdecl.fields); j++) {
+            shake_stmnt(s, &node.us.structdecl.fields[j]);
+        }
+    }
+}
+
+static void shake_exprs(Shake *s, Arr(Expr) exprs) {
+    for (size_t i = 0; i < arrlenu(exprs); i++) {
+        shake_expr(s, &exprs[i]);
+    }
+}
+
+static void shake_block(Shake *s, Arr(Stmnt) block) {
+    for (size_t i = 0; i < arrlenu(block); i++) {
+        shake_stmnt(s, &block[i]);
+    }
+}
+
+static void shake_expr(Shake *s, Expr *expr) {
+    shake_type(s, &expr->type);
+
+    switch (expr->kind) {
+        case EkType:
+            shake_type(s, expr->type_expr);
+            break;
+        case EkIdent:
+            // anything named like a function keeps it, locals shadowing one only cost the function staying in
+            shake_mark_fn(s, expr->ident);
+            break;
+        case EkLiteral:
+            if (expr->literal.kind == LitkExprs) {
+                shake_exprs(s, expr->literal.exprs);
+            } else if (expr->literal.kind == LitkVars) {
+                shake_block(s, expr->literal.vars);
+            }
+            break;
+        case EkFnCall:
+            shake_expr(s, expr->fncall.name);
+            // sema moves every argument into exprs
+            shake_exprs(s, expr->fncall.args.exprs);
+            break;
+        case EkBinop:
+            shake_expr(s, expr->binop.left);
+            shake_expr(s, expr->binop.right);
+            break;
+        case EkUnop:
+            shake_expr(s, expr->unop.val);
+            break;
+        case EkGrouping:
+            shake_expr(s, expr->group);
+            break;
+        case EkRangeLit:
+            shake_expr(s, expr->rangelit.start);
+            shake_expr(s, expr->rangelit.end);
+            break;
+        case EkFieldAccess:
+            shake_expr(s, expr->fieldacc.accessing);
+            break;
+        case EkArrayIndex:
+            shake_expr(s, expr->arrayidx.accessing);
+            shake_expr(s, expr->arrayidx.index);
+            break;
+        case EkArraySlice:
+            shake_expr(s, expr->arrayslice.accessing);
+            shake_expr(s, expr->arrayslice.slice);
+            break;
+        default: break;
+    }
+}
+
+static void shake_stmnt(Shake *s, Stmnt *stmnt) {
+    switch (stmnt->kind) {
+        case SkFnDecl:
+            shake_type(s, &stmnt->fndecl.type);
+            shake_block(s, stmnt->fndecl.args);
+            shake_block(s, stmnt->fndecl.body);
+            break;
+        case SkVarDecl:
+        case SkConstDecl:
+        case SkVarReassign:
+            shake_expr(s, &stmnt->vardecl.name);
+            shake_type(s, &stmnt->vardecl.type);
+            shake_expr(s, &stmnt->vardecl.value);
+            break;
+        case SkReturn:
+            shake_expr(s, &stmnt->returnf.value);
+            break;
+        case SkDefer:
+        case SkExtern:
+            shake_stmnt(s, stmnt->defer);
+            break;
+        case SkFnCall:
+            shake_expr(s, stmnt->fncall.name);
+            shake_exprs(s, stmnt->fncall.args.exprs);
+            break;
+        case SkIf:
+            shake_expr(s, &stmnt->iff.condition);
+            if (stmnt->iff.capturekind == CkConstDecl) shake_stmnt(s, stmnt->iff.capture.constdecl);
+            shake_block(s, stmnt->iff.body);
+            shake_block(s, stmnt->iff.els);
+            break;
+        case SkFor:
+            shake_stmnt(s, stmnt->forf.decl);
+            shake_expr(s, &stmnt->forf.condition);
+            shake_stmnt(s, stmnt->forf.reassign);
+            shake_block(s, stmnt->forf.body);
+            break;
+        case SkSwitch:
+            shake_expr(s, &stmnt->switchf.value);
+            for (size_t i = 0; i < arrlenu(stmnt->switchf.cases); i++) {
+                Case *c = &stmnt->switchf.cases[i];
+                shake_exprs(s, c->values);
+                if (c->capture_decl != NULL) shake_stmnt(s, c->capture_decl);
+                shake_block(s, c->body);
+            }
+            break;
+        case SkBlock:
+            shake_block(s, stmnt->block);
+            break;
+        default: break;
+    }
+}
+
+static bool *shake_flags(size_t count) {
+    bool *flags = ealloc(count + 1);
+    memset(flags, 0, count + 1);
+    return flags;
+}
+
+static int shake_cmp(const void *a, const void *b) {
+    return strcmp(*(const char**)a, *(const char**)b);
+}
+
+static void shake_report_names(const char *what, Arr(const char*) names) {
+    if (arrlenu(names) == 0) return;
+
+    qsort(names, arrlenu(names), sizeof(const char*), shake_cmp);
+    strb line = NULL;
+    for (size_t i = 0; i < arrlenu(names); i++) {
+        strbprintf(&line, i == 0 ? "%s" : ", %s", names[i]);
+    }
+    printfln("dropped %s: %s", what, line);
+    strbfree(line);
+}
+
+void tree_shake(Sema *sema, bool library, bool report) {
+    if (library) {
+        if (report) printfln("nothing dropped, everything in a -pmi library can be called");
+        return;
+    }
+
+    Arr(Stmnt) ast = sema->ast;
+    Dgraph *dgraph = &sema->dgraph;
+    size_t fns = arrlenu(ast);
+    size_t types = arrlenu(dgraph->children);
+
+    Shake s = {
+        .sema = sema,
+        .fns = NULL,
+        .types = NULL,
+        .fn_live = shake_flags(fns),
+        .type_live = shake_flags(types),
+        .work = NULL,
+        .generics = NULL,
+        .marking = true,
+    };
+
+    for (size_t i = 0; i < fns; i++) {
+        if (ast[i].kind == SkFnDecl && ast[i].fndecl.name.kind == EkIdent) {
+            shput(s.fns, ast[i].fndecl.name.ident, i);
+        }
+    }
+    for (size_t i = 0; i < types; i++) {
+        shput(s.types, dgraph->children[i].name, i);
+    }
+
+    // main, externs and globals are always emitted, so whatever they use is too
+    shake_mark_fn(&s, "main");
+    for (size_t i = 0; i < fns; i++) {
+        switch (ast[i].kind) {
+            case SkExtern:
+            case SkVarDecl:
+            case SkConstDecl:
+            case SkVarReassign:
+                shake_stmnt(&s, &ast[i]);
+                break;
+            default: break;
+        }
+    }
+
+    while (arrlenu(s.work) > 0) {
+        size_t i = arrpop(s.work);
+        shake_stmnt(&s, &ast[i]);
+    }
+
+    Arr(const char*) dropped_fns = NULL;
+    s.marking = false;
+    for (size_t i = 0; i < fns; i++) {
+        if (ast[i].kind != SkFnDecl || s.fn_live[i]) continue;
+
+        shake_stmnt(&s, &ast[i]);
+        arrpush(dropped_fns, ast[i].fndecl.name.ident);
+        ast[i] = stmnt_none();
+    }
+
+    Arr(const char*) dropped_types = NULL;
+    Dgraph live = dgraph_init();
+    for (size_t i = 0; i < types; i++) {
+        Dnode node = dgraph->children[i];
+        if (s.type_live[i]) {
+            dgraph_push(&live, node);
+            continue;
+        }
+
+        arrpush(dropped_types, node.name);
+        if (node.us.kind == SkStructDecl || node.us.kind == SkEnumDecl || node.us.kind == SkUnionDecl) {
+            shake_block(&s, node.us.structdecl.fields);
+        }
+    }
+    arrfree(dgraph->names);
+    arrfree(dgraph->children);
+    *dgraph = live;
+
+    Arr(const char*) dropped_generics = NULL;
+    for (ptrdiff_t i = 0; i < shlen(s.generics); i++) {
+        if (!s.generics[i].value) arrpush(dropped_generics, s.generics[i].key);
+    }
+
+    if (report) {
+        printfln("%zu of %zu functions, %zu of %zu types and %zu of %zu slice and option instantiations kept",
+            (size_t)shlen(s.fns) - arrlenu(dropped_fns), (size_t)shlen(s.fns),
+            types - arrlenu(dropped_types), types,
+            (size_t)shlen(s.generics) - arrlenu(dropped_generics), (size_t)shlen(s.generics));
+        shake_report_names("functions", dropped_fns);
+        shake_report_names("types", dropped_types);
+        shake_report_names("instantiations", dropped_generics);
+    }
+
+    arrfree(dropped_fns);
+    arrfree(dropped_types);
+    arrfree(dropped_generics);
+    for (ptrdiff_t i = 0; i < shlen(s.generics); i++) {
+        strbfree(s.generics[i].key);
+    }
+    shfree(s.generics);
+    shfree(s.fns);
+    shfree(s.types);
+    arrfree(s.work);
+    free(s.fn_live);
+    free(s.type_live);
+}
@@ -35,6 +35,14 @@ Stmnt stmnt_enumdecl(EnumDecl v, size_t index) {
     };
 }
 
+Stmnt stmnt_uniondecl(UnionDecl v, size_t index) {
+    return (Stmnt){
+        .kind = SkUnionDecl,
+        .cursors_idx = index,
+        .uniondecl = v,
+    };
+}
+
 Stmnt stmnt_vardecl(VarDecl v, size_t index) {
     return (Stmnt){
         .kind = SkVarDecl,
@@ -113,6 +121,14 @@ Stmnt stmnt_for(For v, size_t index) {
     };
 }
 
+Stmnt stmnt_switch(Switch v, size_t index) {
+    return (Stmnt){
+        .kind = SkSwitch,
+        .cursors_idx = index,
+        .switchf = v,
+    };
+}
+
 Stmnt stmnt_block(Arr(Stmnt) v, size_t index) {
     return (Stmnt){
         .kind = SkBlock,
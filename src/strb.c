@@ -50,7 +50,7 @@ static void strbpushs(strb *sb, const char *s) {
 void vstrbprintf(strb *s, const char *fmt, va_list args) {
     char *buf = NULL;
     int wrote = vasprintf(&buf, fmt, args);
-    assert(wrote != 0);
+    assert(wrote >= 0);
     strbpushs(s, buf);
     free(buf);
 }
@@ -70,6 +70,23 @@ void strbprintfln(strb *s, const char *fmt, ...) {
     va_end(args);
 }
 
+void strbappend(strb *s, const char *str) {
+    size_t add = strlen(str);
+    if (add == 0) return;
+    if (*s == NULL) strbnew(s);
+
+    size_t len = strlen(*s);
+    if (len + add >= strbcap(*s)) {
+        size_t newcap = strbcap(*s);
+        while (len + add >= newcap) newcap = newcap * 2 + 1;
+
+        strbheader *h = erealloc(strbh(*s), sizeof(strbheader) + newcap + sizeof(char));
+        h->cap = newcap;
+        *s = (char*)(h + 1);
+    }
+    memcpy(*s + len, str, add + 1);
+}
+
 // warning: this frees sb and returns a new strb
 strb strbinsert(strb sb, const char *str, size_t index) {
     assert(strlen(sb) >= index);
@@ -1,9 +1,12 @@
 #include <assert.h>
+#include <setjmp.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include "include/typecheck.h"
+#include "include/arena.h"
 #include "include/eval.h"
 #include "include/exprs.h"
+#include "include/module.h"
 #include "include/sema.h"
 #include "include/stmnts.h"
 #include "include/strb.h"
@@ -30,33 +33,42 @@ static const uint64_t U32_MAX = UINT32_MAX;
 // static const uint64_t U64_MAX = UINT64_MAX;
 
 static void elog(Sema *sema, size_t i, const char *msg, ...) {
-    eprintf("%s:%lu:%lu " TERM_RED "error" TERM_END ": ", sema->filename, sema->cursors[i].row, sema->cursors[i].col);
-
     va_list args;
     va_start(args, msg);
 
+    // a worker stops checking the body, the error is printed with the others once every body is done
+    if (sema_buffer_error(sema, i, true, msg, args)) {
+        va_end(args);
+        longjmp(sema->bail, 1);
+    }
+
+    Cursor cursor;
+    const char *filename = module_cursor(i, &cursor);
+    eprintf("%s:%lu:%lu " TERM_RED "error" TERM_END ": ", filename, cursor.row, cursor.col);
+
     veprintfln(msg, args);
 
     va_end(args);
     exit(1);
 }
 
-bool tc_ptr_equals(Sema *sema, Type lhs, Type *rhs) {
-    if (lhs.kind == TkPtr && rhs->kind != TkPtr) {
+bool tc_ptr_equals(Sema *sema, TypeId lhs, Type *rhs) {
+    const Type *l = type_canon(lhs);
+    if (l->kind == TkPtr && rhs->kind != TkPtr) {
         return false;
     }
 
-    if (lhs.kind == TkPtr && rhs->kind == TkPtr) {
-        if (!lhs.constant && rhs->constant) return false;
+    if (l->kind == TkPtr && rhs->kind == TkPtr) {
+        if (!l->constant && rhs->constant) return false;
 
         // hardcoded since usually can't typecheck between void and another type
         // unless it's a *void and *void, or **void and **void so on
-        if (lhs.ptr_to->kind == TkVoid && rhs->ptr_to->kind == TkVoid) {
+        if (l->ptr_to->kind == TkVoid && rhs->ptr_to->kind == TkVoid) {
             return true;
         }
 
-        if (!lhs.constant && !rhs->constant) return tc_ptr_equals(sema, *lhs.ptr_to, rhs->ptr_to);
-        if (lhs.constant) return tc_ptr_equals(sema, *lhs.ptr_to, rhs->ptr_to);
+        if (!l->constant && !rhs->constant) return tc_ptr_equals(sema, l->ptr_to->id, rhs->ptr_to);
+        if (l->constant) return tc_ptr_equals(sema, l->ptr_to->id, rhs->ptr_to);
     } else {
         return tc_equals(sema, lhs, rhs);
     }
@@ -64,58 +76,96 @@ bool tc_ptr_equals(Sema *sema, Type lhs, Type *rhs) {
     return false;
 }
 
-bool tc_range_equals(Sema *sema, Type lhs, Type *rhs) {
-    if (lhs.kind == TkPoison || rhs->kind == TkPoison) {
+bool tc_range_equals(Sema *sema, TypeId lhs, Type *rhs) {
+    const Type *l = type_canon(lhs);
+    if (l->kind == TkPoison || rhs->kind == TkPoison) {
         return false;
     }
 
-    if (lhs.kind == TkRange && rhs->kind == TkRange) {
-        return tc_equals(sema, *lhs.range.subtype, rhs->range.subtype);
+    if (l->kind == TkRange && rhs->kind == TkRange) {
+        return tc_equals(sema, l->range.subtype->id, rhs->range.subtype);
     }
 
     return false;
 }
 
-bool tc_slice_equals(Sema *sema, Type lhs, Type *rhs) {
-    if (lhs.kind == TkPoison || rhs->kind == TkPoison) {
+bool tc_slice_equals(Sema *sema, TypeId lhs, Type *rhs) {
+    const Type *l = type_canon(lhs);
+    if (l->kind == TkPoison || rhs->kind == TkPoison) {
         return false;
     }
 
-    if (lhs.kind == TkSlice && rhs->kind == TkSlice) {
-        return tc_equals(sema, *lhs.slice.of, rhs->slice.of);
+    if (l->kind == TkSlice && rhs->kind == TkSlice) {
+        return tc_equals(sema, l->slice.of->id, rhs->slice.of);
     }
 
     return false;
 }
 
-bool tc_array_equals(Sema *sema, Type lhs, Type *rhs) {
-    if (lhs.kind == TkPoison || rhs->kind == TkPoison) {
+// a length that isn't a literal yet keys lhs by its expression, so inferring it fills in the ast's
+bool tc_array_equals(Sema *sema, TypeId lhs, Type *rhs) {
+    const Type *l = type_canon(lhs);
+    if (l->kind == TkPoison || rhs->kind == TkPoison) {
         return false;
     }
 
-    if (lhs.kind == TkArray && rhs->kind == TkArray) {
-        if (lhs.array.len->kind != EkNone) {
-            uint64_t l_len = eval_expr(sema, lhs.array.len);
+    if (l->kind == TkArray && rhs->kind == TkArray) {
+        if (l->array.len->kind != EkNone) {
+            uint64_t l_len = eval_expr(sema, l->array.len);
 
             if (rhs->array.len->kind == EkNone) elog(sema, rhs->cursors_idx, "cannot infer array length");
             uint64_t r_len = eval_expr(sema, rhs->array.len);
 
             if (l_len != r_len) return false;
-            return tc_equals(sema, *lhs.array.of, rhs->array.of);
+            return tc_equals(sema, l->array.of->id, rhs->array.of);
         } else {
             if (rhs->array.len->kind == EkNone) elog(sema, rhs->cursors_idx, "cannot infer array length");
-            *lhs.array.len = *rhs->array.len;
-            return tc_equals(sema, *lhs.array.of, rhs->array.of);
+            *l->array.len = *rhs->array.len;
+            return tc_equals(sema, l->array.of->id, rhs->array.of);
         }
     }
 
     return false;
 }
 
+// typedefs are only declared globally, so the name only has to be looked up once
+// an undefined name is reported where the type was first written
+bool tc_typedef_equals(Sema *sema, TypeId lhs, Type *rhs) {
+    TypeInfo *info = type_info(lhs);
+    if (!info->resolved) {
+        info->resolved = symtab_find(sema, info->type.typedeff, info->type.cursors_idx).kind != SkNone;
+    }
+
+    return rhs->kind == TkTypeDef && type_intern(rhs) == lhs;
+}
+
+// compound types that intern to the same id are equal without walking them again
+// only if every typedef inside has been resolved, so undefined names are still reported
+bool tc_identical(TypeId lhs, Type *rhs) {
+    TypeInfo *info = type_info(lhs);
+    switch (info->type.kind) {
+        case TkPtr:
+        case TkArray:
+        case TkSlice:
+        case TkSoa:
+        case TkRange:
+            break;
+        default:
+            return false;
+    }
+    if (!info->settled || rhs->kind != info->type.kind || type_intern(rhs) != lhs) return false;
+
+    TypeInfo *leaf = type_info(info->leaf);
+    return leaf->type.kind != TkTypeDef || leaf->resolved;
+}
+
 // <ident>: <lhs> = <rhs>
 // rhs is a pointer because it might be correct if wrapped in an option
-bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
-    switch (lhs.kind) {
+bool tc_equals(Sema *sema, TypeId lhs, Type *rhs) {
+    if (tc_identical(lhs, rhs)) return true;
+
+    const Type *l = type_canon(lhs);
+    switch (l->kind) {
         case TkVoid: {
             // NOTE: not sure about this
             return false;
@@ -135,22 +185,21 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkTypeId:
             return rhs->kind == TkTypeId;
         case TkTypeDef:
-            symtab_find(sema, lhs.typedeff, lhs.cursors_idx);
-            return rhs->kind == TkTypeDef && streq(lhs.typedeff, rhs->typedeff);
+            return tc_typedef_equals(sema, lhs, rhs);
         case TkOption:
             if (rhs->kind == TkOption) {
-                if (lhs.option.subtype->kind == TkVoid) {
-                    elog(sema, lhs.cursors_idx, "cannot use ?void. maybe use bool instead?");
+                if (l->option.subtype->kind == TkVoid) {
+                    elog(sema, l->cursors_idx, "cannot use ?void. maybe use bool instead?");
                 }
 
                 if (rhs->option.is_null) {
-                    *rhs->option.subtype = *lhs.option.subtype;
+                    *rhs->option.subtype = *l->option.subtype;
                     rhs->option.gen_option = true;
                     return true;
                 }
-                return tc_equals(sema, *lhs.option.subtype, rhs->option.subtype);
-            } else if (tc_equals(sema, *lhs.option.subtype, rhs)) {
-                Type *subtype = ealloc(sizeof(Type)); *subtype = *rhs;
+                return tc_equals(sema, l->option.subtype->id, rhs->option.subtype);
+            } else if (tc_equals(sema, l->option.subtype->id, rhs)) {
+                Type *subtype = arena_alloc(&ast_arena, sizeof(Type)); *subtype = *rhs;
                 *rhs = type_option((Option){
                     .subtype = subtype,
                     .is_null = false,
@@ -165,6 +214,8 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
             return tc_array_equals(sema, lhs, rhs);
         case TkSlice:
             return tc_slice_equals(sema, lhs, rhs);
+        case TkSoa:
+            return rhs->kind == TkSoa && tc_equals(sema, l->soa.of->id, rhs->soa.of);
         case TkRange:
             return tc_range_equals(sema, lhs, rhs);
         case TkUntypedInt:
@@ -187,7 +238,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkI8:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkI8:
                     return true;
@@ -197,7 +248,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkI16:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkI8:
                 case TkI16:
@@ -208,7 +259,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkI32:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkI8:
                 case TkI16:
@@ -220,7 +271,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkI64:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkI8:
                 case TkI16:
@@ -233,7 +284,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkIsize:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkI8:
                 case TkI16:
@@ -247,7 +298,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkU8:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkU8:
                     return true;
@@ -257,7 +308,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkU16:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkU8:
                 case TkU16:
@@ -268,7 +319,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkU32:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkU8:
                 case TkU16:
@@ -280,7 +331,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkU64:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkU8:
                 case TkU16:
@@ -293,7 +344,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
         case TkUsize:
             switch (rhs->kind) {
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkU8:
                 case TkU16:
@@ -318,7 +369,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
             switch (rhs->kind) {
                 case TkUntypedFloat:
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkF32:
                     return true;
@@ -329,7 +380,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
             switch (rhs->kind) {
                 case TkUntypedFloat:
                 case TkUntypedInt:
-                    *rhs = lhs;
+                    *rhs = *l;
                     return true;
                 case TkF32:
                 case TkF64:
@@ -339,7 +390,7 @@ bool tc_equals(Sema *sema, Type lhs, Type *rhs) {
             }
     }
 
-    if (lhs.kind == rhs->kind) return true;
+    if (l->kind == rhs->kind) return true;
     return false;
 }
 
@@ -369,7 +420,7 @@ void tc_return(Sema *sema, Stmnt *stmnt) {
         return;
     }
 
-    if (!tc_equals(sema, ret->type, &ret->value.type)) {
+    if (!tc_equals(sema, type_intern(&ret->type), &ret->value.type)) {
         strb t1 = string_from_type(ret->type);
         strb t2 = string_from_type(ret->value.type);
         elog(sema, stmnt->cursors_idx, "mismatch types, expected return type %s, got %s", t1, t2);
@@ -377,7 +428,7 @@ void tc_return(Sema *sema, Stmnt *stmnt) {
         return;
     }
 
-    if (!tc_equals(sema, fndecl.type, &ret->type)) {
+    if (!tc_equals(sema, type_intern(&fndecl.type), &ret->type)) {
         strb t1 = string_from_type(fndecl.type);
         strb t2 = string_from_type(ret->type);
         elog(sema, stmnt->cursors_idx, "mismatch types, funciton type %s, got %s", t1, t2);
@@ -387,26 +438,26 @@ void tc_return(Sema *sema, Stmnt *stmnt) {
 }
 
 // returns TkNone if no default
-Type tc_default_untyped_type(Type type) {
-    if (type.kind == TkUntypedInt) {
-        return type_integer(TkI64, TYPEVAR, 0);
-    } else if (type.kind == TkUntypedFloat) {
-        return type_integer(TkF64, TYPEVAR, 0);
+TypeId tc_default_untyped_type(TypeId type) {
+    if (type == TkUntypedInt) {
+        return TkI64;
+    } else if (type == TkUntypedFloat) {
+        return TkF64;
     }
 
-    return type_none();
+    return TkNone;
 }
 
 void tc_infer(Sema *sema, Type *lhs, Expr *expr) {
     Type *exprtype = resolve_expr_type(sema, expr);
-    Type default_type = tc_default_untyped_type(*exprtype);
+    TypeId default_type = tc_default_untyped_type(type_intern(exprtype));
 
     if (exprtype->kind == TkTypeDef) {
         symtab_find(sema, exprtype->typedeff, expr->cursors_idx);
     }
 
-    if (default_type.kind != TkNone) {
-        *lhs = default_type;
+    if (default_type != TkNone) {
+        *lhs = *type_canon(default_type);
     } else {
         *lhs = *exprtype;
     }
@@ -430,7 +481,7 @@ void tc_var_decl(Sema *sema, Stmnt *stmnt) {
             return;
         }
 
-        if (!tc_equals(sema, vardecl->type, exprtype)) {
+        if (!tc_equals(sema, type_intern(&vardecl->type), exprtype)) {
             strb t1 = string_from_type(vardecl->type);
             strb t2 = string_from_type(*exprtype);
             elog(sema, stmnt->cursors_idx, "mismatch types, variable \"%s\" type %s, expression type %s", vardecl->name.ident, t1, t2);
@@ -443,7 +494,14 @@ void tc_var_decl(Sema *sema, Stmnt *stmnt) {
         elog(sema, stmnt->cursors_idx, "cannot infer array length for \"%s\" without compound literal", vardecl->name.ident);
     }
 
-    tc_number_within_bounds(sema, vardecl->type, vardecl->value);
+    tc_number_within_bounds(sema, type_intern(&vardecl->type), &vardecl->value);
+}
+
+// children can be shared with the type of another declaration, they're copied before they're changed
+static Type *tc_constant_copy(Type *type) {
+    Type *copy = arena_alloc(&ast_arena, sizeof(Type)); *copy = *type;
+    tc_make_constant(copy);
+    return copy;
 }
 
 void tc_make_constant(Type *type) {
@@ -471,24 +529,32 @@ void tc_make_constant(Type *type) {
             type->constant = true;
             return;
         case TkRange:
-            tc_make_constant(type->range.subtype);
+            type->range.subtype = tc_constant_copy(type->range.subtype);
             type->constant = true;
+            type_reintern(type);
             return;
         case TkSlice:
-            tc_make_constant(type->slice.of);
+            type->slice.of = tc_constant_copy(type->slice.of);
             type->constant = true;
+            type_reintern(type);
             return;
         case TkArray:
-            tc_make_constant(type->array.of);
+            type->array.of = tc_constant_copy(type->array.of);
             type->constant = true;
+            type_reintern(type);
             return;
         case TkOption:
-            tc_make_constant(type->option.subtype);
+            type->option.subtype = tc_constant_copy(type->option.subtype);
+            type->constant = true;
+            type_reintern(type);
+            return;
+        case TkSoa:
             type->constant = true;
             return;
         case TkPtr:
             // don't make the underlying type constant
             type->constant = true;
+            type_reintern(type);
             return;
         case TkVoid:
         case TkUntypedInt:
@@ -509,7 +575,7 @@ void tc_const_decl(Sema *sema, Stmnt *stmnt) {
 
     if (constdecl->type.kind == TkNone) {
         tc_infer(sema, &constdecl->type, &constdecl->value);
-    } else if (!tc_equals(sema, constdecl->type, valtype)) {
+    } else if (!tc_equals(sema, type_intern(&constdecl->type), valtype)) {
         strb t1 = string_from_type(constdecl->type);
         strb t2 = string_from_type(*valtype);
         elog(sema, stmnt->cursors_idx, "mismatch types, variable \"%s\" type %s, expression type %s", constdecl->name.ident, t1, t2);
@@ -517,37 +583,34 @@ void tc_const_decl(Sema *sema, Stmnt *stmnt) {
     }
 
     tc_make_constant(&constdecl->type);
-    tc_number_within_bounds(sema, constdecl->type, constdecl->value);
+    tc_number_within_bounds(sema, type_intern(&constdecl->type), &constdecl->value);
 }
 
-void tc_number_within_bounds(Sema *sema, Type type, Expr expr) {
-    if (expr.kind == EkIntLit) {
-        switch (type.kind) {
+void tc_number_within_bounds(Sema *sema, TypeId type, Expr *expr) {
+    if (expr->kind == EkIntLit) {
+        switch (type_canon(type)->kind) {
             case TkF32: {
-                double value = expr.numlit;
+                double value = (double)expr->intlit;
                 if (value > F32_MAX || value < F32_MIN) {
-                    elog(sema, expr.cursors_idx, "literal \"%f\" cannot be represented in f32", value);
+                    elog(sema, expr->cursors_idx, "literal \"%f\" cannot be represented in f32", value);
                 }
             } break;
             case TkF64:
                 // no way to properly check here
                 break;
             case TkU8: {
-                uint64_t value = (uint64_t)expr.numlit;
-                if (value > U8_MAX) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in u8", value);
+                if (expr->intlit > U8_MAX) {
+                    elog(sema, expr->cursors_idx, "literal \"%lu\" cannot be represented in u8", expr->intlit);
                 }
             } break;
             case TkU16: {
-                uint64_t value = (uint64_t)expr.numlit;
-                if (value > U16_MAX) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in u16", value);
+                if (expr->intlit > U16_MAX) {
+                    elog(sema, expr->cursors_idx, "literal \"%lu\" cannot be represented in u16", expr->intlit);
                 }
             } break;
             case TkU32: {
-                uint64_t value = (uint64_t)expr.numlit;
-                if (value > U32_MAX) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in u32", value);
+                if (expr->intlit > U32_MAX) {
+                    elog(sema, expr->cursors_idx, "literal \"%lu\" cannot be represented in u32", expr->intlit);
                 }
             } break;
             case TkU64:
@@ -557,21 +620,21 @@ void tc_number_within_bounds(Sema *sema, Type type, Expr expr) {
                 // no way to properly check here
                 break;
             case TkI8: {
-                int64_t value = (int64_t)expr.numlit;
+                int64_t value = (int64_t)expr->intlit;
                 if (value > I8_MAX || value < I8_MIN) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in i8", value);
+                    elog(sema, expr->cursors_idx, "literal \"%zu\" cannot be represented in i8", value);
                 }
             } break;
             case TkI16: {
-                int64_t value = (int64_t)expr.numlit;
-                if (value > I16_MAX || value < I8_MIN) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in i16", value);
+                int64_t value = (int64_t)expr->intlit;
+                if (value > I16_MAX || value < I16_MIN) {
+                    elog(sema, expr->cursors_idx, "literal \"%zu\" cannot be represented in i16", value);
                 }
             } break;
             case TkI32: {
-                int64_t value = (int64_t)expr.numlit;
+                int64_t value = (int64_t)expr->intlit;
                 if (value > I32_MAX || value < I32_MIN) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in i32", value);
+                    elog(sema, expr->cursors_idx, "literal \"%zu\" cannot be represented in i32", value);
                 }
             } break;
             case TkI64:
@@ -583,24 +646,24 @@ void tc_number_within_bounds(Sema *sema, Type type, Expr expr) {
             default:
                 break;
         }
-    } else if (expr.kind == EkUnop && expr.unop.kind == UkNegate && expr.unop.val->kind == EkIntLit) {
-        switch (type.kind) {
+    } else if (expr->kind == EkUnop && expr->unop.kind == UkNegate && expr->unop.val->kind == EkIntLit) {
+        switch (type_canon(type)->kind) {
             case TkI8: {
-                int64_t value = (int64_t)expr.numlit;
+                int64_t value = -(int64_t)expr->unop.val->intlit;
                 if (value > I8_MAX || value < I8_MIN) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in i8", value);
+                    elog(sema, expr->cursors_idx, "literal \"%zu\" cannot be represented in i8", value);
                 }
             } break;
             case TkI16: {
-                int64_t value = (int64_t)expr.numlit;
+                int64_t value = -(int64_t)expr->unop.val->intlit;
                 if (value > I16_MAX || value < I16_MIN) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in i16", value);
+                    elog(sema, expr->cursors_idx, "literal \"%zu\" cannot be represented in i16", value);
                 }
             } break;
             case TkI32: {
-                int64_t value = (int64_t)expr.numlit;
+                int64_t value = -(int64_t)expr->unop.val->intlit;
                 if (value > I32_MAX || value < I32_MIN) {
-                    elog(sema, expr.cursors_idx, "literal \"%zu\" cannot be represented in i32", value);
+                    elog(sema, expr->cursors_idx, "literal \"%zu\" cannot be represented in i32", value);
                 }
             } break;
             case TkI64:
@@ -615,8 +678,8 @@ void tc_number_within_bounds(Sema *sema, Type type, Expr expr) {
     }
 }
 
-bool tc_is_unsigned(Sema *sema, Expr expr) {
-    Type *type = resolve_expr_type(sema, &expr);
+bool tc_is_unsigned(Sema *sema, Expr *expr) {
+    Type *type = resolve_expr_type(sema, expr);
 
     switch (type->kind) {
         case TkU8:
@@ -639,21 +702,21 @@ bool tc_is_unsigned(Sema *sema, Expr expr) {
             return false;
         default: {
             strb t = string_from_type(*type);
-            elog(sema, expr.cursors_idx, "expected an integer type, got %s", t);
+            elog(sema, expr->cursors_idx, "expected an integer type, got %s", t);
             strbfree(t);
             return false;
         }
     }
 }
 
-bool tc_can_arithmetic(Type lhs, Type rhs, bool ints_only) {
-    switch (lhs.kind) {
+bool tc_can_arithmetic(TypeId lhs, TypeId rhs, bool ints_only) {
+    switch (type_canon(lhs)->kind) {
         case TkI8:
         case TkI16:
         case TkI32:
         case TkI64:
         case TkIsize:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkI8:
                 case TkI16:
                 case TkI32:
@@ -669,7 +732,7 @@ bool tc_can_arithmetic(Type lhs, Type rhs, bool ints_only) {
         case TkU32:
         case TkU64:
         case TkUsize:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkU8:
                 case TkU16:
                 case TkU32:
@@ -681,7 +744,7 @@ bool tc_can_arithmetic(Type lhs, Type rhs, bool ints_only) {
                     return false;
             }
         case TkUntypedInt:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkU8:
                 case TkU16:
                 case TkU32:
@@ -701,7 +764,7 @@ bool tc_can_arithmetic(Type lhs, Type rhs, bool ints_only) {
         case TkF64:
         case TkUntypedFloat:
             if (ints_only) return false;
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkF32:
                 case TkF64:
                 case TkUntypedFloat:
@@ -714,10 +777,10 @@ bool tc_can_arithmetic(Type lhs, Type rhs, bool ints_only) {
     }
 }
 
-bool tc_can_compare_equality(Type lhs, Type rhs) {
-    switch (lhs.kind) {
+bool tc_can_compare_equality(TypeId lhs, TypeId rhs) {
+    switch (type_canon(lhs)->kind) {
         case TkBool:
-            if (rhs.kind == TkBool) {
+            if (type_canon(rhs)->kind == TkBool) {
                 return true;
             }
             return false;
@@ -726,7 +789,7 @@ bool tc_can_compare_equality(Type lhs, Type rhs) {
         case TkI32:
         case TkI64:
         case TkIsize:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkI8:
                 case TkI16:
                 case TkI32:
@@ -742,7 +805,7 @@ bool tc_can_compare_equality(Type lhs, Type rhs) {
         case TkU32:
         case TkU64:
         case TkUsize:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkU8:
                 case TkU16:
                 case TkU32:
@@ -754,7 +817,7 @@ bool tc_can_compare_equality(Type lhs, Type rhs) {
                     return false;
             }
         case TkUntypedInt:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkU8:
                 case TkU16:
                 case TkU32:
@@ -773,7 +836,7 @@ bool tc_can_compare_equality(Type lhs, Type rhs) {
         case TkF32:
         case TkF64:
         case TkUntypedFloat:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkF32:
                 case TkF64:
                 case TkUntypedFloat:
@@ -786,14 +849,14 @@ bool tc_can_compare_equality(Type lhs, Type rhs) {
     }
 }
 
-bool tc_can_compare_order(Type lhs, Type rhs) {
-    switch (lhs.kind) {
+bool tc_can_compare_order(TypeId lhs, TypeId rhs) {
+    switch (type_canon(lhs)->kind) {
         case TkI8:
         case TkI16:
         case TkI32:
         case TkI64:
         case TkIsize:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkI8:
                 case TkI16:
                 case TkI32:
@@ -808,7 +871,7 @@ bool tc_can_compare_order(Type lhs, Type rhs) {
         case TkU32:
         case TkU64:
         case TkUsize:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkU8:
                 case TkU16:
                 case TkU32:
@@ -819,7 +882,7 @@ bool tc_can_compare_order(Type lhs, Type rhs) {
                     return false;
             }
         case TkUntypedInt:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkI8:
                 case TkI16:
                 case TkI32:
@@ -838,7 +901,7 @@ bool tc_can_compare_order(Type lhs, Type rhs) {
         case TkF32:
         case TkF64:
         case TkUntypedFloat:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkF32:
                 case TkF64:
                 case TkUntypedFloat:
@@ -851,8 +914,8 @@ bool tc_can_compare_order(Type lhs, Type rhs) {
     }
 }
 
-bool tc_can_bitwise(Type lhs, Type rhs) {
-    switch (lhs.kind) {
+bool tc_can_bitwise(TypeId lhs, TypeId rhs) {
+    switch (type_canon(lhs)->kind) {
         case TkI8:
         case TkU8:
         case TkI16:
@@ -864,7 +927,7 @@ bool tc_can_bitwise(Type lhs, Type rhs) {
         case TkIsize:
         case TkUsize:
         case TkUntypedInt:
-            switch (rhs.kind) {
+            switch (type_canon(rhs)->kind) {
                 case TkI8:
                 case TkU8:
                 case TkI16:
@@ -885,32 +948,33 @@ bool tc_can_bitwise(Type lhs, Type rhs) {
     }
 }
 
-bool tc_can_cast_ptr(Type *from, Type to) {
-    if (to.kind == TkPtr && from->kind == TkPtr) {
-        if (from->constant && !to.constant) return false;
+bool tc_can_cast_ptr(Type *from, TypeId to) {
+    const Type *t = type_canon(to);
+    if (t->kind == TkPtr && from->kind == TkPtr) {
+        if (from->constant && !t->constant) return false;
         
-        if (to.ptr_to->kind == TkVoid && from->ptr_to->kind != TkPtr) {
+        if (t->ptr_to->kind == TkVoid && from->ptr_to->kind != TkPtr) {
             return true;
         } else if (from->ptr_to->kind == TkVoid && from->ptr_to->kind != TkPtr) {
             return true;
         }
 
-        if (!from->constant && !to.constant) return tc_can_cast_ptr(from->ptr_to, *to.ptr_to);
-        if (to.constant) return tc_can_cast_ptr(from->ptr_to, *to.ptr_to);
+        if (!from->constant && !t->constant) return tc_can_cast_ptr(from->ptr_to, t->ptr_to->id);
+        if (t->constant) return tc_can_cast_ptr(from->ptr_to, t->ptr_to->id);
     }
-    if (to.kind == TkPtr && to.ptr_to->kind == TkVoid) {
+    if (t->kind == TkPtr && t->ptr_to->kind == TkVoid) {
         return true;
     }
 
     return false;
 }
 
-bool tc_can_cast(Sema *sema, Type *from, Type to) {
+bool tc_can_cast(Sema *sema, Type *from, TypeId to) {
     if (tc_equals(sema, to, from)) {
         return true;
     }
 
-    switch (to.kind) {
+    switch (type_canon(to)->kind) {
         case TkPtr:
             return tc_can_cast_ptr(from, to);
         case TkI8:
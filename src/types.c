@@ -1,9 +1,13 @@
 #include <assert.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 #include "include/strb.h"
 #include "include/utils.h"
 #include "include/types.h"
 #include "include/exprs.h"
+#include "include/stb_ds.h"
 
 Type type_none(void) {
     return (Type){.kind = TkNone};
@@ -66,57 +70,80 @@ Type type_decimal(TypeKind kind, CONSTNESS constant, size_t index) {
 }
 
 Type type_range(Range v, CONSTNESS constant, size_t index) {
-    return (Type){
+    Type type = {
         .kind = TkRange,
         .constant = constant,
         .cursors_idx = index,
         .range = v,
     };
+    type.id = type_cache_id(&type);
+    return type;
 }
 
 Type type_slice(Slice v, CONSTNESS constant, size_t index) {
-    return (Type){
+    Type type = {
         .kind = TkSlice,
         .constant = constant,
         .cursors_idx = index,
         .slice = v,
     };
+    type.id = type_cache_id(&type);
+    return type;
 }
 
 Type type_array(Array v, CONSTNESS constant, size_t index) {
-    return (Type){
+    Type type = {
         .kind = TkArray,
         .constant = constant,
         .cursors_idx = index,
         .array = v,
     };
+    type.id = type_cache_id(&type);
+    return type;
 }
 
 Type type_ptr(Type *v, CONSTNESS constant, size_t index) {
-    return (Type){
+    Type type = {
         .kind = TkPtr,
         .constant = constant,
         .cursors_idx = index,
         .ptr_to = v,
     };
+    type.id = type_cache_id(&type);
+    return type;
 }
 
 Type type_option(Option v, CONSTNESS constant, size_t index) {
-    return (Type){
+    Type type = {
         .kind = TkOption,
         .constant = constant,
         .cursors_idx = index,
         .option = v,
     };
+    type.id = type_cache_id(&type);
+    return type;
+}
+
+Type type_soa(Soa v, CONSTNESS constant, size_t index) {
+    Type type = {
+        .kind = TkSoa,
+        .constant = constant,
+        .cursors_idx = index,
+        .soa = v,
+    };
+    type.id = type_cache_id(&type);
+    return type;
 }
 
 Type type_typedef(const char *v, CONSTNESS constant, size_t index) {
-    return (Type){
+    Type type = {
         .kind = TkTypeDef,
         .constant = constant,
         .cursors_idx = index,
         .typedeff = v,
     };
+    type.id = type_cache_id(&type);
+    return type;
 }
 
 Type type_poison(void) {
@@ -180,7 +207,7 @@ strb string_from_type(Type t) {
 
         case TkPtr: {
             strb sub = string_from_type(*t.ptr_to);
-            strbprintf(&ret, "*%s", sub);
+            strbprintf(&ret, t.constant ? "^%s" : "*%s", sub);
         } break;
         case TkRange: {
             strb sub = string_from_type(*t.range.subtype);
@@ -193,7 +220,7 @@ strb string_from_type(Type t) {
         } break;
         case TkArray: {
             strb sub = string_from_type(*t.array.of);
-            strbprintf(&ret, "[%" PRIu64 "]%s", (uint64_t)t.array.len->numlit, sub);
+            strbprintf(&ret, "[%" PRIu64 "]%s", t.array.len->intlit, sub);
             strbfree(sub);
         } break;
         case TkOption: {
@@ -201,6 +228,11 @@ strb string_from_type(Type t) {
             strbprintf(&ret, "?%s", sub);
             strbfree(sub);
         } break;
+        case TkSoa: {
+            strb sub = string_from_type(*t.soa.of);
+            strbprintf(&ret, "#soa %s", sub);
+            strbfree(sub);
+        } break;
 
         case TkTypeId:
             strbprintf(&ret, "typeid");
@@ -269,3 +301,229 @@ strb string_from_type(Type t) {
 
     return ret;
 }
+
+// entries are kept in fixed size chunks so they never move and can be read without the lock
+// ids are only handed out once their entry is written, through the lock or a Type built after it
+#define TYPE_CHUNK_BITS 10
+#define TYPE_CHUNK_LEN ((size_t)1 << TYPE_CHUNK_BITS)
+#define TYPE_CHUNKS 4096
+static TypeInfo **type_chunks[TYPE_CHUNKS];
+
+// scalars never go through the lock, their id is their kind
+// the slots of compound kinds are never handed out
+#define TYPE_FIXED ((size_t)TkPoison + 1)
+#define TYPE_SCALAR(k) [k] = {.type = {.kind = k, .id = k}, .leaf = k, .settled = true}
+static TypeInfo type_fixed[TYPE_FIXED] = {
+    [TkNone] = {.type = {.kind = TkNone}},
+    TYPE_SCALAR(TkVoid), TYPE_SCALAR(TkBool),
+    TYPE_SCALAR(TkChar), TYPE_SCALAR(TkString), TYPE_SCALAR(TkCstring),
+    TYPE_SCALAR(TkI8), TYPE_SCALAR(TkI16), TYPE_SCALAR(TkI32), TYPE_SCALAR(TkI64), TYPE_SCALAR(TkIsize),
+    TYPE_SCALAR(TkU8), TYPE_SCALAR(TkU16), TYPE_SCALAR(TkU32), TYPE_SCALAR(TkU64), TYPE_SCALAR(TkUsize),
+    TYPE_SCALAR(TkF32), TYPE_SCALAR(TkF64),
+    [TkUntypedInt] = {.type = {.kind = TkUntypedInt, .id = TkUntypedInt}, .leaf = TkUntypedInt},
+    [TkUntypedFloat] = {.type = {.kind = TkUntypedFloat, .id = TkUntypedFloat}, .leaf = TkUntypedFloat},
+    TYPE_SCALAR(TkTypeId),
+    [TkPoison] = {.type = {.kind = TkPoison, .id = TkPoison}, .leaf = TkPoison},
+};
+static _Atomic size_t type_count = TYPE_FIXED;
+
+// open addressing over ids, 0 is an empty slot
+static TypeId *type_slots = NULL;
+static size_t type_slots_cap = 0;
+static pthread_mutex_t type_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static TypeInfo *type_entry(TypeId id) {
+    if (id < TYPE_FIXED) return &type_fixed[id];
+    return type_chunks[id >> TYPE_CHUNK_BITS][id & (TYPE_CHUNK_LEN - 1)];
+}
+
+static bool type_is_compound(TypeKind kind) {
+    switch (kind) {
+        case TkRange:
+        case TkSlice:
+        case TkArray:
+        case TkPtr:
+        case TkOption:
+        case TkSoa:
+        case TkTypeDef:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// bumped whenever a struct's field order changes, cached layouts are recomputed after
+_Atomic uint64_t type_layout_epoch = 1;
+
+static uint64_t type_hash_mix(uint64_t hash, uint64_t v) {
+    // fnv-1a over the bytes of v
+    for (size_t b = 0; b < 8; b++) {
+        hash ^= (v >> (b * 8)) & 0xff;
+        hash *= UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+static bool type_info_equals(TypeInfo *info, const Type *type, bool constant, TypeId of, uint64_t len, Expr *len_expr, const char *name) {
+    if (info->type.kind != type->kind || info->of != of || info->len != len || info->len_expr != len_expr) return false;
+    if (type->kind == TkPtr && info->type.constant != constant) return false;
+    if (type->kind == TkOption && info->type.option.is_null != type->option.is_null) return false;
+    if (type->kind == TkTypeDef) return info->type.typedeff == name || streq(info->type.typedeff, name);
+    return true;
+}
+
+static void type_slots_grow(void) {
+    size_t cap = type_slots_cap == 0 ? 256 : type_slots_cap * 2;
+    TypeId *slots = ealloc(sizeof(TypeId) * cap);
+    memset(slots, 0, sizeof(TypeId) * cap);
+
+    for (size_t i = TYPE_FIXED; i < type_count; i++) {
+        size_t slot = type_entry((TypeId)i)->hash & (cap - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (cap - 1);
+        slots[slot] = (TypeId)i;
+    }
+
+    free(type_slots);
+    type_slots = slots;
+    type_slots_cap = cap;
+}
+
+static TypeId type_intern_locked(const Type *type) {
+    if (type->id != 0) return type->id;
+    if (!type_is_compound(type->kind)) return (TypeId)type->kind;
+
+    TypeId of = 0;
+    uint64_t len = 0;
+    Expr *len_expr = NULL;
+    const char *name = NULL;
+
+    switch (type->kind) {
+        case TkPtr:
+            of = type_intern_locked(type->ptr_to);
+            break;
+        case TkArray:
+            if (type->array.len != NULL && type->array.len->kind == EkIntLit) {
+                len = type->array.len->intlit;
+            } else {
+                len_expr = type->array.len;
+            }
+            of = type_intern_locked(type->array.of);
+            break;
+        case TkSlice:
+            of = type_intern_locked(type->slice.of);
+            break;
+        case TkOption:
+            of = type_intern_locked(type->option.subtype);
+            break;
+        case TkSoa:
+            of = type_intern_locked(type->soa.of);
+            break;
+        case TkRange:
+            of = type_intern_locked(type->range.subtype);
+            break;
+        case TkTypeDef:
+            name = type->typedeff;
+            break;
+        default:
+            break;
+    }
+
+    // constness only changes the type of a pointer, anything else can be assigned to either
+    bool constant = type->kind == TkPtr && type->constant;
+    bool is_null = type->kind == TkOption && type->option.is_null;
+
+    uint64_t hash = UINT64_C(14695981039346656037);
+    hash = type_hash_mix(hash, type->kind);
+    hash = type_hash_mix(hash, constant);
+    hash = type_hash_mix(hash, is_null);
+    hash = type_hash_mix(hash, of);
+    hash = type_hash_mix(hash, len);
+    hash = type_hash_mix(hash, (uintptr_t)len_expr);
+    for (const char *c = name; c != NULL && *c != '\0'; c++) {
+        hash = (hash ^ (uint8_t)*c) * UINT64_C(1099511628211);
+    }
+
+    if (type_count * 2 >= type_slots_cap) type_slots_grow();
+
+    size_t slot = hash & (type_slots_cap - 1);
+    for (; type_slots[slot] != 0; slot = (slot + 1) & (type_slots_cap - 1)) {
+        TypeInfo *info = type_entry(type_slots[slot]);
+        if (info->hash == hash && type_info_equals(info, type, constant, of, len, len_expr, name)) {
+            return type_slots[slot];
+        }
+    }
+
+    TypeId id = (TypeId)type_count;
+    if (id >> TYPE_CHUNK_BITS >= TYPE_CHUNKS) {
+        eprintfln("ERROR: more than %zu distinct types", TYPE_CHUNKS * TYPE_CHUNK_LEN);
+        exit(1);
+    }
+
+    bool has_of = type->kind != TkTypeDef;
+    TypeInfo *info = ealloc(sizeof(TypeInfo));
+    *info = (TypeInfo){
+        .type = (Type){.kind = type->kind, .cursors_idx = type->cursors_idx, .constant = constant, .id = id},
+        .hash = hash,
+        .of = of,
+        .leaf = has_of ? type_entry(of)->leaf : id,
+        .len = len,
+        .len_expr = len_expr,
+        .settled = (!has_of || type_entry(of)->settled) && len_expr == NULL && !is_null,
+    };
+
+    Type *of_type = has_of ? &type_entry(of)->type : NULL;
+    switch (type->kind) {
+        case TkPtr: info->type.ptr_to = of_type; break;
+        case TkArray: info->type.array = (Array){.of = of_type, .len = type->array.len}; break;
+        case TkSlice: info->type.slice.of = of_type; break;
+        case TkOption: info->type.option = (Option){.subtype = of_type, .is_null = is_null}; break;
+        case TkSoa: info->type.soa.of = of_type; break;
+        case TkRange: info->type.range.subtype = of_type; break;
+        case TkTypeDef: info->type.typedeff = name; break;
+        default: break;
+    }
+
+    TypeInfo **chunk = type_chunks[id >> TYPE_CHUNK_BITS];
+    if (chunk == NULL) {
+        chunk = ealloc(sizeof(TypeInfo*) * TYPE_CHUNK_LEN);
+        type_chunks[id >> TYPE_CHUNK_BITS] = chunk;
+    }
+    chunk[id & (TYPE_CHUNK_LEN - 1)] = info;
+    type_count = id + 1;
+    type_slots[slot] = id;
+    return id;
+}
+
+TypeId type_intern(const Type *type) {
+    // built by a constructor, interned already, or a scalar
+    if (type->id != 0) return type->id;
+    if (!type_is_compound(type->kind)) return (TypeId)type->kind;
+
+    pthread_mutex_lock(&type_lock);
+    TypeId id = type_intern_locked(type);
+    pthread_mutex_unlock(&type_lock);
+    return id;
+}
+
+TypeId type_cache_id(const Type *type) {
+    TypeId id = type_intern(type);
+    return type_entry(id)->settled ? id : 0;
+}
+
+void type_reintern(Type *type) {
+    type->id = 0;
+    type->id = type_is_compound(type->kind) ? type_cache_id(type) : 0;
+}
+
+TypeInfo *type_info(TypeId id) {
+    assert(id < type_count);
+    return type_entry(id);
+}
+
+const Type *type_canon(TypeId id) {
+    return &type_info(id)->type;
+}
+
+size_t type_table_len(void) {
+    return type_count - TYPE_FIXED;
+}
@@ -165,12 +165,17 @@ bool parse_u64(const char *str, uint64_t *n) {
     }
 
     size_t index = 0;
-    for (size_t i = 0; i < strlen(str); i++) {
+    for (size_t i = str_head; i < strlen(str); i++) {
         if (str[i] == '_') {
             index += 1;
             continue;
         }
         uint64_t v = str[i] - '0';
+        if (str[i] >= 'a' && str[i] <= 'f') {
+            v = str[i] - 'a' + 10;
+        } else if (str[i] >= 'A' && str[i] <= 'F') {
+            v = str[i] - 'A' + 10;
+        }
         if (v >= base) {
             break;
         }
@@ -237,6 +242,16 @@ bool strstartswith(const char *hay, const char *needle) {
     return true;
 }
 
+bool strendswith(const char *hay, const char *needle) {
+    size_t hay_len = strlen(hay);
+    size_t needle_len = strlen(needle);
+    if (hay_len < needle_len) {
+        return false;
+    }
+
+    return streq(hay + hay_len - needle_len, needle);
+}
+
 // from and to must be of the same size
 bool strreplace(char *s, const char *from, const char *to) {
     if (strlen(from) != strlen(to)) {
@@ -0,0 +1,1336 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/eval.h"
+#include "include/exprs.h"
+#include "include/layout.h"
+#include "include/sema.h"
+#include "include/stb_ds.h"
+#include "include/stmnts.h"
+#include "include/strb.h"
+#include "include/types.h"
+#include "include/utils.h"
+#include "include/vm.h"
+
+// a runaway loop or recursion shouldn't hang the compiler
+#define VM_MAX_STEPS 50000000
+#define VM_MAX_CELLS (1 << 22)
+#define VM_MAX_DEPTH 1024
+#define VM_MAX_MEMO (1 << 16)
+// power of two, twice VM_MAX_MEMO so probes stay short
+#define VM_MEMO_TABLE (VM_MAX_MEMO * 2)
+// addresses with this bit set point into constants materialised from the source
+#define VM_STATIC_BIT (UINT64_C(1) << 62)
+
+// every value is one cell, the bits of a ConstValue
+// arrays are laid out flat and passed around by address
+typedef enum OpCode {
+    OpPush, // consts[a]
+    OpLoad, // frame[a]
+    OpStore, // frame[a] = pop
+    OpAddr, // address of frame[a]
+    OpLoadAt, // *pop
+    OpStoreAt, // value = pop, *pop = value
+    OpIndex, // index = pop, pop + index * b, index must be less than a
+    OpCopy, // src = pop, copies a cells to pop
+    OpZero, // zeroes a cells from frame[b]
+    OpBinop,
+    OpUnop,
+    OpConvert, // lhs to rhs
+    OpJump,
+    OpJumpIfFalse,
+    OpCall, // fns[a]
+    OpReturn,
+    OpPop,
+    OpTrap, // fell off the end of a function that returns a value
+} OpCode;
+
+typedef struct Op {
+    uint8_t code;
+    uint8_t sub; // BinopKind or UnopKind
+    uint8_t lhs; // TypeKind of the operands
+    uint8_t rhs;
+    uint32_t a;
+    uint32_t b;
+} Op;
+
+typedef struct VmParam {
+    size_t slot;
+    size_t cells;
+    bool array;
+} VmParam;
+
+typedef struct VmFn {
+    const char *name;
+    Stmnt decl; // SkNone for the entry
+    Arr(Op) code;
+    Arr(size_t) cursors; // one per op
+    Arr(uint64_t) consts;
+    Arr(VmParam) params;
+    size_t slots;
+    size_t args_cells; // hidden result address and arguments
+    bool ret_array;
+    bool compiled;
+} VmFn;
+
+typedef struct VmFrame {
+    size_t fn;
+    size_t pc;
+    size_t fp;
+    size_t key; // offset into keys
+    uint64_t hash;
+} VmFrame;
+
+typedef struct VmMemo {
+    size_t fn;
+    uint64_t hash;
+    size_t key; // offset into memo_cells
+    size_t key_len;
+    size_t result; // offset into memo_cells
+    size_t result_len;
+} VmMemo;
+
+typedef struct VmStatic {
+    const char *name;
+    uint64_t addr;
+} VmStatic;
+
+typedef struct Vm {
+    Arr(VmFn) fns; // 0 is the entry, recompiled for every call
+    Arr(uint64_t) statics;
+    Arr(VmStatic) static_names;
+
+    Arr(VmMemo) memos;
+    Arr(uint64_t) memo_cells;
+    uint32_t *memo_table; // index + 1 into memos, 0 if empty
+
+    // reset for every call
+    Arr(uint64_t) memory;
+    Arr(uint64_t) stack;
+    Arr(VmFrame) frames;
+    Arr(uint64_t) keys;
+
+    strb why;
+    size_t why_cursor;
+} Vm;
+
+typedef struct VmLocal {
+    const char *name;
+    size_t slot;
+    Type type;
+} VmLocal;
+
+typedef struct VmCompiler {
+    Sema *sema;
+    Vm *vm;
+    size_t fn;
+    Type ret;
+    Arr(VmLocal) locals;
+    size_t slots;
+    Arr(size_t) breaks;
+    Arr(size_t) continues;
+} VmCompiler;
+
+static bool vm_expr(VmCompiler *c, Expr *expr, Type *out);
+static bool vm_block(VmCompiler *c, Arr(Stmnt) body);
+
+// only keeps the first reason, the rest are a consequence of it
+static bool vm_fail(Vm *vm, size_t cursor_idx, const char *fmt, ...) {
+    if (vm->why != NULL) return false;
+
+    va_list args;
+    va_start(args, fmt);
+    vstrbprintf(&vm->why, fmt, args);
+    va_end(args);
+
+    vm->why_cursor = cursor_idx;
+    return false;
+}
+
+static bool is_float(Type type) {
+    return type.kind == TkF32 || type.kind == TkF64 || type.kind == TkUntypedFloat;
+}
+
+static size_t vm_cells(Type type) {
+    if (type.kind != TkArray) return 1;
+    return (size_t)type.array.len->intlit * vm_cells(*type.array.of);
+}
+
+static bool vm_check_type(VmCompiler *c, Type type, size_t cursor_idx) {
+    switch (type.kind) {
+        case TkBool:
+        case TkChar:
+        case TkI8:
+        case TkI16:
+        case TkI32:
+        case TkI64:
+        case TkIsize:
+        case TkU8:
+        case TkU16:
+        case TkU32:
+        case TkU64:
+        case TkUsize:
+        case TkF32:
+        case TkF64:
+        case TkUntypedInt:
+        case TkUntypedFloat:
+            return true;
+        case TkTypeDef:
+            if (ast_find_decl(c->sema->ast, type.typedeff).kind == SkEnumDecl) return true;
+            return vm_fail(c->vm, cursor_idx, "\"%s\" is not an enum, only numbers, bools, chars, enums and arrays of them can be used", type.typedeff);
+        case TkArray:
+            if (type.array.len == NULL || type.array.len->kind != EkIntLit) {
+                return vm_fail(c->vm, cursor_idx, "array length is not known");
+            }
+            if (!vm_check_type(c, *type.array.of, cursor_idx)) return false;
+            if (type.array.len->intlit > (uint64_t)VM_MAX_CELLS / vm_cells(*type.array.of)) {
+                return vm_fail(c->vm, cursor_idx, "array is larger than %d cells", VM_MAX_CELLS);
+            }
+            return true;
+        default: {
+            strb t = string_from_type(type);
+            vm_fail(c->vm, cursor_idx, "%s can't be used, only numbers, bools, chars, enums and arrays of them can be used", t);
+            strbfree(t);
+            return false;
+        }
+    }
+}
+
+static uint64_t *vm_at(Vm *vm, uint64_t addr) {
+    if (addr & VM_STATIC_BIT) {
+        addr &= ~VM_STATIC_BIT;
+        assert(addr < arrlenu(vm->statics));
+        return &vm->statics[addr];
+    }
+
+    assert(addr < arrlenu(vm->memory));
+    return &vm->memory[addr];
+}
+
+static size_t vm_emit(VmCompiler *c, Op op, size_t cursor_idx) {
+    VmFn *fn = &c->vm->fns[c->fn];
+    arrpush(fn->code, op);
+    arrpush(fn->cursors, cursor_idx);
+    return arrlenu(fn->code) - 1;
+}
+
+static size_t vm_here(VmCompiler *c) {
+    return arrlenu(c->vm->fns[c->fn].code);
+}
+
+static void vm_patch(VmCompiler *c, size_t at, size_t to) {
+    c->vm->fns[c->fn].code[at].a = (uint32_t)to;
+}
+
+static size_t vm_alloc(VmCompiler *c, size_t cells) {
+    size_t slot = c->slots;
+    c->slots += cells;
+    return slot;
+}
+
+static void vm_push_const(VmCompiler *c, uint64_t bits, size_t cursor_idx) {
+    VmFn *fn = &c->vm->fns[c->fn];
+    arrpush(fn->consts, bits);
+    vm_emit(c, (Op){.code = OpPush, .a = (uint32_t)(arrlenu(fn->consts) - 1)}, cursor_idx);
+}
+
+static void vm_convert(VmCompiler *c, Type from, Type to, size_t cursor_idx) {
+    if (to.kind == TkNone || from.kind == to.kind) return;
+    vm_emit(c, (Op){.code = OpConvert, .lhs = from.kind, .rhs = to.kind}, cursor_idx);
+}
+
+static VmLocal *vm_find_local(VmCompiler *c, const char *name) {
+    for (size_t i = arrlenu(c->locals); i > 0; i--) {
+        if (streq(c->locals[i - 1].name, name)) return &c->locals[i - 1];
+    }
+    return NULL;
+}
+
+static bool vm_static_fill(VmCompiler *c, Type type, Expr *value, size_t at) {
+    if (type.kind == TkArray) {
+        if (value->kind == EkNone) return true;
+        if (value->kind != EkLiteral || value->literal.kind != LitkExprs) {
+            return vm_fail(c->vm, value->cursors_idx, "array constant must be a literal");
+        }
+
+        size_t step = vm_cells(*type.array.of);
+        for (size_t i = 0; i < arrlenu(value->literal.exprs); i++) {
+            if (!vm_static_fill(c, *type.array.of, &value->literal.exprs[i], at + i * step)) return false;
+        }
+        return true;
+    }
+
+    ConstValue v;
+    if (!eval_value(c->sema, value, &v) || !eval_convert(v, type, &v)) {
+        return vm_fail(c->vm, value->cursors_idx, "value is not known at compile time");
+    }
+    c->vm->statics[at] = v.u;
+    return true;
+}
+
+// global array constants are copied in once and shared by every call
+static bool vm_static(VmCompiler *c, ConstDecl constdecl, uint64_t *addr) {
+    Vm *vm = c->vm;
+    for (size_t i = 0; i < arrlenu(vm->static_names); i++) {
+        if (streq(vm->static_names[i].name, constdecl.name.ident)) {
+            *addr = vm->static_names[i].addr;
+            return true;
+        }
+    }
+
+    size_t at = arrlenu(vm->statics);
+    size_t cells = vm_cells(constdecl.type);
+    if (at + cells > VM_MAX_CELLS) {
+        return vm_fail(vm, constdecl.name.cursors_idx, "constants use more than %d cells", VM_MAX_CELLS);
+    }
+
+    arrsetlen(vm->statics, at + cells);
+    // a constant with no cells leaves statics NULL
+    if (cells > 0) memset(&vm->statics[at], 0, cells * sizeof(uint64_t));
+    if (!vm_static_fill(c, constdecl.type, &constdecl.value, at)) {
+        arrsetlen(vm->statics, at);
+        return false;
+    }
+
+    *addr = at | VM_STATIC_BIT;
+    arrpush(vm->static_names, ((VmStatic){.name = constdecl.name.ident, .addr = *addr}));
+    return true;
+}
+
+static bool vm_fn_index(Sema *sema, Vm *vm, const char *name, size_t cursor_idx, size_t *out) {
+    for (size_t i = 1; i < arrlenu(vm->fns); i++) {
+        if (streq(vm->fns[i].name, name)) {
+            *out = i;
+            return true;
+        }
+    }
+
+    Stmnt decl = ast_find_decl(sema->ast, name);
+    if (decl.kind != SkFnDecl) {
+        return vm_fail(vm, cursor_idx, "expected \"%s\" to be a function", name);
+    }
+    if (!decl.fndecl.has_body) {
+        return vm_fail(vm, cursor_idx, "\"%s\" has no body, it can't be called at compile time", name);
+    }
+
+    arrpush(vm->fns, ((VmFn){
+        .name = name,
+        .decl = decl,
+    }));
+    *out = arrlenu(vm->fns) - 1;
+    return true;
+}
+
+// leaves the address of the element on the stack
+static bool vm_index(VmCompiler *c, Expr *expr, Type *out) {
+    assert(expr->kind == EkArrayIndex);
+
+    Type accessing;
+    if (!vm_expr(c, expr->arrayidx.accessing, &accessing)) return false;
+    if (accessing.kind != TkArray) {
+        strb t = string_from_type(accessing);
+        vm_fail(c->vm, expr->cursors_idx, "%s can't be indexed at compile time", t);
+        strbfree(t);
+        return false;
+    }
+
+    Type index;
+    if (!vm_expr(c, expr->arrayidx.index, &index)) return false;
+    // negative indices wrap around and fail the bounds check
+    vm_convert(c, index, type_integer(TkU64, TYPEVAR, 0), expr->cursors_idx);
+
+    Type of = *accessing.array.of;
+    vm_emit(c, (Op){
+        .code = OpIndex,
+        .a = (uint32_t)accessing.array.len->intlit,
+        .b = (uint32_t)vm_cells(of),
+    }, expr->cursors_idx);
+
+    *out = of;
+    return true;
+}
+
+static bool vm_logical(VmCompiler *c, Expr *expr, Type *out) {
+    Type lhs, rhs;
+    if (!vm_expr(c, expr->binop.left, &lhs)) return false;
+
+    if (expr->binop.kind == BkAnd) {
+        // lhs && rhs, false without evaluating rhs
+        size_t skip = vm_emit(c, (Op){.code = OpJumpIfFalse}, expr->cursors_idx);
+        if (!vm_expr(c, expr->binop.right, &rhs)) return false;
+        size_t end = vm_emit(c, (Op){.code = OpJump}, expr->cursors_idx);
+
+        vm_patch(c, skip, vm_here(c));
+        vm_push_const(c, 0, expr->cursors_idx);
+        vm_patch(c, end, vm_here(c));
+    } else {
+        // lhs || rhs, true without evaluating rhs
+        size_t other = vm_emit(c, (Op){.code = OpJumpIfFalse}, expr->cursors_idx);
+        vm_push_const(c, 1, expr->cursors_idx);
+        size_t end = vm_emit(c, (Op){.code = OpJump}, expr->cursors_idx);
+
+        vm_patch(c, other, vm_here(c));
+        if (!vm_expr(c, expr->binop.right, &rhs)) return false;
+        vm_patch(c, end, vm_here(c));
+    }
+
+    *out = type_bool(TYPEVAR, 0);
+    return true;
+}
+
+static bool vm_sizeof(VmCompiler *c, Expr *expr, Type *out) {
+    Expr *of = expr->unop.val->kind == EkGrouping ? expr->unop.val->group : expr->unop.val;
+
+    ConstValue size = {.type = type_integer(TkUsize, TYPEVAR, 0)};
+    VmLocal *local = of->kind == EkIdent ? vm_find_local(c, of->ident) : NULL;
+
+    if (local != NULL) {
+        size.u = layout_sizeof(c->sema->ast, local->type);
+    } else if (!eval_value(c->sema, expr, &size)) {
+        return vm_fail(c->vm, expr->cursors_idx, "size is not known at compile time");
+    }
+
+    vm_push_const(c, size.u, expr->cursors_idx);
+    *out = size.type;
+    return true;
+}
+
+static bool vm_unop(VmCompiler *c, Expr *expr, Type *out) {
+    assert(expr->kind == EkUnop);
+
+    switch (expr->unop.kind) {
+        case UkSizeof:
+            return vm_sizeof(c, expr, out);
+        case UkAddress:
+            return vm_fail(c->vm, expr->cursors_idx, "pointers can't be used at compile time");
+        case UkCast: {
+            Type val;
+            if (!vm_expr(c, expr->unop.val, &val)) return false;
+            if (!vm_check_type(c, expr->type, expr->cursors_idx)) return false;
+            if (val.kind == TkArray || expr->type.kind == TkArray) {
+                return vm_fail(c->vm, expr->cursors_idx, "arrays can't be cast");
+            }
+
+            vm_convert(c, val, expr->type, expr->cursors_idx);
+            *out = expr->type;
+            return true;
+        }
+        case UkNot:
+        case UkNegate:
+        case UkBitNot: {
+            Type val;
+            if (!vm_expr(c, expr->unop.val, &val)) return false;
+
+            vm_emit(c, (Op){.code = OpUnop, .sub = expr->unop.kind, .lhs = val.kind}, expr->cursors_idx);
+            *out = eval_unop_type(expr->unop.kind, val);
+            return true;
+        }
+    }
+
+    assert(false);
+}
+
+static bool vm_call(VmCompiler *c, Expr *expr, Type *out) {
+    assert(expr->kind == EkFnCall);
+
+    if (expr->fncall.name->kind != EkIdent) {
+        return vm_fail(c->vm, expr->cursors_idx, "methods can't be called at compile time");
+    }
+
+    size_t idx;
+    if (!vm_fn_index(c->sema, c->vm, expr->fncall.name->ident, expr->cursors_idx, &idx)) return false;
+
+    FnDecl fndecl = c->vm->fns[idx].decl.fndecl;
+    if (fndecl.type.kind != TkVoid && !vm_check_type(c, fndecl.type, expr->cursors_idx)) return false;
+
+    // the callee copies an array result to an address the caller owns
+    size_t result = 0;
+    if (fndecl.type.kind == TkArray) {
+        result = vm_alloc(c, vm_cells(fndecl.type));
+        vm_emit(c, (Op){.code = OpAddr, .a = (uint32_t)result}, expr->cursors_idx);
+    }
+
+    if (arrlenu(expr->fncall.args.exprs) != arrlenu(fndecl.args)) {
+        return vm_fail(c->vm, expr->cursors_idx, "wrong number of arguments");
+    }
+
+    for (size_t i = 0; i < arrlenu(fndecl.args); i++) {
+        Type param = fndecl.args[i].constdecl.type;
+        Expr *arg = &expr->fncall.args.exprs[i];
+        if (!vm_check_type(c, param, arg->cursors_idx)) return false;
+
+        Type type;
+        if (!vm_expr(c, arg, &type)) return false;
+        if (param.kind != TkArray) vm_convert(c, type, param, arg->cursors_idx);
+    }
+
+    vm_emit(c, (Op){.code = OpCall, .a = (uint32_t)idx}, expr->cursors_idx);
+    if (fndecl.type.kind == TkArray) {
+        vm_emit(c, (Op){.code = OpAddr, .a = (uint32_t)result}, expr->cursors_idx);
+    }
+
+    *out = fndecl.type;
+    return true;
+}
+
+// writes value into the frame from slot
+static bool vm_init(VmCompiler *c, Type type, Expr *value, size_t slot) {
+    size_t cells = vm_cells(type);
+
+    if (value->kind == EkNone) {
+        vm_emit(c, (Op){.code = OpZero, .a = (uint32_t)cells, .b = (uint32_t)slot}, value->cursors_idx);
+        return true;
+    }
+
+    if (type.kind == TkArray && value->kind == EkLiteral) {
+        if (value->literal.kind != LitkExprs) {
+            return vm_fail(c->vm, value->cursors_idx, "array literal can't be evaluated at compile time");
+        }
+
+        // missing elements are zero, same as C
+        size_t len = arrlenu(value->literal.exprs);
+        if (len < (size_t)type.array.len->intlit) {
+            vm_emit(c, (Op){.code = OpZero, .a = (uint32_t)cells, .b = (uint32_t)slot}, value->cursors_idx);
+        }
+
+        size_t step = vm_cells(*type.array.of);
+        for (size_t i = 0; i < len; i++) {
+            if (!vm_init(c, *type.array.of, &value->literal.exprs[i], slot + i * step)) return false;
+        }
+        return true;
+    }
+
+    if (type.kind == TkArray) {
+        vm_emit(c, (Op){.code = OpAddr, .a = (uint32_t)slot}, value->cursors_idx);
+
+        Type from;
+        if (!vm_expr(c, value, &from)) return false;
+        vm_emit(c, (Op){.code = OpCopy, .a = (uint32_t)cells}, value->cursors_idx);
+        return true;
+    }
+
+    Type from;
+    if (!vm_expr(c, value, &from)) return false;
+    if (from.kind == TkArray) return vm_fail(c->vm, value->cursors_idx, "expected a value, got an array");
+
+    vm_convert(c, from, type, value->cursors_idx);
+    vm_emit(c, (Op){.code = OpStore, .a = (uint32_t)slot}, value->cursors_idx);
+    return true;
+}
+
+static bool vm_ident(VmCompiler *c, Expr *expr, Type *out) {
+    assert(expr->kind == EkIdent);
+
+    VmLocal *local = vm_find_local(c, expr->ident);
+    if (local != NULL) {
+        OpCode code = local->type.kind == TkArray ? OpAddr : OpLoad;
+        vm_emit(c, (Op){.code = code, .a = (uint32_t)local->slot}, expr->cursors_idx);
+        *out = local->type;
+        return true;
+    }
+
+    Stmnt decl = ast_find_decl(c->sema->ast, expr->ident);
+    if (decl.kind == SkConstDecl && decl.constdecl.type.kind == TkArray) {
+        if (!vm_check_type(c, decl.constdecl.type, expr->cursors_idx)) return false;
+
+        uint64_t addr;
+        if (!vm_static(c, decl.constdecl, &addr)) return false;
+
+        vm_push_const(c, addr, expr->cursors_idx);
+        *out = decl.constdecl.type;
+        return true;
+    }
+
+    ConstValue value;
+    if (decl.kind == SkConstDecl && eval_value(c->sema, &decl.constdecl.value, &value) && eval_convert(value, decl.constdecl.type, &value)) {
+        vm_push_const(c, value.u, expr->cursors_idx);
+        *out = value.type;
+        return true;
+    }
+
+    if (decl.kind == SkVarDecl) {
+        return vm_fail(c->vm, expr->cursors_idx, "global variable \"%s\" can't be used at compile time", expr->ident);
+    }
+    return vm_fail(c->vm, expr->cursors_idx, "\"%s\" is not known at compile time", expr->ident);
+}
+
+static bool vm_field_access(VmCompiler *c, Expr *expr, Type *out) {
+    assert(expr->kind == EkFieldAccess);
+    Expr *accessing = expr->fieldacc.accessing;
+
+    // <enum>.<field>
+    if (accessing->kind == EkIdent && vm_find_local(c, accessing->ident) == NULL) {
+        Stmnt decl = ast_find_decl(c->sema->ast, accessing->ident);
+
+        ConstValue value;
+        if (decl.kind == SkEnumDecl && eval_value(c->sema, expr, &value)) {
+            vm_push_const(c, value.u, expr->cursors_idx);
+            *out = value.type;
+            return true;
+        }
+    }
+
+    // <array>.len
+    Type type;
+    if (!vm_expr(c, accessing, &type)) return false;
+    if (type.kind != TkArray || !streq(expr->fieldacc.field->ident, "len")) {
+        return vm_fail(c->vm, expr->cursors_idx, "field access can't be evaluated at compile time");
+    }
+
+    vm_emit(c, (Op){.code = OpPop}, expr->cursors_idx);
+    vm_push_const(c, type.array.len->intlit, expr->cursors_idx);
+    *out = type_integer(TkUsize, TYPEVAR, 0);
+    return true;
+}
+
+static bool vm_expr(VmCompiler *c, Expr *expr, Type *out) {
+    switch (expr->kind) {
+        case EkIntLit:
+        case EkFloatLit:
+        case EkCharLit:
+        case EkTrue:
+        case EkFalse: {
+            ConstValue value;
+            if (!eval_value(c->sema, expr, &value)) {
+                return vm_fail(c->vm, expr->cursors_idx, "literal can't be evaluated at compile time");
+            }
+
+            vm_push_const(c, value.u, expr->cursors_idx);
+            *out = value.type;
+            return true;
+        }
+        case EkGrouping:
+            return vm_expr(c, expr->group, out);
+        case EkIdent:
+            return vm_ident(c, expr, out);
+        case EkFieldAccess:
+            return vm_field_access(c, expr, out);
+        case EkArrayIndex:
+            if (!vm_index(c, expr, out)) return false;
+            if (out->kind != TkArray) vm_emit(c, (Op){.code = OpLoadAt}, expr->cursors_idx);
+            return true;
+        case EkLiteral: {
+            if (expr->type.kind != TkArray) {
+                return vm_fail(c->vm, expr->cursors_idx, "only array literals can be evaluated at compile time");
+            }
+            if (!vm_check_type(c, expr->type, expr->cursors_idx)) return false;
+
+            size_t slot = vm_alloc(c, vm_cells(expr->type));
+            if (!vm_init(c, expr->type, expr, slot)) return false;
+
+            vm_emit(c, (Op){.code = OpAddr, .a = (uint32_t)slot}, expr->cursors_idx);
+            *out = expr->type;
+            return true;
+        }
+        case EkFnCall:
+            return vm_call(c, expr, out);
+        case EkUnop:
+            return vm_unop(c, expr, out);
+        case EkBinop: {
+            if (expr->binop.kind == BkAnd || expr->binop.kind == BkOr) return vm_logical(c, expr, out);
+
+            Type lhs, rhs;
+            if (!vm_expr(c, expr->binop.left, &lhs) || !vm_expr(c, expr->binop.right, &rhs)) return false;
+            if (lhs.kind == TkArray || rhs.kind == TkArray) {
+                return vm_fail(c->vm, expr->cursors_idx, "arrays can't be operands at compile time");
+            }
+
+            vm_emit(c, (Op){.code = OpBinop, .sub = expr->binop.kind, .lhs = lhs.kind, .rhs = rhs.kind}, expr->cursors_idx);
+            *out = eval_binop_type(expr->binop.kind, lhs, rhs);
+            return true;
+        }
+        case EkStrLit:
+        case EkCstrLit:
+            return vm_fail(c->vm, expr->cursors_idx, "strings can't be used at compile time");
+        case EkArraySlice:
+        case EkRangeLit:
+            return vm_fail(c->vm, expr->cursors_idx, "slices can't be used at compile time");
+        case EkNull:
+            return vm_fail(c->vm, expr->cursors_idx, "null can't be used at compile time");
+        case EkNone:
+        case EkType:
+            return vm_fail(c->vm, expr->cursors_idx, "expression can't be evaluated at compile time");
+    }
+
+    assert(false);
+}
+
+static bool vm_reassign(VmCompiler *c, Stmnt *stmnt) {
+    Expr *name = &stmnt->varreassign.name;
+    Expr *value = &stmnt->varreassign.value;
+
+    Type type;
+    size_t slot = 0;
+    bool at_slot = false;
+
+    if (name->kind == EkIdent) {
+        VmLocal *local = vm_find_local(c, name->ident);
+        if (local == NULL) {
+            return vm_fail(c->vm, stmnt->cursors_idx, "global variable \"%s\" can't be used at compile time", name->ident);
+        }
+
+        type = local->type;
+        slot = local->slot;
+        at_slot = true;
+
+        if (type.kind == TkArray) vm_emit(c, (Op){.code = OpAddr, .a = (uint32_t)slot}, stmnt->cursors_idx);
+    } else if (name->kind == EkArrayIndex) {
+        if (!vm_index(c, name, &type)) return false;
+    } else {
+        return vm_fail(c->vm, stmnt->cursors_idx, "only variables and array elements can be assigned at compile time");
+    }
+
+    Type from;
+    if (!vm_expr(c, value, &from)) return false;
+
+    if (type.kind == TkArray) {
+        vm_emit(c, (Op){.code = OpCopy, .a = (uint32_t)vm_cells(type)}, stmnt->cursors_idx);
+        return true;
+    }
+
+    vm_convert(c, from, type, stmnt->cursors_idx);
+    if (at_slot) {
+        vm_emit(c, (Op){.code = OpStore, .a = (uint32_t)slot}, stmnt->cursors_idx);
+    } else {
+        vm_emit(c, (Op){.code = OpStoreAt}, stmnt->cursors_idx);
+    }
+    return true;
+}
+
+static bool vm_return(VmCompiler *c, Stmnt *stmnt) {
+    Expr *value = &stmnt->returnf.value;
+
+    if (c->ret.kind == TkArray) {
+        // slot 0 is where the caller wants the result
+        vm_emit(c, (Op){.code = OpLoad, .a = 0}, stmnt->cursors_idx);
+
+        Type from;
+        if (!vm_expr(c, value, &from)) return false;
+        vm_emit(c, (Op){.code = OpCopy, .a = (uint32_t)vm_cells(c->ret)}, stmnt->cursors_idx);
+    } else if (value->kind != EkNone) {
+        Type from;
+        if (!vm_expr(c, value, &from)) return false;
+        vm_convert(c, from, c->ret, stmnt->cursors_idx);
+    }
+
+    vm_emit(c, (Op){.code = OpReturn}, stmnt->cursors_idx);
+    return true;
+}
+
+static bool vm_if(VmCompiler *c, Stmnt *stmnt) {
+    If *iff = &stmnt->iff;
+    if (iff->capturekind != CkNone) {
+        return vm_fail(c->vm, stmnt->cursors_idx, "if captures can't be used at compile time");
+    }
+
+    Type cond;
+    if (!vm_expr(c, &iff->condition, &cond)) return false;
+    size_t skip = vm_emit(c, (Op){.code = OpJumpIfFalse}, stmnt->cursors_idx);
+
+    if (!vm_block(c, iff->body)) return false;
+
+    if (iff->els == NULL) {
+        vm_patch(c, skip, vm_here(c));
+        return true;
+    }
+
+    size_t end = vm_emit(c, (Op){.code = OpJump}, stmnt->cursors_idx);
+    vm_patch(c, skip, vm_here(c));
+    if (!vm_block(c, iff->els)) return false;
+    vm_patch(c, end, vm_here(c));
+    return true;
+}
+
+static bool vm_for(VmCompiler *c, Stmnt *stmnt) {
+    For *forf = &stmnt->forf;
+    size_t locals = arrlenu(c->locals);
+    size_t breaks = arrlenu(c->breaks);
+    size_t continues = arrlenu(c->continues);
+
+    // the loop variable stays in scope for the whole loop
+    if (forf->decl != NULL && forf->decl->kind == SkVarDecl) {
+        VarDecl decl = forf->decl->vardecl;
+        if (!vm_check_type(c, decl.type, forf->decl->cursors_idx)) return false;
+
+        size_t slot = vm_alloc(c, vm_cells(decl.type));
+        if (!vm_init(c, decl.type, &decl.value, slot)) return false;
+        arrpush(c->locals, ((VmLocal){.name = decl.name.ident, .slot = slot, .type = decl.type}));
+    }
+
+    size_t top = vm_here(c);
+    size_t exit = 0;
+    bool has_cond = forf->condition.kind != EkNone;
+    if (has_cond) {
+        Type cond;
+        if (!vm_expr(c, &forf->condition, &cond)) return false;
+        exit = vm_emit(c, (Op){.code = OpJumpIfFalse}, stmnt->cursors_idx);
+    }
+
+    if (!vm_block(c, forf->body)) return false;
+
+    for (size_t i = continues; i < arrlenu(c->continues); i++) {
+        vm_patch(c, c->continues[i], vm_here(c));
+    }
+    arrsetlen(c->continues, continues);
+
+    if (forf->reassign != NULL && forf->reassign->kind == SkVarReassign) {
+        if (!vm_reassign(c, forf->reassign)) return false;
+    }
+    vm_emit(c, (Op){.code = OpJump, .a = (uint32_t)top}, stmnt->cursors_idx);
+
+    if (has_cond) vm_patch(c, exit, vm_here(c));
+    for (size_t i = breaks; i < arrlenu(c->breaks); i++) {
+        vm_patch(c, c->breaks[i], vm_here(c));
+    }
+    arrsetlen(c->breaks, breaks);
+
+    arrsetlen(c->locals, locals);
+    return true;
+}
+
+static bool vm_switch(VmCompiler *c, Stmnt *stmnt) {
+    Switch *sw = &stmnt->switchf;
+
+    Type type;
+    if (!vm_expr(c, &sw->value, &type)) return false;
+    if (type.kind == TkArray || is_float(type)) {
+        return vm_fail(c->vm, stmnt->cursors_idx, "switch can't be evaluated at compile time");
+    }
+
+    // ranges hold two's complement bits, compare them at 64 bits
+    Type wide = type_integer(sw->is_signed ? TkI64 : TkU64, TYPEVAR, 0);
+    vm_convert(c, type, wide, stmnt->cursors_idx);
+    size_t value = vm_alloc(c, 1);
+    vm_emit(c, (Op){.code = OpStore, .a = (uint32_t)value}, stmnt->cursors_idx);
+
+    Arr(size_t) to_case = NULL;
+    Arr(size_t) next = NULL;
+    for (size_t i = 0; i < arrlenu(sw->ranges); i++) {
+        CaseRange range = sw->ranges[i];
+        arrfree(next);
+
+        if (range.lo == range.hi) {
+            vm_emit(c, (Op){.code = OpLoad, .a = (uint32_t)value}, range.cursors_idx);
+            vm_push_const(c, range.lo, range.cursors_idx);
+            vm_emit(c, (Op){.code = OpBinop, .sub = BkEquals, .lhs = wide.kind, .rhs = wide.kind}, range.cursors_idx);
+            arrpush(next, vm_emit(c, (Op){.code = OpJumpIfFalse}, range.cursors_idx));
+        } else {
+            vm_emit(c, (Op){.code = OpLoad, .a = (uint32_t)value}, range.cursors_idx);
+            vm_push_const(c, range.lo, range.cursors_idx);
+            vm_emit(c, (Op){.code = OpBinop, .sub = BkGreaterEqual, .lhs = wide.kind, .rhs = wide.kind}, range.cursors_idx);
+            arrpush(next, vm_emit(c, (Op){.code = OpJumpIfFalse}, range.cursors_idx));
+
+            vm_emit(c, (Op){.code = OpLoad, .a = (uint32_t)value}, range.cursors_idx);
+            vm_push_const(c, range.hi, range.cursors_idx);
+            vm_emit(c, (Op){.code = OpBinop, .sub = BkLessEqual, .lhs = wide.kind, .rhs = wide.kind}, range.cursors_idx);
+            arrpush(next, vm_emit(c, (Op){.code = OpJumpIfFalse}, range.cursors_idx));
+        }
+
+        // a = case index until the case bodies are placed
+        arrpush(to_case, vm_emit(c, (Op){.code = OpJump, .a = (uint32_t)range.case_idx}, range.cursors_idx));
+        for (size_t j = 0; j < arrlenu(next); j++) vm_patch(c, next[j], vm_here(c));
+    }
+
+    size_t no_match = vm_emit(c, (Op){.code = OpJump}, stmnt->cursors_idx);
+    bool has_default = false;
+
+    Arr(size_t) starts = NULL;
+    Arr(size_t) ends = NULL;
+    bool ok = true;
+    for (size_t i = 0; i < arrlenu(sw->cases) && ok; i++) {
+        arrpush(starts, vm_here(c));
+        if (sw->cases[i].values == NULL) {
+            vm_patch(c, no_match, vm_here(c));
+            has_default = true;
+        }
+
+        size_t locals = arrlenu(c->locals);
+        ok = vm_block(c, sw->cases[i].body);
+        arrsetlen(c->locals, locals);
+        arrpush(ends, vm_emit(c, (Op){.code = OpJump}, stmnt->cursors_idx));
+    }
+
+    if (ok) {
+        for (size_t i = 0; i < arrlenu(to_case); i++) {
+            Op *op = &c->vm->fns[c->fn].code[to_case[i]];
+            op->a = (uint32_t)starts[op->a];
+        }
+        for (size_t i = 0; i < arrlenu(ends); i++) vm_patch(c, ends[i], vm_here(c));
+        if (!has_default) vm_patch(c, no_match, vm_here(c));
+    }
+
+    arrfree(to_case);
+    arrfree(next);
+    arrfree(starts);
+    arrfree(ends);
+    return ok;
+}
+
+static bool vm_stmnt(VmCompiler *c, Stmnt *stmnt) {
+    switch (stmnt->kind) {
+        case SkNone:
+            return true;
+        case SkVarDecl:
+        case SkConstDecl: {
+            VarDecl decl = stmnt->vardecl;
+            if (!vm_check_type(c, decl.type, stmnt->cursors_idx)) return false;
+
+            size_t slot = vm_alloc(c, vm_cells(decl.type));
+            if (!vm_init(c, decl.type, &decl.value, slot)) return false;
+            arrpush(c->locals, ((VmLocal){.name = decl.name.ident, .slot = slot, .type = decl.type}));
+            return true;
+        }
+        case SkVarReassign:
+            return vm_reassign(c, stmnt);
+        case SkReturn:
+            return vm_return(c, stmnt);
+        case SkIf:
+            return vm_if(c, stmnt);
+        case SkFor:
+            return vm_for(c, stmnt);
+        case SkSwitch:
+            return vm_switch(c, stmnt);
+        case SkBreak:
+            arrpush(c->breaks, vm_emit(c, (Op){.code = OpJump}, stmnt->cursors_idx));
+            return true;
+        case SkContinue:
+            arrpush(c->continues, vm_emit(c, (Op){.code = OpJump}, stmnt->cursors_idx));
+            return true;
+        case SkBlock:
+            return vm_block(c, stmnt->block);
+        case SkFnCall: {
+            Expr call = expr_fncall(stmnt->fncall, type_none(), stmnt->cursors_idx);
+
+            Type type;
+            if (!vm_expr(c, &call, &type)) return false;
+            if (type.kind != TkVoid) vm_emit(c, (Op){.code = OpPop}, stmnt->cursors_idx);
+            return true;
+        }
+        case SkDefer:
+            return vm_fail(c->vm, stmnt->cursors_idx, "defer can't be used at compile time");
+        case SkExtern:
+        case SkDirective:
+        case SkFnDecl:
+        case SkStructDecl:
+        case SkEnumDecl:
+        case SkUnionDecl:
+            return vm_fail(c->vm, stmnt->cursors_idx, "statement can't be evaluated at compile time");
+    }
+
+    assert(false);
+}
+
+static bool vm_block(VmCompiler *c, Arr(Stmnt) body) {
+    size_t locals = arrlenu(c->locals);
+
+    for (size_t i = 0; i < arrlenu(body); i++) {
+        if (!vm_stmnt(c, &body[i])) return false;
+    }
+
+    arrsetlen(c->locals, locals);
+    return true;
+}
+
+static void vm_compiler_free(VmCompiler *c) {
+    arrfree(c->locals);
+    arrfree(c->breaks);
+    arrfree(c->continues);
+}
+
+static bool vm_compile_fn(Sema *sema, Vm *vm, size_t idx) {
+    VmFn *fn = &vm->fns[idx];
+    FnDecl fndecl = fn->decl.fndecl;
+
+    arrfree(fn->code);
+    arrfree(fn->cursors);
+    arrfree(fn->consts);
+    arrfree(fn->params);
+
+    VmCompiler c = {
+        .sema = sema,
+        .vm = vm,
+        .fn = idx,
+        .ret = fndecl.type,
+    };
+
+    bool ok = true;
+    if (fndecl.type.kind == TkArray) {
+        // hidden result address
+        vm_alloc(&c, 1);
+    }
+
+    for (size_t i = 0; i < arrlenu(fndecl.args) && ok; i++) {
+        Stmnt arg = fndecl.args[i];
+        Type type = arg.constdecl.type;
+        if (!vm_check_type(&c, type, arg.cursors_idx)) {
+            ok = false;
+            break;
+        }
+
+        size_t slot = vm_alloc(&c, vm_cells(type));
+        arrpush(c.locals, ((VmLocal){.name = arg.constdecl.name.ident, .slot = slot, .type = type}));
+        arrpush(vm->fns[idx].params, ((VmParam){.slot = slot, .cells = vm_cells(type), .array = type.kind == TkArray}));
+    }
+    vm->fns[idx].args_cells = c.slots;
+
+    ok = ok && vm_block(&c, fndecl.body);
+    if (ok) {
+        vm_emit(&c, (Op){.code = fndecl.type.kind == TkVoid ? OpReturn : OpTrap}, fn->decl.cursors_idx);
+    }
+
+    fn = &vm->fns[idx];
+    fn->slots = c.slots;
+    fn->ret_array = fndecl.type.kind == TkArray;
+    fn->compiled = ok;
+
+    vm_compiler_free(&c);
+    return ok;
+}
+
+static uint64_t vm_hash(size_t fn, uint64_t *cells, size_t len) {
+    // fnv-1a over the bytes of the cells
+    uint64_t hash = UINT64_C(14695981039346656037) ^ fn;
+    for (size_t i = 0; i < len; i++) {
+        uint64_t cell = cells[i];
+        for (size_t b = 0; b < 8; b++) {
+            hash ^= (cell >> (b * 8)) & 0xff;
+            hash *= UINT64_C(1099511628211);
+        }
+    }
+    return hash;
+}
+
+static VmMemo *vm_memo_find(Vm *vm, size_t fn, uint64_t hash, uint64_t *key, size_t key_len) {
+    if (vm->memo_table == NULL) return NULL;
+
+    for (size_t i = hash & (VM_MEMO_TABLE - 1);; i = (i + 1) & (VM_MEMO_TABLE - 1)) {
+        uint32_t slot = vm->memo_table[i];
+        if (slot == 0) return NULL;
+
+        VmMemo *memo = &vm->memos[slot - 1];
+        if (memo->fn == fn && memo->hash == hash && memo->key_len == key_len
+            && memcmp(&vm->memo_cells[memo->key], key, key_len * sizeof(uint64_t)) == 0) {
+            return memo;
+        }
+    }
+}
+
+static void vm_memo_insert(Vm *vm, VmFrame frame, uint64_t *result, size_t result_len) {
+    size_t key_len = arrlenu(vm->keys) - frame.key;
+    if (arrlenu(vm->memos) >= VM_MAX_MEMO) return;
+    if (arrlenu(vm->memo_cells) + key_len + result_len > VM_MAX_CELLS) return;
+
+    if (vm->memo_table == NULL) {
+        vm->memo_table = ealloc(VM_MEMO_TABLE * sizeof(uint32_t));
+        memset(vm->memo_table, 0, VM_MEMO_TABLE * sizeof(uint32_t));
+    }
+
+    VmMemo memo = {
+        .fn = frame.fn,
+        .hash = frame.hash,
+        .key = arrlenu(vm->memo_cells),
+        .key_len = key_len,
+        .result = arrlenu(vm->memo_cells) + key_len,
+        .result_len = result_len,
+    };
+    for (size_t i = 0; i < key_len; i++) arrpush(vm->memo_cells, vm->keys[frame.key + i]);
+    for (size_t i = 0; i < result_len; i++) arrpush(vm->memo_cells, result[i]);
+    arrpush(vm->memos, memo);
+
+    size_t i = frame.hash & (VM_MEMO_TABLE - 1);
+    while (vm->memo_table[i] != 0) i = (i + 1) & (VM_MEMO_TABLE - 1);
+    vm->memo_table[i] = (uint32_t)arrlenu(vm->memos);
+}
+
+// pops the arguments, returns false on errors
+static bool vm_enter(Sema *sema, Vm *vm, size_t idx, size_t cursor_idx) {
+    if (!vm->fns[idx].compiled && !vm_compile_fn(sema, vm, idx)) return false;
+    VmFn *fn = &vm->fns[idx];
+    FnDecl fndecl = fn->decl.fndecl;
+
+    if (arrlenu(vm->frames) >= VM_MAX_DEPTH) {
+        return vm_fail(vm, cursor_idx, "calls are nested more than %d deep", VM_MAX_DEPTH);
+    }
+    if (arrlenu(vm->memory) + fn->slots > VM_MAX_CELLS) {
+        return vm_fail(vm, cursor_idx, "used more than %d cells of memory", VM_MAX_CELLS);
+    }
+
+    size_t fp = arrlenu(vm->memory);
+    arrsetlen(vm->memory, fp + fn->slots);
+    // a function without locals leaves memory NULL
+    if (fn->slots > 0) memset(&vm->memory[fp], 0, fn->slots * sizeof(uint64_t));
+
+    size_t nargs = arrlenu(fn->params) + fn->ret_array;
+    assert(arrlenu(vm->stack) >= nargs);
+    size_t arg = arrlenu(vm->stack) - nargs;
+
+    if (fn->ret_array) vm->memory[fp] = vm->stack[arg++];
+    for (size_t i = 0; i < arrlenu(fn->params); i++) {
+        VmParam param = fn->params[i];
+        uint64_t value = vm->stack[arg++];
+
+        if (param.array) {
+            memmove(&vm->memory[fp + param.slot], vm_at(vm, value), param.cells * sizeof(uint64_t));
+        } else {
+            vm->memory[fp + param.slot] = value;
+        }
+    }
+    arrsetlen(vm->stack, arrlenu(vm->stack) - nargs);
+
+    // nothing but the arguments can change the result, so every call is memoised
+    size_t key_from = fn->ret_array;
+    uint64_t *key = &vm->memory[fp + key_from];
+    size_t key_len = fn->args_cells - key_from;
+    uint64_t hash = vm_hash(idx, key, key_len);
+
+    VmMemo *memo = vm_memo_find(vm, idx, hash, key, key_len);
+    if (memo != NULL) {
+        uint64_t *result = &vm->memo_cells[memo->result];
+        if (fn->ret_array) {
+            memmove(vm_at(vm, vm->memory[fp]), result, memo->result_len * sizeof(uint64_t));
+        } else if (fndecl.type.kind != TkVoid) {
+            arrpush(vm->stack, result[0]);
+        }
+
+        arrsetlen(vm->memory, fp);
+        return true;
+    }
+
+    size_t key_at = arrlenu(vm->keys);
+    for (size_t i = 0; i < key_len; i++) arrpush(vm->keys, vm->memory[fp + key_from + i]);
+
+    arrpush(vm->frames, ((VmFrame){
+        .fn = idx,
+        .pc = 0,
+        .fp = fp,
+        .key = key_at,
+        .hash = hash,
+    }));
+    return true;
+}
+
+static uint64_t vm_pop(Vm *vm) {
+    assert(arrlenu(vm->stack) > 0);
+    return arrpop(vm->stack);
+}
+
+static bool vm_binop_fail(Vm *vm, Op op, size_t cursor_idx) {
+    switch ((BinopKind)op.sub) {
+        case BkDivide:
+        case BkMod:
+            return vm_fail(vm, cursor_idx, "division by zero or overflow");
+        case BkLeftShift:
+        case BkRightShift:
+            return vm_fail(vm, cursor_idx, "shift count is negative or too large");
+        default:
+            return vm_fail(vm, cursor_idx, "result is not a finite number");
+    }
+}
+
+// runs until the entry returns
+static bool vm_run(Sema *sema, Vm *vm) {
+    for (size_t steps = 0;; steps++) {
+        VmFrame *frame = &vm->frames[arrlenu(vm->frames) - 1];
+        VmFn *fn = &vm->fns[frame->fn];
+        size_t fp = frame->fp;
+        size_t cursor_idx = fn->cursors[frame->pc];
+        Op op = fn->code[frame->pc++];
+
+        if (steps > VM_MAX_STEPS) {
+            return vm_fail(vm, cursor_idx, "took more than %d steps", VM_MAX_STEPS);
+        }
+
+        switch ((OpCode)op.code) {
+            case OpPush:
+                arrpush(vm->stack, fn->consts[op.a]);
+                break;
+            case OpLoad:
+                arrpush(vm->stack, vm->memory[fp + op.a]);
+                break;
+            case OpStore:
+                vm->memory[fp + op.a] = vm_pop(vm);
+                break;
+            case OpAddr:
+                arrpush(vm->stack, fp + op.a);
+                break;
+            case OpLoadAt: {
+                uint64_t addr = vm_pop(vm);
+                arrpush(vm->stack, *vm_at(vm, addr));
+            } break;
+            case OpStoreAt: {
+                uint64_t value = vm_pop(vm);
+                uint64_t addr = vm_pop(vm);
+                *vm_at(vm, addr) = value;
+            } break;
+            case OpIndex: {
+                uint64_t index = vm_pop(vm);
+                uint64_t base = vm_pop(vm);
+                if (index >= op.a) {
+                    if ((int64_t)index < 0) {
+                        return vm_fail(vm, cursor_idx, "index %" PRIi64 " is out of bounds for an array of length %" PRIu32, (int64_t)index, op.a);
+                    }
+                    return vm_fail(vm, cursor_idx, "index %" PRIu64 " is out of bounds for an array of length %" PRIu32, index, op.a);
+                }
+                arrpush(vm->stack, base + index * op.b);
+            } break;
+            case OpCopy: {
+                uint64_t src = vm_pop(vm);
+                uint64_t dst = vm_pop(vm);
+                memmove(vm_at(vm, dst), vm_at(vm, src), op.a * sizeof(uint64_t));
+            } break;
+            case OpZero:
+                memset(&vm->memory[fp + op.b], 0, op.a * sizeof(uint64_t));
+                break;
+            case OpBinop: {
+                ConstValue rhs = {.type = {.kind = op.rhs}, .u = vm_pop(vm)};
+                ConstValue lhs = {.type = {.kind = op.lhs}, .u = vm_pop(vm)};
+
+                ConstValue result;
+                if (!eval_apply_binop(op.sub, lhs, rhs, &result)) return vm_binop_fail(vm, op, cursor_idx);
+                arrpush(vm->stack, result.u);
+            } break;
+            case OpUnop: {
+                ConstValue val = {.type = {.kind = op.lhs}, .u = vm_pop(vm)};
+
+                ConstValue result;
+                if (!eval_apply_unop(op.sub, val, &result)) {
+                    return vm_fail(vm, cursor_idx, "invalid operand");
+                }
+                arrpush(vm->stack, result.u);
+            } break;
+            case OpConvert: {
+                ConstValue val = {.type = {.kind = op.lhs}, .u = vm_pop(vm)};
+
+                ConstValue result;
+                if (!eval_convert(val, (Type){.kind = op.rhs}, &result)) {
+                    strb t = string_from_type((Type){.kind = op.rhs});
+                    vm_fail(vm, cursor_idx, "%g doesn't fit in %s", val.f, t);
+                    strbfree(t);
+                    return false;
+                }
+                arrpush(vm->stack, result.u);
+            } break;
+            case OpJump:
+                frame->pc = op.a;
+                break;
+            case OpJumpIfFalse:
+                if (!vm_pop(vm)) frame->pc = op.a;
+                break;
+            case OpCall:
+                if (!vm_enter(sema, vm, op.a, cursor_idx)) return false;
+                break;
+            case OpReturn: {
+                VmFrame done = arrpop(vm->frames);
+                // the entry's memory is kept so the result can be read
+                if (arrlenu(vm->frames) == 0) return true;
+
+                FnDecl fndecl = vm->fns[done.fn].decl.fndecl;
+                if (vm->fns[done.fn].ret_array) {
+                    vm_memo_insert(vm, done, vm_at(vm, vm->memory[done.fp]), vm_cells(fndecl.type));
+                } else if (fndecl.type.kind != TkVoid) {
+                    vm_memo_insert(vm, done, &vm->stack[arrlenu(vm->stack) - 1], 1);
+                }
+
+                arrsetlen(vm->keys, done.key);
+                arrsetlen(vm->memory, done.fp);
+            } break;
+            case OpPop:
+                vm_pop(vm);
+                break;
+            case OpTrap:
+                return vm_fail(vm, cursor_idx, "\"%s\" reached the end without returning a value", fn->name);
+        }
+    }
+}
+
+static bool vm_to_expr(Vm *vm, Type type, uint64_t *cells, size_t cursor_idx, Expr *out) {
+    if (type.kind == TkArray) {
+        Arr(Expr) exprs = NULL;
+        size_t step = vm_cells(*type.array.of);
+
+        for (size_t i = 0; i < (size_t)type.array.len->intlit; i++) {
+            Expr elem;
+            if (!vm_to_expr(vm, *type.array.of, cells + i * step, cursor_idx, &elem)) {
+                arrfree(exprs);
+                return false;
+            }
+            arrpush(exprs, elem);
+        }
+
+        *out = expr_literal((Literal){.kind = LitkExprs, .exprs = exprs}, type, cursor_idx);
+        return true;
+    }
+
+    ConstValue value = {.type = type, .u = cells[0]};
+    if (!eval_to_expr(value, type, cursor_idx, out)) {
+        strb t = string_from_type(type);
+        vm_fail(vm, cursor_idx, "result of type %s can't be written as a literal", t);
+        strbfree(t);
+        return false;
+    }
+    return true;
+}
+
+static Vm *vm_get(Sema *sema) {
+    if (sema->vm == NULL) {
+        sema->vm = ealloc(sizeof(Vm));
+        memset(sema->vm, 0, sizeof(Vm));
+        arrpush(sema->vm->fns, ((VmFn){.name = "", .decl = stmnt_none()}));
+    }
+    return sema->vm;
+}
+
+bool vm_eval_call(Sema *sema, Expr *call, Expr *out, strb *why, size_t *cursor_idx) {
+    assert(call->kind == EkFnCall);
+    Vm *vm = vm_get(sema);
+
+    strbfree(vm->why);
+    vm->why = NULL;
+    arrfree(vm->memory);
+    arrfree(vm->stack);
+    arrfree(vm->frames);
+    arrfree(vm->keys);
+
+    // the entry is just the call, its frame holds array results
+    VmFn *entry = &vm->fns[0];
+    arrfree(entry->code);
+    arrfree(entry->cursors);
+    arrfree(entry->consts);
+
+    VmCompiler c = {
+        .sema = sema,
+        .vm = vm,
+        .fn = 0,
+        .ret = call->type,
+    };
+
+    Type type;
+    bool ok = vm_expr(&c, call, &type);
+    if (ok && type.kind == TkVoid) ok = vm_fail(vm, call->cursors_idx, "function doesn't return a value");
+
+    if (ok) {
+        vm_emit(&c, (Op){.code = OpReturn}, call->cursors_idx);
+        vm->fns[0].slots = c.slots;
+
+        arrsetlen(vm->memory, c.slots);
+        if (c.slots > 0) memset(vm->memory, 0, c.slots * sizeof(uint64_t));
+        arrpush(vm->frames, ((VmFrame){.fn = 0}));
+
+        ok = vm_run(sema, vm);
+    }
+
+    if (ok) {
+        uint64_t result = vm_pop(vm);
+        uint64_t *cells = type.kind == TkArray ? vm_at(vm, result) : &result;
+        ok = vm_to_expr(vm, type, cells, call->cursors_idx, out);
+    }
+    vm_compiler_free(&c);
+
+    if (!ok) {
+        strbprintf(why, "%s", vm->why);
+        *cursor_idx = vm->why_cursor;
+    }
+    return ok;
+}
@@ -48,6 +48,109 @@ options() {
     echo escaped exit code: $?
 }
 
+soa() {
+    ./pine run tests/soa/main.pine
+    echo soa exit code: $?
+}
+
+unions() {
+    ./pine run tests/unions/main.pine
+    echo unions exit code: $?
+}
+
+switches() {
+    ./pine run tests/switch/main.pine -switch-report
+    echo switch exit code: $?
+}
+
+consteval() {
+    ./pine run tests/consteval/main.pine
+    echo consteval exit code: $?
+}
+
+comptime() {
+    ./pine run tests/comptime/main.pine
+    echo comptime exit code: $?
+}
+
+staticif() {
+    ./pine run tests/staticif/main.pine
+    echo staticif exit code: $?
+}
+
+rodata() {
+    ./pine run tests/rodata/main.pine
+    echo rodata exit code: $?
+}
+
+generics() {
+    ./pine run tests/generics/main.pine -instantiation-report
+    echo generics exit code: $?
+}
+
+imports() {
+    ./pine run tests/imports/main.pine
+    echo imports exit code: $?
+}
+
+pmi() {
+    ./pine build tests/pmi/shapes.pine -pmi
+    ./pine run tests/pmi/main.pine
+    echo pmi exit code: $?
+}
+
+ir() {
+    ./pine run tests/ir/main.pine
+    echo ir exit code: $?
+}
+
+defer() {
+    ./pine run tests/defer/main.pine
+    echo defer exit code: $?
+}
+
+inline() {
+    ./pine run tests/inline/main.pine
+    echo inline exit code: $?
+}
+
+shake() {
+    ./pine run tests/shake/main.pine -tree-shake-report
+    echo shake exit code: $?
+}
+
+byref() {
+    ./pine run tests/byref/main.pine
+    echo byref exit code: $?
+}
+
+alias() {
+    ./pine run tests/alias/main.pine -alias-report
+    echo alias exit code: $?
+}
+
+# function bodies are checked and generated on several threads, any race fails it
+# a race doesn't show up on every run, so it's built a few times
+tsan() {
+    gcc -g -O1 -pthread -fsanitize=thread -o pine_tsan src/*.c
+    code=0
+    for i in 1 2 3 4 5; do
+        TSAN_OPTIONS="halt_on_error=1" ./pine_tsan build tests/byref/main.pine -j 8 || code=$?
+    done
+    echo tsan exit code: $code
+    rm -f pine_tsan
+}
+
+native() {
+    ./pine run tests/native/main.pine -native
+    echo native exit code: $?
+}
+
+layout() {
+    ./pine run tests/layout/main.pine -layout-report
+    echo layout exit code: $?
+}
+
 all() {
     functions
     structs
@@ -58,6 +161,25 @@ all() {
     escaped
     arrays
     options
+    layout
+    soa
+    unions
+    switches
+    consteval
+    comptime
+    staticif
+    rodata
+    generics
+    imports
+    pmi
+    native
+    ir
+    defer
+    inline
+    shake
+    byref
+    alias
+    tsan
 }
 
 if [ "$option" == "functions" ]; then
@@ -78,6 +200,44 @@ elif [ "$option" == "arrays" ]; then
     arrays
 elif [ "$option" == "options" ]; then
     options
+elif [ "$option" == "layout" ]; then
+    layout
+elif [ "$option" == "soa" ]; then
+    soa
+elif [ "$option" == "unions" ]; then
+    unions
+elif [ "$option" == "switch" ]; then
+    switches
+elif [ "$option" == "consteval" ]; then
+    consteval
+elif [ "$option" == "comptime" ]; then
+    comptime
+elif [ "$option" == "staticif" ]; then
+    staticif
+elif [ "$option" == "rodata" ]; then
+    rodata
+elif [ "$option" == "generics" ]; then
+    generics
+elif [ "$option" == "imports" ]; then
+    imports
+elif [ "$option" == "pmi" ]; then
+    pmi
+elif [ "$option" == "native" ]; then
+    native
+elif [ "$option" == "ir" ]; then
+    ir
+elif [ "$option" == "defer" ]; then
+    defer
+elif [ "$option" == "inline" ]; then
+    inline
+elif [ "$option" == "shake" ]; then
+    shake
+elif [ "$option" == "byref" ]; then
+    byref
+elif [ "$option" == "alias" ]; then
+    alias
+elif [ "$option" == "tsan" ]; then
+    tsan
 elif [ "$option" == "all" ]; then
     all
 else